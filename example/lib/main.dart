@@ -180,7 +180,6 @@ class _HomePageState extends State<HomePage> {
         imageBytes: imageBytes,
         modelPath: modelPath,
         confThreshold: 0.3,
-        tempDirectory: appDir.path,
       );
 
       stopwatch.stop();
@@ -146,7 +146,6 @@ class _CameraScanPageState extends State<CameraScanPage> {
         imageBytes: imageBytes,
         modelPath: modelPath,
         confThreshold: 0.3,
-        tempDirectory: appDir.path,
       );
 
       // Cleanup temp file
@@ -1,8 +1,59 @@
 #import "DocLayoutKitPlugin.h"
 
 extern void initModel(const char* model_path);
+extern int initModelWithOptions(const char* model_path, const void* options);
 extern char* detectLayout(const char* img_path, float conf_threshold);
+extern char* detectLayoutFromEncoded(const uint8_t* data, size_t len, float conf_threshold);
+extern int detectLayoutFromEncodedAsync(const uint8_t* data, size_t len, float conf_threshold, int64_t request_id, void (*callback)(int64_t, char*));
+extern int detectLayoutToBuffer(const char* img_path, float conf_threshold, float* out, int32_t max_boxes);
+extern int detectLayoutFromEncodedToBuffer(const uint8_t* data, size_t len, float conf_threshold, float* out, int32_t max_boxes);
+extern int detectLayoutFromBytesToBuffer(const unsigned char* image_data, int width, int height, int channels, float conf_threshold, float* out, int32_t max_boxes);
+extern char* detectLayoutFromYuv(const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride, float conf_threshold);
+extern int detectLayoutFromYuvToBuffer(const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride, float conf_threshold, float* out, int32_t max_boxes);
+extern char* detectLayoutBatch(const uint8_t* const* data, const size_t* lens, int count, float conf_threshold);
 extern char* detectLayoutFromBytes(const unsigned char* image_data, int width, int height, int channels, float conf_threshold);
+extern void* createDetector(const char* model_path, const void* options);
+extern char* detectWithHandle(void* handle, const uint8_t* data, size_t len, float conf_threshold);
+extern int detectWithHandleToBuffer(void* handle, const uint8_t* data, size_t len, float conf_threshold, float* out, int32_t max_boxes);
+extern int detectWithHandleAsync(void* handle, const uint8_t* data, size_t len, float conf_threshold, int64_t request_id, void (*callback)(int64_t, char*));
+extern int detectAsyncWithOptions(void* handle, const uint8_t* data, size_t len, float conf_threshold, const void* options, int64_t request_id, void (*callback)(int64_t, char*));
+extern int cancelRequest(int64_t request_id);
+extern int cancelLane(int64_t lane);
+extern int64_t nextRequestId(void);
+extern void* detectWithCrops(void* handle, const uint8_t* data, size_t len, float conf_threshold, const void* options);
+extern void releaseCrops(void* result);
+extern char* detectRegion(void* handle, const uint8_t* data, size_t len, float conf_threshold, const void* previous, const void* region);
+extern int detectRegionAsync(void* handle, const uint8_t* data, size_t len, float conf_threshold, const void* previous, const void* region, const void* options, int64_t request_id, void (*callback)(int64_t, char*));
+extern char* transformResult(void* handle, const void* previous, const float* transform, int32_t width, int32_t height);
+extern char* detectBatchWithHandle(void* handle, const uint8_t* const* data, const size_t* lens, int count, float conf_threshold);
+extern void* openPageStream(void* handle, float conf_threshold, int32_t queue_depth, int64_t stream_id, void (*callback)(int64_t, int32_t, char*));
+extern int64_t pushPageEncoded(void* stream, const uint8_t* data, size_t len);
+extern int64_t pushPageFile(void* stream, const char* img_path);
+extern void closePageStream(void* stream);
+extern void* detectDocument(void* handle, const char* path, float conf_threshold, const void* options, int64_t document_id, void (*callback)(int64_t, int32_t, char*));
+extern void cancelDocument(void* document);
+extern void closeDocument(void* document);
+extern char* getStats(void);
+extern void resetStats(void);
+extern int trimMemory(void* handle, int shrink_arena);
+extern char* endProfiling(void* handle);
+extern char* getModelInfo(void* handle);
+extern char* warmupModel(int32_t iterations);
+extern char* warmupDetector(void* handle, int32_t iterations);
+extern char* getDeviceCapabilities(void);
+extern int setPostprocessOptions(void* handle, const void* options);
+extern char* detectTiledWithHandle(void* handle, const uint8_t* data, size_t len, float conf_threshold, const void* options);
+extern int configureResultCache(int64_t max_bytes, const char* disk_dir);
+extern void getResultCacheStats(void* stats);
+extern void clearResultCache(int remove_disk);
+extern void* createTracker(void* handle, const void* options);
+extern char* trackFrameFromBytes(void* tracker, const unsigned char* image_data, int width, int height, int channels, float conf_threshold);
+extern int trackFrameFromBytesToBuffer(void* tracker, const unsigned char* image_data, int width, int height, int channels, float conf_threshold, float* out, int32_t max_boxes);
+extern char* trackFrameFromYuv(void* tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride, float conf_threshold);
+extern int trackFrameFromYuvToBuffer(void* tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride, float conf_threshold, float* out, int32_t max_boxes);
+extern void resetTracker(void* tracker);
+extern void destroyTracker(void* tracker);
+extern void destroyDetector(void* handle);
 extern void freeString(char* str);
 extern const char* getVersion(void);
 
@@ -21,8 +72,54 @@ extern const char* getVersion(void);
     // These calls use invalid parameters so they won't actually execute
     if (version == NULL) {
         initModel("/nonexistent");
+        initModelWithOptions("/nonexistent", NULL);
         detectLayout("/nonexistent", 0.0f);
+        detectLayoutFromEncoded(NULL, 0, 0.0f);
+        detectLayoutFromEncodedAsync(NULL, 0, 0.0f, 0, NULL);
+        detectLayoutToBuffer(NULL, 0.0f, NULL, 0);
+        detectLayoutFromEncodedToBuffer(NULL, 0, 0.0f, NULL, 0);
+        detectLayoutFromBytesToBuffer(NULL, 0, 0, 0, 0.0f, NULL, 0);
+        detectLayoutFromYuv(NULL, NULL, NULL, 0, 0, 0, 0, 0, 0.0f);
+        detectLayoutFromYuvToBuffer(NULL, NULL, NULL, 0, 0, 0, 0, 0, 0.0f, NULL, 0);
+        detectLayoutBatch(NULL, NULL, 0, 0.0f);
         detectLayoutFromBytes(NULL, 0, 0, 0, 0.0f);
+        destroyDetector(createDetector(NULL, NULL));
+        detectWithHandle(NULL, NULL, 0, 0.0f);
+        detectWithHandleToBuffer(NULL, NULL, 0, 0.0f, NULL, 0);
+        detectWithHandleAsync(NULL, NULL, 0, 0.0f, 0, NULL);
+        detectAsyncWithOptions(NULL, NULL, 0, 0.0f, NULL, 0, NULL);
+        cancelRequest(0);
+        cancelLane(0);
+        nextRequestId();
+        releaseCrops(detectWithCrops(NULL, NULL, 0, 0.0f, NULL));
+        freeString(detectRegion(NULL, NULL, 0, 0.0f, NULL, NULL));
+        detectRegionAsync(NULL, NULL, 0, 0.0f, NULL, NULL, NULL, 0, NULL);
+        freeString(transformResult(NULL, NULL, NULL, 0, 0));
+        detectBatchWithHandle(NULL, NULL, NULL, 0, 0.0f);
+        pushPageEncoded(NULL, NULL, 0);
+        pushPageFile(NULL, NULL);
+        closePageStream(openPageStream(NULL, 0.0f, 0, 0, NULL));
+        cancelDocument(NULL);
+        closeDocument(detectDocument(NULL, NULL, 0.0f, NULL, 0, NULL));
+        freeString(getStats());
+        resetStats();
+        trimMemory(NULL, 0);
+        freeString(endProfiling(NULL));
+        freeString(getModelInfo(NULL));
+        freeString(warmupModel(0));
+        freeString(warmupDetector(NULL, 0));
+        freeString(getDeviceCapabilities());
+        setPostprocessOptions(NULL, NULL);
+        freeString(detectTiledWithHandle(NULL, NULL, 0, 0.0f, NULL));
+        configureResultCache(-1, NULL);
+        getResultCacheStats(NULL);
+        clearResultCache(0);
+        trackFrameFromBytes(NULL, NULL, 0, 0, 0, 0.0f);
+        trackFrameFromBytesToBuffer(NULL, NULL, 0, 0, 0, 0.0f, NULL, 0);
+        trackFrameFromYuv(NULL, NULL, NULL, NULL, 0, 0, 0, 0, 0, 0.0f);
+        trackFrameFromYuvToBuffer(NULL, NULL, NULL, NULL, 0, 0, 0, 0, 0, 0.0f, NULL, 0);
+        resetTracker(NULL);
+        destroyTracker(createTracker(NULL, NULL));
         freeString(NULL);
     }
     NSLog(@"DocLayoutKit: All symbols retained");
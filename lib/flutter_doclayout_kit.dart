@@ -1,15 +1,27 @@
 import 'dart:convert';
 import 'dart:ffi';
-import 'dart:io';
 import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
 
 import 'flutter_doclayout_kit_bindings_generated.dart';
+import 'src/doc_layout_detector.dart';
+import 'src/incremental.dart';
 import 'src/models.dart';
+import 'src/native_async.dart';
+import 'src/native_library.dart';
+import 'src/page_stream.dart';
+import 'src/region_crops.dart';
+import 'src/result_buffer.dart';
 
 export 'src/models.dart';
+export 'src/incremental.dart' show LayoutRegion, ResultTransform;
+export 'src/native_async.dart' show DetectionCancelToken;
+export 'src/region_crops.dart' hide detectWithCropsOnHandle;
 export 'src/doc_layout_service.dart';
+export 'src/doc_layout_detector.dart';
+export 'src/doc_layout_tracker.dart';
+export 'src/doc_layout_worker.dart';
 export 'src/html_generator.dart';
 export 'src/form_html_generator.dart';
 export 'src/form_editor_widget.dart';
@@ -32,33 +44,13 @@ export 'src/form_editor_widget.dart';
 /// }
 /// ```
 class DocLayoutKit {
-  static DocLayoutKitBindings? _bindings;
   static bool _isInitialized = false;
 
   /// Private constructor
   DocLayoutKit._();
 
   /// Get native bindings (lazy initialization)
-  static DocLayoutKitBindings get _native {
-    _bindings ??= DocLayoutKitBindings(_loadLibrary());
-    return _bindings!;
-  }
-
-  /// Load native library based on platform
-  static DynamicLibrary _loadLibrary() {
-    if (Platform.isIOS || Platform.isMacOS) {
-      // iOS/macOS: Static library linked into main binary
-      return DynamicLibrary.process();
-    }
-    if (Platform.isAndroid || Platform.isLinux) {
-      return DynamicLibrary.open('libdoc_layout_kit.so');
-    }
-    if (Platform.isWindows) {
-      return DynamicLibrary.open('doc_layout_kit.dll');
-    }
-
-    throw UnsupportedError('Unsupported platform: ${Platform.operatingSystem}');
-  }
+  static DocLayoutKitBindings get _native => docLayoutBindings;
 
   /// Check if the library is initialized
   static bool get isInitialized => _isInitialized;
@@ -72,16 +64,142 @@ class DocLayoutKit {
   /// Initialize the detection model
   ///
   /// [modelPath] - Path to the ONNX model file
+  /// [options] - Session threading, optimization and execution providers
   ///
-  /// This must be called before any detection operations.
-  static void init(String modelPath) {
-    final pathPtr = modelPath.toNativeUtf8().cast<Char>();
+  /// This must be called before any detection operations. The model is
+  /// loaded immediately; calling [init] again with a different path or
+  /// options swaps the model, calling it with the same ones keeps the
+  /// loaded session. Throws [StateError] if the model cannot be loaded.
+  static void init(
+    String modelPath, {
+    DetectorOptions options = const DetectorOptions(),
+  }) {
+    using((arena) {
+      final pathPtr = modelPath.toNativeUtf8(allocator: arena).cast<Char>();
+      final optionsPtr = arena<DocLayoutOptions>();
+      options.writeTo(optionsPtr.ref, arena);
+      if (_native.initModelWithOptions(pathPtr, optionsPtr) == 0) {
+        _isInitialized = false;
+        throw StateError('Failed to load model: $modelPath');
+      }
+    });
+    _isInitialized = true;
+  }
+
+  /// Per-stage latency percentiles over the recent detection calls
+  ///
+  /// Stages are decode, preprocess (color conversion, resize and tensor
+  /// layout in one fused pass), run (`session.Run`), parse, serialize and
+  /// total. Use it to tell whether a device is bound by preprocessing or
+  /// by inference.
+  static LatencyStats get stats {
+    final ptr = _native.getStats();
     try {
-      _native.initModel(pathPtr);
+      final jsonStr = ptr.cast<Utf8>().toDartString();
+      return LatencyStats.fromJson(jsonDecode(jsonStr));
     } finally {
-      calloc.free(pathPtr);
+      _native.freeString(ptr);
+    }
+  }
+
+  /// Clear the latency samples
+  static void resetStats() => _native.resetStats();
+
+  /// Release the default model's idle native memory
+  ///
+  /// Frees pooled decode buffers, batch buffers and the free blocks of ONNX
+  /// Runtime's CPU arena, which otherwise keeps its peak size for the life
+  /// of the session. Call it when the app goes to the background, e.g. from
+  /// `AppLifecycleState.paused`. The model stays loaded.
+  ///
+  /// ONNX Runtime only shrinks the arena at the end of a run, so with
+  /// [shrinkArena] the call runs one full inference on the calling isolate,
+  /// as slow as a detection, after waiting for running ones. Pass `false`
+  /// to release only the buffers and return quickly.
+  static void trimMemory({bool shrinkArena = true}) {
+    _checkInitialized();
+    _native.trimMemory(nullptr, shrinkArena ? 1 : 0);
+  }
+
+  /// Stop ONNX Runtime profiling on the default model
+  ///
+  /// Returns the trace file path, or null unless
+  /// [DetectorOptions.profileFilePrefix] was set in [init].
+  static String? endProfiling() {
+    _checkInitialized();
+    return readProfilePath(_native.endProfiling(nullptr));
+  }
+
+  /// Run [iterations] dummy inferences on every run context of the default
+  /// model
+  ///
+  /// The first inference on a fresh session is several times slower than
+  /// the rest: ONNX Runtime picks kernels, grows its memory arena and, with
+  /// NNAPI or Core ML, compiles the graph on it. Warming up moves that cost
+  /// out of the first user-visible detection. The runs use a synthetic page
+  /// at the model input size and are not recorded in [stats]. Blocks for a
+  /// few inference times; use `DocLayoutService.preload` to do it off the
+  /// UI isolate.
+  static WarmupResult warmup({int iterations = 2}) {
+    _checkInitialized();
+    return warmupHandle(nullptr, iterations);
+  }
+
+  /// Inputs, outputs, variant and class table of the default model
+  static ModelInfo get modelInfo {
+    _checkInitialized();
+    return readModelInfo(nullptr);
+  }
+
+  /// CPU features of this device and the model precisions
+  /// [ModelPrecision.auto] tries, fastest first; needs no loaded model
+  static DeviceCapabilities get deviceCapabilities => readDeviceCapabilities();
+
+  /// Enable the native result cache
+  ///
+  /// Results of [detectFromFile], [detectFromEncoded], the batch calls and
+  /// [DocLayoutDetector.detectFromEncoded] are cached under a hash of the
+  /// input bytes, the confidence threshold and the model, so re-submitted
+  /// pages skip decode and inference. [maxBytes] bounds the memory used,
+  /// 0 disables the cache. With a [diskDirectory] entries are also written
+  /// there and survive restarts. Returns false if the directory cannot be
+  /// created.
+  static bool configureCache({
+    required int maxBytes,
+    String? diskDirectory,
+  }) {
+    final dirPtr = diskDirectory?.toNativeUtf8().cast<Char>() ?? nullptr;
+    try {
+      return _native.configureResultCache(maxBytes, dirPtr) == 0;
+    } finally {
+      if (dirPtr != nullptr) calloc.free(dirPtr);
+    }
+  }
+
+  /// Hit/miss counters of the result cache
+  static ResultCacheStats get cacheStats {
+    final statsPtr = calloc<DocLayoutCacheStats>();
+    try {
+      _native.getResultCacheStats(statsPtr);
+      final stats = statsPtr.ref;
+      return ResultCacheStats(
+        hits: stats.hits,
+        misses: stats.misses,
+        diskHits: stats.disk_hits,
+        evictions: stats.evictions,
+        entries: stats.entries,
+        bytes: stats.bytes,
+      );
+    } finally {
+      calloc.free(statsPtr);
     }
-    _isInitialized = true;
+  }
+
+  /// Drop the cached results and reset the counters
+  ///
+  /// With [removeDisk] the entries in the disk directory are deleted too.
+  static void clearCache({bool removeDisk = false}) {
+    _native.clearResultCache(removeDisk ? 1 : 0);
   }
 
   /// Detect document layout from image file
@@ -91,7 +209,8 @@ class DocLayoutKit {
   ///
   /// Returns [DetectionResult] containing detected layout elements
   ///
-  /// Note: The native code runs inference asynchronously internally.
+  /// Note: Inference runs on the calling thread. Use [detectFromEncodedAsync]
+  /// or [DocLayoutService] to keep it off the UI thread.
   static DetectionResult detectFromFile(
     String imagePath, {
     double confThreshold = 0.5,
@@ -99,20 +218,253 @@ class DocLayoutKit {
     _checkInitialized();
 
     final pathPtr = imagePath.toNativeUtf8().cast<Char>();
-    Pointer<Char>? resultPtr;
+    final buffer = ResultBuffer.shared;
 
     try {
-      resultPtr = _native.detectLayout(pathPtr, confThreshold);
-      final jsonStr = resultPtr.cast<Utf8>().toDartString();
-      return DetectionResult.fromJson(jsonDecode(jsonStr));
+      _native.detectLayoutToBuffer(
+          pathPtr, confThreshold, buffer.pointer, buffer.capacity);
+      return buffer.toResult();
     } finally {
       calloc.free(pathPtr);
-      if (resultPtr != null) {
+    }
+  }
+
+  /// Detect document layout from encoded image bytes
+  ///
+  /// [encodedImage] - Image file contents in any format supported by OpenCV (PNG, JPEG, etc.)
+  /// [confThreshold] - Confidence threshold (0.0 - 1.0), default 0.5
+  ///
+  /// The image is decoded in native memory, no temporary file is written.
+  static DetectionResult detectFromEncoded(
+    Uint8List encodedImage, {
+    double confThreshold = 0.5,
+  }) {
+    _checkInitialized();
+
+    final dataPtr = calloc<Uint8>(encodedImage.length);
+    final buffer = ResultBuffer.shared;
+
+    try {
+      dataPtr.asTypedList(encodedImage.length).setAll(0, encodedImage);
+
+      _native.detectLayoutFromEncodedToBuffer(
+        dataPtr,
+        encodedImage.length,
+        confThreshold,
+        buffer.pointer,
+        buffer.capacity,
+      );
+      return buffer.toResult();
+    } finally {
+      calloc.free(dataPtr);
+    }
+  }
+
+  /// Configure the native postprocess of the default model
+  ///
+  /// Per-class thresholds, class-aware NMS, containment suppression and
+  /// reading-order sorting run in C++ right after inference, so overlap
+  /// handling no longer needs an O(N²) pass in Dart. Applies to every
+  /// following detection until changed; results already cached were
+  /// produced with the old options and are not reused.
+  static void setPostprocess(PostprocessOptions options) {
+    _checkInitialized();
+    writePostprocessOptions(nullptr, options);
+  }
+
+  /// Detect on a dense high-resolution page as overlapping tiles
+  ///
+  /// Newspapers, engineering drawings and A3 scans lose small elements
+  /// (formula numbers, footnotes, page numbers) when squeezed into the
+  /// model input. The page is split into overlapping [tiles] that run as
+  /// one batch (or in parallel with [DetectorOptions.maxConcurrentRuns] on
+  /// models without batch support), plus the whole page unless disabled,
+  /// and the boxes are merged with class-aware NMS in original-image
+  /// coordinates. Costs roughly one inference per tile.
+  static DetectionResult detectTiledFromEncoded(
+    Uint8List encodedImage, {
+    double confThreshold = 0.5,
+    TileOptions tiles = const TileOptions(),
+  }) {
+    _checkInitialized();
+    return detectTiledOnHandle(nullptr, encodedImage, confThreshold, tiles);
+  }
+
+  /// Detect and crop the selected detections from the same decode
+  ///
+  /// The page is decoded once, natively and at full resolution; the boxes
+  /// of [crops]' classes are cut out of it as raw BGR views (no copy) or
+  /// PNG / JPEG bytes, ready for OCR or export without decoding the image
+  /// again in Dart. Call [CropResult.release] when done with the crops.
+  static CropResult detectWithCrops(
+    Uint8List encodedImage, {
+    double confThreshold = 0.5,
+    CropOptions crops = CropOptions.ocrTargets,
+  }) {
+    _checkInitialized();
+    return detectWithCropsOnHandle(nullptr, encodedImage, confThreshold, crops);
+  }
+
+  /// Re-detect only the part of a page that changed
+  ///
+  /// For form editing: after the user re-captures a field or pastes a
+  /// signature, [region] of [encodedImage] is grown to cover every box of
+  /// [previous] it touches and only that crop goes through the model; the
+  /// boxes outside it are kept. The result carries [DetectionBox.diff]
+  /// (unchanged, added or updated), [DetectionBox.previousIndex] and
+  /// [DetectionResult.removed], which [FormHtmlGenerator.generateUpdateScript]
+  /// turns into an in-place update of the generated HTML. A null region
+  /// re-detects the whole page (and still diffs it against [previous]).
+  static Future<DetectionResult> detectRegionAsync(
+    Uint8List encodedImage, {
+    required DetectionResult previous,
+    LayoutRegion? region,
+    double confThreshold = 0.5,
+    Duration? deadline,
+    DetectionCancelToken? cancelToken,
+  }) {
+    _checkInitialized();
+    return submitRegionOnHandle(
+        nullptr, encodedImage, confThreshold, previous, region,
+        deadline: deadline, cancelToken: cancelToken);
+  }
+
+  /// Synchronous [detectRegionAsync], runs on the calling thread
+  static DetectionResult detectRegion(
+    Uint8List encodedImage, {
+    required DetectionResult previous,
+    LayoutRegion? region,
+    double confThreshold = 0.5,
+  }) {
+    _checkInitialized();
+    return detectRegionOnHandle(
+        nullptr, encodedImage, confThreshold, previous, region);
+  }
+
+  /// Remap [previous] after the page was only rotated, flipped or scaled
+  ///
+  /// No decode and no inference: every box goes through [transform] and is
+  /// marked [DetectionDiff.moved]; boxes that end up off the page are in
+  /// [DetectionResult.removed]. Works without a loaded model.
+  static DetectionResult transformResult(
+    DetectionResult previous,
+    ResultTransform transform,
+  ) {
+    return transformResultOnHandle(nullptr, previous, transform);
+  }
+
+  /// Detect document layout on several encoded images at once
+  ///
+  /// Pages are run through the model in batches of
+  /// [DetectorOptions.maxBatchSize], which amortizes per-run overhead for
+  /// multi-page documents. Returns one result per entry of [encodedImages],
+  /// in the same order; pages that fail to decode carry their own error.
+  static List<DetectionResult> detectBatchFromEncoded(
+    List<Uint8List> encodedImages, {
+    double confThreshold = 0.5,
+  }) {
+    _checkInitialized();
+    if (encodedImages.isEmpty) return [];
+
+    return using((arena) {
+      final count = encodedImages.length;
+      final dataPtrs = arena<Pointer<Uint8>>(count);
+      final lens = arena<Size>(count);
+      for (var i = 0; i < count; i++) {
+        final bytes = encodedImages[i];
+        final ptr = arena<Uint8>(bytes.isEmpty ? 1 : bytes.length);
+        ptr.asTypedList(bytes.length).setAll(0, bytes);
+        dataPtrs[i] = ptr;
+        lens[i] = bytes.length;
+      }
+
+      final resultPtr =
+          _native.detectLayoutBatch(dataPtrs, lens, count, confThreshold);
+      try {
+        final jsonStr = resultPtr.cast<Utf8>().toDartString();
+        return DetectionResult.listFromBatchJson(jsonDecode(jsonStr), count);
+      } finally {
         _native.freeString(resultPtr);
       }
-    }
+    });
+  }
+
+  /// Stream detection over many encoded pages
+  ///
+  /// Pages run through a native pipeline with one thread per stage
+  /// (decode, preprocess, inference, serialize) and bounded queues of
+  /// [queueDepth] in between, so the next page is decoded and resized while
+  /// the current one is in inference. Results are emitted in page order;
+  /// [pages] is read lazily as the pipeline makes room.
+  static Stream<DetectionResult> detectPages(
+    Iterable<Uint8List> pages, {
+    double confThreshold = 0.5,
+    int queueDepth = defaultPageQueueDepth,
+  }) {
+    _checkInitialized();
+    return runPageStream(nullptr, pages,
+        confThreshold: confThreshold, queueDepth: queueDepth);
   }
 
+  /// Stream detection over the pages of a multi-page TIFF at [path]
+  ///
+  /// Pages are read natively one at a time, reduced to the resolution the
+  /// model needs and fed to the same pipeline as [detectPages], so only a
+  /// few pages are in memory however long the document is. Emits one result
+  /// per page from [firstPage] (0-based), [pageCount] pages or to the end,
+  /// in page order. Other image files are one-page documents. PDFs are not
+  /// decoded natively: rasterize them on the platform side and use
+  /// [detectPages]. A file that cannot be opened is reported as a
+  /// [StateError] on the stream.
+  static Stream<DetectionResult> detectDocument(
+    String path, {
+    double confThreshold = 0.5,
+    int firstPage = 0,
+    int? pageCount,
+    int queueDepth = defaultPageQueueDepth,
+  }) {
+    _checkInitialized();
+    return runDocumentStream(nullptr, path,
+        confThreshold: confThreshold,
+        firstPage: firstPage,
+        pageCount: pageCount,
+        queueDepth: queueDepth);
+  }
+
+  /// Detect document layout from encoded image bytes without blocking
+  ///
+  /// The request is queued on the long-lived native worker thread and the
+  /// future completes when it finishes, so no isolate or thread is spawned
+  /// per call.
+  ///
+  /// [deadline] gives up on the request that long after the call, stopping
+  /// the inference if it is already running (`DEADLINE_EXCEEDED` error).
+  /// With [latestWins] a new call stops the older pending [latestWins] calls,
+  /// which complete with a `SUPERSEDED` error: for live preview, where only
+  /// the newest frame matters. [cancelToken] cancels the request on demand
+  /// (`CANCELLED` error).
+  static Future<DetectionResult> detectFromEncodedAsync(
+    Uint8List encodedImage, {
+    double confThreshold = 0.5,
+    Duration? deadline,
+    bool latestWins = false,
+    DetectionCancelToken? cancelToken,
+  }) {
+    _checkInitialized();
+
+    final dataPtr = calloc<Uint8>(encodedImage.length);
+    dataPtr.asTypedList(encodedImage.length).setAll(0, encodedImage);
+
+    return NativeAsyncDispatcher.instance.submitEncoded(
+        nullptr, dataPtr, encodedImage.length, confThreshold,
+        deadline: deadline,
+        lane: latestWins ? _latestLane : 0,
+        cancelToken: cancelToken);
+  }
+
+  /// Lane of the default model's [detectFromEncodedAsync] latestWins calls
+  static final int _latestLane = _native.nextRequestId();
+
   /// Detect document layout from raw image bytes
   ///
   /// [imageData] - Raw image bytes (RGB or RGBA format)
@@ -131,30 +483,77 @@ class DocLayoutKit {
   }) {
     _checkInitialized();
 
-    final dataPtr = calloc<UnsignedChar>(imageData.length);
-    Pointer<Char>? resultPtr;
+    final dataPtr = calloc<Uint8>(imageData.length);
+    final buffer = ResultBuffer.shared;
 
     try {
       // Copy image data to native memory
-      for (int i = 0; i < imageData.length; i++) {
-        dataPtr[i] = imageData[i];
-      }
+      dataPtr.asTypedList(imageData.length).setAll(0, imageData);
 
-      resultPtr = _native.detectLayoutFromBytes(
-        dataPtr,
+      _native.detectLayoutFromBytesToBuffer(
+        dataPtr.cast<UnsignedChar>(),
         width,
         height,
         channels,
         confThreshold,
+        buffer.pointer,
+        buffer.capacity,
       );
+      return buffer.toResult();
+    } finally {
+      calloc.free(dataPtr);
+    }
+  }
+
+  /// Detect document layout from a YUV 4:2:0 camera frame
+  ///
+  /// Takes the planes as delivered by the camera plugin on Android
+  /// (`CameraImage.planes` with `ImageFormatGroup.yuv420`): for NV21/NV12
+  /// pass [uvPixelStride] 2, for I420 pass 1. Color conversion and
+  /// downscaling to the model input happen in one native pass, so no RGB
+  /// copy of the frame is built on either side.
+  static DetectionResult detectFromYuv({
+    required Uint8List yPlane,
+    required Uint8List uPlane,
+    required Uint8List vPlane,
+    required int width,
+    required int height,
+    required int yRowStride,
+    required int uvRowStride,
+    int uvPixelStride = 1,
+    double confThreshold = 0.5,
+  }) {
+    _checkInitialized();
 
-      final jsonStr = resultPtr.cast<Utf8>().toDartString();
-      return DetectionResult.fromJson(jsonDecode(jsonStr));
+    final total = yPlane.length + uPlane.length + vPlane.length;
+    final dataPtr = calloc<Uint8>(total == 0 ? 1 : total);
+    final buffer = ResultBuffer.shared;
+
+    try {
+      // One native block holding the three planes back to back
+      final yPtr = dataPtr;
+      final uPtr = dataPtr + yPlane.length;
+      final vPtr = uPtr + uPlane.length;
+      yPtr.asTypedList(yPlane.length).setAll(0, yPlane);
+      uPtr.asTypedList(uPlane.length).setAll(0, uPlane);
+      vPtr.asTypedList(vPlane.length).setAll(0, vPlane);
+
+      _native.detectLayoutFromYuvToBuffer(
+        yPtr,
+        uPtr,
+        vPtr,
+        width,
+        height,
+        yRowStride,
+        uvRowStride,
+        uvPixelStride,
+        confThreshold,
+        buffer.pointer,
+        buffer.capacity,
+      );
+      return buffer.toResult();
     } finally {
       calloc.free(dataPtr);
-      if (resultPtr != null) {
-        _native.freeString(resultPtr);
-      }
     }
   }
 
@@ -23,6 +23,22 @@ class DocLayoutKitBindings {
   late final _initModel =
       _initModelPtr.asFunction<void Function(ffi.Pointer<ffi.Char>)>();
 
+  /// Initialize model with path and session options
+  /// int initModelWithOptions(const char* model_path, const DocLayoutOptions* options)
+  int initModelWithOptions(
+    ffi.Pointer<ffi.Char> modelPath,
+    ffi.Pointer<DocLayoutOptions> options,
+  ) {
+    return _initModelWithOptions(modelPath, options);
+  }
+
+  late final _initModelWithOptionsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>,
+              ffi.Pointer<DocLayoutOptions>)>>('initModelWithOptions');
+  late final _initModelWithOptions = _initModelWithOptionsPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<DocLayoutOptions>)>();
+
   /// Detect layout from image file path
   /// char* detectLayout(const char* img_path, float conf_threshold)
   ffi.Pointer<ffi.Char> detectLayout(
@@ -37,6 +53,65 @@ class DocLayoutKitBindings {
   late final _detectLayout = _detectLayoutPtr
       .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Char>, double)>();
 
+  /// Detect layout from encoded image bytes (PNG, JPEG, ...)
+  /// char* detectLayoutFromEncoded(const uint8_t* data, size_t len, float conf_threshold)
+  ffi.Pointer<ffi.Char> detectLayoutFromEncoded(
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+  ) {
+    return _detectLayoutFromEncoded(data, len, confThreshold);
+  }
+
+  late final _detectLayoutFromEncodedPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Uint8>, ffi.Size,
+              ffi.Float)>>('detectLayoutFromEncoded');
+  late final _detectLayoutFromEncoded = _detectLayoutFromEncodedPtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Uint8>, int, double)>();
+
+  /// Detect layout from several encoded images
+  /// char* detectLayoutBatch(const uint8_t* const* data, const size_t* lens, int count, float conf_threshold)
+  ffi.Pointer<ffi.Char> detectLayoutBatch(
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> data,
+    ffi.Pointer<ffi.Size> lens,
+    int count,
+    double confThreshold,
+  ) {
+    return _detectLayoutBatch(data, lens, count, confThreshold);
+  }
+
+  late final _detectLayoutBatchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+              ffi.Pointer<ffi.Size>, ffi.Int, ffi.Float)>>('detectLayoutBatch');
+  late final _detectLayoutBatch = _detectLayoutBatchPtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+          ffi.Pointer<ffi.Size>, int, double)>();
+
+  /// Queue detection of encoded image bytes on the native worker
+  /// int detectLayoutFromEncodedAsync(const uint8_t* data, size_t len, float conf_threshold,
+  ///                                  int64_t request_id, DocLayoutResultCallback callback)
+  int detectLayoutFromEncodedAsync(
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    int requestId,
+    DocLayoutResultCallback callback,
+  ) {
+    return _detectLayoutFromEncodedAsync(
+        data, len, confThreshold, requestId, callback);
+  }
+
+  late final _detectLayoutFromEncodedAsyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Uint8>, ffi.Size, ffi.Float,
+              ffi.Int64, DocLayoutResultCallback)>>('detectLayoutFromEncodedAsync');
+  late final _detectLayoutFromEncodedAsync =
+      _detectLayoutFromEncodedAsyncPtr.asFunction<
+          int Function(ffi.Pointer<ffi.Uint8>, int, double, int,
+              DocLayoutResultCallback)>();
+
   /// Detect layout from raw image bytes
   /// char* detectLayoutFromBytes(const unsigned char* image_data, int width, int height, int channels, float conf_threshold)
   ffi.Pointer<ffi.Char> detectLayoutFromBytes(
@@ -62,6 +137,991 @@ class DocLayoutKitBindings {
       ffi.Pointer<ffi.Char> Function(
           ffi.Pointer<ffi.UnsignedChar>, int, int, int, double)>();
 
+  /// Binary variant of detectLayout, fills [out] with the result layout
+  /// int detectLayoutToBuffer(const char* img_path, float conf_threshold, float* out, int32_t max_boxes)
+  int detectLayoutToBuffer(
+    ffi.Pointer<ffi.Char> imgPath,
+    double confThreshold,
+    ffi.Pointer<ffi.Float> out,
+    int maxBoxes,
+  ) {
+    return _detectLayoutToBuffer(imgPath, confThreshold, out, maxBoxes);
+  }
+
+  late final _detectLayoutToBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Float,
+              ffi.Pointer<ffi.Float>, ffi.Int32)>>('detectLayoutToBuffer');
+  late final _detectLayoutToBuffer = _detectLayoutToBufferPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, double, ffi.Pointer<ffi.Float>, int)>();
+
+  /// Binary variant of detectLayoutFromEncoded
+  /// int detectLayoutFromEncodedToBuffer(const uint8_t* data, size_t len, float conf_threshold,
+  ///                                     float* out, int32_t max_boxes)
+  int detectLayoutFromEncodedToBuffer(
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    ffi.Pointer<ffi.Float> out,
+    int maxBoxes,
+  ) {
+    return _detectLayoutFromEncodedToBuffer(
+        data, len, confThreshold, out, maxBoxes);
+  }
+
+  late final _detectLayoutFromEncodedToBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Uint8>, ffi.Size, ffi.Float,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int32)>>('detectLayoutFromEncodedToBuffer');
+  late final _detectLayoutFromEncodedToBuffer =
+      _detectLayoutFromEncodedToBufferPtr.asFunction<
+          int Function(ffi.Pointer<ffi.Uint8>, int, double,
+              ffi.Pointer<ffi.Float>, int)>();
+
+  /// Binary variant of detectLayoutFromBytes
+  /// int detectLayoutFromBytesToBuffer(const unsigned char* image_data, int width, int height, int channels,
+  ///                                   float conf_threshold, float* out, int32_t max_boxes)
+  int detectLayoutFromBytesToBuffer(
+    ffi.Pointer<ffi.UnsignedChar> imageData,
+    int width,
+    int height,
+    int channels,
+    double confThreshold,
+    ffi.Pointer<ffi.Float> out,
+    int maxBoxes,
+  ) {
+    return _detectLayoutFromBytesToBuffer(
+        imageData, width, height, channels, confThreshold, out, maxBoxes);
+  }
+
+  late final _detectLayoutFromBytesToBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.UnsignedChar>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Float,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int32)>>('detectLayoutFromBytesToBuffer');
+  late final _detectLayoutFromBytesToBuffer =
+      _detectLayoutFromBytesToBufferPtr.asFunction<
+          int Function(ffi.Pointer<ffi.UnsignedChar>, int, int, int, double,
+              ffi.Pointer<ffi.Float>, int)>();
+
+  /// Detect layout from YUV 4:2:0 camera planes
+  /// char* detectLayoutFromYuv(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+  ///                           int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+  ///                           float conf_threshold)
+  ffi.Pointer<ffi.Char> detectLayoutFromYuv(
+    ffi.Pointer<ffi.Uint8> y,
+    ffi.Pointer<ffi.Uint8> u,
+    ffi.Pointer<ffi.Uint8> v,
+    int width,
+    int height,
+    int yRowStride,
+    int uvRowStride,
+    int uvPixelStride,
+    double confThreshold,
+  ) {
+    return _detectLayoutFromYuv(y, u, v, width, height, yRowStride,
+        uvRowStride, uvPixelStride, confThreshold);
+  }
+
+  late final _detectLayoutFromYuvPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Float)>>('detectLayoutFromYuv');
+  late final _detectLayoutFromYuv = _detectLayoutFromYuvPtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Uint8>,
+          ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint8>, int, int, int, int,
+          int, double)>();
+
+  /// Binary variant of detectLayoutFromYuv
+  /// int detectLayoutFromYuvToBuffer(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+  ///                                 int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+  ///                                 float conf_threshold, float* out, int32_t max_boxes)
+  int detectLayoutFromYuvToBuffer(
+    ffi.Pointer<ffi.Uint8> y,
+    ffi.Pointer<ffi.Uint8> u,
+    ffi.Pointer<ffi.Uint8> v,
+    int width,
+    int height,
+    int yRowStride,
+    int uvRowStride,
+    int uvPixelStride,
+    double confThreshold,
+    ffi.Pointer<ffi.Float> out,
+    int maxBoxes,
+  ) {
+    return _detectLayoutFromYuvToBuffer(y, u, v, width, height, yRowStride,
+        uvRowStride, uvPixelStride, confThreshold, out, maxBoxes);
+  }
+
+  late final _detectLayoutFromYuvToBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Float,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int32)>>('detectLayoutFromYuvToBuffer');
+  late final _detectLayoutFromYuvToBuffer =
+      _detectLayoutFromYuvToBufferPtr.asFunction<
+          int Function(
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              int,
+              int,
+              int,
+              int,
+              int,
+              double,
+              ffi.Pointer<ffi.Float>,
+              int)>();
+
+  /// Create a detector instance, returns nullptr on failure
+  /// void* createDetector(const char* model_path, const DocLayoutOptions* options)
+  ffi.Pointer<ffi.Void> createDetector(
+    ffi.Pointer<ffi.Char> modelPath,
+    ffi.Pointer<DocLayoutOptions> options,
+  ) {
+    return _createDetector(modelPath, options);
+  }
+
+  late final _createDetectorPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Void> Function(ffi.Pointer<ffi.Char>,
+              ffi.Pointer<DocLayoutOptions>)>>('createDetector');
+  late final _createDetector = _createDetectorPtr.asFunction<
+      ffi.Pointer<ffi.Void> Function(
+          ffi.Pointer<ffi.Char>, ffi.Pointer<DocLayoutOptions>)>();
+
+  /// Detect layout from encoded image bytes on a detector instance
+  /// char* detectWithHandle(void* handle, const uint8_t* data, size_t len, float conf_threshold)
+  ffi.Pointer<ffi.Char> detectWithHandle(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+  ) {
+    return _detectWithHandle(handle, data, len, confThreshold);
+  }
+
+  late final _detectWithHandlePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>, ffi.Size, ffi.Float)>>('detectWithHandle');
+  late final _detectWithHandle = _detectWithHandlePtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(
+          ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>, int, double)>();
+
+  /// Binary variant of detectWithHandle
+  /// int detectWithHandleToBuffer(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+  ///                              float* out, int32_t max_boxes)
+  int detectWithHandleToBuffer(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    ffi.Pointer<ffi.Float> out,
+    int maxBoxes,
+  ) {
+    return _detectWithHandleToBuffer(
+        handle, data, len, confThreshold, out, maxBoxes);
+  }
+
+  late final _detectWithHandleToBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>,
+              ffi.Size, ffi.Float, ffi.Pointer<ffi.Float>,
+              ffi.Int32)>>('detectWithHandleToBuffer');
+  late final _detectWithHandleToBuffer =
+      _detectWithHandleToBufferPtr.asFunction<
+          int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>, int,
+              double, ffi.Pointer<ffi.Float>, int)>();
+
+  /// Queue detection on a detector instance
+  /// int detectWithHandleAsync(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+  ///                           int64_t request_id, DocLayoutResultCallback callback)
+  int detectWithHandleAsync(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    int requestId,
+    DocLayoutResultCallback callback,
+  ) {
+    return _detectWithHandleAsync(
+        handle, data, len, confThreshold, requestId, callback);
+  }
+
+  late final _detectWithHandleAsyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>,
+              ffi.Size, ffi.Float, ffi.Int64,
+              DocLayoutResultCallback)>>('detectWithHandleAsync');
+  late final _detectWithHandleAsync = _detectWithHandleAsyncPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>, int, double,
+          int, DocLayoutResultCallback)>();
+
+  /// Queue detection with a deadline and / or a latest-wins lane, nullptr handle = default model
+  /// int detectAsyncWithOptions(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+  ///                            const DocLayoutRequestOptions* options, int64_t request_id,
+  ///                            DocLayoutResultCallback callback)
+  int detectAsyncWithOptions(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    ffi.Pointer<DocLayoutRequestOptions> options,
+    int requestId,
+    DocLayoutResultCallback callback,
+  ) {
+    return _detectAsyncWithOptions(
+        handle, data, len, confThreshold, options, requestId, callback);
+  }
+
+  late final _detectAsyncWithOptionsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Float,
+              ffi.Pointer<DocLayoutRequestOptions>,
+              ffi.Int64,
+              DocLayoutResultCallback)>>('detectAsyncWithOptions');
+  late final _detectAsyncWithOptions = _detectAsyncWithOptionsPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>, int, double,
+          ffi.Pointer<DocLayoutRequestOptions>, int, DocLayoutResultCallback)>();
+
+  /// Cancel a queued or running async request, 1 if it was in flight
+  /// int cancelRequest(int64_t request_id)
+  int cancelRequest(int requestId) {
+    return _cancelRequest(requestId);
+  }
+
+  late final _cancelRequestPtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int64)>>('cancelRequest');
+  late final _cancelRequest = _cancelRequestPtr.asFunction<int Function(int)>();
+
+  /// Cancel every queued or running async request of a lane
+  /// int cancelLane(int64_t lane)
+  int cancelLane(int lane) {
+    return _cancelLane(lane);
+  }
+
+  late final _cancelLanePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function(ffi.Int64)>>('cancelLane');
+  late final _cancelLane = _cancelLanePtr.asFunction<int Function(int)>();
+
+  /// Process-unique value for a request id or a lane
+  /// int64_t nextRequestId(void)
+  int nextRequestId() {
+    return _nextRequestId();
+  }
+
+  late final _nextRequestIdPtr =
+      _lookup<ffi.NativeFunction<ffi.Int64 Function()>>('nextRequestId');
+  late final _nextRequestId = _nextRequestIdPtr.asFunction<int Function()>();
+
+  /// Detect layout from several encoded images on a detector instance
+  /// char* detectBatchWithHandle(void* handle, const uint8_t* const* data, const size_t* lens, int count,
+  ///                             float conf_threshold)
+  ffi.Pointer<ffi.Char> detectBatchWithHandle(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> data,
+    ffi.Pointer<ffi.Size> lens,
+    int count,
+    double confThreshold,
+  ) {
+    return _detectBatchWithHandle(handle, data, lens, count, confThreshold);
+  }
+
+  late final _detectBatchWithHandlePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+              ffi.Pointer<ffi.Size>,
+              ffi.Int,
+              ffi.Float)>>('detectBatchWithHandle');
+  late final _detectBatchWithHandle = _detectBatchWithHandlePtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>,
+          ffi.Pointer<ffi.Pointer<ffi.Uint8>>, ffi.Pointer<ffi.Size>, int, double)>();
+
+  /// Set the postprocess passes, handle may be nullptr for the default model
+  /// int setPostprocessOptions(void* handle, const DocLayoutPostprocessOptions* options)
+  int setPostprocessOptions(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<DocLayoutPostprocessOptions> options,
+  ) {
+    return _setPostprocessOptions(handle, options);
+  }
+
+  late final _setPostprocessOptionsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Void>,
+              ffi.Pointer<DocLayoutPostprocessOptions>)>>('setPostprocessOptions');
+  late final _setPostprocessOptions = _setPostprocessOptionsPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<DocLayoutPostprocessOptions>)>();
+
+  /// Tiled detection, handle may be nullptr for the default model
+  /// char* detectTiledWithHandle(void* handle, const uint8_t* data, size_t len,
+  ///                             float conf_threshold, const DocLayoutTileOptions* options)
+  ffi.Pointer<ffi.Char> detectTiledWithHandle(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    ffi.Pointer<DocLayoutTileOptions> options,
+  ) {
+    return _detectTiledWithHandle(handle, data, len, confThreshold, options);
+  }
+
+  late final _detectTiledWithHandlePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Float,
+              ffi.Pointer<DocLayoutTileOptions>)>>('detectTiledWithHandle');
+  late final _detectTiledWithHandle = _detectTiledWithHandlePtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>,
+          int, double, ffi.Pointer<DocLayoutTileOptions>)>();
+
+  /// Detect and cut the selected detections out of the same decoded page,
+  /// handle may be nullptr for the default model; free with releaseCrops
+  /// DocLayoutCropResult* detectWithCrops(void* handle, const uint8_t* data, size_t len,
+  ///                                      float conf_threshold, const DocLayoutCropOptions* options)
+  ffi.Pointer<DocLayoutCropResult> detectWithCrops(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    ffi.Pointer<DocLayoutCropOptions> options,
+  ) {
+    return _detectWithCrops(handle, data, len, confThreshold, options);
+  }
+
+  late final _detectWithCropsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<DocLayoutCropResult> Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Float,
+              ffi.Pointer<DocLayoutCropOptions>)>>('detectWithCrops');
+  late final _detectWithCrops = _detectWithCropsPtr.asFunction<
+      ffi.Pointer<DocLayoutCropResult> Function(ffi.Pointer<ffi.Void>,
+          ffi.Pointer<ffi.Uint8>, int, double, ffi.Pointer<DocLayoutCropOptions>)>();
+
+  /// Free a detectWithCrops result
+  /// void releaseCrops(DocLayoutCropResult* result)
+  void releaseCrops(ffi.Pointer<DocLayoutCropResult> result) {
+    return _releaseCrops(result);
+  }
+
+  late final _releaseCropsPtr = _lookup<
+          ffi.NativeFunction<ffi.Void Function(ffi.Pointer<DocLayoutCropResult>)>>(
+      'releaseCrops');
+  late final _releaseCrops = _releaseCropsPtr
+      .asFunction<void Function(ffi.Pointer<DocLayoutCropResult>)>();
+
+  /// Re-detect only the changed region of a page and merge with a previous
+  /// result, handle may be nullptr for the default model
+  /// char* detectRegion(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+  ///                    const DocLayoutPreviousResult* previous, const DocLayoutRegion* region)
+  ffi.Pointer<ffi.Char> detectRegion(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    ffi.Pointer<DocLayoutPreviousResult> previous,
+    ffi.Pointer<DocLayoutRegion> region,
+  ) {
+    return _detectRegion(handle, data, len, confThreshold, previous, region);
+  }
+
+  late final _detectRegionPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Float,
+              ffi.Pointer<DocLayoutPreviousResult>,
+              ffi.Pointer<DocLayoutRegion>)>>('detectRegion');
+  late final _detectRegion = _detectRegionPtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>,
+          int, double, ffi.Pointer<DocLayoutPreviousResult>, ffi.Pointer<DocLayoutRegion>)>();
+
+  /// detectRegion on the background worker, scheduled like detectAsyncWithOptions
+  /// int detectRegionAsync(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+  ///                       const DocLayoutPreviousResult* previous, const DocLayoutRegion* region,
+  ///                       const DocLayoutRequestOptions* options, int64_t request_id,
+  ///                       DocLayoutResultCallback callback)
+  int detectRegionAsync(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    double confThreshold,
+    ffi.Pointer<DocLayoutPreviousResult> previous,
+    ffi.Pointer<DocLayoutRegion> region,
+    ffi.Pointer<DocLayoutRequestOptions> options,
+    int requestId,
+    DocLayoutResultCallback callback,
+  ) {
+    return _detectRegionAsync(handle, data, len, confThreshold, previous, region,
+        options, requestId, callback);
+  }
+
+  late final _detectRegionAsyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Float,
+              ffi.Pointer<DocLayoutPreviousResult>,
+              ffi.Pointer<DocLayoutRegion>,
+              ffi.Pointer<DocLayoutRequestOptions>,
+              ffi.Int64,
+              DocLayoutResultCallback)>>('detectRegionAsync');
+  late final _detectRegionAsync = _detectRegionAsyncPtr.asFunction<
+      int Function(
+          ffi.Pointer<ffi.Void>,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+          double,
+          ffi.Pointer<DocLayoutPreviousResult>,
+          ffi.Pointer<DocLayoutRegion>,
+          ffi.Pointer<DocLayoutRequestOptions>,
+          int,
+          DocLayoutResultCallback)>();
+
+  /// Remap a previous result through a 2x3 affine transform, no inference
+  /// char* transformResult(void* handle, const DocLayoutPreviousResult* previous,
+  ///                       const float* transform, int32_t width, int32_t height)
+  ffi.Pointer<ffi.Char> transformResult(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<DocLayoutPreviousResult> previous,
+    ffi.Pointer<ffi.Float> transform,
+    int width,
+    int height,
+  ) {
+    return _transformResult(handle, previous, transform, width, height);
+  }
+
+  late final _transformResultPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<DocLayoutPreviousResult>,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int32,
+              ffi.Int32)>>('transformResult');
+  late final _transformResult = _transformResultPtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>,
+          ffi.Pointer<DocLayoutPreviousResult>, ffi.Pointer<ffi.Float>, int, int)>();
+
+  /// Open a streaming page pipeline, handle may be nullptr for the default model
+  /// void* openPageStream(void* handle, float conf_threshold, int32_t queue_depth,
+  ///                      int64_t stream_id, DocLayoutPageCallback callback)
+  ffi.Pointer<ffi.Void> openPageStream(
+    ffi.Pointer<ffi.Void> handle,
+    double confThreshold,
+    int queueDepth,
+    int streamId,
+    DocLayoutPageCallback callback,
+  ) {
+    return _openPageStream(
+        handle, confThreshold, queueDepth, streamId, callback);
+  }
+
+  late final _openPageStreamPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Void> Function(ffi.Pointer<ffi.Void>, ffi.Float,
+              ffi.Int32, ffi.Int64, DocLayoutPageCallback)>>('openPageStream');
+  late final _openPageStream = _openPageStreamPtr.asFunction<
+      ffi.Pointer<ffi.Void> Function(
+          ffi.Pointer<ffi.Void>, double, int, int, DocLayoutPageCallback)>();
+
+  /// Queue an encoded page on a stream (bytes are copied)
+  /// int64_t pushPageEncoded(void* stream, const uint8_t* data, size_t len)
+  int pushPageEncoded(
+    ffi.Pointer<ffi.Void> stream,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+  ) {
+    return _pushPageEncoded(stream, data, len);
+  }
+
+  late final _pushPageEncodedPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int64 Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>,
+              ffi.Size)>>('pushPageEncoded');
+  late final _pushPageEncoded = _pushPageEncodedPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>, int)>();
+
+  /// Queue an image file on a stream
+  /// int64_t pushPageFile(void* stream, const char* img_path)
+  int pushPageFile(
+    ffi.Pointer<ffi.Void> stream,
+    ffi.Pointer<ffi.Char> imgPath,
+  ) {
+    return _pushPageFile(stream, imgPath);
+  }
+
+  late final _pushPageFilePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int64 Function(
+              ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Char>)>>('pushPageFile');
+  late final _pushPageFile = _pushPageFilePtr
+      .asFunction<int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Char>)>();
+
+  /// Wait for all queued pages and release the stream
+  /// void closePageStream(void* stream)
+  void closePageStream(ffi.Pointer<ffi.Void> stream) {
+    return _closePageStream(stream);
+  }
+
+  late final _closePageStreamPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'closePageStream');
+  late final _closePageStream =
+      _closePageStreamPtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Stream the pages of a multi-page file, handle may be nullptr for the
+  /// default model; the final callback has page_index -1
+  /// void* detectDocument(void* handle, const char* path, float conf_threshold,
+  ///                      const DocLayoutDocumentOptions* options, int64_t document_id,
+  ///                      DocLayoutPageCallback callback)
+  ffi.Pointer<ffi.Void> detectDocument(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<ffi.Char> path,
+    double confThreshold,
+    ffi.Pointer<DocLayoutDocumentOptions> options,
+    int documentId,
+    DocLayoutPageCallback callback,
+  ) {
+    return _detectDocument(
+        handle, path, confThreshold, options, documentId, callback);
+  }
+
+  late final _detectDocumentPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Void> Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Char>,
+              ffi.Float,
+              ffi.Pointer<DocLayoutDocumentOptions>,
+              ffi.Int64,
+              DocLayoutPageCallback)>>('detectDocument');
+  late final _detectDocument = _detectDocumentPtr.asFunction<
+      ffi.Pointer<ffi.Void> Function(
+          ffi.Pointer<ffi.Void>,
+          ffi.Pointer<ffi.Char>,
+          double,
+          ffi.Pointer<DocLayoutDocumentOptions>,
+          int,
+          DocLayoutPageCallback)>();
+
+  /// Stop reading further pages of a document, does not block
+  /// void cancelDocument(void* document)
+  void cancelDocument(ffi.Pointer<ffi.Void> document) {
+    return _cancelDocument(document);
+  }
+
+  late final _cancelDocumentPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'cancelDocument');
+  late final _cancelDocument =
+      _cancelDocumentPtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Wait for the reader and release a document
+  /// void closeDocument(void* document)
+  void closeDocument(ffi.Pointer<ffi.Void> document) {
+    return _closeDocument(document);
+  }
+
+  late final _closeDocumentPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'closeDocument');
+  late final _closeDocument =
+      _closeDocumentPtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Enable the content-hash result cache, max_bytes = 0 disables it
+  /// int configureResultCache(int64_t max_bytes, const char* disk_dir)
+  int configureResultCache(
+    int maxBytes,
+    ffi.Pointer<ffi.Char> diskDir,
+  ) {
+    return _configureResultCache(maxBytes, diskDir);
+  }
+
+  late final _configureResultCachePtr = _lookup<
+          ffi.NativeFunction<
+              ffi.Int Function(ffi.Int64, ffi.Pointer<ffi.Char>)>>(
+      'configureResultCache');
+  late final _configureResultCache = _configureResultCachePtr
+      .asFunction<int Function(int, ffi.Pointer<ffi.Char>)>();
+
+  /// Read the result cache counters
+  /// void getResultCacheStats(DocLayoutCacheStats* stats)
+  void getResultCacheStats(ffi.Pointer<DocLayoutCacheStats> stats) {
+    return _getResultCacheStats(stats);
+  }
+
+  late final _getResultCacheStatsPtr = _lookup<
+          ffi.NativeFunction<ffi.Void Function(ffi.Pointer<DocLayoutCacheStats>)>>(
+      'getResultCacheStats');
+  late final _getResultCacheStats = _getResultCacheStatsPtr
+      .asFunction<void Function(ffi.Pointer<DocLayoutCacheStats>)>();
+
+  /// Drop the cached results, remove_disk != 0 also deletes the disk entries
+  /// void clearResultCache(int remove_disk)
+  void clearResultCache(int removeDisk) {
+    return _clearResultCache(removeDisk);
+  }
+
+  late final _clearResultCachePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Int)>>(
+          'clearResultCache');
+  late final _clearResultCache =
+      _clearResultCachePtr.asFunction<void Function(int)>();
+
+  /// Per-stage latency percentiles as JSON, free with freeString
+  /// char* getStats(void)
+  ffi.Pointer<ffi.Char> getStats() {
+    return _getStats();
+  }
+
+  late final _getStatsPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Char> Function()>>(
+          'getStats');
+  late final _getStats =
+      _getStatsPtr.asFunction<ffi.Pointer<ffi.Char> Function()>();
+
+  /// Clear the latency samples
+  /// void resetStats(void)
+  void resetStats() {
+    return _resetStats();
+  }
+
+  late final _resetStatsPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function()>>('resetStats');
+  late final _resetStats = _resetStatsPtr.asFunction<void Function()>();
+
+  /// Release a detector's idle buffers and arena blocks, handle may be
+  /// nullptr for the default model
+  /// int trimMemory(void* handle, int shrink_arena)
+  int trimMemory(ffi.Pointer<ffi.Void> handle, int shrink_arena) {
+    return _trimMemory(handle, shrink_arena);
+  }
+
+  late final _trimMemoryPtr = _lookup<
+          ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ffi.Void>, ffi.Int)>>(
+      'trimMemory');
+  late final _trimMemory =
+      _trimMemoryPtr.asFunction<int Function(ffi.Pointer<ffi.Void>, int)>();
+
+  /// Stop ONNX Runtime profiling and return the trace path, free with freeString
+  /// char* endProfiling(void* handle)
+  ffi.Pointer<ffi.Char> endProfiling(ffi.Pointer<ffi.Void> handle) {
+    return _endProfiling(handle);
+  }
+
+  late final _endProfilingPtr = _lookup<
+          ffi.NativeFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>)>>(
+      'endProfiling');
+  late final _endProfiling = _endProfilingPtr
+      .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Model descriptor as JSON, handle may be nullptr for the default model,
+  /// free with freeString
+  /// char* getModelInfo(void* handle)
+  ffi.Pointer<ffi.Char> getModelInfo(ffi.Pointer<ffi.Void> handle) {
+    return _getModelInfo(handle);
+  }
+
+  late final _getModelInfoPtr = _lookup<
+          ffi.NativeFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>)>>(
+      'getModelInfo');
+  late final _getModelInfo = _getModelInfoPtr
+      .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Dummy inferences on the default model, timings as JSON, free with freeString
+  /// char* warmupModel(int32_t iterations)
+  ffi.Pointer<ffi.Char> warmupModel(int iterations) {
+    return _warmupModel(iterations);
+  }
+
+  late final _warmupModelPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Char> Function(ffi.Int32)>>(
+          'warmupModel');
+  late final _warmupModel =
+      _warmupModelPtr.asFunction<ffi.Pointer<ffi.Char> Function(int)>();
+
+  /// Dummy inferences on a detector instance, free with freeString
+  /// char* warmupDetector(void* handle, int32_t iterations)
+  ffi.Pointer<ffi.Char> warmupDetector(
+    ffi.Pointer<ffi.Void> handle,
+    int iterations,
+  ) {
+    return _warmupDetector(handle, iterations);
+  }
+
+  late final _warmupDetectorPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(
+              ffi.Pointer<ffi.Void>, ffi.Int32)>>('warmupDetector');
+  late final _warmupDetector = _warmupDetectorPtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>, int)>();
+
+  /// CPU features and variant preference order as JSON, free with freeString
+  /// char* getDeviceCapabilities(void)
+  ffi.Pointer<ffi.Char> getDeviceCapabilities() {
+    return _getDeviceCapabilities();
+  }
+
+  late final _getDeviceCapabilitiesPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Char> Function()>>(
+          'getDeviceCapabilities');
+  late final _getDeviceCapabilities =
+      _getDeviceCapabilitiesPtr.asFunction<ffi.Pointer<ffi.Char> Function()>();
+
+  /// Create a live-camera tracker, handle may be nullptr for the default model
+  /// void* createTracker(void* handle, const DocLayoutTrackerOptions* options)
+  ffi.Pointer<ffi.Void> createTracker(
+    ffi.Pointer<ffi.Void> handle,
+    ffi.Pointer<DocLayoutTrackerOptions> options,
+  ) {
+    return _createTracker(handle, options);
+  }
+
+  late final _createTrackerPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Void> Function(ffi.Pointer<ffi.Void>,
+              ffi.Pointer<DocLayoutTrackerOptions>)>>('createTracker');
+  late final _createTracker = _createTrackerPtr.asFunction<
+      ffi.Pointer<ffi.Void> Function(
+          ffi.Pointer<ffi.Void>, ffi.Pointer<DocLayoutTrackerOptions>)>();
+
+  /// Track a raw pixel frame
+  /// char* trackFrameFromBytes(void* tracker, const unsigned char* image_data, int width, int height,
+  ///                           int channels, float conf_threshold)
+  ffi.Pointer<ffi.Char> trackFrameFromBytes(
+    ffi.Pointer<ffi.Void> tracker,
+    ffi.Pointer<ffi.UnsignedChar> imageData,
+    int width,
+    int height,
+    int channels,
+    double confThreshold,
+  ) {
+    return _trackFrameFromBytes(
+        tracker, imageData, width, height, channels, confThreshold);
+  }
+
+  late final _trackFrameFromBytesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.UnsignedChar>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Float)>>('trackFrameFromBytes');
+  late final _trackFrameFromBytes = _trackFrameFromBytesPtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Void>,
+          ffi.Pointer<ffi.UnsignedChar>, int, int, int, double)>();
+
+  /// Track a raw pixel frame into a caller-owned float buffer
+  /// int trackFrameFromBytesToBuffer(void* tracker, const unsigned char* image_data, int width, int height,
+  ///                                 int channels, float conf_threshold, float* out, int32_t max_boxes)
+  int trackFrameFromBytesToBuffer(
+    ffi.Pointer<ffi.Void> tracker,
+    ffi.Pointer<ffi.UnsignedChar> imageData,
+    int width,
+    int height,
+    int channels,
+    double confThreshold,
+    ffi.Pointer<ffi.Float> out,
+    int maxBoxes,
+  ) {
+    return _trackFrameFromBytesToBuffer(tracker, imageData, width, height,
+        channels, confThreshold, out, maxBoxes);
+  }
+
+  late final _trackFrameFromBytesToBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.UnsignedChar>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Float,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int32)>>('trackFrameFromBytesToBuffer');
+  late final _trackFrameFromBytesToBuffer =
+      _trackFrameFromBytesToBufferPtr.asFunction<
+          int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.UnsignedChar>,
+              int, int, int, double, ffi.Pointer<ffi.Float>, int)>();
+
+  /// Track a YUV 4:2:0 frame
+  /// char* trackFrameFromYuv(void* tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+  ///                         int width, int height, int y_row_stride, int uv_row_stride,
+  ///                         int uv_pixel_stride, float conf_threshold)
+  ffi.Pointer<ffi.Char> trackFrameFromYuv(
+    ffi.Pointer<ffi.Void> tracker,
+    ffi.Pointer<ffi.Uint8> y,
+    ffi.Pointer<ffi.Uint8> u,
+    ffi.Pointer<ffi.Uint8> v,
+    int width,
+    int height,
+    int yRowStride,
+    int uvRowStride,
+    int uvPixelStride,
+    double confThreshold,
+  ) {
+    return _trackFrameFromYuv(tracker, y, u, v, width, height, yRowStride,
+        uvRowStride, uvPixelStride, confThreshold);
+  }
+
+  late final _trackFrameFromYuvPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Char> Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Float)>>('trackFrameFromYuv');
+  late final _trackFrameFromYuv = _trackFrameFromYuvPtr.asFunction<
+      ffi.Pointer<ffi.Char> Function(
+          ffi.Pointer<ffi.Void>,
+          ffi.Pointer<ffi.Uint8>,
+          ffi.Pointer<ffi.Uint8>,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+          int,
+          int,
+          int,
+          int,
+          double)>();
+
+  /// Track a YUV 4:2:0 frame into a caller-owned float buffer
+  /// int trackFrameFromYuvToBuffer(void* tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+  ///                               int width, int height, int y_row_stride, int uv_row_stride,
+  ///                               int uv_pixel_stride, float conf_threshold, float* out, int32_t max_boxes)
+  int trackFrameFromYuvToBuffer(
+    ffi.Pointer<ffi.Void> tracker,
+    ffi.Pointer<ffi.Uint8> y,
+    ffi.Pointer<ffi.Uint8> u,
+    ffi.Pointer<ffi.Uint8> v,
+    int width,
+    int height,
+    int yRowStride,
+    int uvRowStride,
+    int uvPixelStride,
+    double confThreshold,
+    ffi.Pointer<ffi.Float> out,
+    int maxBoxes,
+  ) {
+    return _trackFrameFromYuvToBuffer(tracker, y, u, v, width, height,
+        yRowStride, uvRowStride, uvPixelStride, confThreshold, out, maxBoxes);
+  }
+
+  late final _trackFrameFromYuvToBufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Float,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int32)>>('trackFrameFromYuvToBuffer');
+  late final _trackFrameFromYuvToBuffer =
+      _trackFrameFromYuvToBufferPtr.asFunction<
+          int Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint8>,
+              int,
+              int,
+              int,
+              int,
+              int,
+              double,
+              ffi.Pointer<ffi.Float>,
+              int)>();
+
+  /// Forget the cached frame of a tracker
+  /// void resetTracker(void* tracker)
+  void resetTracker(ffi.Pointer<ffi.Void> tracker) {
+    return _resetTracker(tracker);
+  }
+
+  late final _resetTrackerPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'resetTracker');
+  late final _resetTracker =
+      _resetTrackerPtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Release a tracker
+  /// void destroyTracker(void* tracker)
+  void destroyTracker(ffi.Pointer<ffi.Void> tracker) {
+    return _destroyTracker(tracker);
+  }
+
+  late final _destroyTrackerPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'destroyTracker');
+  late final _destroyTracker =
+      _destroyTrackerPtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  /// Release a detector instance
+  /// void destroyDetector(void* handle)
+  void destroyDetector(ffi.Pointer<ffi.Void> handle) {
+    return _destroyDetector(handle);
+  }
+
+  late final _destroyDetectorPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'destroyDetector');
+  late final _destroyDetector =
+      _destroyDetectorPtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
   /// Free allocated string memory
   /// void freeString(char* str)
   void freeString(ffi.Pointer<ffi.Char> str) {
@@ -86,3 +1146,307 @@ class DocLayoutKitBindings {
   late final _getVersion =
       _getVersionPtr.asFunction<ffi.Pointer<ffi.Char> Function()>();
 }
+
+/// Completion callback for the *Async functions, runs on a native worker thread
+/// typedef void (*DocLayoutResultCallback)(int64_t request_id, char* result_json)
+typedef DocLayoutResultCallbackFunction = ffi.Void Function(
+    ffi.Int64 requestId, ffi.Pointer<ffi.Char> resultJson);
+typedef DocLayoutResultCallback
+    = ffi.Pointer<ffi.NativeFunction<DocLayoutResultCallbackFunction>>;
+
+/// Per-page callback of a page stream, called in page order
+/// typedef void (*DocLayoutPageCallback)(int64_t stream_id, int32_t page_index, char* result_json)
+typedef DocLayoutPageCallbackFunction = ffi.Void Function(
+    ffi.Int64 streamId, ffi.Int32 pageIndex, ffi.Pointer<ffi.Char> resultJson);
+typedef DocLayoutPageCallback
+    = ffi.Pointer<ffi.NativeFunction<DocLayoutPageCallbackFunction>>;
+
+/// Detector session options, zero values mean defaults
+/// struct DocLayoutOptions
+final class DocLayoutOptions extends ffi.Struct {
+  /// 0 = ONNX Runtime default
+  @ffi.Int32()
+  external int intra_op_threads;
+
+  /// 0 = ONNX Runtime default
+  @ffi.Int32()
+  external int inter_op_threads;
+
+  /// DOCLAYOUT_GRAPH_OPT_*
+  @ffi.Int32()
+  external int graph_optimization_level;
+
+  /// DOCLAYOUT_EP_* bits
+  @ffi.Int32()
+  external int execution_providers;
+
+  /// Pages per inference run in the batch calls, 0 = default (8)
+  @ffi.Int32()
+  external int max_batch_size;
+
+  /// 1 = never decode large JPEGs at reduced resolution
+  @ffi.Int32()
+  external int full_resolution_decode;
+
+  /// Non-null = ONNX Runtime profiling trace to <prefix>_<timestamp>.json
+  external ffi.Pointer<ffi.Char> profile_file_prefix;
+
+  /// Inferences in flight on one detector, 0 = 1 (calls are serialized)
+  @ffi.Int32()
+  external int max_concurrent_runs;
+
+  /// Square model input, multiple of 32, 0 = 640
+  @ffi.Int32()
+  external int input_size;
+
+  /// 1 = keep the page's aspect ratio and pad, 0 = stretch
+  @ffi.Int32()
+  external int letterbox;
+
+  /// DOCLAYOUT_PRECISION_*, which variant of model_path to load
+  @ffi.Int32()
+  external int precision;
+
+  /// 1 = read the model into the heap instead of memory-mapping it
+  @ffi.Int32()
+  external int disable_memory_map;
+
+  /// Non-null = directory for the cached optimized graph (.ort)
+  external ffi.Pointer<ffi.Char> optimized_model_dir;
+
+  /// 1 = no CPU arena, run buffers are freed after each run
+  @ffi.Int32()
+  external int disable_cpu_arena;
+
+  /// DOCLAYOUT_ARENA_EXTEND_*
+  @ffi.Int32()
+  external int arena_extend_strategy;
+
+  /// First arena block, 0 = ONNX Runtime default
+  @ffi.Int64()
+  external int arena_initial_chunk_bytes;
+
+  /// Cap on the CPU arena, 0 = none
+  @ffi.Int64()
+  external int arena_max_bytes;
+
+  /// 1 = hand arena growth back at the end of every run
+  @ffi.Int32()
+  external int shrink_arena_after_run;
+
+  /// Decoded page buffers kept for reuse, 0 = 2, < 0 = none
+  @ffi.Int32()
+  external int decode_pool_size;
+
+  /// 1 = find the page outline and warp only the page into the model input
+  @ffi.Int32()
+  external int page_crop;
+}
+
+/// Tracking mode settings, zero values mean defaults
+/// struct DocLayoutTrackerOptions
+final class DocLayoutTrackerOptions extends ffi.Struct {
+  /// Mean abs luma difference (0-1) that triggers inference, 0 = 0.04
+  @ffi.Float()
+  external double change_threshold;
+
+  /// Re-run inference at least this often, 0 = 1000
+  @ffi.Int32()
+  external int max_age_ms;
+
+  /// Weight of the previous box position (0-1), 0 = 0.3, < 0 = off
+  @ffi.Float()
+  external double smoothing;
+}
+
+/// Native postprocess settings, zero values mean the plain confidence filter
+/// struct DocLayoutPostprocessOptions
+final class DocLayoutPostprocessOptions extends ffi.Struct {
+  /// Score threshold by class ID, < 0 = the call's conf_threshold
+  external ffi.Pointer<ffi.Float> class_thresholds;
+
+  @ffi.Int32()
+  external int num_class_thresholds;
+
+  /// > 0 = class-aware NMS at this IoU
+  @ffi.Float()
+  external double nms_iou;
+
+  /// > 0 = drop boxes this much inside a higher-scoring same-class box
+  @ffi.Float()
+  external double containment;
+
+  /// 1 = reading order instead of score order
+  @ffi.Int32()
+  external int reading_order;
+}
+
+/// Tiled detection settings, zero values mean defaults
+/// struct DocLayoutTileOptions
+final class DocLayoutTileOptions extends ffi.Struct {
+  /// Square tile side in original-image pixels, 0 = auto
+  @ffi.Int32()
+  external int tile_size;
+
+  /// Fraction of a tile shared with its neighbour, 0 = 0.2
+  @ffi.Float()
+  external double overlap;
+
+  /// Same-class boxes overlapping more than this are merged, 0 = 0.5
+  @ffi.Float()
+  external double nms_iou;
+
+  /// 1 = tiles only, no whole-page pass
+  @ffi.Int32()
+  external int skip_full_page;
+}
+
+/// Which detections detectWithCrops cuts out
+final class DocLayoutCropOptions extends ffi.Struct {
+  /// Classes to crop, nullptr = all
+  external ffi.Pointer<ffi.Int32> class_ids;
+
+  @ffi.Int32()
+  external int num_class_ids;
+
+  /// Margin on each side as a fraction of the box size
+  @ffi.Float()
+  external double padding;
+
+  /// DOCLAYOUT_CROP_RAW (0), _PNG (1) or _JPEG (2)
+  @ffi.Int32()
+  external int encoding;
+
+  /// 1-100, 0 = 90
+  @ffi.Int32()
+  external int jpeg_quality;
+}
+
+/// One crop of a DocLayoutCropResult
+final class DocLayoutCrop extends ffi.Struct {
+  /// Index into the result JSON's detections
+  @ffi.Int32()
+  external int detection_index;
+
+  /// Crop rectangle in original image pixels
+  @ffi.Int32()
+  external int x;
+
+  @ffi.Int32()
+  external int y;
+
+  @ffi.Int32()
+  external int width;
+
+  @ffi.Int32()
+  external int height;
+
+  /// Raw: bytes per row; encoded: 0
+  @ffi.Int32()
+  external int stride;
+
+  /// Raw: first BGR pixel of the crop; encoded: PNG / JPEG bytes
+  external ffi.Pointer<ffi.Uint8> data;
+
+  /// Bytes at data
+  @ffi.Int64()
+  external int size;
+}
+
+/// Detections plus crops from one decode of the page
+final class DocLayoutCropResult extends ffi.Struct {
+  /// Same JSON as detectWithHandle, owned by the result
+  external ffi.Pointer<ffi.Char> result_json;
+
+  @ffi.Int32()
+  external int count;
+
+  external ffi.Pointer<DocLayoutCrop> crops;
+
+  /// Internal
+  external ffi.Pointer<ffi.Void> reserved;
+}
+
+/// Earlier result handed to detectRegion / transformResult
+final class DocLayoutPreviousResult extends ffi.Struct {
+  /// count rows of [x1, y1, x2, y2, score, class_id]
+  external ffi.Pointer<ffi.Float> boxes;
+
+  @ffi.Int32()
+  external int count;
+
+  /// Size the boxes refer to, 0 = the new image's size
+  @ffi.Int32()
+  external int image_width;
+
+  @ffi.Int32()
+  external int image_height;
+}
+
+/// Changed area of the page in original image pixels
+final class DocLayoutRegion extends ffi.Struct {
+  @ffi.Int32()
+  external int x;
+
+  @ffi.Int32()
+  external int y;
+
+  @ffi.Int32()
+  external int width;
+
+  @ffi.Int32()
+  external int height;
+}
+
+/// Scheduling of one async request (detectAsyncWithOptions)
+final class DocLayoutRequestOptions extends ffi.Struct {
+  /// Give up this long after submission, also mid-inference; 0 = none
+  @ffi.Int32()
+  external int deadline_ms;
+
+  /// Non-zero: a new request stops the older ones in the same lane; 0 = none
+  @ffi.Int64()
+  external int lane;
+}
+
+/// Page range of detectDocument
+/// struct DocLayoutDocumentOptions
+final class DocLayoutDocumentOptions extends ffi.Struct {
+  /// 0-based index of the first page to detect
+  @ffi.Int32()
+  external int first_page;
+
+  /// Pages from first_page, 0 = to the last page
+  @ffi.Int32()
+  external int page_count;
+
+  /// Pages queued between pipeline stages, 0 = 2
+  @ffi.Int32()
+  external int queue_depth;
+}
+
+/// Result cache counters
+/// struct DocLayoutCacheStats
+final class DocLayoutCacheStats extends ffi.Struct {
+  /// Memory and disk hits
+  @ffi.Int64()
+  external int hits;
+
+  @ffi.Int64()
+  external int misses;
+
+  /// Hits loaded back from the disk directory
+  @ffi.Int64()
+  external int disk_hits;
+
+  /// Entries dropped to stay within max_bytes
+  @ffi.Int64()
+  external int evictions;
+
+  @ffi.Int64()
+  external int entries;
+
+  /// Estimated memory held by the entries
+  @ffi.Int64()
+  external int bytes;
+}
@@ -0,0 +1,780 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../flutter_doclayout_kit_bindings_generated.dart';
+import 'doc_layout_tracker.dart';
+import 'incremental.dart';
+import 'models.dart';
+import 'native_async.dart';
+import 'native_library.dart';
+import 'page_stream.dart';
+import 'region_crops.dart';
+import 'result_buffer.dart';
+
+/// ONNX Runtime graph optimization level
+enum GraphOptimizationLevel {
+  /// Leave ONNX Runtime's default
+  platformDefault(0),
+  disable(1),
+  basic(2),
+  extended(3),
+  all(4);
+
+  final int value;
+
+  const GraphOptimizationLevel(this.value);
+}
+
+/// Opt-in hardware execution providers
+///
+/// Providers that are not available on the device, or that reject the
+/// model, are skipped and inference falls back to the CPU.
+enum ExecutionProvider {
+  /// Android Neural Networks API (Android only)
+  nnapi(1 << 0),
+
+  /// XNNPACK optimized CPU kernels
+  xnnpack(1 << 1),
+
+  /// Core ML (iOS/macOS only)
+  coreml(1 << 2);
+
+  final int bit;
+
+  const ExecutionProvider(this.bit);
+}
+
+/// Which numeric variant of a model file to load
+///
+/// Variants sit next to the given file as `<name>.int8.onnx`
+/// (QDQ-quantized) and `<name>.fp16.onnx`. A variant that is missing or
+/// fails to load falls back to the given file; `modelInfo` tells which one
+/// was loaded.
+enum ModelPrecision {
+  /// Load the given file as is
+  model(0),
+
+  /// Fastest variant for this device: INT8 on CPUs with dot-product
+  /// instructions, FP16 with NNAPI or Core ML, see
+  /// `DocLayoutKit.deviceCapabilities`
+  auto(1),
+
+  fp32(2),
+  fp16(3),
+  int8(4);
+
+  final int value;
+
+  const ModelPrecision(this.value);
+}
+
+/// How ONNX Runtime's CPU arena grows when a run needs more memory
+enum ArenaExtendStrategy {
+  /// ONNX Runtime's default, next power of two
+  platformDefault(0),
+
+  /// Fewer, larger blocks, up to twice what is needed
+  nextPowerOfTwo(1),
+
+  /// Exactly what the run asked for, the least slack
+  sameAsRequested(2);
+
+  final int value;
+
+  const ArenaExtendStrategy(this.value);
+}
+
+/// Native memory budget of a detector, see [DetectorOptions.memory]
+///
+/// The arena settings ([arenaExtendStrategy], [arenaInitialChunkBytes],
+/// [arenaMaxBytes]) configure one CPU arena shared by every model in the
+/// process that sets any of them; the first such model creates it.
+class MemoryOptions {
+  /// Keep ONNX Runtime's CPU memory arena
+  ///
+  /// Without it run buffers are freed after every run: the lowest idle
+  /// memory, at the cost of allocating on every run.
+  final bool cpuArena;
+
+  final ArenaExtendStrategy arenaExtendStrategy;
+
+  /// Size of the first arena block, 0 = ONNX Runtime default
+  final int arenaInitialChunkBytes;
+
+  /// Cap on the CPU arena, 0 = none; a run that needs more fails
+  final int arenaMaxBytes;
+
+  /// Hand arena growth back at the end of every run
+  final bool shrinkArenaAfterRun;
+
+  /// Decoded page buffers kept for reuse, 0 = 2, -1 = none
+  final int decodePoolSize;
+
+  const MemoryOptions({
+    this.cpuArena = true,
+    this.arenaExtendStrategy = ArenaExtendStrategy.platformDefault,
+    this.arenaInitialChunkBytes = 0,
+    this.arenaMaxBytes = 0,
+    this.shrinkArenaAfterRun = false,
+    this.decodePoolSize = 0,
+  });
+
+  /// Settings for 2-3 GB devices: the arena grows only by what a run needs
+  /// and is trimmed after each run, one decode buffer is kept
+  static const MemoryOptions lowMemory = MemoryOptions(
+    arenaExtendStrategy: ArenaExtendStrategy.sameAsRequested,
+    shrinkArenaAfterRun: true,
+    decodePoolSize: 1,
+  );
+
+  @override
+  bool operator ==(Object other) =>
+      other is MemoryOptions &&
+      other.cpuArena == cpuArena &&
+      other.arenaExtendStrategy == arenaExtendStrategy &&
+      other.arenaInitialChunkBytes == arenaInitialChunkBytes &&
+      other.arenaMaxBytes == arenaMaxBytes &&
+      other.shrinkArenaAfterRun == shrinkArenaAfterRun &&
+      other.decodePoolSize == decodePoolSize;
+
+  @override
+  int get hashCode => Object.hash(cpuArena, arenaExtendStrategy,
+      arenaInitialChunkBytes, arenaMaxBytes, shrinkArenaAfterRun, decodePoolSize);
+}
+
+/// Session options for a [DocLayoutDetector]
+///
+/// Input tensors are always preallocated and bound once. The output is
+/// preallocated only for models exported with a static output shape; an
+/// output with a data-dependent row count (most NMS exports) is taken from
+/// ONNX Runtime's CPU arena, which reuses its block between runs but still
+/// creates a small tensor object per run.
+class DetectorOptions {
+  /// Intra-op thread count, 0 = ONNX Runtime default
+  final int intraOpThreads;
+
+  /// Inter-op thread count, 0 = ONNX Runtime default
+  final int interOpThreads;
+
+  /// Graph optimization level
+  final GraphOptimizationLevel graphOptimizationLevel;
+
+  /// Execution providers to try before the CPU
+  final Set<ExecutionProvider> executionProviders;
+
+  /// Pages per inference run in the batch calls, 0 = default (8)
+  ///
+  /// Models exported with a fixed batch size of 1 always run page by page.
+  final int maxBatchSize;
+
+  /// Always decode images at full resolution
+  ///
+  /// By default JPEGs much larger than the model input (e.g. 600 dpi scans)
+  /// are decoded at 1/2, 1/4 or 1/8 size with libjpeg's DCT scaling; boxes
+  /// are still reported in original-image coordinates.
+  final bool fullResolutionDecode;
+
+  /// Enable ONNX Runtime profiling, trace written to
+  /// `<profileFilePrefix>_<timestamp>.json` when profiling is ended
+  ///
+  /// Use a path in a writable directory; the trace path is returned by
+  /// `endProfiling()`. Profiling slows inference down, leave null in
+  /// production.
+  final String? profileFilePrefix;
+
+  /// Detections that may run at once on one model, 0 = 1
+  ///
+  /// All runs share one ONNX Runtime session (weights are loaded once);
+  /// each in-flight run has its own input/output buffers, and callers
+  /// beyond the limit wait for a free slot. Unless [intraOpThreads] is set,
+  /// the cores are split evenly between the concurrent runs. Use it when
+  /// several threads or isolates detect on the same model.
+  final int maxConcurrentRuns;
+
+  /// Square model input size in pixels, 0 = 640
+  ///
+  /// Rounded up to a multiple of 32. Smaller inputs (e.g. 480) are faster
+  /// on low-end phones, larger ones (800, 1024) keep small text blocks on
+  /// dense A3 scans. Models exported with a fixed input size always run at
+  /// that size, check `modelInfo`.
+  final int inputSize;
+
+  /// Keep the page's aspect ratio and pad the rest of the input
+  ///
+  /// By default pages are stretched to the square input, which squashes
+  /// tall receipts and wide spreads. Boxes are reported in original-image
+  /// coordinates either way.
+  final bool letterbox;
+
+  /// Model variant to load, by default the given file
+  final ModelPrecision precision;
+
+  /// Memory-map the model file instead of reading it into the heap
+  ///
+  /// Mapped weights are clean file-backed pages, loaded on first touch and
+  /// reclaimable by the OS; turn it off only to debug loading problems.
+  final bool memoryMapModel;
+
+  /// Writable directory (e.g. the app's cache directory) for the optimized
+  /// graph of the model
+  ///
+  /// The first load saves the graph after ONNX Runtime's optimizations in
+  /// ORT format; later starts load that instead, skipping the protobuf parse
+  /// and the optimizer passes. It is rebuilt when the model file or the
+  /// runtime changes. Only used for CPU sessions without
+  /// [executionProviders], which compile their own graphs.
+  final String? optimizedModelCacheDir;
+
+  /// Arena and buffer settings for low-RAM devices, see [MemoryOptions]
+  final MemoryOptions memory;
+
+  /// Find the page outline in camera captures and detect on the page only
+  ///
+  /// A cheap edge pass on a downsampled frame looks for the page; if it
+  /// covers between 20% and 90% of the frame, only the page is
+  /// perspective-warped into the model input, so its elements get the
+  /// pixels the table and background would take. Boxes are reported in
+  /// original-image coordinates. Applies to single-image calls (file,
+  /// encoded and pixel input, tracking); YUV frames, batches, tiles and
+  /// page streams always use the whole image.
+  final bool pageCrop;
+
+  const DetectorOptions({
+    this.intraOpThreads = 0,
+    this.interOpThreads = 0,
+    this.graphOptimizationLevel = GraphOptimizationLevel.platformDefault,
+    this.executionProviders = const {},
+    this.maxBatchSize = 0,
+    this.fullResolutionDecode = false,
+    this.profileFilePrefix,
+    this.maxConcurrentRuns = 0,
+    this.inputSize = 0,
+    this.letterbox = false,
+    this.precision = ModelPrecision.model,
+    this.memoryMapModel = true,
+    this.optimizedModelCacheDir,
+    this.memory = const MemoryOptions(),
+    this.pageCrop = false,
+  });
+
+  /// Copy into a native options struct, strings are allocated with [allocator]
+  void writeTo(DocLayoutOptions native, Allocator allocator) {
+    native
+      ..intra_op_threads = intraOpThreads
+      ..inter_op_threads = interOpThreads
+      ..graph_optimization_level = graphOptimizationLevel.value
+      ..execution_providers =
+          executionProviders.fold(0, (bits, provider) => bits | provider.bit)
+      ..max_batch_size = maxBatchSize
+      ..full_resolution_decode = fullResolutionDecode ? 1 : 0
+      ..profile_file_prefix =
+          profileFilePrefix?.toNativeUtf8(allocator: allocator).cast<Char>() ??
+              nullptr
+      ..max_concurrent_runs = maxConcurrentRuns
+      ..input_size = inputSize
+      ..letterbox = letterbox ? 1 : 0
+      ..precision = precision.value
+      ..disable_memory_map = memoryMapModel ? 0 : 1
+      ..optimized_model_dir = optimizedModelCacheDir
+              ?.toNativeUtf8(allocator: allocator)
+              .cast<Char>() ??
+          nullptr
+      ..disable_cpu_arena = memory.cpuArena ? 0 : 1
+      ..arena_extend_strategy = memory.arenaExtendStrategy.value
+      ..arena_initial_chunk_bytes = memory.arenaInitialChunkBytes
+      ..arena_max_bytes = memory.arenaMaxBytes
+      ..shrink_arena_after_run = memory.shrinkArenaAfterRun ? 1 : 0
+      ..decode_pool_size = memory.decodePoolSize
+      ..page_crop = pageCrop ? 1 : 0;
+  }
+
+  @override
+  bool operator ==(Object other) =>
+      other is DetectorOptions &&
+      other.intraOpThreads == intraOpThreads &&
+      other.interOpThreads == interOpThreads &&
+      other.graphOptimizationLevel == graphOptimizationLevel &&
+      other.executionProviders.length == executionProviders.length &&
+      other.executionProviders.containsAll(executionProviders) &&
+      other.maxBatchSize == maxBatchSize &&
+      other.fullResolutionDecode == fullResolutionDecode &&
+      other.profileFilePrefix == profileFilePrefix &&
+      other.maxConcurrentRuns == maxConcurrentRuns &&
+      other.inputSize == inputSize &&
+      other.letterbox == letterbox &&
+      other.precision == precision &&
+      other.memoryMapModel == memoryMapModel &&
+      other.optimizedModelCacheDir == optimizedModelCacheDir &&
+      other.memory == memory &&
+      other.pageCrop == pageCrop;
+
+  @override
+  int get hashCode => Object.hash(
+        intraOpThreads,
+        interOpThreads,
+        graphOptimizationLevel,
+        Object.hashAllUnordered(executionProviders),
+        maxBatchSize,
+        fullResolutionDecode,
+        profileFilePrefix,
+        maxConcurrentRuns,
+        inputSize,
+        letterbox,
+        precision,
+        memoryMapModel,
+        optimizedModelCacheDir,
+        memory,
+        pageCrop,
+      );
+}
+
+/// Native postprocess passes, see `DocLayoutKit.setPostprocess`
+///
+/// The defaults keep every box above the call's confidence threshold, in
+/// score order.
+class PostprocessOptions {
+  /// Score threshold by class ID, overriding the call's `confThreshold`
+  ///
+  /// For example `{DocLayoutClass.formulaNumber.id: 0.3}` keeps faint
+  /// formula numbers without lowering the threshold for everything else.
+  final Map<int, double> classThresholds;
+
+  /// IoU above which same-class boxes are merged, 0 = off
+  final double nmsIou;
+
+  /// Drop boxes that lie at least this fraction inside a higher-scoring box
+  /// of the same class, 0 = off
+  final double containment;
+
+  /// Return boxes in reading order (top to bottom, column by column)
+  /// instead of by score
+  final bool readingOrder;
+
+  const PostprocessOptions({
+    this.classThresholds = const {},
+    this.nmsIou = 0.0,
+    this.containment = 0.0,
+    this.readingOrder = false,
+  });
+
+  /// Copy into a native options struct, the threshold table is allocated
+  /// with [allocator]
+  void writeTo(DocLayoutPostprocessOptions native, Allocator allocator) {
+    var count = 0;
+    for (final id in classThresholds.keys) {
+      if (id >= count) count = id + 1;
+    }
+    final thresholds = count == 0 ? nullptr : allocator<Float>(count);
+    for (var i = 0; i < count; i++) {
+      thresholds[i] = classThresholds[i] ?? -1.0;
+    }
+    native
+      ..class_thresholds = thresholds
+      ..num_class_thresholds = count
+      ..nms_iou = nmsIou
+      ..containment = containment
+      ..reading_order = readingOrder ? 1 : 0;
+  }
+}
+
+/// Tiling of a page for `detectTiledFromEncoded`
+class TileOptions {
+  /// Square tile side in original-image pixels, 0 = auto
+  ///
+  /// Auto uses half the longest page side, but never less than the model
+  /// input, so a dense A3 scan is run as a 2x2 to 3x3 grid.
+  final int tileSize;
+
+  /// Fraction of a tile shared with its neighbour
+  final double overlap;
+
+  /// Same-class boxes overlapping more than this IoU are merged
+  final double nmsIou;
+
+  /// Also run the whole page, so elements larger than the overlap (tables,
+  /// figures) are found uncut
+  final bool includeFullPage;
+
+  const TileOptions({
+    this.tileSize = 0,
+    this.overlap = 0.2,
+    this.nmsIou = 0.5,
+    this.includeFullPage = true,
+  });
+
+  /// Copy into a native tile options struct
+  void writeTo(DocLayoutTileOptions native) {
+    native
+      ..tile_size = tileSize
+      ..overlap = overlap
+      ..nms_iou = nmsIou
+      ..skip_full_page = includeFullPage ? 0 : 1;
+  }
+}
+
+/// An explicitly loaded model instance
+///
+/// Unlike `DocLayoutKit.init`, each detector owns its own native session,
+/// so several models (e.g. M and L) can be held in memory at once and
+/// swapped without restarting the process. The model is loaded when the
+/// detector is created, so the first detection does not pay for it.
+///
+/// Usage:
+/// ```dart
+/// final detector = DocLayoutDetector.create('/path/to/pp_doclayout_m.onnx');
+/// final result = detector.detectFromEncoded(jpegBytes, confThreshold: 0.3);
+/// detector.dispose();
+/// ```
+class DocLayoutDetector {
+  Pointer<Void> _handle;
+  int _inFlight = 0;
+  bool _disposeRequested = false;
+
+  /// Path of the loaded model
+  final String modelPath;
+
+  /// Lane of this detector's latestWins requests
+  late final int _latestLane = docLayoutBindings.nextRequestId();
+
+  DocLayoutDetector._(this._handle, this.modelPath);
+
+  /// Load [modelPath] into a new detector
+  ///
+  /// Throws [StateError] if the model cannot be loaded.
+  static DocLayoutDetector create(
+    String modelPath, {
+    DetectorOptions options = const DetectorOptions(),
+  }) {
+    return using((arena) {
+      final pathPtr = modelPath.toNativeUtf8(allocator: arena).cast<Char>();
+      final optionsPtr = arena<DocLayoutOptions>();
+      options.writeTo(optionsPtr.ref, arena);
+      final handle = docLayoutBindings.createDetector(pathPtr, optionsPtr);
+      if (handle == nullptr) {
+        throw StateError('Failed to load model: $modelPath');
+      }
+      return DocLayoutDetector._(handle, modelPath);
+    });
+  }
+
+  /// Whether [dispose] has been called
+  bool get isDisposed => _handle == nullptr || _disposeRequested;
+
+  /// Detect document layout from encoded image bytes (PNG, JPEG, etc.)
+  DetectionResult detectFromEncoded(
+    Uint8List encodedImage, {
+    double confThreshold = 0.5,
+  }) {
+    _checkNotDisposed();
+
+    final dataPtr = calloc<Uint8>(encodedImage.length);
+    final buffer = ResultBuffer.shared;
+
+    try {
+      dataPtr.asTypedList(encodedImage.length).setAll(0, encodedImage);
+
+      docLayoutBindings.detectWithHandleToBuffer(
+        _handle,
+        dataPtr,
+        encodedImage.length,
+        confThreshold,
+        buffer.pointer,
+        buffer.capacity,
+      );
+      return buffer.toResult();
+    } finally {
+      calloc.free(dataPtr);
+    }
+  }
+
+  /// Detect document layout on several encoded images at once
+  ///
+  /// Pages are run through the model in batches of
+  /// [DetectorOptions.maxBatchSize], which amortizes per-run overhead for
+  /// multi-page documents. Returns one result per entry of [encodedImages],
+  /// in the same order; pages that fail to decode carry their own error.
+  List<DetectionResult> detectBatchFromEncoded(
+    List<Uint8List> encodedImages, {
+    double confThreshold = 0.5,
+  }) {
+    _checkNotDisposed();
+    if (encodedImages.isEmpty) return [];
+
+    return using((arena) {
+      final count = encodedImages.length;
+      final dataPtrs = arena<Pointer<Uint8>>(count);
+      final lens = arena<Size>(count);
+      for (var i = 0; i < count; i++) {
+        final bytes = encodedImages[i];
+        final ptr = arena<Uint8>(bytes.isEmpty ? 1 : bytes.length);
+        ptr.asTypedList(bytes.length).setAll(0, bytes);
+        dataPtrs[i] = ptr;
+        lens[i] = bytes.length;
+      }
+
+      final resultPtr = docLayoutBindings.detectBatchWithHandle(
+          _handle, dataPtrs, lens, count, confThreshold);
+      try {
+        final jsonStr = resultPtr.cast<Utf8>().toDartString();
+        return DetectionResult.listFromBatchJson(jsonDecode(jsonStr), count);
+      } finally {
+        docLayoutBindings.freeString(resultPtr);
+      }
+    });
+  }
+
+  /// Set the native postprocess passes for the following detections on
+  /// this model, see `DocLayoutKit.setPostprocess`
+  void setPostprocess(PostprocessOptions options) {
+    _checkNotDisposed();
+    writePostprocessOptions(_handle, options);
+  }
+
+  /// Tiled detection for dense high-resolution pages, see
+  /// `DocLayoutKit.detectTiledFromEncoded`
+  DetectionResult detectTiledFromEncoded(
+    Uint8List encodedImage, {
+    double confThreshold = 0.5,
+    TileOptions tiles = const TileOptions(),
+  }) {
+    _checkNotDisposed();
+    return detectTiledOnHandle(_handle, encodedImage, confThreshold, tiles);
+  }
+
+  /// Detect and crop from one decode, see `DocLayoutKit.detectWithCrops`
+  CropResult detectWithCrops(
+    Uint8List encodedImage, {
+    double confThreshold = 0.5,
+    CropOptions crops = CropOptions.ocrTargets,
+  }) {
+    _checkNotDisposed();
+    return detectWithCropsOnHandle(_handle, encodedImage, confThreshold, crops);
+  }
+
+  /// Stream detection over many encoded pages, see `DocLayoutKit.detectPages`
+  Stream<DetectionResult> detectPages(
+    Iterable<Uint8List> pages, {
+    double confThreshold = 0.5,
+    int queueDepth = defaultPageQueueDepth,
+  }) async* {
+    _checkNotDisposed();
+
+    _inFlight++;
+    try {
+      yield* runPageStream(_handle, pages,
+          confThreshold: confThreshold, queueDepth: queueDepth);
+    } finally {
+      _inFlight--;
+      if (_disposeRequested && _inFlight == 0) {
+        _destroy();
+      }
+    }
+  }
+
+  /// Stream detection over the pages of a multi-page file, see
+  /// `DocLayoutKit.detectDocument`
+  Stream<DetectionResult> detectDocument(
+    String path, {
+    double confThreshold = 0.5,
+    int firstPage = 0,
+    int? pageCount,
+    int queueDepth = defaultPageQueueDepth,
+  }) async* {
+    _checkNotDisposed();
+
+    _inFlight++;
+    try {
+      yield* runDocumentStream(_handle, path,
+          confThreshold: confThreshold,
+          firstPage: firstPage,
+          pageCount: pageCount,
+          queueDepth: queueDepth);
+    } finally {
+      _inFlight--;
+      if (_disposeRequested && _inFlight == 0) {
+        _destroy();
+      }
+    }
+  }
+
+  /// Detect on the native worker thread without blocking this isolate
+  ///
+  /// [deadline], [latestWins] and [cancelToken] work as in
+  /// [DocLayoutKit.detectFromEncodedAsync]; latestWins requests replace each
+  /// other per detector.
+  Future<DetectionResult> detectFromEncodedAsync(
+    Uint8List encodedImage, {
+    double confThreshold = 0.5,
+    Duration? deadline,
+    bool latestWins = false,
+    DetectionCancelToken? cancelToken,
+  }) async {
+    _checkNotDisposed();
+
+    final dataPtr = calloc<Uint8>(encodedImage.length);
+    dataPtr.asTypedList(encodedImage.length).setAll(0, encodedImage);
+    return detectFromNativeAsync(dataPtr, encodedImage.length,
+        confThreshold: confThreshold,
+        deadline: deadline,
+        latestWins: latestWins,
+        cancelToken: cancelToken);
+  }
+
+  /// [detectFromEncodedAsync] on encoded bytes already in native memory
+  ///
+  /// Takes ownership of [data], which must come from `calloc`: it is freed
+  /// when the detection completes, or right away if this detector has been
+  /// disposed. Lets an isolate that received only the buffer's address
+  /// detect without copying the image again.
+  Future<DetectionResult> detectFromNativeAsync(
+    Pointer<Uint8> data,
+    int length, {
+    double confThreshold = 0.5,
+    Duration? deadline,
+    bool latestWins = false,
+    DetectionCancelToken? cancelToken,
+  }) async {
+    if (isDisposed) {
+      calloc.free(data);
+      _checkNotDisposed();
+    }
+
+    _inFlight++;
+    try {
+      return await NativeAsyncDispatcher.instance.submitEncoded(
+          _handle, data, length, confThreshold,
+          deadline: deadline,
+          lane: latestWins ? _latestLane : 0,
+          cancelToken: cancelToken);
+    } finally {
+      _inFlight--;
+      if (_disposeRequested && _inFlight == 0) {
+        _destroy();
+      }
+    }
+  }
+
+  /// Re-detect only the changed [region] of a page, see
+  /// `DocLayoutKit.detectRegionAsync`
+  Future<DetectionResult> detectRegionAsync(
+    Uint8List encodedImage, {
+    required DetectionResult previous,
+    LayoutRegion? region,
+    double confThreshold = 0.5,
+    Duration? deadline,
+    DetectionCancelToken? cancelToken,
+  }) async {
+    _checkNotDisposed();
+
+    _inFlight++;
+    try {
+      return await submitRegionOnHandle(
+          _handle, encodedImage, confThreshold, previous, region,
+          deadline: deadline, cancelToken: cancelToken);
+    } finally {
+      _inFlight--;
+      if (_disposeRequested && _inFlight == 0) {
+        _destroy();
+      }
+    }
+  }
+
+  /// Synchronous [detectRegionAsync]
+  DetectionResult detectRegion(
+    Uint8List encodedImage, {
+    required DetectionResult previous,
+    LayoutRegion? region,
+    double confThreshold = 0.5,
+  }) {
+    _checkNotDisposed();
+    return detectRegionOnHandle(_handle, encodedImage, confThreshold, previous, region);
+  }
+
+  /// Remap [previous] through [transform] with this model's class names,
+  /// see `DocLayoutKit.transformResult`
+  DetectionResult transformResult(DetectionResult previous, ResultTransform transform) {
+    _checkNotDisposed();
+    return transformResultOnHandle(_handle, previous, transform);
+  }
+
+  /// Stop ONNX Runtime profiling and return the trace file path
+  ///
+  /// Returns null unless [DetectorOptions.profileFilePrefix] was set.
+  String? endProfiling() {
+    _checkNotDisposed();
+    return readProfilePath(docLayoutBindings.endProfiling(_handle));
+  }
+
+  /// Release this model's idle buffers and free arena blocks, see
+  /// `DocLayoutKit.trimMemory` for the cost of [shrinkArena]
+  void trimMemory({bool shrinkArena = true}) {
+    _checkNotDisposed();
+    docLayoutBindings.trimMemory(_handle, shrinkArena ? 1 : 0);
+  }
+
+  /// Run dummy inferences so the first real detection is not the cold one,
+  /// see `DocLayoutKit.warmup`
+  WarmupResult warmup({int iterations = 2}) {
+    _checkNotDisposed();
+    return warmupHandle(_handle, iterations);
+  }
+
+  /// Inputs, outputs, variant and class table read from the model at load time
+  ModelInfo get modelInfo {
+    _checkNotDisposed();
+    return readModelInfo(_handle);
+  }
+
+  /// Create a live-camera tracker on this detector, see [DocLayoutTracker]
+  ///
+  /// The session stays alive until the tracker is disposed.
+  DocLayoutTracker createTracker({
+    double changeThreshold = 0.0,
+    Duration maxAge = Duration.zero,
+    double smoothing = 0.0,
+  }) {
+    _checkNotDisposed();
+
+    final tracker = DocLayoutTracker.createOnHandle(
+      _handle,
+      changeThreshold: changeThreshold,
+      maxAge: maxAge,
+      smoothing: smoothing,
+      onDispose: () {
+        _inFlight--;
+        if (_disposeRequested && _inFlight == 0) {
+          _destroy();
+        }
+      },
+    );
+    _inFlight++;
+    return tracker;
+  }
+
+  /// Release the native session
+  ///
+  /// If async detections are still running or trackers are still open,
+  /// the session is released once the last one completes.
+  void dispose() {
+    if (isDisposed) return;
+    _disposeRequested = true;
+    if (_inFlight == 0) {
+      _destroy();
+    }
+  }
+
+  void _destroy() {
+    if (_handle == nullptr) return;
+    docLayoutBindings.destroyDetector(_handle);
+    _handle = nullptr;
+  }
+
+  void _checkNotDisposed() {
+    if (isDisposed) {
+      throw StateError('DocLayoutDetector has been disposed');
+    }
+  }
+}
@@ -1,17 +1,16 @@
-import 'dart:convert';
-import 'dart:ffi';
-import 'dart:io';
+import 'dart:async';
 
-import 'package:ffi/ffi.dart';
 import 'package:flutter/foundation.dart';
 
-import '../flutter_doclayout_kit_bindings_generated.dart';
+import 'doc_layout_detector.dart';
+import 'doc_layout_worker.dart';
 import 'models.dart';
 
 /// High-level document layout detection service with isolate support
 ///
-/// This service automatically runs detection in a background isolate
-/// to prevent blocking the UI thread.
+/// This service runs detection in a long-lived background isolate
+/// ([DocLayoutWorker]) to prevent blocking the UI thread. The isolate and
+/// the loaded model are reused across calls.
 ///
 /// Usage:
 /// ```dart
@@ -45,151 +44,91 @@ class DocLayoutService {
   /// Private constructor
   DocLayoutService._();
 
+  static Future<DocLayoutWorker>? _worker;
+
   /// Detect document layout from image bytes in a background isolate
   ///
   /// [imageBytes] - Image data in any format supported by OpenCV (PNG, JPEG, etc.)
   /// [modelPath] - Path to the ONNX model file
   /// [confThreshold] - Confidence threshold (0.0 - 1.0), default 0.3
-  /// [tempDirectory] - Optional temporary directory for saving image file
+  /// [tempDirectory] - No longer used, images are decoded from memory
   ///
   /// Returns [DetectionResult] containing detected layout elements.
-  /// Automatically runs in a background isolate to avoid blocking UI.
+  /// The first call spawns the worker isolate and loads the model; later
+  /// calls reuse both. Passing a different [modelPath] swaps the model and
+  /// keeps the options it was loaded with (see [preload]).
   static Future<DetectionResult> detectLayout({
     required Uint8List imageBytes,
     required String modelPath,
     double confThreshold = 0.3,
+    @Deprecated('Images are decoded from memory, no temp file is written')
     String? tempDirectory,
   }) async {
-    // Use compute() to automatically create and manage isolate
-    return compute(_isolateDetect, {
-      'imageBytes': imageBytes,
-      'modelPath': modelPath,
-      'confThreshold': confThreshold,
-      'tempDirectory': tempDirectory,
-      'timestamp': DateTime.now().millisecondsSinceEpoch,
-    });
+    final DocLayoutWorker worker;
+    try {
+      worker = await _workerFor(modelPath);
+    } catch (e) {
+      return DetectionResult.error('Model initialization failed: $e');
+    }
+    return worker.detect(imageBytes, confThreshold: confThreshold);
   }
 
-  /// Isolate entry point - must be static or top-level function
+  /// Spawn the background isolate, load [modelPath] and warm it up
   ///
-  /// This function runs in a separate isolate and handles:
-  /// 1. FFI library initialization
-  /// 2. Saving image to temporary file
-  /// 3. Calling native detection function
-  /// 4. Parsing JSON result
-  /// 5. Cleaning up temporary file
-  static DetectionResult _isolateDetect(Map<String, dynamic> params) {
-    // Extract parameters
-    final Uint8List imageBytes = params['imageBytes'];
-    final String modelPath = params['modelPath'];
-    final double confThreshold = params['confThreshold'];
-    final String? tempDir = params['tempDirectory'];
-    final int timestamp = params['timestamp'];
+  /// Call it at app start or when a scanning screen opens, so the first
+  /// [detectLayout] does not pay for session creation and the cold first
+  /// inference. Both happen in the worker isolate; the UI isolate only
+  /// awaits the returned future. Later [detectLayout] calls with the same
+  /// [modelPath] reuse the warmed session. If the worker already has a
+  /// model loaded with another path or other [options], it is reloaded.
+  static Future<WarmupResult> preload({
+    required String modelPath,
+    DetectorOptions options = const DetectorOptions(),
+    int iterations = 2,
+  }) async {
+    final worker = await _workerFor(modelPath, options: options);
+    return worker.warmup(iterations: iterations);
+  }
 
-    // Determine temp directory
-    String tempDirPath;
-    if (tempDir != null) {
-      tempDirPath = tempDir;
-    } else {
-      // In isolate, we can't use async getTemporaryDirectory()
-      // Use system temp directory instead
-      final dir = Directory.systemTemp;
-      tempDirPath = dir.path;
+  /// Stop the background isolate and release its model
+  static Future<void> dispose() async {
+    final worker = _worker;
+    _worker = null;
+    if (worker != null) {
+      try {
+        await (await worker).close();
+      } catch (_) {}
     }
+  }
 
-    // Generate temporary file path
-    final fileName = 'doclayout_$timestamp.png';
-    final filePath = '$tempDirPath/$fileName';
+  /// Shared worker with [modelPath] loaded, spawned on first use
+  ///
+  /// Without [options] the worker's current options are kept.
+  static Future<DocLayoutWorker> _workerFor(
+    String modelPath, {
+    DetectorOptions? options,
+  }) async {
+    final pending = _worker ??= DocLayoutWorker.spawn(
+      modelPath: modelPath,
+      options: options ?? const DetectorOptions(),
+    );
 
+    final DocLayoutWorker worker;
     try {
-      // Step 1: Initialize FFI in isolate
-      // Note: FFI library must be reinitialized in each isolate
-      late final DynamicLibrary nativeLib;
-      late final DocLayoutKitBindings bindings;
-
-      try {
-        const libName = 'doc_layout_kit';
-
-        if (Platform.isIOS || Platform.isMacOS) {
-          // iOS/macOS: Static library linked into main binary
-          nativeLib = DynamicLibrary.process();
-        } else if (Platform.isAndroid || Platform.isLinux) {
-          nativeLib = DynamicLibrary.open('lib$libName.so');
-        } else if (Platform.isWindows) {
-          nativeLib = DynamicLibrary.open('$libName.dll');
-        } else {
-          return DetectionResult.error('Unsupported platform: ${Platform.operatingSystem}');
-        }
-
-        bindings = DocLayoutKitBindings(nativeLib);
-      } catch (e) {
-        return DetectionResult.error('FFI initialization failed: $e');
-      }
-
-      // Step 2: Initialize model
-      final modelPathPtr = modelPath.toNativeUtf8().cast<Char>();
-      try {
-        bindings.initModel(modelPathPtr);
-      } catch (e) {
-        calloc.free(modelPathPtr);
-        return DetectionResult.error('Model initialization failed: $e');
-      } finally {
-        calloc.free(modelPathPtr);
-      }
-
-      // Step 3: Save image to temporary file (synchronous in isolate)
-      try {
-        File(filePath).writeAsBytesSync(imageBytes, flush: false);
-      } catch (e) {
-        return DetectionResult.error('Failed to save image: $e');
-      }
-
-      // Verify file was saved correctly
-      final savedFile = File(filePath);
-      if (!savedFile.existsSync()) {
-        return DetectionResult.error('Image file not found after saving');
-      }
-
-      // Step 4: Call native detection function
-      final imagePathPtr = filePath.toNativeUtf8().cast<Char>();
-      Pointer<Char>? resultPtr;
-
-      try {
-        resultPtr = bindings.detectLayout(imagePathPtr, confThreshold);
-        final jsonStr = resultPtr.cast<Utf8>().toDartString();
-
-        // Step 5: Parse result
-        final result = DetectionResult.fromJson(jsonDecode(jsonStr));
-
-        // Step 6: Clean up temporary file
-        try {
-          savedFile.deleteSync();
-        } catch (e) {
-          // Log warning but don't fail
-          debugPrint('[Isolate] Warning: Failed to delete temp file: $e');
-        }
-
-        return result;
-
-      } catch (e) {
-        // Clean up on error
-        try {
-          savedFile.deleteSync();
-        } catch (_) {}
-        return DetectionResult.error('Detection failed: $e');
-      } finally {
-        calloc.free(imagePathPtr);
-        if (resultPtr != null) {
-          bindings.freeString(resultPtr);
-        }
+      worker = await pending;
+    } catch (e) {
+      // Let the next call retry the spawn
+      if (identical(_worker, pending)) {
+        _worker = null;
       }
+      rethrow;
+    }
 
-    } catch (e) {
-      // Clean up on unexpected error
-      try {
-        File(filePath).deleteSync();
-      } catch (_) {}
-      return DetectionResult.error('Unexpected error: $e');
+    final wanted = options ?? worker.options;
+    if (worker.modelPath != modelPath || worker.options != wanted) {
+      debugPrint('[DocLayoutService] Switching model to $modelPath');
+      await worker.loadModel(modelPath, options: wanted);
     }
+    return worker;
   }
 }
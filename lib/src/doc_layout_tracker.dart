@@ -0,0 +1,207 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../flutter_doclayout_kit_bindings_generated.dart';
+import 'models.dart';
+import 'native_library.dart';
+import 'result_buffer.dart';
+
+/// Result of one tracked camera frame
+class TrackedResult {
+  /// Detections for the frame
+  final DetectionResult result;
+
+  /// Whether the cached detections of an earlier frame were returned
+  /// without running inference
+  final bool reused;
+
+  /// Mean absolute luma difference (0-1) against the last inferred frame
+  final double change;
+
+  const TrackedResult({
+    required this.result,
+    required this.reused,
+    required this.change,
+  });
+
+  @override
+  String toString() => 'TrackedResult(reused: $reused, change: '
+      '${change.toStringAsFixed(4)}, $result)';
+}
+
+/// Live-camera detection that skips inference on steady scenes
+///
+/// Each frame is reduced to a tiny luma thumbnail and compared with the
+/// last frame that went through the model. While the change stays below
+/// [changeThreshold] the previous boxes are returned immediately; a
+/// moving camera, a new frame size or [maxAge] passing triggers a fresh
+/// inference, whose boxes are blended with their previous position to
+/// reduce jitter.
+///
+/// Usage:
+/// ```dart
+/// final tracker = DocLayoutTracker.create();
+/// final tracked = tracker.trackYuv(...);
+/// if (!tracked.reused) repaintOverlay(tracked.result);
+/// tracker.dispose();
+/// ```
+class DocLayoutTracker {
+  Pointer<Void> _handle;
+  final ResultBuffer _buffer = ResultBuffer(ResultBuffer.defaultCapacity);
+  final void Function()? _onDispose;
+
+  DocLayoutTracker._(this._handle, this._onDispose);
+
+  /// Create a tracker on the model loaded by `DocLayoutKit.init`
+  ///
+  /// Use `DocLayoutDetector.createTracker` to track on a detector instance.
+  /// Throws [StateError] if no model is loaded.
+  static DocLayoutTracker create({
+    double changeThreshold = 0.0,
+    Duration maxAge = Duration.zero,
+    double smoothing = 0.0,
+  }) =>
+      createOnHandle(nullptr,
+          changeThreshold: changeThreshold,
+          maxAge: maxAge,
+          smoothing: smoothing);
+
+  /// Create a tracker on a native detector handle, nullptr = default model
+  ///
+  /// Zero values select the native defaults (0.04, 1 s, 0.3); a negative
+  /// [smoothing] disables box smoothing. [onDispose] runs once the tracker
+  /// is released.
+  static DocLayoutTracker createOnHandle(
+    Pointer<Void> detectorHandle, {
+    double changeThreshold = 0.0,
+    Duration maxAge = Duration.zero,
+    double smoothing = 0.0,
+    void Function()? onDispose,
+  }) {
+    final optionsPtr = calloc<DocLayoutTrackerOptions>();
+    try {
+      optionsPtr.ref
+        ..change_threshold = changeThreshold
+        ..max_age_ms = maxAge.inMilliseconds
+        ..smoothing = smoothing;
+      final handle =
+          docLayoutBindings.createTracker(detectorHandle, optionsPtr);
+      if (handle == nullptr) {
+        throw StateError('No model loaded for the tracker');
+      }
+      return DocLayoutTracker._(handle, onDispose);
+    } finally {
+      calloc.free(optionsPtr);
+    }
+  }
+
+  /// Whether [dispose] has been called
+  bool get isDisposed => _handle == nullptr;
+
+  /// Track a raw RGB/RGBA/gray frame
+  TrackedResult trackBytes(
+    Uint8List imageData, {
+    required int width,
+    required int height,
+    int channels = 3,
+    double confThreshold = 0.5,
+  }) {
+    _checkNotDisposed();
+
+    final dataPtr = calloc<UnsignedChar>(imageData.length);
+    try {
+      dataPtr.cast<Uint8>().asTypedList(imageData.length).setAll(0, imageData);
+
+      docLayoutBindings.trackFrameFromBytesToBuffer(
+        _handle,
+        dataPtr,
+        width,
+        height,
+        channels,
+        confThreshold,
+        _buffer.pointer,
+        _buffer.capacity,
+      );
+      return _readResult();
+    } finally {
+      calloc.free(dataPtr);
+    }
+  }
+
+  /// Track a YUV 4:2:0 camera frame, see `DocLayoutKit.detectFromYuv`
+  TrackedResult trackYuv({
+    required Uint8List yPlane,
+    required Uint8List uPlane,
+    required Uint8List vPlane,
+    required int width,
+    required int height,
+    required int yRowStride,
+    required int uvRowStride,
+    int uvPixelStride = 1,
+    double confThreshold = 0.5,
+  }) {
+    _checkNotDisposed();
+
+    final total = yPlane.length + uPlane.length + vPlane.length;
+    final dataPtr = calloc<Uint8>(total == 0 ? 1 : total);
+
+    try {
+      final yPtr = dataPtr;
+      final uPtr = dataPtr + yPlane.length;
+      final vPtr = uPtr + uPlane.length;
+      yPtr.asTypedList(yPlane.length).setAll(0, yPlane);
+      uPtr.asTypedList(uPlane.length).setAll(0, uPlane);
+      vPtr.asTypedList(vPlane.length).setAll(0, vPlane);
+
+      docLayoutBindings.trackFrameFromYuvToBuffer(
+        _handle,
+        yPtr,
+        uPtr,
+        vPtr,
+        width,
+        height,
+        yRowStride,
+        uvRowStride,
+        uvPixelStride,
+        confThreshold,
+        _buffer.pointer,
+        _buffer.capacity,
+      );
+      return _readResult();
+    } finally {
+      calloc.free(dataPtr);
+    }
+  }
+
+  /// Forget the cached frame, the next frame always runs inference
+  void reset() {
+    _checkNotDisposed();
+    docLayoutBindings.resetTracker(_handle);
+  }
+
+  /// Release the native tracker
+  void dispose() {
+    if (isDisposed) return;
+    docLayoutBindings.destroyTracker(_handle);
+    _handle = nullptr;
+    _buffer.free();
+    _onDispose?.call();
+  }
+
+  TrackedResult _readResult() {
+    final view = _buffer.view;
+    return TrackedResult(
+      result: DetectionResult.fromFloat32List(view),
+      reused: view[6] != 0.0,
+      change: view[7],
+    );
+  }
+
+  void _checkNotDisposed() {
+    if (isDisposed) {
+      throw StateError('DocLayoutTracker has been disposed');
+    }
+  }
+}
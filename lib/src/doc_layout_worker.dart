@@ -0,0 +1,291 @@
+import 'dart:async';
+import 'dart:ffi';
+import 'dart:isolate';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../flutter_doclayout_kit.dart';
+
+/// Message sent to a worker isolate that loads (or swaps) the model
+class _LoadModelRequest {
+  final int id;
+  final String modelPath;
+  final DetectorOptions options;
+
+  _LoadModelRequest(this.id, this.modelPath, this.options);
+}
+
+/// Message sent to a worker isolate with one image to detect
+///
+/// [address] points to [length] encoded bytes allocated with `calloc`;
+/// the worker takes ownership of them.
+class _DetectRequest {
+  final int id;
+  final int address;
+  final int length;
+  final double confThreshold;
+
+  _DetectRequest(this.id, this.address, this.length, this.confThreshold);
+}
+
+/// Message sent to a worker isolate to warm up the loaded model
+class _WarmupRequest {
+  final int id;
+  final int iterations;
+
+  _WarmupRequest(this.id, this.iterations);
+}
+
+/// Message sent to a worker isolate to release its model and exit
+class _CloseRequest {
+  final int id;
+
+  _CloseRequest(this.id);
+}
+
+/// Sent by the isolate's exit listener
+const _exitMarker = 'DocLayoutWorker.exit';
+
+/// Reply from the worker isolate, [result] is null for model loads
+class _WorkerResponse {
+  final int id;
+  final DetectionResult? result;
+  final WarmupResult? warmup;
+  final String? error;
+
+  _WorkerResponse(this.id, {this.result, this.warmup, this.error});
+}
+
+/// Long-lived background isolate for layout detection
+///
+/// The isolate opens the native library, builds the FFI bindings and loads
+/// the model into its own [DocLayoutDetector] once, then serves requests over
+/// a [SendPort]. The default model of [DocLayoutKit] is left alone, so
+/// several workers and main-isolate callers can use different models.
+///
+/// Image bytes are copied once, straight into native memory (the Dart heap
+/// may move them, native code needs a fixed address); only the address
+/// crosses to the isolate, which hands the buffer to the native worker.
+/// Requests are queued on the native worker, so several can be in flight.
+///
+/// Usage:
+/// ```dart
+/// final worker = await DocLayoutWorker.spawn(modelPath: modelPath);
+/// final result = await worker.detect(jpegBytes, confThreshold: 0.3);
+/// await worker.close();
+/// ```
+class DocLayoutWorker {
+  final Isolate _isolate;
+  final SendPort _commands;
+  final ReceivePort _responses;
+  final Map<int, Completer<_WorkerResponse>> _pending = {};
+  int _nextId = 0;
+  bool _closed = false;
+
+  String _modelPath;
+  DetectorOptions _options;
+
+  DocLayoutWorker._(this._isolate, this._commands, this._responses,
+      Stream<dynamic> responseStream, this._modelPath, this._options) {
+    responseStream.listen(_handleResponse);
+    // Fail pending requests if the isolate dies instead of replying
+    _isolate.addOnExitListener(_responses.sendPort, response: _exitMarker);
+  }
+
+  /// Path of the model currently loaded in the worker
+  String get modelPath => _modelPath;
+
+  /// Options the current model was loaded with
+  DetectorOptions get options => _options;
+
+  /// Whether [close] has been called
+  bool get isClosed => _closed;
+
+  /// Spawn a worker isolate and load [modelPath] in it
+  ///
+  /// Throws [StateError] if the model cannot be loaded.
+  static Future<DocLayoutWorker> spawn({
+    required String modelPath,
+    DetectorOptions options = const DetectorOptions(),
+  }) async {
+    final responses = ReceivePort();
+    final isolate = await Isolate.spawn(
+      _workerMain,
+      responses.sendPort,
+      debugName: 'DocLayoutWorker',
+    );
+
+    // First message from the isolate is its command port
+    final portCompleter = Completer<SendPort>();
+    final broadcast = responses.asBroadcastStream();
+    final subscription = broadcast.listen((message) {
+      if (message is SendPort && !portCompleter.isCompleted) {
+        portCompleter.complete(message);
+      }
+    });
+    final commands = await portCompleter.future;
+    await subscription.cancel();
+
+    final worker = DocLayoutWorker._(
+        isolate, commands, responses, broadcast, modelPath, options);
+    try {
+      await worker.loadModel(modelPath, options: options);
+    } catch (_) {
+      await worker.close();
+      rethrow;
+    }
+    return worker;
+  }
+
+  /// Load (or swap) the model used by this worker
+  Future<void> loadModel(
+    String modelPath, {
+    DetectorOptions options = const DetectorOptions(),
+  }) async {
+    final response =
+        await _send((id) => _LoadModelRequest(id, modelPath, options));
+    if (response.error != null) {
+      throw StateError(response.error!);
+    }
+    _modelPath = modelPath;
+    _options = options;
+  }
+
+  /// Detect document layout from encoded image bytes (PNG, JPEG, etc.)
+  Future<DetectionResult> detect(
+    Uint8List imageBytes, {
+    double confThreshold = 0.3,
+  }) async {
+    if (imageBytes.isEmpty) {
+      return DetectionResult.error('Image data is empty');
+    }
+    if (_closed) {
+      return DetectionResult.error('Worker closed');
+    }
+    // The one copy: the worker's detector frees the buffer when done
+    final dataPtr = calloc<Uint8>(imageBytes.length);
+    dataPtr.asTypedList(imageBytes.length).setAll(0, imageBytes);
+    final response = await _send((id) =>
+        _DetectRequest(id, dataPtr.address, imageBytes.length, confThreshold));
+    return response.result ??
+        DetectionResult.error(response.error ?? 'Detection failed');
+  }
+
+  /// Run dummy inferences in the worker, see `DocLayoutKit.warmup`
+  ///
+  /// Throws [StateError] if no model is loaded or the worker is closed.
+  Future<WarmupResult> warmup({int iterations = 2}) async {
+    final response = await _send((id) => _WarmupRequest(id, iterations));
+    if (response.warmup == null) {
+      throw StateError(response.error ?? 'Warm-up failed');
+    }
+    return response.warmup!;
+  }
+
+  /// Stop the worker isolate and release its model, pending requests fail
+  ///
+  /// Running detections are cancelled; the isolate exits once the native
+  /// worker has returned them and the model is released.
+  Future<void> close() async {
+    if (_closed) return;
+    final released = _send((id) => _CloseRequest(id));
+    _closed = true;
+    await released;
+    _responses.close();
+    _failPending();
+  }
+
+  void _failPending() {
+    for (final completer in _pending.values) {
+      completer.complete(_WorkerResponse(-1, error: 'Worker closed'));
+    }
+    _pending.clear();
+  }
+
+  Future<_WorkerResponse> _send(Object Function(int id) buildMessage) {
+    if (_closed) {
+      return Future.value(_WorkerResponse(-1, error: 'Worker closed'));
+    }
+    final id = _nextId++;
+    final completer = Completer<_WorkerResponse>();
+    _pending[id] = completer;
+    _commands.send(buildMessage(id));
+    return completer.future;
+  }
+
+  void _handleResponse(dynamic message) {
+    if (message == _exitMarker) {
+      _closed = true;
+      _failPending();
+      return;
+    }
+    if (message is! _WorkerResponse) return;
+    _pending.remove(message.id)?.complete(message);
+  }
+
+  /// Worker isolate entry point
+  static void _workerMain(SendPort replies) {
+    final commands = ReceivePort();
+    replies.send(commands.sendPort);
+
+    // Owned by this isolate, disposed on swap and on close
+    DocLayoutDetector? detector;
+    final running = DetectionCancelToken();
+
+    commands.listen((message) {
+      if (message is _LoadModelRequest) {
+        try {
+          final loaded =
+              DocLayoutDetector.create(message.modelPath, options: message.options);
+          // Released once its in-flight detections complete
+          detector?.dispose();
+          detector = loaded;
+          replies.send(_WorkerResponse(message.id));
+        } catch (e) {
+          replies.send(_WorkerResponse(message.id, error: '$e'));
+        }
+      } else if (message is _DetectRequest) {
+        final data = Pointer<Uint8>.fromAddress(message.address);
+        final current = detector;
+        if (current == null) {
+          calloc.free(data);
+          replies.send(_WorkerResponse(message.id, error: 'No model loaded'));
+          return;
+        }
+        current
+            .detectFromNativeAsync(
+              data,
+              message.length,
+              confThreshold: message.confThreshold,
+              cancelToken: running,
+            )
+            .then((result) {
+          replies.send(_WorkerResponse(message.id, result: result));
+        }, onError: (Object e) {
+          replies.send(_WorkerResponse(message.id, error: 'Detection failed: $e'));
+        });
+      } else if (message is _WarmupRequest) {
+        final current = detector;
+        if (current == null) {
+          replies.send(_WorkerResponse(message.id, error: 'No model loaded'));
+          return;
+        }
+        try {
+          final warmup = current.warmup(iterations: message.iterations);
+          replies.send(_WorkerResponse(message.id, warmup: warmup));
+        } catch (e) {
+          replies.send(_WorkerResponse(message.id, error: '$e'));
+        }
+      } else if (message is _CloseRequest) {
+        // The isolate stays alive until the cancelled runs have returned
+        // and the detector is destroyed, then exits with no open ports
+        running.cancel();
+        detector?.dispose();
+        detector = null;
+        commands.close();
+        replies.send(_WorkerResponse(message.id));
+      }
+    });
+  }
+}
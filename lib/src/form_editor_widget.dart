@@ -152,6 +152,17 @@ class FormEditorWidgetState extends State<FormEditorWidget> {
     _loadImage();
   }
 
+  @override
+  void didUpdateWidget(FormEditorWidget oldWidget) {
+    super.didUpdateWidget(oldWidget);
+    if (!identical(widget.result, oldWidget.result)) {
+      _updateFields(oldWidget.result);
+    }
+    if (!identical(widget.imageBytes, oldWidget.imageBytes)) {
+      _loadImage();
+    }
+  }
+
   @override
   void dispose() {
     for (final field in _fields) {
@@ -161,6 +172,37 @@ class FormEditorWidgetState extends State<FormEditorWidget> {
     super.dispose();
   }
 
+  /// Rebuild the fields for a new result. With an incremental result
+  /// (`detectRegionAsync`, `transformResult`) the boxes that continue a
+  /// previous one keep their field, so typed text and focus survive.
+  void _updateFields(DetectionResult previous) {
+    final byBox = Map<DetectionBox, FormFieldData>.identity();
+    for (final field in _fields) {
+      byBox[field.box] = field;
+    }
+    _fields.clear();
+
+    final sortedDetections = _sortByReadingOrder(widget.result.detections);
+    for (var i = 0; i < sortedDetections.length; i++) {
+      final box = sortedDetections[i];
+      final previousIndex = box.previousIndex;
+      final kept = previousIndex != null && previousIndex < previous.detections.length
+          ? byBox.remove(previous.detections[previousIndex])
+          : null;
+      _fields.add(FormFieldData(
+        index: i,
+        box: box,
+        controller: kept?.controller ?? TextEditingController(),
+        focusNode: kept?.focusNode ?? FocusNode(),
+        isEditable: isEditableType(box.className),
+      ));
+    }
+
+    for (final field in byBox.values) {
+      field.dispose();
+    }
+  }
+
   void _initFields() {
     final sortedDetections = _sortByReadingOrder(widget.result.detections);
 
@@ -392,38 +392,108 @@ $elements
   static String _generateElements(
       List<DetectionBox> detections, DetectionResult result) {
     final buffer = StringBuffer();
-    final imgWidth = result.imageWidth.toDouble();
-    final imgHeight = result.imageHeight.toDouble();
+    final detectionIndex = _detectionIndices(result);
 
     for (var i = 0; i < detections.length; i++) {
       final box = detections[i];
-      final isEditableElement = isEditable(box.className);
+      buffer.write(_generateElement(box, i, detectionIndex[box]!, result));
+    }
 
-      // Calculate percentage positions
-      final left = (box.x1 / imgWidth * 100).toStringAsFixed(3);
-      final top = (box.y1 / imgHeight * 100).toStringAsFixed(3);
-      final width = (box.width / imgWidth * 100).toStringAsFixed(3);
-      final height = (box.height / imgHeight * 100).toStringAsFixed(3);
+    return buffer.toString();
+  }
 
-      final fontSize = _fontSizeMapping[box.className] ?? '14px';
-      final cssClass = isEditableElement ? 'editable-field' : 'visual-element';
-      final editableAttr = isEditableElement ? 'contenteditable="true"' : '';
-
-      buffer.writeln('    <div class="form-element $cssClass ${_toCssClass(box.className)}"');
-      buffer.writeln('         $editableAttr');
-      buffer.writeln('         style="left: $left%; top: $top%; width: $width%; height: $height%; font-size: $fontSize;"');
-      buffer.writeln('         data-type="${box.className}"');
-      buffer.writeln('         data-index="$i"');
-      buffer.writeln('         data-score="${box.score.toStringAsFixed(4)}"');
-      if (isEditableElement) {
-        buffer.writeln('         placeholder="${_getPlaceholder(box.className)}"');
-      }
-      buffer.writeln('    ></div>');
+  /// Index of each box in [DetectionResult.detections], which the elements
+  /// carry as `data-detection` so incremental updates can find them
+  static Map<DetectionBox, int> _detectionIndices(DetectionResult result) {
+    final indices = Map<DetectionBox, int>.identity();
+    for (var i = 0; i < result.detections.length; i++) {
+      indices[result.detections[i]] = i;
     }
+    return indices;
+  }
+
+  /// Position of [box] as CSS percentages of the page
+  static String _positionStyle(DetectionBox box, DetectionResult result) {
+    final imgWidth = result.imageWidth.toDouble();
+    final imgHeight = result.imageHeight.toDouble();
+    final left = (box.x1 / imgWidth * 100).toStringAsFixed(3);
+    final top = (box.y1 / imgHeight * 100).toStringAsFixed(3);
+    final width = (box.width / imgWidth * 100).toStringAsFixed(3);
+    final height = (box.height / imgHeight * 100).toStringAsFixed(3);
+    return 'left: $left%; top: $top%; width: $width%; height: $height%;';
+  }
+
+  /// Generate the HTML of one element, [index] in reading order
+  static String _generateElement(
+      DetectionBox box, int index, int detectionIndex, DetectionResult result) {
+    final buffer = StringBuffer();
+    final isEditableElement = isEditable(box.className);
+
+    final fontSize = _fontSizeMapping[box.className] ?? '14px';
+    final cssClass = isEditableElement ? 'editable-field' : 'visual-element';
+    final editableAttr = isEditableElement ? 'contenteditable="true"' : '';
+
+    buffer.writeln('    <div class="form-element $cssClass ${_toCssClass(box.className)}"');
+    buffer.writeln('         $editableAttr');
+    buffer.writeln('         style="${_positionStyle(box, result)} font-size: $fontSize;"');
+    buffer.writeln('         data-type="${box.className}"');
+    buffer.writeln('         data-index="$index"');
+    buffer.writeln('         data-detection="$detectionIndex"');
+    buffer.writeln('         data-score="${box.score.toStringAsFixed(4)}"');
+    if (isEditableElement) {
+      buffer.writeln('         placeholder="${_getPlaceholder(box.className)}"');
+    }
+    buffer.writeln('    ></div>');
 
     return buffer.toString();
   }
 
+  /// JavaScript that applies an incremental result to a page generated
+  /// from the previous one, instead of regenerating the whole document
+  ///
+  /// [update] comes from `detectRegionAsync` or `transformResult` against
+  /// the result the page was generated from. Removed boxes' nodes are
+  /// deleted, added and updated ones are (re)built, moved ones only
+  /// repositioned, unchanged ones left alone; text typed into an updated
+  /// field is kept. Run it with `WebViewController.runJavaScript`.
+  static String generateUpdateScript(DetectionResult update) {
+    if (!update.isSuccess) {
+      return '';
+    }
+
+    final detectionIndex = _detectionIndices(update);
+    final sortedDetections = _sortByReadingOrder(update.detections);
+    final elements = <Map<String, dynamic>>[];
+    for (var i = 0; i < sortedDetections.length; i++) {
+      final box = sortedDetections[i];
+      final element = <String, dynamic>{
+        'detection': detectionIndex[box],
+        'previous': box.previousIndex ?? -1,
+      };
+      switch (box.diff) {
+        case DetectionDiff.added:
+        case DetectionDiff.updated:
+        case null:
+          element['html'] = _generateElement(box, i, detectionIndex[box]!, update);
+          break;
+        case DetectionDiff.moved:
+          element['style'] = _positionStyle(box, update);
+          break;
+        case DetectionDiff.unchanged:
+          break;
+      }
+      elements.add(element);
+    }
+
+    final payload = jsonEncode({
+      'width': update.imageWidth,
+      'height': update.imageHeight,
+      'removed': update.removed,
+      'elements': elements,
+    });
+    return 'applyLayoutUpdate($payload);';
+  }
+
   /// Convert class name to CSS class
   static String _toCssClass(String className) {
     return className.replaceAll('_', '-');
@@ -633,14 +703,11 @@ $elements
   /// Generate JavaScript for interactivity
   static String _generateScript() {
     return '''
-    var editableFields = document.querySelectorAll('.editable-field');
-    var fieldArray = Array.from(editableFields);
+    var fieldArray = [];
     var currentFieldIndex = -1;
 
-    // Track content changes
-    editableFields.forEach(function(el, index) {
-      el.dataset.fieldIndex = index;
-
+    function bindField(el) {
+      // Track content changes
       el.addEventListener('input', function() {
         if (this.textContent.trim().length > 0) {
           this.classList.add('has-content');
@@ -691,7 +758,28 @@ $elements
           }
         }
       });
-    });
+
+      // Click on editable field to focus
+      el.addEventListener('mousedown', function(e) {
+        e.stopPropagation();
+      });
+
+      el.addEventListener('click', function(e) {
+        e.stopPropagation();
+        this.focus();
+      });
+    }
+
+    // Number the editable fields in document order
+    function refreshFields() {
+      fieldArray = Array.from(document.querySelectorAll('.editable-field'));
+      fieldArray.forEach(function(el, index) {
+        el.dataset.fieldIndex = index;
+      });
+    }
+
+    refreshFields();
+    fieldArray.forEach(bindField);
 
     // Prevent losing focus when clicking container background
     document.querySelector('.document-container').addEventListener('mousedown', function(e) {
@@ -704,17 +792,57 @@ $elements
       }
     });
 
-    // Click on editable field to focus
-    editableFields.forEach(function(el) {
-      el.addEventListener('mousedown', function(e) {
-        e.stopPropagation();
+    // Apply an incremental result (FormHtmlGenerator.generateUpdateScript)
+    function applyLayoutUpdate(update) {
+      var container = document.querySelector('.document-container');
+      // Look every node up by its previous index before any is re-keyed
+      var nodes = {};
+      container.querySelectorAll('.form-element').forEach(function(el) {
+        nodes[el.dataset.detection] = el;
+      });
+      update.removed.forEach(function(index) {
+        if (nodes[index]) {
+          nodes[index].remove();
+        }
       });
 
-      el.addEventListener('click', function(e) {
-        e.stopPropagation();
-        this.focus();
+      var ordered = [];
+      update.elements.forEach(function(item) {
+        var el = item.previous >= 0 ? nodes[item.previous] : null;
+        if (item.html !== undefined) {
+          var holder = document.createElement('div');
+          holder.innerHTML = item.html.trim();
+          var fresh = holder.firstElementChild;
+          if (el) {
+            if (el.classList.contains('editable-field') && fresh.classList.contains('editable-field') &&
+                el.textContent.trim().length > 0) {
+              fresh.textContent = el.textContent;
+              fresh.classList.add('has-content');
+            }
+            el.remove();
+          }
+          if (fresh.classList.contains('editable-field')) {
+            bindField(fresh);
+          }
+          el = fresh;
+        } else if (el && item.style !== undefined) {
+          el.style.cssText = item.style + ' font-size: ' + el.style.fontSize + ';';
+        }
+        if (el) {
+          el.dataset.detection = item.detection;
+          ordered.push(el);
+        }
       });
-    });
+
+      // Reading order of the new result
+      ordered.forEach(function(el, index) {
+        el.dataset.index = index;
+        container.appendChild(el);
+      });
+      container.dataset.width = update.width;
+      container.dataset.height = update.height;
+      refreshFields();
+    }
 
     // Get all form data as JSON
     function getFormData() {
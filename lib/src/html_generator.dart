@@ -57,12 +57,18 @@ class HtmlGenerator {
   };
 
   /// Generate HTML from detection result
-  static String generate(DetectionResult result, {String? title}) {
+  ///
+  /// Set [keepOrder] when the detections are already in reading order
+  /// (`PostprocessOptions.readingOrder`), which is column-aware; otherwise
+  /// they are sorted by rows here.
+  static String generate(DetectionResult result,
+      {String? title, bool keepOrder = false}) {
     if (!result.isSuccess || result.detections.isEmpty) {
       return _generateEmptyHtml(title);
     }
 
-    final sortedDetections = _sortByReadingOrder(result.detections);
+    final sortedDetections =
+        keepOrder ? result.detections : _sortByReadingOrder(result.detections);
     final elements = _generateElements(sortedDetections, result);
     final css = _generateCss();
 
@@ -85,12 +91,13 @@ $elements
   }
 
   /// Generate only the body content (without full HTML structure)
-  static String generateBody(DetectionResult result) {
+  static String generateBody(DetectionResult result, {bool keepOrder = false}) {
     if (!result.isSuccess || result.detections.isEmpty) {
       return '<article class="document-container"></article>';
     }
 
-    final sortedDetections = _sortByReadingOrder(result.detections);
+    final sortedDetections =
+        keepOrder ? result.detections : _sortByReadingOrder(result.detections);
     final elements = _generateElements(sortedDetections, result);
 
     return '''<article class="document-container" data-width="${result.imageWidth}" data-height="${result.imageHeight}">
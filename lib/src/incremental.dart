@@ -0,0 +1,191 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:math';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../flutter_doclayout_kit_bindings_generated.dart';
+import 'models.dart';
+import 'native_async.dart';
+import 'native_library.dart';
+
+/// Changed area of a page in original image pixels
+class LayoutRegion {
+  final int x;
+  final int y;
+  final int width;
+  final int height;
+
+  const LayoutRegion(this.x, this.y, this.width, this.height);
+
+  /// Region covering [box], e.g. the field the user re-captured
+  factory LayoutRegion.fromBox(DetectionBox box) {
+    final x = box.x1.floor();
+    final y = box.y1.floor();
+    return LayoutRegion(x, y, box.x2.ceil() - x, box.y2.ceil() - y);
+  }
+
+  bool get isEmpty => width <= 0 || height <= 0;
+
+  @override
+  String toString() => 'LayoutRegion($x, $y, ${width}x$height)';
+}
+
+/// Pure geometric change of a page: a 2x3 affine matrix `[a b tx; c d ty]`
+/// from the previous result's pixels into a [width] x [height] image
+class ResultTransform {
+  final double a, b, tx, c, d, ty;
+  final int width;
+  final int height;
+
+  const ResultTransform(
+      this.a, this.b, this.tx, this.c, this.d, this.ty, this.width, this.height);
+
+  /// Quarter turn clockwise of a [width] x [height] page
+  factory ResultTransform.rotate90(int width, int height) =>
+      ResultTransform(0, -1, height.toDouble(), 1, 0, 0, height, width);
+
+  /// Half turn of a [width] x [height] page
+  factory ResultTransform.rotate180(int width, int height) => ResultTransform(
+      -1, 0, width.toDouble(), 0, -1, height.toDouble(), width, height);
+
+  /// Quarter turn counter-clockwise of a [width] x [height] page
+  factory ResultTransform.rotate270(int width, int height) =>
+      ResultTransform(0, 1, 0, -1, 0, width.toDouble(), height, width);
+
+  /// Mirror a [width] x [height] page left to right
+  factory ResultTransform.flipHorizontal(int width, int height) =>
+      ResultTransform(-1, 0, width.toDouble(), 0, 1, 0, width, height);
+
+  /// Resize a [width] x [height] page by [sx] / [sy] (default [sx])
+  factory ResultTransform.scale(int width, int height, double sx, [double? sy]) {
+    final fy = sy ?? sx;
+    return ResultTransform(
+        sx, 0, 0, 0, fy, 0, max(1, (width * sx).round()), max(1, (height * fy).round()));
+  }
+}
+
+/// Copy [previous]'s boxes into a native struct, the rows are allocated
+/// with [allocator]
+void _writePrevious(
+    DocLayoutPreviousResult native, DetectionResult previous, Allocator allocator) {
+  final count = previous.detections.length;
+  final rows = count == 0 ? nullptr : allocator<Float>(count * 6);
+  for (var i = 0; i < count; i++) {
+    final box = previous.detections[i];
+    rows[i * 6] = box.x1;
+    rows[i * 6 + 1] = box.y1;
+    rows[i * 6 + 2] = box.x2;
+    rows[i * 6 + 3] = box.y2;
+    rows[i * 6 + 4] = box.score;
+    rows[i * 6 + 5] = box.classId.toDouble();
+  }
+  native
+    ..boxes = rows
+    ..count = count
+    ..image_width = previous.imageWidth
+    ..image_height = previous.imageHeight;
+}
+
+void _writeRegion(DocLayoutRegion native, LayoutRegion? region) {
+  native
+    ..x = region?.x ?? 0
+    ..y = region?.y ?? 0
+    ..width = region?.width ?? 0
+    ..height = region?.height ?? 0;
+}
+
+DetectionResult _takeResult(Pointer<Char> resultPtr) {
+  try {
+    return DetectionResult.fromJson(
+        jsonDecode(resultPtr.cast<Utf8>().toDartString()));
+  } finally {
+    docLayoutBindings.freeString(resultPtr);
+  }
+}
+
+/// Re-detect [region] of [encodedImage] against [previous] on a detector
+/// handle (nullptr = default model)
+DetectionResult detectRegionOnHandle(
+  Pointer<Void> handle,
+  Uint8List encodedImage,
+  double confThreshold,
+  DetectionResult previous,
+  LayoutRegion? region,
+) {
+  return using((arena) {
+    final dataPtr = arena<Uint8>(encodedImage.isEmpty ? 1 : encodedImage.length);
+    dataPtr.asTypedList(encodedImage.length).setAll(0, encodedImage);
+    final previousPtr = arena<DocLayoutPreviousResult>();
+    _writePrevious(previousPtr.ref, previous, arena);
+    final regionPtr = arena<DocLayoutRegion>();
+    _writeRegion(regionPtr.ref, region);
+    return _takeResult(docLayoutBindings.detectRegion(
+        handle, dataPtr, encodedImage.length, confThreshold, previousPtr, regionPtr));
+  });
+}
+
+/// [detectRegionOnHandle] on the native worker; the previous boxes are
+/// copied natively at submission
+Future<DetectionResult> submitRegionOnHandle(
+  Pointer<Void> handle,
+  Uint8List encodedImage,
+  double confThreshold,
+  DetectionResult previous,
+  LayoutRegion? region, {
+  Duration? deadline,
+  int lane = 0,
+  DetectionCancelToken? cancelToken,
+}) {
+  final dataPtr = calloc<Uint8>(encodedImage.isEmpty ? 1 : encodedImage.length);
+  dataPtr.asTypedList(encodedImage.length).setAll(0, encodedImage);
+
+  return NativeAsyncDispatcher.instance.submit(dataPtr, (requestId, callback) {
+    return using((arena) {
+      final previousPtr = arena<DocLayoutPreviousResult>();
+      _writePrevious(previousPtr.ref, previous, arena);
+      final regionPtr = arena<DocLayoutRegion>();
+      _writeRegion(regionPtr.ref, region);
+      final options = arena<DocLayoutRequestOptions>();
+      options.ref
+        ..deadline_ms = deadline == null ? 0 : max(1, deadline.inMilliseconds)
+        ..lane = lane;
+      return docLayoutBindings.detectRegionAsync(
+            handle,
+            dataPtr,
+            encodedImage.length,
+            confThreshold,
+            previousPtr,
+            regionPtr,
+            options,
+            requestId,
+            callback,
+          ) !=
+          0;
+    });
+  }, cancelToken: cancelToken);
+}
+
+/// Remap [previous] through [transform] without inference
+DetectionResult transformResultOnHandle(
+  Pointer<Void> handle,
+  DetectionResult previous,
+  ResultTransform transform,
+) {
+  return using((arena) {
+    final previousPtr = arena<DocLayoutPreviousResult>();
+    _writePrevious(previousPtr.ref, previous, arena);
+    final matrix = arena<Float>(6);
+    matrix.asTypedList(6).setAll(0, [
+      transform.a,
+      transform.b,
+      transform.tx,
+      transform.c,
+      transform.d,
+      transform.ty,
+    ]);
+    return _takeResult(docLayoutBindings.transformResult(
+        handle, previousPtr, matrix, transform.width, transform.height));
+  });
+}
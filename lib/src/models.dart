@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 /// 23 document element classes
 enum DocLayoutClass {
   paragraphTitle(0, 'paragraph_title'),
@@ -38,6 +40,25 @@ enum DocLayoutClass {
   }
 }
 
+/// How a box of an incremental result relates to the previous result
+enum DetectionDiff {
+  /// Outside the changed region, kept as it was
+  unchanged,
+
+  /// Found in the changed region, no previous box matches it
+  added,
+
+  /// Re-detected in the changed region, replaces [DetectionBox.previousIndex]
+  updated,
+
+  /// Previous box remapped by a rotation / scale
+  moved;
+
+  static DetectionDiff? fromName(String? name) {
+    return DetectionDiff.values.where((e) => e.name == name).firstOrNull;
+  }
+}
+
 /// Detection bounding box
 class DetectionBox {
   /// Top-left x coordinate (in original image space)
@@ -61,6 +82,13 @@ class DetectionBox {
   /// Class name
   final String className;
 
+  /// Relation to the previous result, null outside incremental results
+  final DetectionDiff? diff;
+
+  /// Index of the box in the previous result this one continues, null for
+  /// added boxes and outside incremental results
+  final int? previousIndex;
+
   DetectionBox({
     required this.x1,
     required this.y1,
@@ -69,6 +97,8 @@ class DetectionBox {
     required this.score,
     required this.classId,
     required this.className,
+    this.diff,
+    this.previousIndex,
   });
 
   /// Get the layout class enum
@@ -90,6 +120,7 @@ class DetectionBox {
   double get area => width * height;
 
   factory DetectionBox.fromJson(Map<String, dynamic> json) {
+    final previousIndex = json['previous_index'] as int?;
     return DetectionBox(
       x1: (json['x1'] as num).toDouble(),
       y1: (json['y1'] as num).toDouble(),
@@ -98,6 +129,8 @@ class DetectionBox {
       score: (json['score'] as num).toDouble(),
       classId: json['class_id'] as int,
       className: json['class_name'] as String,
+      diff: DetectionDiff.fromName(json['diff'] as String?),
+      previousIndex: previousIndex != null && previousIndex >= 0 ? previousIndex : null,
     );
   }
 
@@ -110,6 +143,8 @@ class DetectionBox {
       'score': score,
       'class_id': classId,
       'class_name': className,
+      if (diff != null) 'diff': diff!.name,
+      if (diff != null) 'previous_index': previousIndex ?? -1,
     };
   }
 
@@ -142,6 +177,13 @@ class DetectionResult {
   /// Error code (if any)
   final String? errorCode;
 
+  /// Incremental results: indices of previous boxes with no box any more
+  final List<int> removed;
+
+  /// Incremental results: area that was re-detected as `[x, y, width,
+  /// height]`, null for transforms and full results
+  final List<int>? region;
+
   DetectionResult({
     required this.detections,
     required this.count,
@@ -150,11 +192,16 @@ class DetectionResult {
     required this.imageHeight,
     this.error,
     this.errorCode,
+    this.removed = const [],
+    this.region,
   });
 
   /// Check if result has error
   bool get hasError => error != null;
 
+  /// Whether the detections carry [DetectionBox.diff] markers
+  bool get isIncremental => detections.any((d) => d.diff != null) || removed.isNotEmpty;
+
   /// Check if result is successful
   bool get isSuccess => error == null;
 
@@ -206,6 +253,8 @@ class DetectionResult {
       inferenceTimeMs: json['inference_time_ms'] as int,
       imageWidth: json['image_width'] as int,
       imageHeight: json['image_height'] as int,
+      removed: (json['removed'] as List<dynamic>?)?.cast<int>() ?? const [],
+      region: (json['region'] as List<dynamic>?)?.cast<int>(),
     );
   }
 
@@ -223,9 +272,79 @@ class DetectionResult {
       'inference_time_ms': inferenceTimeMs,
       'image_width': imageWidth,
       'image_height': imageHeight,
+      if (isIncremental) 'removed': removed,
+      if (region != null) 'region': region,
     };
   }
 
+  /// Read the binary result layout written by the native *ToBuffer calls
+  ///
+  /// [data] starts with an 8-float header `[status, count, total_count,
+  /// inference_time_ms, image_width, image_height, reused, change]`
+  /// followed by `count` boxes of `[x1, y1, x2, y2, score, class_id]`.
+  factory DetectionResult.fromFloat32List(Float32List data) {
+    final status = data[0].toInt();
+    if (status < 0) {
+      final (message, code) = _binaryStatusErrors[status] ??
+          ('Detection failed', 'INFERENCE_FAILED');
+      return DetectionResult.error(message, code: code);
+    }
+
+    final count = data[1].toInt();
+    final detections = List<DetectionBox>.generate(count, (i) {
+      final offset = 8 + i * 6;
+      final classId = data[offset + 5].toInt();
+      return DetectionBox(
+        x1: data[offset],
+        y1: data[offset + 1],
+        x2: data[offset + 2],
+        y2: data[offset + 3],
+        score: data[offset + 4],
+        classId: classId,
+        className: DocLayoutClass.fromId(classId)?.name ?? 'unknown',
+      );
+    }, growable: false);
+
+    return DetectionResult(
+      detections: detections,
+      count: count,
+      inferenceTimeMs: data[3].toInt(),
+      imageWidth: data[4].toInt(),
+      imageHeight: data[5].toInt(),
+    );
+  }
+
+  /// DOCLAYOUT_ERR_* status codes and their JSON equivalents
+  static const Map<int, (String, String)> _binaryStatusErrors = {
+    -1: ('Model not initialized', 'MODEL_NOT_LOADED'),
+    -2: ('Could not load image', 'IMAGE_LOAD_FAILED'),
+    -3: ('Could not decode image', 'IMAGE_DECODE_FAILED'),
+    -4: ('Empty image buffer', 'IMAGE_DECODE_FAILED'),
+    -5: ('Invalid argument', 'INVALID_ARGUMENT'),
+    -6: ('Request cancelled', 'CANCELLED'),
+    -7: ('Deadline exceeded', 'DEADLINE_EXCEEDED'),
+    -8: ('Superseded by a newer request', 'SUPERSEDED'),
+    -9: ('Inference failed', 'INFERENCE_FAILED'),
+  };
+
+  /// Parse a batch response into one result per input page
+  ///
+  /// A batch-level error (e.g. model not initialized) is repeated for all
+  /// [expectedCount] pages.
+  static List<DetectionResult> listFromBatchJson(
+    Map<String, dynamic> json,
+    int expectedCount,
+  ) {
+    if (json.containsKey('error')) {
+      final error = DetectionResult.fromJson(json);
+      return List.filled(expectedCount, error);
+    }
+    final resultsJson = json['results'] as List<dynamic>;
+    return resultsJson
+        .map((r) => DetectionResult.fromJson(r as Map<String, dynamic>))
+        .toList();
+  }
+
   @override
   String toString() {
     if (hasError) {
@@ -234,3 +353,354 @@ class DetectionResult {
     return 'DetectionResult(count: $count, inferenceTime: ${inferenceTimeMs}ms, size: ${imageWidth}x$imageHeight)';
   }
 }
+
+/// Counters of the native result cache, see `DocLayoutKit.configureCache`
+class ResultCacheStats {
+  /// Requests answered from memory or disk
+  final int hits;
+
+  /// Requests that ran decode and inference
+  final int misses;
+
+  /// Hits that were loaded back from the disk directory
+  final int diskHits;
+
+  /// Entries dropped to stay within the memory bound
+  final int evictions;
+
+  /// Entries currently held in memory
+  final int entries;
+
+  /// Estimated memory held by the entries
+  final int bytes;
+
+  const ResultCacheStats({
+    required this.hits,
+    required this.misses,
+    required this.diskHits,
+    required this.evictions,
+    required this.entries,
+    required this.bytes,
+  });
+
+  /// Share of requests answered from the cache
+  double get hitRate => hits + misses == 0 ? 0.0 : hits / (hits + misses);
+
+  @override
+  String toString() =>
+      'ResultCacheStats(hits: $hits, misses: $misses, diskHits: $diskHits, '
+      'evictions: $evictions, entries: $entries, bytes: $bytes)';
+}
+
+/// Latency percentiles of one detection stage, in milliseconds
+class StageLatency {
+  /// Samples recorded since the last reset
+  final int count;
+
+  final double p50Ms;
+  final double p95Ms;
+  final double p99Ms;
+  final double meanMs;
+  final double maxMs;
+
+  const StageLatency({
+    required this.count,
+    required this.p50Ms,
+    required this.p95Ms,
+    required this.p99Ms,
+    required this.meanMs,
+    required this.maxMs,
+  });
+
+  factory StageLatency.fromJson(Map<String, dynamic> json) {
+    return StageLatency(
+      count: json['count'] as int? ?? 0,
+      p50Ms: (json['p50_ms'] as num?)?.toDouble() ?? 0.0,
+      p95Ms: (json['p95_ms'] as num?)?.toDouble() ?? 0.0,
+      p99Ms: (json['p99_ms'] as num?)?.toDouble() ?? 0.0,
+      meanMs: (json['mean_ms'] as num?)?.toDouble() ?? 0.0,
+      maxMs: (json['max_ms'] as num?)?.toDouble() ?? 0.0,
+    );
+  }
+
+  @override
+  String toString() => 'StageLatency(count: $count, p50: ${p50Ms}ms, '
+      'p95: ${p95Ms}ms, p99: ${p99Ms}ms)';
+}
+
+/// Per-stage latency stats, see `DocLayoutKit.stats`
+class LatencyStats {
+  /// Recent samples per stage the percentiles are computed over
+  final int window;
+
+  /// Stages by name: decode, page_crop, preprocess, run, parse, serialize, total
+  final Map<String, StageLatency> stages;
+
+  /// Resident memory of the process now, in bytes (0 if not reported)
+  final int currentMemoryBytes;
+
+  /// Highest resident memory of the process so far, in bytes
+  final int peakMemoryBytes;
+
+  const LatencyStats({
+    required this.window,
+    required this.stages,
+    this.currentMemoryBytes = 0,
+    this.peakMemoryBytes = 0,
+  });
+
+  factory LatencyStats.fromJson(Map<String, dynamic> json) {
+    final stagesJson = json['stages'] as Map<String, dynamic>? ?? const {};
+    final memory = json['memory'] as Map<String, dynamic>? ?? const {};
+    return LatencyStats(
+      window: json['window'] as int? ?? 0,
+      stages: stagesJson.map((name, value) =>
+          MapEntry(name, StageLatency.fromJson(value as Map<String, dynamic>))),
+      currentMemoryBytes: memory['current_bytes'] as int? ?? 0,
+      peakMemoryBytes: memory['peak_bytes'] as int? ?? 0,
+    );
+  }
+
+  StageLatency? get decode => stages['decode'];
+  StageLatency? get pageCrop => stages['page_crop'];
+  StageLatency? get preprocess => stages['preprocess'];
+  StageLatency? get run => stages['run'];
+  StageLatency? get parse => stages['parse'];
+  StageLatency? get serialize => stages['serialize'];
+  StageLatency? get total => stages['total'];
+
+  @override
+  String toString() => 'LatencyStats($stages, '
+      'memory: ${currentMemoryBytes >> 20} MiB, peak: ${peakMemoryBytes >> 20} MiB)';
+}
+
+/// Name, shape and ONNX element type of one model input or output
+class ModelTensorInfo {
+  final String name;
+
+  /// Dimensions, -1 where the model leaves them dynamic
+  final List<int> shape;
+
+  /// ONNX TensorProto element type (1 = float, 7 = int64, ...)
+  final int elementType;
+
+  const ModelTensorInfo({
+    required this.name,
+    required this.shape,
+    required this.elementType,
+  });
+
+  factory ModelTensorInfo.fromJson(Map<String, dynamic> json) {
+    return ModelTensorInfo(
+      name: json['name'] as String,
+      shape: (json['shape'] as List<dynamic>).cast<int>(),
+      elementType: json['type'] as int? ?? 0,
+    );
+  }
+
+  @override
+  String toString() => '$name$shape';
+}
+
+/// What the native side read from the model at load time, see
+/// `DocLayoutKit.modelInfo`
+class ModelInfo {
+  /// 'M' (image + scale_factor) or 'L' (im_shape + image + scale_factor)
+  final String variant;
+
+  /// Static model input size, 0 when the model's size is dynamic
+  final int inputWidth;
+  final int inputHeight;
+
+  /// Whether the model accepts several pages per run
+  final bool batchCapable;
+
+  final List<ModelTensorInfo> inputs;
+  final List<ModelTensorInfo> outputs;
+
+  /// Class names by class ID
+  final List<String> classNames;
+
+  /// True if [classNames] came from the model's metadata rather than the
+  /// built-in 23-class table
+  final bool classNamesFromMetadata;
+
+  final String producer;
+  final int version;
+
+  /// 'fp32', 'fp16' or 'int8'
+  final String precision;
+
+  /// Whether the model takes and returns float16 tensors
+  final bool halfIo;
+
+  /// File actually loaded: the given path or one of its variants
+  final String modelFile;
+
+  /// How the session was created: 'mmap', 'file' or 'ort_cache' (the
+  /// cached optimized graph, see `DetectorOptions.optimizedModelCacheDir`)
+  final String loadMethod;
+
+  /// Session creation time in milliseconds
+  final double loadMs;
+
+  const ModelInfo({
+    required this.variant,
+    required this.inputWidth,
+    required this.inputHeight,
+    required this.batchCapable,
+    required this.inputs,
+    required this.outputs,
+    required this.classNames,
+    required this.classNamesFromMetadata,
+    required this.producer,
+    required this.version,
+    this.precision = 'fp32',
+    this.halfIo = false,
+    this.modelFile = '',
+    this.loadMethod = '',
+    this.loadMs = 0.0,
+  });
+
+  factory ModelInfo.fromJson(Map<String, dynamic> json) {
+    if (json.containsKey('error')) {
+      throw StateError(json['error'] as String);
+    }
+    List<ModelTensorInfo> tensors(String key) => (json[key] as List<dynamic>)
+        .map((t) => ModelTensorInfo.fromJson(t as Map<String, dynamic>))
+        .toList();
+    return ModelInfo(
+      variant: json['variant'] as String,
+      inputWidth: json['input_width'] as int? ?? 0,
+      inputHeight: json['input_height'] as int? ?? 0,
+      batchCapable: json['batch_capable'] as bool? ?? false,
+      inputs: tensors('inputs'),
+      outputs: tensors('outputs'),
+      classNames: (json['classes'] as List<dynamic>).cast<String>(),
+      classNamesFromMetadata: json['classes_from_metadata'] as bool? ?? false,
+      producer: json['producer'] as String? ?? '',
+      version: json['version'] as int? ?? 0,
+      precision: json['precision'] as String? ?? 'fp32',
+      halfIo: json['half_io'] as bool? ?? false,
+      modelFile: json['model_file'] as String? ?? '',
+      loadMethod: json['load_method'] as String? ?? '',
+      loadMs: (json['load_ms'] as num?)?.toDouble() ?? 0.0,
+    );
+  }
+
+  /// Class name of [classId], 'unknown' if the model has no such class
+  String className(int classId) =>
+      classId >= 0 && classId < classNames.length ? classNames[classId] : 'unknown';
+
+  @override
+  String toString() => 'ModelInfo($variant, ${inputWidth}x$inputHeight, '
+      '${classNames.length} classes, inputs: $inputs, outputs: $outputs)';
+}
+
+/// CPU features probed for model variant selection
+class DeviceCapabilities {
+  final bool arm64;
+
+  /// ARMv8.2 dot-product instructions, INT8 models run about twice as fast
+  final bool armDotProd;
+
+  /// ARMv8.2 half-precision arithmetic
+  final bool armFp16;
+
+  /// ARMv8.6 int8 matrix multiply
+  final bool armI8mm;
+
+  final bool x86Avx2;
+
+  /// AVX512-VNNI or AVX-VNNI
+  final bool x86Vnni;
+
+  final bool x86F16c;
+
+  /// Precisions `ModelPrecision.auto` tries, fastest first ('int8', 'fp16',
+  /// 'fp32')
+  final List<String> preferred;
+
+  /// The same when NNAPI or Core ML is requested
+  final List<String> preferredWithAccelerator;
+
+  const DeviceCapabilities({
+    required this.arm64,
+    required this.armDotProd,
+    required this.armFp16,
+    required this.armI8mm,
+    required this.x86Avx2,
+    required this.x86Vnni,
+    required this.x86F16c,
+    required this.preferred,
+    required this.preferredWithAccelerator,
+  });
+
+  factory DeviceCapabilities.fromJson(Map<String, dynamic> json) {
+    final cpu = json['cpu'] as Map<String, dynamic>? ?? const {};
+    bool flag(String key) => cpu[key] as bool? ?? false;
+    List<String> names(String key) =>
+        (json[key] as List<dynamic>? ?? const []).cast<String>();
+    return DeviceCapabilities(
+      arm64: flag('arm64'),
+      armDotProd: flag('arm_dotprod'),
+      armFp16: flag('arm_fp16'),
+      armI8mm: flag('arm_i8mm'),
+      x86Avx2: flag('x86_avx2'),
+      x86Vnni: flag('x86_vnni'),
+      x86F16c: flag('x86_f16c'),
+      preferred: names('preferred'),
+      preferredWithAccelerator: names('preferred_with_accelerator'),
+    );
+  }
+
+  @override
+  String toString() =>
+      'DeviceCapabilities(arm64: $arm64, dotprod: $armDotProd, fp16: $armFp16, '
+      'avx2: $x86Avx2, vnni: $x86Vnni, preferred: $preferred)';
+}
+
+/// Timings of a model warm-up, see `DocLayoutKit.warmup`
+class WarmupResult {
+  /// Dummy inferences run, across all run contexts
+  final int runs;
+
+  /// The first (cold) run, includes kernel selection and arena growth
+  final double firstMs;
+
+  final double meanMs;
+
+  /// The last run, close to the steady-state latency
+  final double lastMs;
+
+  const WarmupResult({
+    required this.runs,
+    required this.firstMs,
+    required this.meanMs,
+    required this.lastMs,
+  });
+
+  factory WarmupResult.fromJson(Map<String, dynamic> json) {
+    if (json.containsKey('error')) {
+      throw StateError(json['error'] as String);
+    }
+    double ms(String key) => (json[key] as num?)?.toDouble() ?? 0.0;
+    return WarmupResult(
+      runs: json['runs'] as int? ?? 0,
+      firstMs: ms('first_ms'),
+      meanMs: ms('mean_ms'),
+      lastMs: ms('last_ms'),
+    );
+  }
+
+  Map<String, dynamic> toJson() => {
+        'runs': runs,
+        'first_ms': firstMs,
+        'mean_ms': meanMs,
+        'last_ms': lastMs,
+      };
+
+  @override
+  String toString() => 'WarmupResult($runs runs, first: ${firstMs.toStringAsFixed(1)} ms, '
+      'last: ${lastMs.toStringAsFixed(1)} ms)';
+}
@@ -0,0 +1,162 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:math';
+
+import 'package:ffi/ffi.dart';
+
+import '../flutter_doclayout_kit_bindings_generated.dart';
+import 'models.dart';
+import 'native_library.dart';
+
+/// Starts a native async request, returns false if it was rejected
+typedef NativeAsyncStart = bool Function(
+    int requestId, DocLayoutResultCallback callback);
+
+class _PendingRequest {
+  final Completer<DetectionResult> completer;
+  final Pointer<Uint8> buffer;
+  final DetectionCancelToken? cancelToken;
+
+  _PendingRequest(this.completer, this.buffer, this.cancelToken);
+}
+
+/// Cancels async detections it was passed to
+///
+/// A cancelled request that had not started is skipped; one that is running
+/// has its inference terminated. Its future still completes, with a
+/// `CANCELLED` error, once the native side has let go of the input. One
+/// token may be shared by several requests, e.g. everything started for a
+/// page, and cancelled when the user leaves it.
+class DetectionCancelToken {
+  final Set<int> _requestIds = {};
+  bool _cancelled = false;
+
+  /// Whether [cancel] has been called
+  bool get isCancelled => _cancelled;
+
+  /// Cancel every request started with this token, and any started later
+  void cancel() {
+    if (_cancelled) return;
+    _cancelled = true;
+    for (final requestId in _requestIds) {
+      docLayoutBindings.cancelRequest(requestId);
+    }
+  }
+
+  void _attach(int requestId) {
+    _requestIds.add(requestId);
+    if (_cancelled) {
+      docLayoutBindings.cancelRequest(requestId);
+    }
+  }
+
+  void _detach(int requestId) => _requestIds.remove(requestId);
+}
+
+/// Routes completions of the native *Async functions back to Dart futures
+///
+/// The native worker calls back from its own thread; a
+/// [NativeCallable.listener] forwards each call to this isolate's event loop.
+/// There is one dispatcher per isolate.
+class NativeAsyncDispatcher {
+  static NativeAsyncDispatcher? _instance;
+
+  /// Dispatcher for the current isolate
+  static NativeAsyncDispatcher get instance =>
+      _instance ??= NativeAsyncDispatcher._();
+
+  late final NativeCallable<DocLayoutResultCallbackFunction> _callable;
+  final Map<int, _PendingRequest> _pending = {};
+
+  NativeAsyncDispatcher._() {
+    _callable =
+        NativeCallable<DocLayoutResultCallbackFunction>.listener(_onResult);
+    // Only keep the isolate alive while results are outstanding
+    _callable.keepIsolateAlive = false;
+  }
+
+  /// Number of requests still waiting for a result
+  int get pendingCount => _pending.length;
+
+  /// Submit a request through [start]
+  ///
+  /// [buffer] is the native input memory; it is freed once the result
+  /// arrives (or immediately if the request is rejected). Request ids come
+  /// from the native side, so they are unique across isolates and
+  /// [cancelToken] cancels only this isolate's requests.
+  Future<DetectionResult> submit(Pointer<Uint8> buffer, NativeAsyncStart start,
+      {DetectionCancelToken? cancelToken}) {
+    final requestId = docLayoutBindings.nextRequestId();
+    final completer = Completer<DetectionResult>();
+    _pending[requestId] = _PendingRequest(completer, buffer, cancelToken);
+    _callable.keepIsolateAlive = true;
+
+    if (!start(requestId, _callable.nativeFunction)) {
+      _complete(requestId, DetectionResult.error('Request rejected', code: 'REQUEST_REJECTED'));
+    } else {
+      cancelToken?._attach(requestId);
+    }
+    return completer.future;
+  }
+
+  /// Submit encoded image bytes to [handle] (nullptr = default model)
+  ///
+  /// [deadline] counts from now and also stops a running inference; the
+  /// result is then a `DEADLINE_EXCEEDED` error. Requests with the same
+  /// non-zero [lane] replace each other: submitting one stops the older
+  /// ones, which complete with a `SUPERSEDED` error, so only the newest
+  /// frame is worked on.
+  Future<DetectionResult> submitEncoded(
+    Pointer<Void> handle,
+    Pointer<Uint8> data,
+    int length,
+    double confThreshold, {
+    Duration? deadline,
+    int lane = 0,
+    DetectionCancelToken? cancelToken,
+  }) {
+    return submit(data, (requestId, callback) {
+      return using((arena) {
+        final options = arena<DocLayoutRequestOptions>();
+        options.ref
+          ..deadline_ms = deadline == null ? 0 : max(1, deadline.inMilliseconds)
+          ..lane = lane;
+        return docLayoutBindings.detectAsyncWithOptions(
+              handle,
+              data,
+              length,
+              confThreshold,
+              options,
+              requestId,
+              callback,
+            ) !=
+            0;
+      });
+    }, cancelToken: cancelToken);
+  }
+
+  void _onResult(int requestId, Pointer<Char> resultJson) {
+    DetectionResult result;
+    try {
+      result = DetectionResult.fromJson(
+          jsonDecode(resultJson.cast<Utf8>().toDartString()));
+    } catch (e) {
+      result = DetectionResult.error('Detection failed: $e');
+    } finally {
+      docLayoutBindings.freeString(resultJson);
+    }
+    _complete(requestId, result);
+  }
+
+  void _complete(int requestId, DetectionResult result) {
+    final request = _pending.remove(requestId);
+    if (request == null) return;
+    request.cancelToken?._detach(requestId);
+    calloc.free(request.buffer);
+    request.completer.complete(result);
+    if (_pending.isEmpty) {
+      _callable.keepIsolateAlive = false;
+    }
+  }
+}
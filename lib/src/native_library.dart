@@ -0,0 +1,113 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../flutter_doclayout_kit_bindings_generated.dart';
+import 'doc_layout_detector.dart';
+import 'models.dart';
+
+/// Load native library based on platform
+DynamicLibrary loadDocLayoutLibrary() {
+  if (Platform.isIOS || Platform.isMacOS) {
+    // iOS/macOS: Static library linked into main binary
+    return DynamicLibrary.process();
+  }
+  if (Platform.isAndroid || Platform.isLinux) {
+    return DynamicLibrary.open('libdoc_layout_kit.so');
+  }
+  if (Platform.isWindows) {
+    return DynamicLibrary.open('doc_layout_kit.dll');
+  }
+
+  throw UnsupportedError('Unsupported platform: ${Platform.operatingSystem}');
+}
+
+DocLayoutKitBindings? _bindings;
+
+/// Native bindings for the current isolate (lazy initialization)
+DocLayoutKitBindings get docLayoutBindings {
+  _bindings ??= DocLayoutKitBindings(loadDocLayoutLibrary());
+  return _bindings!;
+}
+
+/// Convert and free the trace path returned by the native endProfiling,
+/// null if profiling was not enabled
+String? readProfilePath(Pointer<Char> pathPtr) {
+  try {
+    final path = pathPtr.cast<Utf8>().toDartString();
+    return path.isEmpty ? null : path;
+  } finally {
+    docLayoutBindings.freeString(pathPtr);
+  }
+}
+
+/// Read the model descriptor of a detector handle (nullptr = default model)
+ModelInfo readModelInfo(Pointer<Void> handle) {
+  final ptr = docLayoutBindings.getModelInfo(handle);
+  try {
+    final jsonStr = ptr.cast<Utf8>().toDartString();
+    return ModelInfo.fromJson(jsonDecode(jsonStr) as Map<String, dynamic>);
+  } finally {
+    docLayoutBindings.freeString(ptr);
+  }
+}
+
+/// Warm up a detector handle (nullptr = default model)
+WarmupResult warmupHandle(Pointer<Void> handle, int iterations) {
+  final ptr = handle == nullptr
+      ? docLayoutBindings.warmupModel(iterations)
+      : docLayoutBindings.warmupDetector(handle, iterations);
+  try {
+    final jsonStr = ptr.cast<Utf8>().toDartString();
+    return WarmupResult.fromJson(jsonDecode(jsonStr) as Map<String, dynamic>);
+  } finally {
+    docLayoutBindings.freeString(ptr);
+  }
+}
+
+/// Read the CPU features used for model variant selection
+DeviceCapabilities readDeviceCapabilities() {
+  final ptr = docLayoutBindings.getDeviceCapabilities();
+  try {
+    final jsonStr = ptr.cast<Utf8>().toDartString();
+    return DeviceCapabilities.fromJson(jsonDecode(jsonStr) as Map<String, dynamic>);
+  } finally {
+    docLayoutBindings.freeString(ptr);
+  }
+}
+
+/// Run tiled detection on a detector handle (nullptr = default model)
+DetectionResult detectTiledOnHandle(
+  Pointer<Void> handle,
+  Uint8List encodedImage,
+  double confThreshold,
+  TileOptions tiles,
+) {
+  return using((arena) {
+    final dataPtr = arena<Uint8>(encodedImage.isEmpty ? 1 : encodedImage.length);
+    dataPtr.asTypedList(encodedImage.length).setAll(0, encodedImage);
+    final optionsPtr = arena<DocLayoutTileOptions>();
+    tiles.writeTo(optionsPtr.ref);
+
+    final resultPtr = docLayoutBindings.detectTiledWithHandle(
+        handle, dataPtr, encodedImage.length, confThreshold, optionsPtr);
+    try {
+      final jsonStr = resultPtr.cast<Utf8>().toDartString();
+      return DetectionResult.fromJson(jsonDecode(jsonStr));
+    } finally {
+      docLayoutBindings.freeString(resultPtr);
+    }
+  });
+}
+
+/// Apply postprocess options to a detector handle (nullptr = default model)
+void writePostprocessOptions(Pointer<Void> handle, PostprocessOptions options) {
+  using((arena) {
+    final optionsPtr = arena<DocLayoutPostprocessOptions>();
+    options.writeTo(optionsPtr.ref, arena);
+    docLayoutBindings.setPostprocessOptions(handle, optionsPtr);
+  });
+}
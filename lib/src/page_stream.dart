@@ -0,0 +1,176 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../flutter_doclayout_kit_bindings_generated.dart';
+import 'models.dart';
+import 'native_library.dart';
+
+/// Default depth of the queues between pipeline stages
+const int defaultPageQueueDepth = 2;
+
+/// Stream [pages] through the native decode -> preprocess -> inference ->
+/// serialize pipeline of [handle] (nullptr = default model)
+///
+/// Results are emitted in page order. Pages are pushed only while the
+/// pipeline has room, so pushing never blocks this isolate and [pages] is
+/// consumed lazily.
+Stream<DetectionResult> runPageStream(
+  Pointer<Void> handle,
+  Iterable<Uint8List> pages, {
+  required double confThreshold,
+  int queueDepth = defaultPageQueueDepth,
+}) {
+  final controller = StreamController<DetectionResult>();
+  final iterator = pages.iterator;
+  final depth = queueDepth > 0 ? queueDepth : defaultPageQueueDepth;
+  // Four queues of `depth` between the stages, never more than that in flight
+  final maxInFlight = depth * 4;
+
+  late final NativeCallable<DocLayoutPageCallbackFunction> callable;
+  Pointer<Void> stream = nullptr;
+  var pushed = 0;
+  var received = 0;
+  var exhausted = false;
+
+  void finish() {
+    if (stream != nullptr) {
+      docLayoutBindings.closePageStream(stream);
+      stream = nullptr;
+    }
+    callable.close();
+    controller.close();
+  }
+
+  void pushMore() {
+    while (!exhausted && pushed - received < maxInFlight) {
+      if (!iterator.moveNext()) {
+        exhausted = true;
+        break;
+      }
+      final bytes = iterator.current;
+      final dataPtr = calloc<Uint8>(bytes.isEmpty ? 1 : bytes.length);
+      try {
+        dataPtr.asTypedList(bytes.length).setAll(0, bytes);
+        if (docLayoutBindings.pushPageEncoded(stream, dataPtr, bytes.length) <
+            0) {
+          exhausted = true;
+          break;
+        }
+        pushed++;
+      } finally {
+        calloc.free(dataPtr);
+      }
+    }
+    if (exhausted && received == pushed) {
+      finish();
+    }
+  }
+
+  callable = NativeCallable<DocLayoutPageCallbackFunction>.listener(
+      (int streamId, int pageIndex, Pointer<Char> resultJson) {
+    DetectionResult result;
+    try {
+      result = DetectionResult.fromJson(
+          jsonDecode(resultJson.cast<Utf8>().toDartString()));
+    } catch (e) {
+      result = DetectionResult.error('Detection failed: $e');
+    } finally {
+      docLayoutBindings.freeString(resultJson);
+    }
+    received++;
+    controller.add(result);
+    pushMore();
+  });
+
+  stream = docLayoutBindings.openPageStream(
+      handle, confThreshold, depth, 0, callable.nativeFunction);
+  if (stream == nullptr) {
+    callable.close();
+    controller.addError(StateError('Model not initialized'));
+    controller.close();
+    return controller.stream;
+  }
+
+  pushMore();
+  return controller.stream;
+}
+
+/// Stream the pages of the multi-page image file at [path] through the
+/// native page pipeline of [handle] (nullptr = default model)
+///
+/// Pages are read and decoded natively, one at a time, so nothing is
+/// rasterized or copied in Dart. Emits one result per page from
+/// [firstPage] on, in page order; an unreadable page yields an error
+/// result in its place. A file that cannot be opened (or a PDF) is reported
+/// as a [StateError] on the stream. Cancelling the subscription stops the
+/// reader after the pages already queued.
+Stream<DetectionResult> runDocumentStream(
+  Pointer<Void> handle,
+  String path, {
+  required double confThreshold,
+  int firstPage = 0,
+  int? pageCount,
+  int queueDepth = defaultPageQueueDepth,
+}) {
+  late final StreamController<DetectionResult> controller;
+  late final NativeCallable<DocLayoutPageCallbackFunction> callable;
+  Pointer<Void> document = nullptr;
+
+  callable = NativeCallable<DocLayoutPageCallbackFunction>.listener(
+      (int documentId, int pageIndex, Pointer<Char> resultJson) {
+    final String jsonStr;
+    try {
+      jsonStr = resultJson.cast<Utf8>().toDartString();
+    } finally {
+      docLayoutBindings.freeString(resultJson);
+    }
+
+    if (pageIndex >= 0) {
+      DetectionResult result;
+      try {
+        result = DetectionResult.fromJson(jsonDecode(jsonStr));
+      } catch (e) {
+        result = DetectionResult.error('Detection failed: $e');
+      }
+      if (!controller.isClosed) controller.add(result);
+      return;
+    }
+
+    // Final call: the reader is done, closing does not block
+    docLayoutBindings.closeDocument(document);
+    document = nullptr;
+    callable.close();
+    final summary = jsonDecode(jsonStr) as Map<String, dynamic>;
+    if (summary.containsKey('error') && !controller.isClosed) {
+      controller.addError(StateError(summary['error'] as String));
+    }
+    controller.close();
+  });
+
+  controller = StreamController<DetectionResult>(onCancel: () {
+    if (document != nullptr) {
+      docLayoutBindings.cancelDocument(document);
+    }
+  });
+
+  document = using((arena) {
+    final pathPtr = path.toNativeUtf8(allocator: arena).cast<Char>();
+    final optionsPtr = arena<DocLayoutDocumentOptions>();
+    optionsPtr.ref
+      ..first_page = firstPage
+      ..page_count = pageCount ?? 0
+      ..queue_depth = queueDepth;
+    return docLayoutBindings.detectDocument(
+        handle, pathPtr, confThreshold, optionsPtr, 0, callable.nativeFunction);
+  });
+  if (document == nullptr) {
+    callable.close();
+    controller.addError(StateError('Model not initialized'));
+    controller.close();
+  }
+  return controller.stream;
+}
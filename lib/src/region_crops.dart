@@ -0,0 +1,178 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../flutter_doclayout_kit_bindings_generated.dart';
+import 'models.dart';
+import 'native_library.dart';
+
+/// How `detectWithCrops` hands out crops
+enum CropEncoding {
+  /// BGR pixels viewed in place in the native page, no copy
+  raw(0),
+
+  /// Lossless, for OCR
+  png(1),
+
+  /// Smaller, for export and thumbnails
+  jpeg(2);
+
+  final int value;
+
+  const CropEncoding(this.value);
+}
+
+/// Which detections `detectWithCrops` cuts out
+class CropOptions {
+  /// Classes to crop, empty = every detection
+  final Set<DocLayoutClass> classes;
+
+  /// Margin on each side as a fraction of the box size
+  final double padding;
+
+  final CropEncoding encoding;
+
+  /// JPEG quality 1-100, used with [CropEncoding.jpeg]
+  final int jpegQuality;
+
+  const CropOptions({
+    this.classes = const {},
+    this.padding = 0.0,
+    this.encoding = CropEncoding.raw,
+    this.jpegQuality = 90,
+  });
+
+  /// Tables, formulas and pictures, the usual OCR and export targets
+  static const CropOptions ocrTargets = CropOptions(
+    classes: {DocLayoutClass.table, DocLayoutClass.formula, DocLayoutClass.image},
+    encoding: CropEncoding.png,
+  );
+
+  /// Copy into a native options struct, the class list is allocated with
+  /// [allocator]
+  void writeTo(DocLayoutCropOptions native, Allocator allocator) {
+    final ids = classes.isEmpty ? nullptr : allocator<Int32>(classes.length);
+    var i = 0;
+    for (final layoutClass in classes) {
+      ids[i++] = layoutClass.id;
+    }
+    native
+      ..class_ids = ids
+      ..num_class_ids = classes.length
+      ..padding = padding
+      ..encoding = encoding.value
+      ..jpeg_quality = jpegQuality;
+  }
+}
+
+/// One cropped detection of a [CropResult]
+class RegionCrop {
+  /// Index into the result's detections
+  final int detectionIndex;
+
+  /// The detection the crop was cut for
+  final DetectionBox detection;
+
+  /// Crop rectangle in original image pixels, padding included
+  final int x;
+  final int y;
+  final int width;
+  final int height;
+
+  /// Bytes per row of [bytes] for raw crops (the native page's row), 0 for
+  /// encoded ones
+  final int stride;
+
+  /// Raw BGR rows or PNG / JPEG bytes, a view onto native memory
+  ///
+  /// Valid only until [CropResult.release]; copy it (or use [toBgr]) to keep
+  /// it longer.
+  final Uint8List bytes;
+
+  RegionCrop._(this.detectionIndex, this.detection, this.x, this.y, this.width,
+      this.height, this.stride, this.bytes);
+
+  /// Whether [bytes] holds an encoded image rather than raw pixels
+  bool get isEncoded => stride == 0;
+
+  /// Packed `width * height * 3` BGR copy of a raw crop
+  Uint8List toBgr() {
+    if (isEncoded) {
+      throw StateError('Crop is encoded, not raw pixels');
+    }
+    final rowBytes = width * 3;
+    final packed = Uint8List(rowBytes * height);
+    for (var row = 0; row < height; row++) {
+      packed.setRange(row * rowBytes, (row + 1) * rowBytes, bytes, row * stride);
+    }
+    return packed;
+  }
+}
+
+/// Detections plus crops taken from the same native decode of the page
+///
+/// The crops' [RegionCrop.bytes] point into native memory that lives until
+/// [release]; call it once the crops have been consumed.
+class CropResult {
+  final DetectionResult result;
+  final List<RegionCrop> crops;
+  Pointer<DocLayoutCropResult> _native;
+
+  CropResult._(this.result, this.crops, this._native);
+
+  /// Whether [release] has been called
+  bool get isReleased => _native == nullptr;
+
+  /// Free the native page and crops; [RegionCrop.bytes] is invalid afterwards
+  void release() {
+    if (_native == nullptr) return;
+    docLayoutBindings.releaseCrops(_native);
+    _native = nullptr;
+  }
+}
+
+/// Detect with crops on a detector handle (nullptr = default model)
+CropResult detectWithCropsOnHandle(
+  Pointer<Void> handle,
+  Uint8List encodedImage,
+  double confThreshold,
+  CropOptions options,
+) {
+  final native = using((arena) {
+    final dataPtr = arena<Uint8>(encodedImage.isEmpty ? 1 : encodedImage.length);
+    dataPtr.asTypedList(encodedImage.length).setAll(0, encodedImage);
+    final optionsPtr = arena<DocLayoutCropOptions>();
+    options.writeTo(optionsPtr.ref, arena);
+    return docLayoutBindings.detectWithCrops(
+        handle, dataPtr, encodedImage.length, confThreshold, optionsPtr);
+  });
+  if (native == nullptr) {
+    return CropResult._(
+        DetectionResult.error('Out of memory', code: 'OUT_OF_MEMORY'), const [], nullptr);
+  }
+
+  try {
+    final result = DetectionResult.fromJson(
+        jsonDecode(native.ref.result_json.cast<Utf8>().toDartString()));
+    final crops = <RegionCrop>[];
+    for (var i = 0; i < native.ref.count; i++) {
+      final crop = native.ref.crops[i];
+      crops.add(RegionCrop._(
+        crop.detection_index,
+        result.detections[crop.detection_index],
+        crop.x,
+        crop.y,
+        crop.width,
+        crop.height,
+        crop.stride,
+        crop.data.asTypedList(crop.size),
+      ));
+    }
+    return CropResult._(result, crops, native);
+  } catch (_) {
+    docLayoutBindings.releaseCrops(native);
+    rethrow;
+  }
+}
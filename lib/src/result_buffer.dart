@@ -0,0 +1,48 @@
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import 'models.dart';
+
+/// Native float buffer for the binary result layout of the *ToBuffer calls
+///
+/// Layout (all float32): an 8-float header
+/// `[status, count, total_count, inference_time_ms, image_width,
+/// image_height, reused, change]` followed by `count` boxes of
+/// `[x1, y1, x2, y2, score, class_id]`.
+///
+/// The synchronous detection calls of an isolate share one buffer, so
+/// steady-state detection neither allocates nor parses JSON.
+class ResultBuffer {
+  static const int headerFloats = 8;
+  static const int boxFloats = 6;
+
+  /// Upper bound of boxes the PP-DocLayout models return per image
+  static const int defaultCapacity = 300;
+
+  static ResultBuffer? _shared;
+
+  /// Buffer shared by the synchronous calls of the current isolate
+  static ResultBuffer get shared =>
+      _shared ??= ResultBuffer(defaultCapacity);
+
+  /// Maximum number of boxes the buffer holds
+  final int capacity;
+
+  /// Native memory handed to the *ToBuffer calls
+  final Pointer<Float> pointer;
+
+  ResultBuffer(this.capacity)
+      : pointer = calloc<Float>(headerFloats + boxFloats * capacity);
+
+  /// Float view over the native memory, no copy
+  Float32List get view =>
+      pointer.asTypedList(headerFloats + boxFloats * capacity);
+
+  /// Parse the last result written into the buffer
+  DetectionResult toResult() => DetectionResult.fromFloat32List(view);
+
+  /// Release the native memory; the buffer must not be used afterwards
+  void free() => calloc.free(pointer);
+}
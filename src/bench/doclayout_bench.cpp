@@ -0,0 +1,423 @@
+// doclayout_bench: measure the native detection hot path without the Flutter app.
+//
+// Usage:
+//   doclayout_bench --model pp_doclayout_m.onnx --images ./pages
+//                   [--threads 1,2,4] [--batch 1,4] [--providers cpu,xnnpack]
+//                   [--input-size 480,640,800] [--letterbox] [--tiled]
+//                   [--precision model,int8,fp16,auto] [--ort-cache DIR] [--no-mmap]
+//                   [--iterations 3] [--warmup 2] [--conf 0.5] [--full-decode]
+//
+// Every combination of precision, input size, thread count, batch size and execution provider set
+// loads a fresh detector, runs the warm-up passes, then runs --iterations
+// passes over all images and reports throughput, per-stage latency
+// percentiles, warm-up vs steady-state time and peak RSS.
+
+#include "doc_detector.h"
+#include "latency_stats.h"
+#include "memory_stats.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/resource.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    std::string model_path;
+    std::string image_dir;
+    std::vector<int> threads = {0};
+    std::vector<int> batches = {1};
+    std::vector<int> providers = {kProviderCpu};
+    std::vector<int> input_sizes = {0};
+    std::vector<int> precisions = {kPrecisionModel};
+    bool letterbox = false;
+    bool tiled = false;
+    int iterations = 3;
+    int warmup = 1;
+    float conf_threshold = 0.5f;
+    bool full_decode = false;
+    bool no_mmap = false;
+    std::string ort_cache_dir;
+};
+
+struct Page {
+    std::string name;
+    std::vector<uint8_t> bytes;
+};
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s --model PATH --images DIR [--threads 1,2,4] [--batch 1,4]\n"
+        "          [--providers cpu,xnnpack,nnapi,coreml] [--iterations N] [--warmup N]\n"
+        "          [--input-size 480,640,800] [--letterbox] [--tiled] [--conf 0.5] [--full-decode]\n"
+        "          [--precision model,fp32,fp16,int8,auto] [--ort-cache DIR] [--no-mmap]\n"
+        "  --ort-cache saves/loads the optimized graph in DIR, run twice to time the cached start\n"
+        "  --precision loads <model>.int8.onnx / <model>.fp16.onnx next to --model where present\n"
+        "  --tiled runs every page as overlapping tiles plus the whole page (batch is ignored)\n"
+        "  each --providers entry is one set, combine providers with '+', e.g. cpu,xnnpack,nnapi+xnnpack\n",
+        argv0);
+}
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+bool parseInts(const std::string& text, std::vector<int>& values) {
+    values.clear();
+    for (const std::string& part : split(text, ',')) {
+        char* end = nullptr;
+        long value = std::strtol(part.c_str(), &end, 10);
+        if (end == part.c_str() || *end != '\0' || value < 0) {
+            return false;
+        }
+        values.push_back(static_cast<int>(value));
+    }
+    return !values.empty();
+}
+
+bool parseProviders(const std::string& text, std::vector<int>& sets) {
+    sets.clear();
+    for (const std::string& set : split(text, ',')) {
+        int bits = kProviderCpu;
+        for (const std::string& name : split(set, '+')) {
+            if (name == "cpu") {
+                continue;
+            } else if (name == "nnapi") {
+                bits |= kProviderNnapi;
+            } else if (name == "xnnpack") {
+                bits |= kProviderXnnpack;
+            } else if (name == "coreml") {
+                bits |= kProviderCoreML;
+            } else {
+                return false;
+            }
+        }
+        sets.push_back(bits);
+    }
+    return !sets.empty();
+}
+
+std::string providerName(int bits) {
+    if (bits == kProviderCpu) {
+        return "cpu";
+    }
+    std::string name;
+    auto add = [&](int bit, const char* label) {
+        if (bits & bit) {
+            name += name.empty() ? label : std::string("+") + label;
+        }
+    };
+    add(kProviderNnapi, "nnapi");
+    add(kProviderXnnpack, "xnnpack");
+    add(kProviderCoreML, "coreml");
+    return name;
+}
+
+bool parsePrecisions(const char* text, std::vector<int>& out) {
+    static const ModelPrecision kAll[] = {kPrecisionModel, kPrecisionAuto, kPrecisionFp32, kPrecisionFp16,
+                                          kPrecisionInt8};
+    out.clear();
+    for (const std::string& name : split(text, ',')) {
+        const ModelPrecision* match = std::find_if(std::begin(kAll), std::end(kAll),
+            [&](ModelPrecision precision) { return name == precisionName(precision); });
+        if (match == std::end(kAll)) {
+            std::fprintf(stderr, "unknown precision: %s\n", name.c_str());
+            return false;
+        }
+        out.push_back(*match);
+    }
+    return !out.empty();
+}
+
+bool parseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* value = nullptr;
+        if (arg == "--full-decode") {
+            config.full_decode = true;
+            continue;
+        }
+        if (arg == "--letterbox") {
+            config.letterbox = true;
+            continue;
+        }
+        if (arg == "--tiled") {
+            config.tiled = true;
+            continue;
+        }
+        if (arg == "--no-mmap") {
+            config.no_mmap = true;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || (value = next()) == nullptr) {
+            return false;
+        }
+        if (arg == "--model") {
+            config.model_path = value;
+        } else if (arg == "--images") {
+            config.image_dir = value;
+        } else if (arg == "--threads") {
+            if (!parseInts(value, config.threads)) return false;
+        } else if (arg == "--batch") {
+            if (!parseInts(value, config.batches)) return false;
+        } else if (arg == "--providers") {
+            if (!parseProviders(value, config.providers)) return false;
+        } else if (arg == "--input-size") {
+            if (!parseInts(value, config.input_sizes)) return false;
+        } else if (arg == "--ort-cache") {
+            config.ort_cache_dir = value;
+        } else if (arg == "--precision") {
+            if (!parsePrecisions(value, config.precisions)) return false;
+        } else if (arg == "--iterations") {
+            config.iterations = std::max(1, std::atoi(value));
+        } else if (arg == "--warmup") {
+            config.warmup = std::max(0, std::atoi(value));
+        } else if (arg == "--conf") {
+            config.conf_threshold = static_cast<float>(std::atof(value));
+        } else {
+            return false;
+        }
+    }
+    return !config.model_path.empty() && !config.image_dir.empty();
+}
+
+bool isImageFile(const std::string& name) {
+    static const char* kExtensions[] = {".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp"};
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    for (const char* ext : kExtensions) {
+        size_t len = std::strlen(ext);
+        if (lower.size() > len && lower.compare(lower.size() - len, len, ext) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Encoded files are read once up front, so disk I/O is not part of the timings
+bool loadPages(const std::string& dir, std::vector<Page>& pages) {
+    DIR* handle = opendir(dir.c_str());
+    if (handle == nullptr) {
+        return false;
+    }
+    std::vector<std::string> names;
+    while (dirent* entry = readdir(handle)) {
+        if (isImageFile(entry->d_name)) {
+            names.emplace_back(entry->d_name);
+        }
+    }
+    closedir(handle);
+    std::sort(names.begin(), names.end());
+
+    for (const std::string& name : names) {
+        Page page;
+        page.name = name;
+        if (readFileBytes((dir + "/" + name).c_str(), page.bytes)) {
+            pages.push_back(std::move(page));
+        }
+    }
+    return !pages.empty();
+}
+
+// Peak resident set size of the process in MiB
+double peakRssMb() {
+    const ProcessMemory memory = processMemory();
+    if (memory.peak_bytes > 0) {
+        return memory.peak_bytes / (1024.0 * 1024.0);
+    }
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+#else
+    return usage.ru_maxrss / 1024.0;             // KiB
+#endif
+}
+
+// One pass over all pages, returns the number of detections
+size_t runPass(DocDetector& detector, const std::vector<Page>& pages, int batch, bool tiled,
+               float conf_threshold) {
+    size_t total = 0;
+    if (tiled) {
+        TileOptions tile_options;
+        std::vector<DetectionBox> boxes;
+        for (const Page& page : pages) {
+            DecodedImage decoded = detector.DecodeForTiles(page.bytes.data(), page.bytes.size(), tile_options);
+            detector.DetectTiled(decoded.image, conf_threshold, tile_options, boxes);
+            total += boxes.size();
+        }
+        return total;
+    }
+    if (batch <= 1) {
+        for (const Page& page : pages) {
+            DecodedImage decoded = detector.Decode(page.bytes.data(), page.bytes.size());
+            std::vector<DetectionBox> boxes = detectDocLayout(decoded.image, conf_threshold);
+            mapDetectionsToOriginal(boxes, decoded.image.cols, decoded.image.rows,
+                                    decoded.original_width, decoded.original_height);
+            total += boxes.size();
+        }
+        return total;
+    }
+
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<DetectionBox>> results;
+    for (size_t first = 0; first < pages.size(); first += batch) {
+        size_t count = std::min(pages.size() - first, static_cast<size_t>(batch));
+        images.clear();
+        for (size_t i = 0; i < count; i++) {
+            const Page& page = pages[first + i];
+            images.push_back(detector.Decode(page.bytes.data(), page.bytes.size()).image);
+        }
+        detector.DetectBatch(images, conf_threshold, results);
+        for (const auto& boxes : results) {
+            total += boxes.size();
+        }
+    }
+    return total;
+}
+
+void printStage(LatencyStage stage) {
+    StagePercentiles p = LatencyStats::GetInstance().Percentiles(stage);
+    std::printf("    %-11s n=%-6llu p50 %8.2f  p95 %8.2f  p99 %8.2f  mean %8.2f  max %8.2f ms\n",
+                LatencyStats::StageName(stage), static_cast<unsigned long long>(p.count),
+                p.p50, p.p95, p.p99, p.mean, p.max);
+}
+
+void runConfig(const BenchConfig& config, const std::vector<Page>& pages, int precision, int input_size,
+               int threads, int batch, int providers) {
+    DetectorOptions options;
+    options.precision = precision;
+    options.input_size = input_size;
+    options.letterbox = config.letterbox ? 1 : 0;
+    options.intra_op_threads = threads;
+    options.execution_providers = providers;
+    options.max_batch_size = batch;
+    options.full_resolution_decode = config.full_decode ? 1 : 0;
+    options.disable_memory_map = config.no_mmap ? 1 : 0;
+    options.optimized_model_dir = config.ort_cache_dir;
+
+    std::printf("\n== precision=%s input=%d threads=%d batch=%d providers=%s\n",
+                precisionName(static_cast<ModelPrecision>(precision)), input_size > 0 ? input_size : 640,
+                threads, batch, providerName(providers).c_str());
+
+    std::shared_ptr<DocDetector> detector;
+    auto load_start = Clock::now();
+    try {
+        detector = std::make_shared<DocDetector>(config.model_path, options);
+    } catch (const std::exception& e) {
+        std::printf("  load failed: %s\n", e.what());
+        return;
+    }
+    double load_ms = elapsedMs(load_start);
+    setDefaultDetector(detector);
+    std::printf("  load %.1f ms, input %dx%d%s%s, active providers: %s, batch capable: %s\n", load_ms,
+                detector->InputWidth(), detector->InputHeight(), config.letterbox ? " letterbox" : "",
+                config.tiled ? " tiled" : "",
+                providerName(detector->ActiveProviders()).c_str(), detector->SupportsBatch() ? "yes" : "no");
+    std::printf("  loaded %s (%s%s) via %s, session %.1f ms\n", detector->LoadedPath().c_str(),
+                precisionName(detector->Precision()), detector->Descriptor().half_image ? ", float16 I/O" : "",
+                detector->Descriptor().load_method.c_str(), detector->Descriptor().load_ms);
+
+    // Warm-up: the first run pays for allocator growth and kernel selection
+    LatencyStats::GetInstance().Reset();
+    double first_ms = 0.0;
+    double warmup_ms = 0.0;
+    for (int i = 0; i < config.warmup; i++) {
+        auto start = Clock::now();
+        runPass(*detector, pages, batch, config.tiled, config.conf_threshold);
+        double ms = elapsedMs(start) / pages.size();
+        if (i == 0) {
+            first_ms = ms;
+        }
+        warmup_ms += ms;
+    }
+
+    // Steady state
+    LatencyStats::GetInstance().Reset();
+    size_t detections = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < config.iterations; i++) {
+        detections += runPass(*detector, pages, batch, config.tiled, config.conf_threshold);
+    }
+    double steady_total_ms = elapsedMs(start);
+    size_t images = pages.size() * static_cast<size_t>(config.iterations);
+    double steady_ms = steady_total_ms / images;
+
+    if (config.warmup > 0) {
+        std::printf("  warm-up: first pass %.2f ms/image, mean %.2f ms/image over %d pass(es)\n",
+                    first_ms, warmup_ms / config.warmup, config.warmup);
+    }
+    std::printf("  steady:  %.2f ms/image, %.2f images/s (%zu images, %.1f detections/image)\n",
+                steady_ms, 1000.0 * images / steady_total_ms, images,
+                static_cast<double>(detections) / images);
+    std::printf("  stages (steady state; batch runs count as one run/parse sample):\n");
+    for (int stage = 0; stage < kStageCount; stage++) {
+        if (stage == kStageSerialize || stage == kStageTotal) {
+            continue;  // not exercised by the C++ path
+        }
+        printStage(static_cast<LatencyStage>(stage));
+    }
+    std::printf("  peak RSS %.1f MiB\n", peakRssMb());
+
+    setDefaultDetector(nullptr);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Page> pages;
+    if (!loadPages(config.image_dir, pages)) {
+        std::fprintf(stderr, "no images found in %s\n", config.image_dir.c_str());
+        return 1;
+    }
+    std::printf("model %s, %zu images, %d warm-up + %d timed pass(es)\n",
+                config.model_path.c_str(), pages.size(), config.warmup, config.iterations);
+
+    std::printf("cpu %s\n", cpuFeatures().ToJson().c_str());
+
+    for (int precision : config.precisions) {
+        for (int input_size : config.input_sizes) {
+            for (int providers : config.providers) {
+                for (int threads : config.threads) {
+                    for (int batch : config.batches) {
+                        runConfig(config, pages, precision, input_size, threads, batch, providers);
+                    }
+                }
+            }
+        }
+    }
+    std::printf("\npeak RSS overall %.1f MiB\n", peakRssMb());
+    return 0;
+}
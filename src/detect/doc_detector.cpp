@@ -1,199 +1,1299 @@
 #include "include/doc_detector.h"
+#include "include/latency_stats.h"
+#include "include/model_descriptor.h"
+#include "include/model_variant.h"
+#include "include/page_crop.h"
+#include "include/postprocess.h"
+#include "include/request_control.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <sstream>
 #include <iomanip>
+#include <limits>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#if defined(__ANDROID__) && __has_include(<nnapi_provider_factory.h>)
+#include <nnapi_provider_factory.h>
+#define DOCLAYOUT_HAS_NNAPI 1
+#endif
+
+#if defined(__APPLE__) && __has_include(<coreml_provider_factory.h>)
+#include <coreml_provider_factory.h>
+#define DOCLAYOUT_HAS_COREML 1
+#endif
 
 #define LOGD(...) do {} while(0)
 
+namespace {
+
+std::mutex g_default_mutex;
+std::shared_ptr<DocDetector> g_default_detector;
+
+// Run fn(0..count) on up to `workers` threads, the calling thread included.
+// Helper threads work for the caller's request, so stopping it terminates
+// their runs too.
+template <typename Fn>
+void parallelFor(size_t count, size_t workers, Fn fn) {
+    workers = std::min(workers, count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+    RequestControl* request = ScopedRequest::Current();
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; w++) {
+        threads.emplace_back([&work, request]() {
+            ScopedRequest scope(request);
+            work();
+        });
+    }
+    work();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Start offsets of tiles of side `tile` covering [0, length), evenly spread
+// so neighbours share at least `overlap` of a tile
+std::vector<int> tileOffsets(int length, int tile, float overlap) {
+    if (length <= tile) {
+        return {0};
+    }
+    const float step = std::max(1.0f, tile * (1.0f - overlap));
+    const int count = static_cast<int>(std::ceil((length - tile) / step)) + 1;
+    std::vector<int> offsets(count);
+    for (int i = 0; i < count; i++) {
+        offsets[i] = static_cast<int>(std::lround(static_cast<double>(i) * (length - tile) / (count - 1)));
+    }
+    return offsets;
+}
+
+// 64-bit FNV-1a, names optimized-model cache files
+uint64_t fnv1a(const std::string& text, uint64_t hash = 14695981039346656037ull) {
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+#ifdef _WIN32
+std::wstring toOrtPath(const std::string& path) {
+    return ConfigManager::ConvertToWstring(path);
+}
+#else
+const std::string& toOrtPath(const std::string& path) {
+    return path;
+}
+#endif
+
+}  // namespace
+
+Ort::Env& DocDetector::SharedEnv() {
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "DocLayout");
+    return env;
+}
+
+void DocDetector::RegisterSharedArena(const DetectorOptions& options) {
+    static std::mutex mutex;
+    static bool registered = false;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (registered) {
+        return;
+    }
+    // OrtArenaCfg: -1 keeps ONNX Runtime's default for a field
+    const int strategy = options.arena_extend_strategy == kArenaExtendNextPowerOfTwo ? 0
+                       : options.arena_extend_strategy == kArenaExtendSameAsRequested ? 1 : -1;
+    const int initial_chunk = options.arena_initial_chunk_bytes > 0
+        ? static_cast<int>(std::min<int64_t>(options.arena_initial_chunk_bytes, std::numeric_limits<int>::max()))
+        : -1;
+    const size_t max_mem = options.arena_max_bytes > 0 ? static_cast<size_t>(options.arena_max_bytes) : 0;
+    Ort::ArenaCfg arena(max_mem, strategy, initial_chunk, -1);
+    Ort::MemoryInfo cpu = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    SharedEnv().CreateAndRegisterAllocator(cpu, arena);
+    registered = true;
+}
+
+Ort::SessionOptions DocDetector::BuildSessionOptions(const DetectorOptions& options, bool with_providers,
+                                                     int* applied_providers) {
+    Ort::SessionOptions session_options;
+
+    if (options.disable_cpu_arena != 0) {
+        session_options.DisableCpuMemArena();
+    } else if (options.arena_extend_strategy != kArenaExtendDefault || options.arena_initial_chunk_bytes > 0 ||
+               options.arena_max_bytes > 0) {
+        // Per-session CPU arenas cannot be configured; sessions opt into the env's
+        RegisterSharedArena(options);
+        session_options.AddConfigEntry("session.use_env_allocators", "1");
+    }
+
+    // Concurrent runs share the cores: unless pinned, give each run its slice
+    int intra_op_threads = options.intra_op_threads;
+    if (intra_op_threads <= 0 && options.max_concurrent_runs > 1) {
+        intra_op_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) /
+                                           options.max_concurrent_runs);
+    }
+    if (intra_op_threads > 0) {
+        session_options.SetIntraOpNumThreads(intra_op_threads);
+    }
+    if (options.inter_op_threads > 0) {
+        session_options.SetInterOpNumThreads(options.inter_op_threads);
+    }
+    switch (options.graph_optimization_level) {
+        case kGraphOptDisable:  session_options.SetGraphOptimizationLevel(ORT_DISABLE_ALL); break;
+        case kGraphOptBasic:    session_options.SetGraphOptimizationLevel(ORT_ENABLE_BASIC); break;
+        case kGraphOptExtended: session_options.SetGraphOptimizationLevel(ORT_ENABLE_EXTENDED); break;
+        case kGraphOptAll:      session_options.SetGraphOptimizationLevel(ORT_ENABLE_ALL); break;
+        default: break;
+    }
+    if (!options.profile_prefix.empty()) {
+        // Chrome trace written to <prefix>_<timestamp>.json by EndProfiling()
+        session_options.EnableProfiling(toOrtPath(options.profile_prefix).c_str());
+    }
+
+    *applied_providers = 0;
+    if (!with_providers) {
+        return session_options;
+    }
+
+    // Each provider is optional: if this ONNX Runtime build lacks it, keep going on CPU
+#ifdef DOCLAYOUT_HAS_NNAPI
+    if (options.execution_providers & kProviderNnapi) {
+        try {
+            Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_Nnapi(session_options, 0));
+            *applied_providers |= kProviderNnapi;
+        } catch (const Ort::Exception& e) {
+            (void)e;
+            LOGD("NNAPI unavailable: %s", e.what());
+        }
+    }
+#endif
+#ifdef DOCLAYOUT_HAS_COREML
+    if (options.execution_providers & kProviderCoreML) {
+        try {
+            Ort::ThrowOnError(OrtSessionOptionsAppendExecutionProvider_CoreML(session_options, 0));
+            *applied_providers |= kProviderCoreML;
+        } catch (const Ort::Exception& e) {
+            (void)e;
+            LOGD("CoreML unavailable: %s", e.what());
+        }
+    }
+#endif
+    if (options.execution_providers & kProviderXnnpack) {
+        try {
+            // XNNPACK runs its own thread pool, ORT's intra-op pool would only spin against it
+            int xnnpack_threads = intra_op_threads > 0
+                ? intra_op_threads
+                : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            session_options.AppendExecutionProvider("XNNPACK",
+                {{"intra_op_num_threads", std::to_string(xnnpack_threads)}});
+            session_options.AddConfigEntry("session.intra_op.allow_spinning", "0");
+            session_options.SetIntraOpNumThreads(1);
+            *applied_providers |= kProviderXnnpack;
+        } catch (const Ort::Exception& e) {
+            (void)e;
+            LOGD("XNNPACK unavailable: %s", e.what());
+        }
+    }
+    return session_options;
+}
+
+DocDetector::DocDetector(const std::string& model_path, const DetectorOptions& options)
+    : model_path_(model_path),
+      options_(options),
+      postprocess_(std::make_shared<const PostprocessOptions>()),
+      decode_pool_(options.decode_pool_size < 0 ? 0
+                   : options.decode_pool_size == 0 ? kDefaultDecodePool
+                   : static_cast<size_t>(options.decode_pool_size)) {
+    // INT8/FP16 variants come first when asked for; one that this ONNX
+    // Runtime build or the providers cannot load falls through to the next
+    const bool accelerator = (options_.execution_providers & (kProviderNnapi | kProviderCoreML)) != 0;
+    const std::vector<ModelCandidate> candidates = modelCandidates(model_path, options_.precision, accelerator);
+    const auto load_start = std::chrono::steady_clock::now();
+    size_t loaded = 0;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        try {
+            CreateSession(candidates[i].path);
+            loaded = i;
+            break;
+        } catch (const Ort::Exception& e) {
+            if (i + 1 == candidates.size()) {
+                throw;
+            }
+            (void)e;
+            LOGD("Variant %s failed to load (%s), trying the next", candidates[i].path.c_str(), e.what());
+        }
+    }
+
+    const double load_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - load_start).count();
+
+    BindIo();
+    descriptor_.load_method = load_method_;
+    descriptor_.load_ms = load_ms;
+    // A file without a precision suffix keeps what its I/O types tell
+    descriptor_.model_file = candidates[loaded].path;
+    uint64_t model_size = 0;
+    int64_t model_mtime = 0;
+    if (fileStamp(descriptor_.model_file, model_size, model_mtime)) {
+        model_stamp_ = std::to_string(model_size) + ":" + std::to_string(model_mtime);
+    }
+    if (candidates[loaded].precision != kPrecisionFp32) {
+        descriptor_.precision = candidates[loaded].precision;
+    }
+    LOGD("ONNX session created: %s (%s, %s in %.1f ms, providers: 0x%x)", descriptor_.model_file.c_str(),
+         precisionName(descriptor_.precision), load_method_.c_str(), load_ms, active_providers_);
+}
+
+std::string DocDetector::OptimizedModelPath(const std::string& source) const {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (options_.optimized_model_dir.empty() || options_.execution_providers != kProviderCpu ||
+        !fileStamp(source, size, mtime)) {
+        return std::string();
+    }
+    // Any change of the source file, the runtime or the optimizations gets a new file
+    uint64_t key = fnv1a(source);
+    key = fnv1a(std::to_string(size) + ":" + std::to_string(mtime), key);
+    key = fnv1a(Ort::GetVersionString() + ":" + std::to_string(options_.graph_optimization_level), key);
+
+    std::string name = source.substr(source.find_last_of("/\\") + 1);
+    if (name.size() > 5 && name.compare(name.size() - 5, 5, ".onnx") == 0) {
+        name.resize(name.size() - 5);
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+
+    std::string dir = options_.optimized_model_dir;
+    if (dir.back() != '/' && dir.back() != '\\') {
+        dir += '/';
+    }
+    return dir + name + "." + hex + ".ort";
+}
+
+void DocDetector::CreateSession(const std::string& path) {
+    // The cached graph is already optimized and in ORT format: no protobuf
+    // parse, no optimizer passes, weights used in place from the mapping.
+    // One that fails to load is dropped and rebuilt from the source.
+    const std::string cache_path = OptimizedModelPath(path);
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (!cache_path.empty() && fileStamp(cache_path, size, mtime)) {
+        try {
+            LoadSession(cache_path, true, std::string());
+            return;
+        } catch (const Ort::Exception& e) {
+            (void)e;
+            LOGD("Optimized model %s unusable (%s), rebuilding", cache_path.c_str(), e.what());
+            std::remove(cache_path.c_str());
+        }
+    }
+    if (cache_path.empty()) {
+        LoadSession(path, false, std::string());
+        return;
+    }
+    try {
+        LoadSession(path, false, cache_path);
+    } catch (const Ort::Exception& e) {
+        // An unwritable cache directory must not keep the model from loading
+        (void)e;
+        LOGD("Saving the optimized model failed (%s), loading without cache", e.what());
+        LoadSession(path, false, std::string());
+    }
+}
+
+void DocDetector::LoadSession(const std::string& path, bool ort_format, const std::string& save_path) {
+    Ort::SessionOptions session_options = BuildSessionOptions(options_, true, &active_providers_);
+    try {
+        OpenSession(path, ort_format, save_path, session_options);
+    } catch (const Ort::Exception& e) {
+        // A provider can accept the options and still reject the graph, fall back to plain CPU
+        if (active_providers_ == 0) {
+            throw;
+        }
+        (void)e;
+        LOGD("Session with execution providers failed (%s), retrying on CPU", e.what());
+        session_options = BuildSessionOptions(options_, false, &active_providers_);
+        OpenSession(path, ort_format, save_path, session_options);
+    }
+}
+
+void DocDetector::OpenSession(const std::string& path, bool ort_format, const std::string& save_path,
+                              Ort::SessionOptions& session_options) {
+    // Written under a temporary name, a crash mid-write must not leave a truncated cache
+    const std::string temp_path = save_path.empty() ? std::string() : save_path + ".tmp";
+    if (!temp_path.empty()) {
+        session_options.SetOptimizedModelFilePath(toOrtPath(temp_path).c_str());
+        session_options.AddConfigEntry("session.save_model_format", "ORT");
+    }
+    if (ort_format) {
+        session_options.AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+        session_options.AddConfigEntry("session.use_ort_model_bytes_for_initializers", "1");
+    }
+
+    bool opened = false;
+    if (options_.disable_memory_map == 0 && model_mapping_.Open(path)) {
+        try {
+            session_ = Ort::Session(SharedEnv(), model_mapping_.Data(), model_mapping_.Size(), session_options);
+            opened = true;
+            load_method_ = ort_format ? "ort_cache" : "mmap";
+        } catch (const Ort::Exception& e) {
+            // e.g. external weight files, which resolve against the model path only
+            (void)e;
+            LOGD("Loading %s from memory failed (%s), loading by path", path.c_str(), e.what());
+        }
+        // A protobuf model is copied while parsing; only ORT format keeps pointing into the mapping
+        if (!opened || !ort_format) {
+            model_mapping_.Close();
+        }
+    }
+    if (!opened) {
+        session_ = Ort::Session(SharedEnv(), toOrtPath(path).c_str(), session_options);
+        load_method_ = ort_format ? "ort_cache" : "file";
+    }
+
+    if (!temp_path.empty()) {
+        std::remove(save_path.c_str());
+        if (std::rename(temp_path.c_str(), save_path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+        }
+    }
+}
+
+void setDefaultDetector(std::shared_ptr<DocDetector> detector) {
+    std::lock_guard<std::mutex> lock(g_default_mutex);
+    g_default_detector = std::move(detector);
+}
+
+std::shared_ptr<DocDetector> getDefaultDetector() {
+    std::lock_guard<std::mutex> lock(g_default_mutex);
+    return g_default_detector;
+}
+
 std::vector<DetectionBox> detectDocLayout(const cv::Mat& image, float conf_threshold) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        LOGD("Error: Model not initialized");
+        return {};
+    }
+    return detector->Detect(image, conf_threshold);
+}
+
+std::vector<DetectionBox> DocDetector::Detect(const cv::Mat& image, float conf_threshold) {
+    return Detect(image, PixelFormat::kBGR, conf_threshold);
+}
+
+void DocDetector::BindIo() {
+    // Names, roles, input size and class table come from the model itself
+    descriptor_ = DescribeModel(session_, DOC_CLASSES);
+
+    // A static image H/W in the graph wins; dynamic models run at input_size
+    int requested = kDefaultInputSize;
+    if (options_.input_size > 0) {
+        requested = (options_.input_size + kInputAlignment - 1) / kInputAlignment * kInputAlignment;
+    }
+    input_width_ = descriptor_.input_width > 0 ? descriptor_.input_width : requested;
+    input_height_ = descriptor_.input_height > 0 ? descriptor_.input_height : requested;
+    resize_mode_ = options_.letterbox != 0 ? ResizeMode::kLetterbox : ResizeMode::kStretch;
+
+    memory_info_ = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+    // A fixed-size output ([max_detections, 6]) is written straight into a
+    // context buffer. NMS outputs usually have a dynamic row count; those are
+    // bound to the CPU arena, which recycles the same block between runs.
+    for (const TensorInfo& output : descriptor_.outputs) {
+        if (output.name == descriptor_.boxes_output) {
+            output_shape_ = output.shape;
+        }
+    }
+    static_output_ = !output_shape_.empty();
+    size_t output_elements = 1;
+    for (int64_t dim : output_shape_) {
+        if (dim <= 0) {
+            static_output_ = false;
+            break;
+        }
+        output_elements *= static_cast<size_t>(dim);
+    }
+    results_capacity_ = static_output_ ? output_elements / 6 : kDefaultMaxDetections;
+
+    // One context per inference allowed in flight, all on the shared session
+    const size_t context_count = options_.max_concurrent_runs > 0
+        ? static_cast<size_t>(options_.max_concurrent_runs) : 1;
+    for (size_t i = 0; i < context_count; i++) {
+        contexts_.push_back(std::make_unique<RunContext>());
+        InitContext(*contexts_.back());
+        free_contexts_.push_back(contexts_.back().get());
+    }
+    LOGD("IO bound: %s model, %dx%d %s input, %s output, %zu classes%s, %zu contexts",
+         descriptor_.variant == kModelVariantL ? "L" : "M", input_width_, input_height_,
+         resize_mode_ == ResizeMode::kLetterbox ? "letterbox" : "stretch",
+         static_output_ ? "static" : "dynamic", descriptor_.class_names.size(),
+         descriptor_.class_names_from_metadata ? " from metadata" : "", context_count);
+}
+
+Ort::Value DocDetector::WrapTensor(void* data, size_t count, bool half, const int64_t* shape, size_t rank) const {
+    return Ort::Value::CreateTensor(memory_info_, data, count * (half ? sizeof(uint16_t) : sizeof(float)),
+                                    shape, rank,
+                                    half ? ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16 : ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT);
+}
+
+void DocDetector::InitContext(RunContext& context) {
+    // Only the buffer in the model's element type is allocated
+    const size_t image_elements = static_cast<size_t>(3) * input_height_ * input_width_;
+    if (descriptor_.half_image) {
+        context.input_half.assign(image_elements, 0);
+    } else {
+        context.input_image.assign(image_elements, 0.0f);
+    }
+    context.scale_factor = {1.0f, 1.0f};
+    context.im_shape = {static_cast<float>(input_height_), static_cast<float>(input_width_)};
+    floatsToHalves(context.scale_factor.data(), context.scale_half.data(), 2);
+    floatsToHalves(context.im_shape.data(), context.im_shape_half.data(), 2);
+
+    const int64_t image_shape[] = {1, 3, input_height_, input_width_};
+    const int64_t pair_shape[] = {1, 2};
+    const bool half_side = descriptor_.half_side_inputs;
+
+    // Tensors wrap the context buffers, so refreshing an input is just writing into it
+    context.image_tensor = descriptor_.half_image
+        ? WrapTensor(context.input_half.data(), image_elements, true, image_shape, 4)
+        : WrapTensor(context.input_image.data(), image_elements, false, image_shape, 4);
+    context.scale_tensor = half_side
+        ? WrapTensor(context.scale_half.data(), 2, true, pair_shape, 2)
+        : WrapTensor(context.scale_factor.data(), 2, false, pair_shape, 2);
+
+    context.binding = Ort::IoBinding(session_);
+    if (options_.shrink_arena_after_run != 0 && options_.disable_cpu_arena == 0) {
+        // Free arena blocks the run no longer uses before Run returns
+        context.run_options.AddConfigEntry("memory.enable_memory_arena_shrinkage", "cpu:0");
+    }
+    if (!descriptor_.shape_input.empty()) {
+        context.im_shape_tensor = half_side
+            ? WrapTensor(context.im_shape_half.data(), 2, true, pair_shape, 2)
+            : WrapTensor(context.im_shape.data(), 2, false, pair_shape, 2);
+        context.binding.BindInput(descriptor_.shape_input.c_str(), context.im_shape_tensor);
+    }
+    context.binding.BindInput(descriptor_.image_input.c_str(), context.image_tensor);
+    if (!descriptor_.scale_input.empty()) {
+        context.binding.BindInput(descriptor_.scale_input.c_str(), context.scale_tensor);
+    }
+
+    if (static_output_) {
+        if (descriptor_.half_boxes) {
+            context.output_half.assign(results_capacity_ * 6, 0);
+            context.output_tensor = WrapTensor(context.output_half.data(), context.output_half.size(), true,
+                                               output_shape_.data(), output_shape_.size());
+        } else {
+            context.output_buffer.assign(results_capacity_ * 6, 0.0f);
+            context.output_tensor = WrapTensor(context.output_buffer.data(), context.output_buffer.size(), false,
+                                               output_shape_.data(), output_shape_.size());
+        }
+        context.binding.BindOutput(descriptor_.boxes_output.c_str(), context.output_tensor);
+    } else {
+        context.binding.BindOutput(descriptor_.boxes_output.c_str(), memory_info_);
+    }
+}
+
+std::array<float, 2> DocDetector::PreprocessInto(RunContext& context, const cv::Mat& image,
+                                                PixelFormat format) const {
+    if (descriptor_.half_image) {
+        return preprocessToTensor(image, format, input_width_, input_height_, context.input_half.data(), resize_mode_);
+    }
+    return preprocessToTensor(image, format, input_width_, input_height_, context.input_image.data(), resize_mode_);
+}
+
+std::array<float, 2> DocDetector::PreprocessInto(RunContext& context, const YuvPlanes& frame) const {
+    if (descriptor_.half_image) {
+        return preprocessYuvToTensor(frame, input_width_, input_height_, context.input_half.data(), resize_mode_);
+    }
+    return preprocessYuvToTensor(frame, input_width_, input_height_, context.input_image.data(), resize_mode_);
+}
+
+std::array<float, 2> DocDetector::ImShape(const std::array<float, 2>& scale_factor,
+                                          int image_width, int image_height) const {
+    if (resize_mode_ == ResizeMode::kLetterbox) {
+        // L outputs boxes relative to the whole input, border included; give
+        // it the padded input's size in original pixels so they still come
+        // back in original coordinates
+        return {input_height_ / scale_factor[1], input_width_ / scale_factor[0]};
+    }
+    return {static_cast<float>(image_height), static_cast<float>(image_width)};
+}
+
+DocDetector::RunContext* DocDetector::AcquireContext() {
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    pool_cv_.wait(lock, [this] { return !free_contexts_.empty(); });
+    RunContext* context = free_contexts_.back();
+    free_contexts_.pop_back();
+    return context;
+}
+
+void DocDetector::ReleaseContext(RunContext* context) {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        free_contexts_.push_back(context);
+    }
+    // Wake TrimMemory too, it waits for the whole pool
+    pool_cv_.notify_all();
+}
+
+std::vector<DocDetector::RunContext*> DocDetector::AcquireAllContexts() {
+    // All at once: two trims leasing one by one could each hold part of the pool
+    std::unique_lock<std::mutex> lock(pool_mutex_);
+    pool_cv_.wait(lock, [this] { return free_contexts_.size() == contexts_.size(); });
+    std::vector<RunContext*> leased;
+    leased.swap(free_contexts_);
+    return leased;
+}
+
+void DocDetector::ReleaseAllContexts(std::vector<RunContext*>& leased) {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        free_contexts_.insert(free_contexts_.end(), leased.begin(), leased.end());
+    }
+    leased.clear();
+    pool_cv_.notify_all();
+}
+
+void DocDetector::AppendDetections(const float* rows, int num_rows, float inv_scale_x, float inv_scale_y,
+                                   int image_width, int image_height, float conf_threshold,
+                                   const PostprocessOptions& postprocess,
+                                   std::vector<DetectionBox>& results) const {
+    // Format: [class_id, score, x1, y1, x2, y2]
+    const size_t first = results.size();
+    filterDetections(rows, num_rows, static_cast<int>(descriptor_.class_names.size()), conf_threshold,
+                     postprocess, inv_scale_x, inv_scale_y, image_width, image_height, results);
+    // Refine only this page's boxes in place, results may already hold others
+    refineDetections(results, postprocess, first);
+}
+
+void DocDetector::SetPostprocess(const PostprocessOptions& options) {
+    auto snapshot = std::make_shared<const PostprocessOptions>(options);
+    std::lock_guard<std::mutex> lock(postprocess_mutex_);
+    postprocess_ = std::move(snapshot);
+}
+
+std::shared_ptr<const PostprocessOptions> DocDetector::Postprocess() const {
+    std::lock_guard<std::mutex> lock(postprocess_mutex_);
+    return postprocess_;
+}
+
+std::vector<DetectionBox> DocDetector::Detect(const cv::Mat& image, PixelFormat format, float conf_threshold) {
     std::vector<DetectionBox> results;
+    Detect(image, format, conf_threshold, results);
+    return results;
+}
+
+bool DocDetector::Detect(const cv::Mat& image, PixelFormat format, float conf_threshold,
+                         std::vector<DetectionBox>& results) {
+    if (options_.page_crop == 0 || image.empty()) {
+        return DetectFrame(image, format, conf_threshold, results);
+    }
+
+    // Only the page goes into the model input, rectified, so its elements
+    // get the pixels the background would otherwise take
+    PageQuad quad;
+    PageCrop crop;
+    {
+        StageTimer crop_timer(kStagePageCrop);
+        if (findPageQuad(image, format, quad)) {
+            warpPage(image, quad, input_width_, input_height_, crop);
+        }
+    }
+    if (crop.page.empty()) {
+        return DetectFrame(image, format, conf_threshold, results);
+    }
+    if (!DetectFrame(crop.page, format, conf_threshold, results)) {
+        return false;
+    }
+    mapDetectionsFromPage(results, crop.to_frame, image.cols, image.rows);
+    return true;
+}
+
+bool DocDetector::DetectFrame(const cv::Mat& image, PixelFormat format, float conf_threshold,
+                              std::vector<DetectionBox>& results) {
+    results.clear();
 
-    LOGD("detectDocLayout called, image size: %dx%d, threshold: %.2f", image.cols, image.rows, conf_threshold);
+    LOGD("Detect called, image size: %dx%d, threshold: %.2f", image.cols, image.rows, conf_threshold);
 
     if (image.empty()) {
         LOGD("Error: Empty image");
-        return results;
+        return false;
     }
 
+    // Blocks while max_concurrent_runs other calls are in flight
+    ContextLease context(*this);
+
     try {
-        // 1. Initialize ONNX Runtime (static, only once)
-        LOGD("Creating ONNX session...");
-        static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "DocLayout");
-        static Ort::SessionOptions session_options;
-        static Ort::Session session(env, ConfigManager::GetInstance().MODEL_PATH.c_str(), session_options);
-        LOGD("ONNX session created");
-
-        // 2. Get input/output info
-        static Ort::AllocatorWithDefaultOptions allocator;
-        static auto input_name = session.GetInputNameAllocated(0, allocator);
-
-        // Get number of inputs and outputs
-        size_t num_inputs = session.GetInputCount();
-        size_t num_outputs = session.GetOutputCount();
-        LOGD("Model has %zu inputs and %zu outputs", num_inputs, num_outputs);
-
-        // Log input names
-        for (size_t i = 0; i < num_inputs; i++) {
-            auto name = session.GetInputNameAllocated(i, allocator);
-            LOGD("Input %zu: %s", i, name.get());
-        }
-
-        // Log output names
-        for (size_t i = 0; i < num_outputs; i++) {
-            auto name = session.GetOutputNameAllocated(i, allocator);
-            LOGD("Output %zu: %s", i, name.get());
-        }
-
-        static auto output_name_0 = session.GetOutputNameAllocated(0, allocator);
-        static auto output_name_1 = (num_outputs > 1) ? session.GetOutputNameAllocated(1, allocator) : session.GetOutputNameAllocated(0, allocator);
-
-        // 3. Preprocess image
-        int target_width = 640;
-        int target_height = 640;
-        LOGD("Preprocessing image to %dx%d", target_width, target_height);
-        auto [resized_img, scale_factor] = preprocessImage(image, target_width, target_height);
+        // 1. Preprocess image straight into the bound input buffer:
+        //    resize (stretched or letterboxed), RGB swap, scaling and NCHW layout in one pass,
+        //    written as float16 directly for FP16 models
+        LOGD("Preprocessing image to %dx%d", input_width_, input_height_);
+        StageTimer preprocess_timer(kStagePreprocess);
+        std::array<float, 2> scale_factor = PreprocessInto(*context, image, format);
+        preprocess_timer.Stop();
         LOGD("Scale factors: x=%.4f, y=%.4f", scale_factor[0], scale_factor[1]);
 
-        // 4. Convert to blob
-        cv::Mat blob = imageToBlob(resized_img);
-        LOGD("Blob created, total elements: %zu", blob.total());
+        // 2-5. Run on the bound tensors and convert the output
+        RunBound(*context, scale_factor, image.cols, image.rows, conf_threshold, results);
+        return true;
 
-        // 5. Prepare input tensors
-        std::vector<int64_t> image_shape = {1, 3, target_height, target_width};
-        std::vector<int64_t> scale_shape = {1, 2};
+    } catch (const Ort::Exception& e) {
+        (void)e;
+        LOGD("Inference failed: %s", e.what());
+    } catch (const cv::Exception& e) {
+        (void)e;
+    } catch (const std::exception& e) {
+        (void)e;
+    }
+    results.clear();
+    return false;
+}
 
-        Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+bool DocDetector::Detect(const YuvPlanes& frame, float conf_threshold, std::vector<DetectionBox>& results) {
+    results.clear();
 
-        Ort::Value image_tensor = Ort::Value::CreateTensor<float>(
-            memory_info, blob.ptr<float>(), blob.total(),
-            image_shape.data(), image_shape.size());
+    if (frame.y == nullptr || frame.u == nullptr || frame.v == nullptr || frame.width <= 0 || frame.height <= 0) {
+        LOGD("Error: Empty YUV frame");
+        return false;
+    }
 
-        Ort::Value scale_tensor = Ort::Value::CreateTensor<float>(
-            memory_info, scale_factor.data(), scale_factor.size(),
-            scale_shape.data(), scale_shape.size());
+    ContextLease context(*this);
 
-        // 6. Run inference - auto detect model type (M: 2 inputs, L: 3 inputs)
-        LOGD("Running inference with %zu inputs...", num_inputs);
-        std::vector<Ort::Value> outputs;
-        std::vector<const char*> input_names;
-        std::vector<Ort::Value> input_tensors;
-        std::vector<const char*> output_names = {output_name_0.get()};
-
-        // Track if we're using L model
-        bool is_l_model = (num_inputs == 3);
-
-        // Prepare im_shape for L model (original image size)
-        std::vector<float> im_shape_data = {static_cast<float>(image.rows), static_cast<float>(image.cols)};
-        std::vector<int64_t> im_shape_shape = {1, 2};
-
-        // L model scale_factor = [1.0, 1.0] (must be declared here to extend lifetime)
-        std::vector<float> l_scale_factor = {1.0f, 1.0f};
-
-        if (is_l_model) {
-            // L model: im_shape, image, scale_factor
-            // im_shape = original image size [h, w]
-            // scale_factor = [1.0, 1.0] - L model uses im_shape internally to output original coords
-            Ort::Value im_shape_tensor = Ort::Value::CreateTensor<float>(
-                memory_info, im_shape_data.data(), im_shape_data.size(),
-                im_shape_shape.data(), im_shape_shape.size());
-
-            Ort::Value l_scale_tensor = Ort::Value::CreateTensor<float>(
-                memory_info, l_scale_factor.data(), l_scale_factor.size(),
-                scale_shape.data(), scale_shape.size());
-
-            input_names = {"im_shape", "image", "scale_factor"};
-            input_tensors.push_back(std::move(im_shape_tensor));
-            input_tensors.push_back(std::move(image_tensor));
-            input_tensors.push_back(std::move(l_scale_tensor));
-            LOGD("Using L model format (3 inputs), im_shape=[%.0f, %.0f], scale_factor=[1.0, 1.0]", im_shape_data[0], im_shape_data[1]);
+    try {
+        // Color conversion and resize straight from the camera planes
+        StageTimer preprocess_timer(kStagePreprocess);
+        std::array<float, 2> scale_factor = PreprocessInto(*context, frame);
+        preprocess_timer.Stop();
+        RunBound(*context, scale_factor, frame.width, frame.height, conf_threshold, results);
+        return true;
+    } catch (const Ort::Exception& e) {
+        (void)e;
+        LOGD("Inference failed: %s", e.what());
+    } catch (const cv::Exception& e) {
+        (void)e;
+    } catch (const std::exception& e) {
+        (void)e;
+    }
+    results.clear();
+    return false;
+}
+
+void DocDetector::RunBound(RunContext& context, const std::array<float, 2>& scale_factor,
+                           int image_width, int image_height, float conf_threshold,
+                           std::vector<DetectionBox>& results) {
+    const bool is_l_model = descriptor_.variant == kModelVariantL;
+
+    // 2. Refresh the small inputs in place
+    if (is_l_model) {
+        // im_shape = original image size [h, w] (with letterbox: padded input size in original pixels)
+        // scale_factor = [1.0, 1.0] - L model uses im_shape internally to output original coords
+        context.im_shape = ImShape(scale_factor, image_width, image_height);
+    } else {
+        context.scale_factor = scale_factor;
+    }
+    if (descriptor_.half_side_inputs) {
+        floatsToHalves(context.scale_factor.data(), context.scale_half.data(), 2);
+        floatsToHalves(context.im_shape.data(), context.im_shape_half.data(), 2);
+    }
+
+    // 3. Run inference on the bound tensors
+    {
+        StageTimer run_timer(kStageRun);
+        // A cancelled or expired async request terminates the run, which throws
+        ScopedRunAttachment attachment(context.run_options);
+        session_.Run(context.run_options, context.binding);
+    }
+    arena_used_.store(true, std::memory_order_relaxed);
+    LOGD("Inference complete");
+    StageTimer parse_timer(kStageParse);
+
+    // 4. Parse output: [N, 6] = [class_id, score, x1, y1, x2, y2]
+    const float* output_data = nullptr;
+    const uint16_t* half_data = nullptr;
+    size_t output_elements = 0;
+    std::vector<Ort::Value> outputs;
+    if (static_output_) {
+        output_data = context.output_buffer.data();
+        half_data = context.output_half.data();
+        output_elements = descriptor_.half_boxes ? context.output_half.size() : context.output_buffer.size();
+    } else {
+        outputs = context.binding.GetOutputValues();
+        output_data = outputs[0].GetTensorData<float>();
+        half_data = outputs[0].GetTensorData<uint16_t>();
+        output_elements = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
+    }
+    if (descriptor_.half_boxes) {
+        // float16 boxes are widened once, filtering then runs on floats
+        context.output_widened.resize(output_elements);
+        halvesToFloats(half_data, context.output_widened.data(), output_elements);
+        output_data = context.output_widened.data();
+    }
+
+    int num_detections = static_cast<int>(output_elements / 6);
+    LOGD("Number of raw detections: %d", num_detections);
+
+    // 5. Convert to DetectionBox and restore to original image coordinates
+    // M model: output in model input space, need to scale back to original
+    // L model: output already in original space (scale_factor=[1,1]), no scaling needed
+    float inv_scale_x = is_l_model ? 1.0f : (1.0f / scale_factor[0]);
+    float inv_scale_y = is_l_model ? 1.0f : (1.0f / scale_factor[1]);
+    LOGD("Inverse scale: x=%.4f, y=%.4f (L model: %s)", inv_scale_x, inv_scale_y, is_l_model ? "yes" : "no");
+
+    results.reserve(results_capacity_);
+    AppendDetections(output_data, num_detections, inv_scale_x, inv_scale_y,
+                     image_width, image_height, conf_threshold, *Postprocess(), results);
+    LOGD("Detections passed threshold: %zu", results.size());
+}
+
+DecodedImage DocDetector::Decode(const uint8_t* data, size_t len) const {
+    StageTimer decode_timer(kStageDecode);
+    cv::Mat buffer = decode_pool_.Acquire();
+    if (options_.full_resolution_decode != 0) {
+        return decodeImageReduced(data, len, 0, 0, &buffer);
+    }
+    // With page_crop only part of the frame reaches the model, so keep
+    // enough pixels for a page covering about half of each side
+    const int boost = options_.page_crop != 0 ? kPageCropDecodeBoost : 1;
+    int width = 0, height = 0;
+    if (resize_mode_ == ResizeMode::kLetterbox && probeJpegSize(data, len, width, height)) {
+        // Only the scaled content has to be covered, so a tall receipt can
+        // be decoded further reduced than a stretched one
+        float scale = letterboxScale(width, height, input_width_, input_height_) * boost;
+        return decodeImageReduced(data, len, static_cast<int>(std::ceil(width * scale)),
+                                  static_cast<int>(std::ceil(height * scale)), &buffer);
+    }
+    return decodeImageReduced(data, len, input_width_ * boost, input_height_ * boost, &buffer);
+}
+
+void DocDetector::RecycleDecoded(DecodedImage& decoded) {
+    decode_pool_.Release(std::move(decoded.image));
+    decoded.image = cv::Mat();
+}
+
+DecodedImage DocDetector::ReducePage(cv::Mat page) const {
+    DecodedImage reduced;
+    reduced.original_width = page.cols;
+    reduced.original_height = page.rows;
+    int factor = 1;
+    if (options_.full_resolution_decode == 0 && !page.empty()) {
+        if (resize_mode_ == ResizeMode::kLetterbox) {
+            float scale = letterboxScale(page.cols, page.rows, input_width_, input_height_);
+            factor = reducedDecodeFactor(page.cols, page.rows, static_cast<int>(std::ceil(page.cols * scale)),
+                                         static_cast<int>(std::ceil(page.rows * scale)));
+        } else {
+            factor = reducedDecodeFactor(page.cols, page.rows, input_width_, input_height_);
+        }
+    }
+    if (factor == 1) {
+        reduced.image = std::move(page);
+        return reduced;
+    }
+    cv::resize(page, reduced.image, cv::Size((page.cols + factor - 1) / factor, (page.rows + factor - 1) / factor),
+               0, 0, cv::INTER_AREA);
+    return reduced;
+}
+
+void DocDetector::Preprocess(const cv::Mat& image, PixelFormat format, PreparedInput& input) const {
+    StageTimer preprocess_timer(kStagePreprocess);
+    const size_t elements = static_cast<size_t>(3) * input_height_ * input_width_;
+    input.image_width = image.cols;
+    input.image_height = image.rows;
+    if (descriptor_.half_image) {
+        input.tensor_half.resize(elements);
+        input.scale_factor = preprocessToTensor(image, format, input_width_, input_height_,
+                                                input.tensor_half.data(), resize_mode_);
+    } else {
+        input.tensor.resize(elements);
+        input.scale_factor = preprocessToTensor(image, format, input_width_, input_height_, input.tensor.data(),
+                                                resize_mode_);
+    }
+}
+
+bool DocDetector::Infer(PreparedInput& input, float conf_threshold, std::vector<DetectionBox>& results) {
+    results.clear();
+    const size_t elements = static_cast<size_t>(3) * input_height_ * input_width_;
+    const bool half = descriptor_.half_image;
+    if ((half ? input.tensor_half.size() : input.tensor.size()) != elements) {
+        return false;
+    }
+
+    ContextLease context(*this);
+
+    bool ok = false;
+    try {
+        // Point the bound image input at the staged tensor instead of copying it
+        const int64_t image_shape[] = {1, 3, input_height_, input_width_};
+        Ort::Value staged = half
+            ? WrapTensor(input.tensor_half.data(), elements, true, image_shape, 4)
+            : WrapTensor(input.tensor.data(), elements, false, image_shape, 4);
+        context->binding.BindInput(descriptor_.image_input.c_str(), staged);
+
+        RunBound(*context, input.scale_factor, input.image_width, input.image_height, conf_threshold, results);
+        ok = true;
+    } catch (const Ort::Exception& e) {
+        (void)e;
+        results.clear();
+    } catch (const std::exception& e) {
+        (void)e;
+        results.clear();
+    }
+
+    // Restore the context's own input buffer for Detect()
+    try {
+        context->binding.BindInput(descriptor_.image_input.c_str(), context->image_tensor);
+    } catch (const Ort::Exception& e) {
+        (void)e;
+        LOGD("Failed to rebind image input: %s", e.what());
+    }
+    return ok;
+}
+
+void DocDetector::DetectBatch(const std::vector<cv::Mat>& images, float conf_threshold,
+                              std::vector<std::vector<DetectionBox>>& results,
+                              std::vector<uint8_t>* succeeded) {
+    results.assign(images.size(), {});
+    // One byte per page, written by whichever thread runs that page
+    std::vector<uint8_t> local;
+    std::vector<uint8_t>& ok = succeeded != nullptr ? *succeeded : local;
+    ok.assign(images.size(), 0);
+
+    const size_t max_batch = options_.max_batch_size > 0
+        ? static_cast<size_t>(options_.max_batch_size) : kDefaultMaxBatch;
+
+    // Models exported with a fixed batch of 1 (or without per-image counts) go
+    // one by one, as many at a time as there are run contexts
+    if (!descriptor_.batch_capable || max_batch == 1) {
+        parallelFor(images.size(), contexts_.size(), [&](size_t i) {
+            ok[i] = DetectFrame(images[i], PixelFormat::kBGR, conf_threshold, results[i]) ? 1 : 0;
+        });
+        return;
+    }
+
+    // Empty images are skipped and keep an empty result
+    std::vector<size_t> pending;
+    pending.reserve(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+        if (!images[i].empty()) {
+            pending.push_back(i);
+        }
+    }
+
+    const size_t batches = (pending.size() + max_batch - 1) / max_batch;
+    parallelFor(batches, contexts_.size(), [&](size_t b) {
+        size_t first = b * max_batch;
+        size_t count = std::min(max_batch, pending.size() - first);
+        RunBatch(images, pending.data() + first, count, conf_threshold, results, ok);
+    });
+}
+
+WarmupStats DocDetector::Warmup(int iterations) {
+    WarmupStats stats;
+    iterations = std::max(1, iterations);
+
+    // Synthetic page: white paper with two columns of text-like bars, so the
+    // model finds boxes and the output buffers grow to a realistic size
+    cv::Mat page(input_height_, input_width_, CV_8UC3, cv::Scalar(255, 255, 255));
+    const int margin = std::max(8, input_width_ / 12);
+    const int column = (input_width_ - 3 * margin) / 2;
+    const int line = std::max(4, input_height_ / 80);
+    for (int y = margin; y + line < input_height_ - margin; y += line * 2) {
+        page(cv::Rect(margin, y, column, line)).setTo(cv::Scalar(40, 40, 40));
+        page(cv::Rect(2 * margin + column, y, column, line)).setTo(cv::Scalar(40, 40, 40));
+    }
+
+    // Every context has its own bound buffers; run them all at once so each
+    // one is leased and warmed
+    const size_t contexts = contexts_.size();
+    const size_t runs = contexts * static_cast<size_t>(iterations);
+    std::vector<double> times(runs, 0.0);
+    parallelFor(runs, contexts, [&](size_t i) {
+        ScopedStatsPause pause;
+        std::vector<DetectionBox> results;
+        const auto start = std::chrono::steady_clock::now();
+        DetectFrame(page, PixelFormat::kBGR, 0.5f, results);
+        times[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    });
+
+    // Batch runs allocate their own, larger buffers
+    if (descriptor_.batch_capable && options_.max_batch_size != 1) {
+        ScopedStatsPause pause;
+        const size_t batch = options_.max_batch_size > 0
+            ? static_cast<size_t>(options_.max_batch_size) : kDefaultMaxBatch;
+        std::vector<cv::Mat> pages(batch, page);
+        std::vector<std::vector<DetectionBox>> results;
+        DetectBatch(pages, 0.5f, results);
+    }
+
+    stats.runs = static_cast<int>(runs);
+    stats.first_ms = times.front();
+    stats.last_ms = times.back();
+    double total = 0.0;
+    for (double ms : times) {
+        total += ms;
+    }
+    stats.mean_ms = total / runs;
+    LOGD("Warm-up: %d runs, first %.1f ms, last %.1f ms", stats.runs, stats.first_ms, stats.last_ms);
+    return stats;
+}
+
+void DocDetector::TrimMemory(bool shrink_arena) {
+    decode_pool_.Trim();
+
+    // Lease every context so no run is using the buffers that go
+    std::vector<RunContext*> leased = AcquireAllContexts();
+    for (RunContext* context : leased) {
+        // Grown again by the next batch or float16 run that needs them
+        std::vector<float>().swap(context->batch_image);
+        std::vector<float>().swap(context->batch_scale);
+        std::vector<float>().swap(context->batch_im_shape);
+        std::vector<uint16_t>().swap(context->batch_image_half);
+        std::vector<uint16_t>().swap(context->batch_side_half);
+        std::vector<float>().swap(context->output_widened);
+    }
+
+    // ONNX Runtime has no call to shrink an arena outside a run; one run
+    // with shrinkage on returns every block no live tensor is using
+    const bool shrink = shrink_arena && options_.disable_cpu_arena == 0 &&
+                        options_.shrink_arena_after_run == 0 && !leased.empty() && arena_used_.exchange(false);
+    if (shrink) {
+        ScopedStatsPause pause;
+        Ort::RunOptions run_options;
+        run_options.AddConfigEntry("memory.enable_memory_arena_shrinkage", "cpu:0");
+        try {
+            session_.Run(run_options, leased.front()->binding);
+        } catch (const Ort::Exception& e) {
+            (void)e;
+            LOGD("Arena shrink run failed: %s", e.what());
+        }
+    }
+
+    ReleaseAllContexts(leased);
+    LOGD("Memory trimmed%s", shrink ? ", arena shrunk" : "");
+}
+
+int DocDetector::TileSize(int width, int height, const TileOptions& options) const {
+    if (options.tile_size > 0) {
+        return options.tile_size;
+    }
+    const int longest = std::max(width, height);
+    return std::max(std::max(input_width_, input_height_), (longest + 1) / 2);
+}
+
+DecodedImage DocDetector::DecodeForTiles(const uint8_t* data, size_t len, const TileOptions& options) const {
+    StageTimer decode_timer(kStageDecode);
+    int width = 0, height = 0;
+    if (options_.full_resolution_decode != 0 || !probeJpegSize(data, len, width, height)) {
+        return decodeImageReduced(data, len, 0, 0);
+    }
+    // Scale at which one tile still covers the model input
+    const float scale = static_cast<float>(std::max(input_width_, input_height_)) /
+                        TileSize(width, height, options);
+    return decodeImageReduced(data, len, static_cast<int>(std::ceil(width * scale)),
+                              static_cast<int>(std::ceil(height * scale)));
+}
+
+bool DocDetector::DetectRegion(const cv::Mat& image, const cv::Rect& region, float conf_threshold,
+                               std::vector<DetectionBox>& results) {
+    const cv::Rect rect = region & cv::Rect(0, 0, image.cols, image.rows);
+    if (rect.width <= 0 || rect.height <= 0) {
+        results.clear();
+        return true;
+    }
+    // ROI view, no pixels are copied
+    if (!DetectFrame(image(rect), PixelFormat::kBGR, conf_threshold, results)) {
+        return false;
+    }
+    for (DetectionBox& box : results) {
+        box.x1 += rect.x;
+        box.y1 += rect.y;
+        box.x2 += rect.x;
+        box.y2 += rect.y;
+    }
+    return true;
+}
+
+DecodedImage DocDetector::DecodeForRegion(const uint8_t* data, size_t len, const cv::Rect& region) const {
+    int width = 0, height = 0;
+    if (region.width <= 0 || region.height <= 0 || options_.full_resolution_decode != 0 ||
+        !probeJpegSize(data, len, width, height)) {
+        return Decode(data, len);
+    }
+    StageTimer decode_timer(kStageDecode);
+    // Scale at which the region still covers the model input
+    const double scale = std::max(static_cast<double>(input_width_) / std::min(region.width, width),
+                                  static_cast<double>(input_height_) / std::min(region.height, height));
+    return decodeImageReduced(data, len, static_cast<int>(std::ceil(width * scale)),
+                              static_cast<int>(std::ceil(height * scale)));
+}
+
+bool DocDetector::DetectTiled(const cv::Mat& image, float conf_threshold, const TileOptions& options,
+                              std::vector<DetectionBox>& results) {
+    results.clear();
+    if (image.empty()) {
+        return false;
+    }
+
+    const int tile = std::min(TileSize(image.cols, image.rows, options), std::max(image.cols, image.rows));
+    const float overlap = std::max(0.0f, std::min(options.overlap, 0.9f));
+    const std::vector<int> xs = tileOffsets(image.cols, tile, overlap);
+    const std::vector<int> ys = tileOffsets(image.rows, tile, overlap);
+    if (xs.size() == 1 && ys.size() == 1) {
+        return DetectFrame(image, PixelFormat::kBGR, conf_threshold, results);
+    }
+
+    // Tiles are ROI views into the page, no pixels are copied
+    std::vector<cv::Rect> rects;
+    std::vector<cv::Mat> views;
+    if (options.full_page) {
+        rects.emplace_back(0, 0, image.cols, image.rows);
+        views.push_back(image);
+    }
+    for (int y : ys) {
+        for (int x : xs) {
+            rects.emplace_back(x, y, std::min(tile, image.cols - x), std::min(tile, image.rows - y));
+            views.push_back(image(rects.back()));
+        }
+    }
+
+    std::vector<std::vector<DetectionBox>> per_view;
+    std::vector<uint8_t> succeeded;
+    DetectBatch(views, conf_threshold, per_view, &succeeded);
+    // A missing view would leave a hole in the page, not fewer boxes
+    if (std::find(succeeded.begin(), succeeded.end(), 0) != succeeded.end()) {
+        return false;
+    }
+
+    // Boxes touching an edge that is inside the page were cut by the tile;
+    // the whole-page pass (or the neighbouring tile) has the complete box
+    const float kEdgeMargin = 2.0f;
+    for (size_t v = 0; v < views.size(); v++) {
+        const cv::Rect& rect = rects[v];
+        const bool is_tile = !(options.full_page && v == 0);
+        const bool inner_left = rect.x > 0;
+        const bool inner_top = rect.y > 0;
+        const bool inner_right = rect.x + rect.width < image.cols;
+        const bool inner_bottom = rect.y + rect.height < image.rows;
+        for (DetectionBox box : per_view[v]) {
+            if (is_tile && options.full_page &&
+                ((inner_left && box.x1 <= kEdgeMargin) || (inner_top && box.y1 <= kEdgeMargin) ||
+                 (inner_right && box.x2 >= rect.width - kEdgeMargin) ||
+                 (inner_bottom && box.y2 >= rect.height - kEdgeMargin))) {
+                continue;
+            }
+            box.x1 += rect.x;
+            box.y1 += rect.y;
+            box.x2 += rect.x;
+            box.y2 += rect.y;
+            results.push_back(std::move(box));
+        }
+    }
+
+    nmsDetections(results, options.nms_iou > 0.0f ? options.nms_iou : 0.5f);
+
+    // Containment and reading order are page-level, redo them on the merged boxes
+    PostprocessOptions page_pass = *Postprocess();
+    page_pass.nms_iou = 0.0f;
+    refineDetections(results, page_pass);
+    LOGD("Tiled detection: %zu views (%zux%zu tiles of %d px), %zu boxes",
+         views.size(), xs.size(), ys.size(), tile, results.size());
+    return true;
+}
+
+void DocDetector::RunBatch(const std::vector<cv::Mat>& images, const size_t* indices, size_t count,
+                           float conf_threshold, std::vector<std::vector<DetectionBox>>& results,
+                           std::vector<uint8_t>& succeeded) {
+    ContextLease context(*this);
+    std::vector<float>& batch_image = context->batch_image;
+    std::vector<float>& batch_scale = context->batch_scale;
+    std::vector<float>& batch_im_shape = context->batch_im_shape;
+    const bool is_l_model = descriptor_.variant == kModelVariantL;
+    const bool half_image = descriptor_.half_image;
+    const bool half_side = descriptor_.half_side_inputs;
+
+    try {
+        // 1. Preprocess every page into its slice of the N x 3 x H x W input
+        const size_t image_elements = static_cast<size_t>(3) * input_height_ * input_width_;
+        if (half_image) {
+            context->batch_image_half.resize(count * image_elements);
         } else {
-            // M model: image, scale_factor
-            input_names = {"image", "scale_factor"};
-            input_tensors.push_back(std::move(image_tensor));
+            batch_image.resize(count * image_elements);
+        }
+        batch_scale.resize(count * 2);
+        batch_im_shape.resize(count * 2);
+
+        for (size_t j = 0; j < count; j++) {
+            const cv::Mat& image = images[indices[j]];
+            StageTimer preprocess_timer(kStagePreprocess);
+            std::array<float, 2> scale_factor = half_image
+                ? preprocessToTensor(image, PixelFormat::kBGR, input_width_, input_height_,
+                                     context->batch_image_half.data() + j * image_elements, resize_mode_)
+                : preprocessToTensor(image, PixelFormat::kBGR, input_width_, input_height_,
+                                     batch_image.data() + j * image_elements, resize_mode_);
+            if (is_l_model) {
+                std::array<float, 2> im_shape = ImShape(scale_factor, image.cols, image.rows);
+                batch_im_shape[j * 2 + 0] = im_shape[0];
+                batch_im_shape[j * 2 + 1] = im_shape[1];
+                batch_scale[j * 2 + 0] = 1.0f;
+                batch_scale[j * 2 + 1] = 1.0f;
+            } else {
+                batch_scale[j * 2 + 0] = scale_factor[0];
+                batch_scale[j * 2 + 1] = scale_factor[1];
+            }
+        }
+
+        // 2. Wrap the batch buffers; float16 side inputs are [scale | im_shape] in one buffer
+        const int64_t n = static_cast<int64_t>(count);
+        const int64_t image_shape[] = {n, 3, input_height_, input_width_};
+        const int64_t pair_shape[] = {n, 2};
+        std::vector<uint16_t>& side_half = context->batch_side_half;
+        if (half_side) {
+            side_half.resize(count * 4);
+            floatsToHalves(batch_scale.data(), side_half.data(), count * 2);
+            floatsToHalves(batch_im_shape.data(), side_half.data() + count * 2, count * 2);
+        }
+
+        Ort::Value image_tensor = half_image
+            ? WrapTensor(context->batch_image_half.data(), count * image_elements, true, image_shape, 4)
+            : WrapTensor(batch_image.data(), count * image_elements, false, image_shape, 4);
+        Ort::Value scale_tensor = half_side
+            ? WrapTensor(side_half.data(), count * 2, true, pair_shape, 2)
+            : WrapTensor(batch_scale.data(), count * 2, false, pair_shape, 2);
+
+        std::vector<Ort::Value> input_tensors;
+        std::vector<const char*> input_names;
+        if (!descriptor_.shape_input.empty()) {
+            input_tensors.push_back(half_side
+                ? WrapTensor(side_half.data() + count * 2, count * 2, true, pair_shape, 2)
+                : WrapTensor(batch_im_shape.data(), count * 2, false, pair_shape, 2));
+            input_names.push_back(descriptor_.shape_input.c_str());
+        }
+        input_tensors.push_back(std::move(image_tensor));
+        input_names.push_back(descriptor_.image_input.c_str());
+        if (!descriptor_.scale_input.empty()) {
             input_tensors.push_back(std::move(scale_tensor));
-            LOGD("Using M model format (2 inputs)");
+            input_names.push_back(descriptor_.scale_input.c_str());
         }
 
-        outputs = session.Run(
-            Ort::RunOptions{nullptr},
+        // 3. One Run for the whole batch: boxes of all pages plus the per-page box count
+        const char* output_names[] = {descriptor_.boxes_output.c_str(), descriptor_.count_output.c_str()};
+        StageTimer run_timer(kStageRun);
+        ScopedRunAttachment attachment(context->run_options);
+        std::vector<Ort::Value> outputs = session_.Run(
+            context->run_options,
             input_names.data(), input_tensors.data(), input_tensors.size(),
-            output_names.data(), output_names.size());
-
-        LOGD("Inference complete");
-
-        // 7. Parse output: [N, 6] = [x1, y1, x2, y2, score, class_id]
-        auto output_shape = outputs[0].GetTensorTypeAndShapeInfo().GetShape();
-        LOGD("Output shape: dims=%zu", output_shape.size());
-        for (size_t i = 0; i < output_shape.size(); i++) {
-            LOGD("  dim[%zu] = %lld", i, output_shape[i]);
-        }
-
-        int num_detections = static_cast<int>(output_shape[0]);
-        LOGD("Number of raw detections: %d", num_detections);
-
-        float* output_data = outputs[0].GetTensorMutableData<float>();
-
-        // PP-DocLayout output format: [class_id, score, x1, y1, x2, y2]
-        // Log first few raw outputs
-        int log_count = std::min(5, num_detections);
-        for (int i = 0; i < log_count; i++) {
-            LOGD("Raw detection %d: class=%.0f, score=%.4f, x1=%.2f, y1=%.2f, x2=%.2f, y2=%.2f",
-                i, output_data[i*6+0], output_data[i*6+1], output_data[i*6+2],
-                output_data[i*6+3], output_data[i*6+4], output_data[i*6+5]);
-        }
-
-        // 8. Convert to DetectionBox and restore to original image coordinates
-        // M model: output in 640 space, need to scale back to original
-        // L model: output already in original space (scale_factor=[1,1]), no scaling needed
-        float inv_scale_x = is_l_model ? 1.0f : (1.0f / scale_factor[0]);
-        float inv_scale_y = is_l_model ? 1.0f : (1.0f / scale_factor[1]);
-        LOGD("Inverse scale: x=%.4f, y=%.4f (L model: %s)", inv_scale_x, inv_scale_y, is_l_model ? "yes" : "no");
-
-        int passed_count = 0;
-        for (int i = 0; i < num_detections; i++) {
-            // Format: [class_id, score, x1, y1, x2, y2]
-            int class_id = static_cast<int>(output_data[i * 6 + 0]);
-            float score = output_data[i * 6 + 1];
-            float x1 = output_data[i * 6 + 2];
-            float y1 = output_data[i * 6 + 3];
-            float x2 = output_data[i * 6 + 4];
-            float y2 = output_data[i * 6 + 5];
-
-            if (score >= conf_threshold && class_id >= 0 && class_id < static_cast<int>(DOC_CLASSES.size())) {
-                DetectionBox box;
-                box.x1 = x1 * inv_scale_x;
-                box.y1 = y1 * inv_scale_y;
-                box.x2 = x2 * inv_scale_x;
-                box.y2 = y2 * inv_scale_y;
-
-                // Clamp coordinates to image bounds
-                box.x1 = std::max(0.0f, std::min(box.x1, static_cast<float>(image.cols)));
-                box.y1 = std::max(0.0f, std::min(box.y1, static_cast<float>(image.rows)));
-                box.x2 = std::max(0.0f, std::min(box.x2, static_cast<float>(image.cols)));
-                box.y2 = std::max(0.0f, std::min(box.y2, static_cast<float>(image.rows)));
-
-                box.score = score;
-                box.class_id = class_id;
-                box.class_name = DOC_CLASSES[class_id];
-                results.push_back(box);
-                passed_count++;
-                LOGD("Passed: class=%d (%s), score=%.4f, box=[%.1f,%.1f,%.1f,%.1f]",
-                    class_id, box.class_name.c_str(), score, box.x1, box.y1, box.x2, box.y2);
-            }
+            output_names, 2);
+        run_timer.Stop();
+        arena_used_.store(true, std::memory_order_relaxed);
+        StageTimer parse_timer(kStageParse);
+
+        // 4. Split [total, 6] back into pages using bbox_num
+        std::shared_ptr<const PostprocessOptions> postprocess = Postprocess();
+        const float* rows = outputs[0].GetTensorData<float>();
+        const size_t total_rows = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount() / 6;
+        if (descriptor_.half_boxes) {
+            context->output_widened.resize(total_rows * 6);
+            halvesToFloats(outputs[0].GetTensorData<uint16_t>(), context->output_widened.data(), total_rows * 6);
+            rows = context->output_widened.data();
+        }
+
+        auto count_info = outputs[1].GetTensorTypeAndShapeInfo();
+        const bool counts_are_int64 = count_info.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64;
+        auto page_rows = [&](size_t j) -> size_t {
+            int64_t value = counts_are_int64 ? outputs[1].GetTensorData<int64_t>()[j]
+                                             : outputs[1].GetTensorData<int32_t>()[j];
+            return value > 0 ? static_cast<size_t>(value) : 0;
+        };
+
+        size_t offset = 0;
+        for (size_t j = 0; j < count && j < count_info.GetElementCount(); j++) {
+            const cv::Mat& image = images[indices[j]];
+            size_t num_rows = std::min(page_rows(j), total_rows - offset);
+
+            // M model: output in model input space, L model: already in original space
+            float inv_scale_x = is_l_model ? 1.0f : (1.0f / batch_scale[j * 2 + 0]);
+            float inv_scale_y = is_l_model ? 1.0f : (1.0f / batch_scale[j * 2 + 1]);
+
+            std::vector<DetectionBox>& page = results[indices[j]];
+            AppendDetections(rows + offset * 6, static_cast<int>(num_rows), inv_scale_x, inv_scale_y,
+                             image.cols, image.rows, conf_threshold, *postprocess, page);
+            offset += num_rows;
+        }
+        LOGD("Batch of %zu pages: %zu raw rows", count, total_rows);
+        for (size_t j = 0; j < count; j++) {
+            succeeded[indices[j]] = 1;
         }
-        LOGD("Detections passed threshold: %d", passed_count);
 
     } catch (const Ort::Exception& e) {
         (void)e;
+        LOGD("Batch inference failed: %s", e.what());
     } catch (const cv::Exception& e) {
         (void)e;
     } catch (const std::exception& e) {
         (void)e;
     }
 
-    return results;
+    // A failed run may have converted some pages before throwing
+    for (size_t j = 0; j < count; j++) {
+        if (!succeeded[indices[j]]) {
+            results[indices[j]].clear();
+        }
+    }
+}
+
+std::string DocDetector::EndProfiling() {
+    if (options_.profile_prefix.empty()) {
+        return std::string();
+    }
+    ContextLease context(*this);
+    try {
+        Ort::AllocatorWithDefaultOptions allocator;
+        Ort::AllocatedStringPtr path = session_.EndProfilingAllocated(allocator);
+        return path ? std::string(path.get()) : std::string();
+    } catch (const Ort::Exception& e) {
+        (void)e;
+        LOGD("EndProfiling failed: %s", e.what());
+        return std::string();
+    }
+}
+
+void mapDetectionsToOriginal(std::vector<DetectionBox>& detections, int decoded_width, int decoded_height,
+                             int original_width, int original_height) {
+    if (decoded_width <= 0 || decoded_height <= 0 ||
+        (decoded_width == original_width && decoded_height == original_height)) {
+        return;
+    }
+    const float sx = static_cast<float>(original_width) / decoded_width;
+    const float sy = static_cast<float>(original_height) / decoded_height;
+    const float max_x = static_cast<float>(original_width);
+    const float max_y = static_cast<float>(original_height);
+    for (DetectionBox& box : detections) {
+        box.x1 = std::min(box.x1 * sx, max_x);
+        box.y1 = std::min(box.y1 * sy, max_y);
+        box.x2 = std::min(box.x2 * sx, max_x);
+        box.y2 = std::min(box.y2 * sy, max_y);
+    }
+}
+
+const char* className(const std::vector<std::string>& class_names, int class_id) {
+    return class_id >= 0 && class_id < static_cast<int>(class_names.size())
+        ? class_names[class_id].c_str() : "unknown";
 }
 
-std::string detectionsToJson(const std::vector<DetectionBox>& detections) {
+std::string detectionsToJson(const std::vector<DetectionBox>& detections,
+                             const std::vector<std::string>& class_names) {
     std::ostringstream json;
     json << "{\"detections\":[";
 
@@ -206,7 +1306,7 @@ std::string detectionsToJson(const std::vector<DetectionBox>& detections) {
         json << "\"y2\":" << box.y2 << ",";
         json << "\"score\":" << std::setprecision(4) << box.score << ",";
         json << "\"class_id\":" << box.class_id << ",";
-        json << "\"class_name\":\"" << box.class_name << "\"";
+        json << "\"class_name\":\"" << className(class_names, box.class_id) << "\"";
         json << "}";
         if (i < detections.size() - 1) {
             json << ",";
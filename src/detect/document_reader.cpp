@@ -0,0 +1,135 @@
+#include "include/document_reader.h"
+#include "include/latency_stats.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Leading bytes of the file, fewer if it is shorter
+std::string readMagic(const std::string& path, size_t count) {
+    std::ifstream file(path, std::ios::binary);
+    std::string magic(count, '\0');
+    file.read(&magic[0], static_cast<std::streamsize>(count));
+    magic.resize(static_cast<size_t>(std::max<std::streamsize>(file.gcount(), 0)));
+    return magic;
+}
+
+}  // namespace
+
+bool DocumentReader::Open(const std::string& path, std::string& error, std::string& error_code) {
+    path_ = path;
+    page_count_ = 0;
+
+    const std::string magic = readMagic(path, 5);
+    if (magic.empty()) {
+        error = "Could not load image";
+        error_code = "IMAGE_LOAD_FAILED";
+        return false;
+    }
+    if (magic == "%PDF-") {
+        // Rasterize on the platform side (PdfRenderer, PDFKit) and use a page stream
+        error = "PDF documents are not supported";
+        error_code = "UNSUPPORTED_FORMAT";
+        return false;
+    }
+
+    try {
+        page_count_ = cv::imcount(path, cv::IMREAD_COLOR);
+    } catch (const cv::Exception& e) {
+        (void)e;
+        page_count_ = 0;
+    }
+    if (page_count_ == 0) {
+        error = "Could not load image";
+        error_code = "IMAGE_LOAD_FAILED";
+        return false;
+    }
+    return true;
+}
+
+cv::Mat DocumentReader::ReadPage(size_t index) const {
+    std::vector<cv::Mat> pages;
+    try {
+        if (!cv::imreadmulti(path_, pages, static_cast<int>(index), 1, cv::IMREAD_COLOR) || pages.empty()) {
+            return cv::Mat();
+        }
+    } catch (const cv::Exception& e) {
+        (void)e;
+        return cv::Mat();
+    }
+    return pages.front();
+}
+
+std::string DocumentSummary::ToJson() const {
+    std::ostringstream json;
+    if (!error.empty()) {
+        json << "{\"error\":\"" << error << "\",\"code\":\"" << error_code << "\"}";
+    } else {
+        json << "{\"total_pages\":" << total_pages << ",\"pages\":" << pages
+             << ",\"cancelled\":" << (cancelled ? "true" : "false") << "}";
+    }
+    return json.str();
+}
+
+DocumentStream::DocumentStream(std::shared_ptr<DocDetector> detector, std::string path, float conf_threshold,
+                               const DocumentOptions& options, PagePipeline::Serializer serializer,
+                               PagePipeline::PageCallback page_callback, DoneCallback done_callback)
+    : detector_(std::move(detector)),
+      path_(std::move(path)),
+      conf_threshold_(conf_threshold),
+      options_(options),
+      serializer_(std::move(serializer)),
+      page_callback_(std::move(page_callback)),
+      done_callback_(std::move(done_callback)) {
+    reader_ = std::thread(&DocumentStream::Run, this);
+}
+
+DocumentStream::~DocumentStream() {
+    Cancel();
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+}
+
+void DocumentStream::Run() {
+    DocumentSummary summary;
+    DocumentReader reader;
+    if (!reader.Open(path_, summary.error, summary.error_code)) {
+        done_callback_(summary);
+        return;
+    }
+    summary.total_pages = reader.PageCount();
+
+    const size_t first = std::min(options_.first_page, summary.total_pages);
+    const size_t last = options_.page_count > 0 ? std::min(summary.total_pages, first + options_.page_count)
+                                                : summary.total_pages;
+
+    // Pipeline indices count from 0; callers get the page's index in the file
+    PagePipeline::PageCallback page_callback = page_callback_;
+    PagePipeline pipeline(
+        detector_, conf_threshold_, options_.queue_depth, serializer_,
+        [first, page_callback](size_t page_index, std::string result) {
+            page_callback(first + page_index, std::move(result));
+        });
+
+    for (size_t page = first; page < last; page++) {
+        if (cancelled_) {
+            summary.cancelled = true;
+            break;
+        }
+        DecodedImage decoded;
+        {
+            StageTimer decode_timer(kStageDecode);
+            decoded = detector_->ReducePage(reader.ReadPage(page));
+        }
+        // Blocks while the pipeline holds queue_depth pages per stage
+        if (pipeline.SubmitDecoded(std::move(decoded)) < 0) {
+            break;
+        }
+        summary.pages++;
+    }
+
+    pipeline.Finish();
+    done_callback_(summary);
+}
@@ -0,0 +1,154 @@
+#include "include/frame_tracker.h"
+
+namespace {
+
+float iou(const DetectionBox& a, const DetectionBox& b) {
+    float ix = std::max(0.0f, std::min(a.x2, b.x2) - std::max(a.x1, b.x1));
+    float iy = std::max(0.0f, std::min(a.y2, b.y2) - std::max(a.y1, b.y1));
+    float inter = ix * iy;
+    float uni = (a.x2 - a.x1) * (a.y2 - a.y1) + (b.x2 - b.x1) * (b.y2 - b.y1) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+// Mean absolute difference of two equally sized CV_8UC1 thumbnails, 0-1
+float thumbnailChange(const cv::Mat& a, const cv::Mat& b) {
+    cv::Mat diff;
+    cv::absdiff(a, b, diff);
+    return static_cast<float>(cv::mean(diff)[0] / 255.0);
+}
+
+int grayConversion(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::kBGR:  return cv::COLOR_BGR2GRAY;
+        case PixelFormat::kRGB:  return cv::COLOR_RGB2GRAY;
+        case PixelFormat::kBGRA: return cv::COLOR_BGRA2GRAY;
+        case PixelFormat::kRGBA: return cv::COLOR_RGBA2GRAY;
+        case PixelFormat::kGray: break;
+    }
+    return -1;
+}
+
+}  // namespace
+
+FrameTracker::FrameTracker(std::shared_ptr<DocDetector> detector, const TrackerOptions& options)
+    : detector_(std::move(detector)),
+      change_threshold_(options.change_threshold > 0.0f ? options.change_threshold : kDefaultChangeThreshold),
+      max_age_ms_(options.max_age_ms > 0 ? options.max_age_ms : kDefaultMaxAgeMs),
+      smoothing_(options.smoothing > 0.0f ? std::min(options.smoothing, 1.0f)
+                 : (options.smoothing < 0.0f ? 0.0f : kDefaultSmoothing)) {}
+
+bool FrameTracker::Track(const cv::Mat& frame, PixelFormat format, float conf_threshold, TrackedFrame& result) {
+    result.detections.clear();
+    result.reused = false;
+    result.change = 1.0f;
+    if (frame.empty()) {
+        return false;
+    }
+
+    // Area-average down to the thumbnail first, convert the few pixels left to luma
+    cv::Mat small, thumbnail;
+    cv::resize(frame, small, cv::Size(kThumbnailSize, kThumbnailSize), 0, 0, cv::INTER_AREA);
+    int code = grayConversion(format);
+    if (code >= 0) {
+        cv::cvtColor(small, thumbnail, code);
+    } else {
+        thumbnail = small;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (CanReuse(thumbnail, frame.cols, frame.rows, conf_threshold, result.change)) {
+        result.detections = cached_;
+        result.reused = true;
+        return true;
+    }
+
+    // A failed frame must not become the reference, its empty result would be reused
+    if (!detector_->Detect(frame, format, conf_threshold, result.detections)) {
+        return false;
+    }
+    Update(thumbnail, frame.cols, frame.rows, conf_threshold, result.detections);
+    return true;
+}
+
+bool FrameTracker::Track(const YuvPlanes& frame, float conf_threshold, TrackedFrame& result) {
+    result.detections.clear();
+    result.reused = false;
+    result.change = 1.0f;
+    if (frame.y == nullptr || frame.width <= 0 || frame.height <= 0) {
+        return false;
+    }
+
+    // The luma plane alone is enough for the change metric
+    cv::Mat luma(frame.height, frame.width, CV_8UC1, const_cast<uint8_t*>(frame.y),
+                 static_cast<size_t>(frame.y_row_stride));
+    cv::Mat thumbnail;
+    cv::resize(luma, thumbnail, cv::Size(kThumbnailSize, kThumbnailSize), 0, 0, cv::INTER_AREA);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (CanReuse(thumbnail, frame.width, frame.height, conf_threshold, result.change)) {
+        result.detections = cached_;
+        result.reused = true;
+        return true;
+    }
+
+    if (!detector_->Detect(frame, conf_threshold, result.detections)) {
+        return false;
+    }
+    Update(thumbnail, frame.width, frame.height, conf_threshold, result.detections);
+    return true;
+}
+
+void FrameTracker::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    has_reference_ = false;
+    cached_.clear();
+}
+
+bool FrameTracker::CanReuse(const cv::Mat& thumbnail, int width, int height, float conf_threshold,
+                            float& change) const {
+    if (!has_reference_ || width != reference_width_ || height != reference_height_ ||
+        conf_threshold != reference_conf_) {
+        change = 1.0f;
+        return false;
+    }
+    change = thumbnailChange(thumbnail, reference_);
+
+    auto age = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - reference_time_).count();
+    return change < change_threshold_ && age < max_age_ms_;
+}
+
+void FrameTracker::Update(const cv::Mat& thumbnail, int width, int height, float conf_threshold,
+                          std::vector<DetectionBox>& detections) {
+    // Pull each box toward its previous position (same class, overlapping)
+    if (has_reference_ && smoothing_ > 0.0f && width == reference_width_ && height == reference_height_) {
+        for (DetectionBox& box : detections) {
+            const DetectionBox* match = nullptr;
+            float best = 0.5f;
+            for (const DetectionBox& prev : cached_) {
+                if (prev.class_id != box.class_id) {
+                    continue;
+                }
+                float overlap = iou(box, prev);
+                if (overlap > best) {
+                    best = overlap;
+                    match = &prev;
+                }
+            }
+            if (match != nullptr) {
+                const float w = smoothing_;
+                box.x1 = box.x1 * (1.0f - w) + match->x1 * w;
+                box.y1 = box.y1 * (1.0f - w) + match->y1 * w;
+                box.x2 = box.x2 * (1.0f - w) + match->x2 * w;
+                box.y2 = box.y2 * (1.0f - w) + match->y2 * w;
+            }
+        }
+    }
+
+    thumbnail.copyTo(reference_);
+    reference_width_ = width;
+    reference_height_ = height;
+    reference_conf_ = conf_threshold;
+    reference_time_ = Clock::now();
+    cached_ = detections;
+    has_reference_ = true;
+}
@@ -3,18 +3,30 @@
 
 #include "utils.h"
 #include "config_manager.h"
+#include "model_descriptor.h"
+#include "model_variant.h"
+#include "mapped_file.h"
+#include "memory_stats.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
-// Detection result structure
+// Detection result structure. Names are looked up at serialization from
+// the model's class table (ModelDescriptor::class_names, className()).
 struct DetectionBox {
     float x1, y1, x2, y2;  // Bounding box coordinates (in original image space)
     float score;           // Confidence score
     int class_id;          // Class ID (0-22)
-    std::string class_name; // Class name
 };
 
-// 23 document element classes
+struct PostprocessOptions;
+
+// 23 document element classes, used when the model carries no class table
 const std::vector<std::string> DOC_CLASSES = {
     "paragraph_title",  // 0
     "image",           // 1
@@ -41,10 +53,437 @@ const std::vector<std::string> DOC_CLASSES = {
     "aside_text"       // 22
 };
 
-// Main detection function
+// Graph optimization levels (DetectorOptions::graph_optimization_level)
+enum GraphOptimization {
+    kGraphOptDefault = 0,   // leave ONNX Runtime's default
+    kGraphOptDisable = 1,
+    kGraphOptBasic = 2,
+    kGraphOptExtended = 3,
+    kGraphOptAll = 4,
+};
+
+// Execution provider bits (DetectorOptions::execution_providers)
+enum ExecutionProvider {
+    kProviderCpu = 0,
+    kProviderNnapi = 1 << 0,     // Android only
+    kProviderXnnpack = 1 << 1,
+    kProviderCoreML = 1 << 2,    // iOS/macOS only
+};
+
+// How the CPU arena grows when a run needs more (DetectorOptions::arena_extend_strategy)
+enum ArenaExtendStrategy {
+    kArenaExtendDefault = 0,            // leave ONNX Runtime's default (next power of two)
+    kArenaExtendNextPowerOfTwo = 1,     // fewer, larger blocks; up to 2x slack
+    kArenaExtendSameAsRequested = 2,    // exactly what the run asked for, least slack
+};
+
+// Session configuration for a detector instance. Zero per-run allocation
+// needs a static output shape, see DocDetector.
+struct DetectorOptions {
+    int intra_op_threads = 0;   // 0 = ONNX Runtime default
+    int inter_op_threads = 0;   // 0 = ONNX Runtime default
+    int graph_optimization_level = kGraphOptDefault;
+    int execution_providers = kProviderCpu;  // ExecutionProvider bits, CPU is always the fallback
+    int max_batch_size = 0;     // pages per session.Run in DetectBatch, 0 = default (8)
+    int full_resolution_decode = 0;  // 1 = never use reduced-resolution JPEG decoding
+    std::string profile_prefix;      // non-empty = ONNX Runtime profiling to <prefix>_<timestamp>.json
+    int max_concurrent_runs = 0;     // inferences in flight on the shared session, 0 = 1 (serialized)
+    int input_size = 0;              // square model input, rounded up to a multiple of 32; 0 = 640.
+                                     // Ignored for models exported with a static image size
+    int letterbox = 0;               // 1 = keep the aspect ratio and pad instead of stretching
+    int precision = kPrecisionModel; // ModelPrecision: load the given file, a fixed variant or the
+                                     // fastest variant for this device (model.int8.onnx, model.fp16.onnx)
+    int disable_memory_map = 0;      // 1 = let ONNX Runtime read the model into the heap instead of mapping it
+    std::string optimized_model_dir; // non-empty = save the optimized graph there as .ort on first load and
+                                     // load that on later starts (CPU only, providers compile their own)
+    // Memory budget. The arena settings configure one CPU arena shared by all
+    // detectors in the process that set any of them; the first such detector
+    // creates it and later ones use it as is.
+    int disable_cpu_arena = 0;       // 1 = no CPU arena: run buffers are freed after every run, runs allocate more
+    int arena_extend_strategy = kArenaExtendDefault;
+    int64_t arena_initial_chunk_bytes = 0;  // first arena block, 0 = ONNX Runtime default
+    int64_t arena_max_bytes = 0;     // cap on the CPU arena, 0 = none; a run that needs more fails
+    int shrink_arena_after_run = 0;  // 1 = hand arena growth back at the end of every run
+    int decode_pool_size = 0;        // decoded page buffers kept for reuse, 0 = 2, < 0 = none
+    int page_crop = 0;               // 1 = find the page outline in single-image calls and warp only the page
+                                     // into the model input (camera captures with background around the page)
+
+    bool operator==(const DetectorOptions& other) const {
+        return intra_op_threads == other.intra_op_threads &&
+               inter_op_threads == other.inter_op_threads &&
+               graph_optimization_level == other.graph_optimization_level &&
+               execution_providers == other.execution_providers &&
+               max_batch_size == other.max_batch_size &&
+               full_resolution_decode == other.full_resolution_decode &&
+               profile_prefix == other.profile_prefix &&
+               max_concurrent_runs == other.max_concurrent_runs &&
+               input_size == other.input_size &&
+               letterbox == other.letterbox &&
+               precision == other.precision &&
+               disable_memory_map == other.disable_memory_map &&
+               optimized_model_dir == other.optimized_model_dir &&
+               disable_cpu_arena == other.disable_cpu_arena &&
+               arena_extend_strategy == other.arena_extend_strategy &&
+               arena_initial_chunk_bytes == other.arena_initial_chunk_bytes &&
+               arena_max_bytes == other.arena_max_bytes &&
+               shrink_arena_after_run == other.shrink_arena_after_run &&
+               decode_pool_size == other.decode_pool_size &&
+               page_crop == other.page_crop;
+    }
+    bool operator!=(const DetectorOptions& other) const { return !(*this == other); }
+};
+
+// Tiled detection settings (DocDetector::DetectTiled)
+struct TileOptions {
+    int tile_size = 0;          // square tile side in image pixels, 0 = auto (half the longest side, at least the model input)
+    float overlap = 0.2f;       // fraction of a tile shared with its neighbour
+    float nms_iou = 0.5f;       // same-class boxes overlapping more than this are merged
+    bool full_page = true;      // also run the whole page, for elements larger than the overlap
+};
+
+// Timings of DocDetector::Warmup, wall time per dummy run in milliseconds
+struct WarmupStats {
+    int runs = 0;
+    double first_ms = 0.0;
+    double mean_ms = 0.0;
+    double last_ms = 0.0;   // close to steady state once warm
+};
+
+// A page that has been preprocessed into model input, produced and consumed
+// by different threads in the streaming pipeline
+struct PreparedInput {
+    std::vector<float> tensor;          // 3 x H x W planes, RGB, [0, 1]
+    std::vector<uint16_t> tensor_half;  // the same in float16, used instead for float16-input models
+    std::array<float, 2> scale_factor = {1.0f, 1.0f};
+    int image_width = 0;
+    int image_height = 0;
+};
+
+// One loaded PP-DocLayout model. The session is created eagerly in the
+// constructor, so a bad model path fails here and not on the first detection.
+// With options.precision set, an INT8 or FP16 variant next to model_path is
+// loaded instead when present (model_path is the fallback if it fails).
+// Model files are memory-mapped rather than read into the heap, and with
+// options.optimized_model_dir the optimized graph is cached in ORT format so
+// later starts skip parsing and graph optimization.
+// Input tensors are allocated once and bound with Ort::IoBinding. So is the
+// output, sized for the maximum detection count, when the model declares a
+// static output shape; then steady-state detection does not touch the heap.
+// An output with a data-dependent row count (the usual NMS export) cannot be
+// preallocated, ONNX Runtime rejects a bound buffer whose shape differs from
+// the computed one. It is bound to the CPU arena instead, which hands back
+// the same block every run, and each run still creates one small OrtValue.
+//
+// Thread safety: every public method may be called from any thread. The
+// session is shared (Ort::Session::Run is thread-safe); each in-flight
+// inference borrows one of max_concurrent_runs run contexts holding its own
+// bound buffers, and further callers block until a context is free. With the
+// default of one context, calls on one detector are serialized.
+class DocDetector {
+public:
+    explicit DocDetector(const std::string& model_path, const DetectorOptions& options = DetectorOptions());
+
+    DocDetector(const DocDetector&) = delete;
+    DocDetector& operator=(const DocDetector&) = delete;
+
+    std::vector<DetectionBox> Detect(const cv::Mat& image, float conf_threshold = 0.5);
+
+    // Detect on pixels in any PixelFormat, no color conversion of the full image needed
+    std::vector<DetectionBox> Detect(const cv::Mat& image, PixelFormat format, float conf_threshold);
+
+    // Same, filling a caller-owned vector so steady-state calls reuse its capacity.
+    // With page_crop the page outline is searched first and, if found, only
+    // the rectified page is detected on; boxes are in image coordinates either way.
+    // Returns false if inference failed (or the image is empty): results is
+    // then empty but is not a "no boxes" answer and must not be kept.
+    bool Detect(const cv::Mat& image, PixelFormat format, float conf_threshold,
+                std::vector<DetectionBox>& results);
+
+    // Detect on a YUV 4:2:0 camera frame without building an RGB copy, false on failure
+    bool Detect(const YuvPlanes& frame, float conf_threshold, std::vector<DetectionBox>& results);
+
+    // Decode an encoded image for this detector. JPEGs much larger than the
+    // model input are decoded at a reduced resolution unless
+    // full_resolution_decode is set; map boxes back with
+    // mapDetectionsToOriginal().
+    DecodedImage Decode(const uint8_t* data, size_t len) const;
+
+    // Shrink an already decoded BGR page by the factor Decode would use for
+    // a JPEG of the same size, so pages read from a multi-page file are not
+    // carried through the pipeline at scan resolution
+    DecodedImage ReducePage(cv::Mat page) const;
+
+    // Hand the buffer of a page from Decode or ReducePage back for reuse by
+    // the next decode, once nothing refers to its pixels any more
+    void RecycleDecoded(DecodedImage& decoded);
+
+    // Preprocess without touching the session. Safe to call from another
+    // thread while Detect/Infer are running.
+    void Preprocess(const cv::Mat& image, PixelFormat format, PreparedInput& input) const;
+
+    // Run inference on a page prepared by Preprocess, false on failure
+    bool Infer(PreparedInput& input, float conf_threshold, std::vector<DetectionBox>& results);
+
+    // Detect on several BGR pages with one session.Run per max_batch_size pages.
+    // results[i] belongs to images[i]. Falls back to one run per page when the
+    // model has a fixed batch dimension. With max_concurrent_runs > 1 the
+    // runs are spread over that many threads. If succeeded is given,
+    // (*succeeded)[i] is 1 when images[i] went through inference and 0 when
+    // it was empty or its run failed.
+    void DetectBatch(const std::vector<cv::Mat>& images, float conf_threshold,
+                     std::vector<std::vector<DetectionBox>>& results,
+                     std::vector<uint8_t>* succeeded = nullptr);
+
+    // Detect on a high-resolution BGR page as overlapping tiles, so small
+    // elements keep enough pixels. Tiles (and the whole page, if
+    // options.full_page) go through DetectBatch in one call; boxes cut by an
+    // inner tile edge are dropped in favour of the whole-page pass and the
+    // rest are merged with class-aware NMS. Falls back to Detect() when one
+    // tile covers the page. Returns false if any view failed.
+    bool DetectTiled(const cv::Mat& image, float conf_threshold, const TileOptions& options,
+                     std::vector<DetectionBox>& results);
+
+    // Tile side DetectTiled uses on a width x height page
+    int TileSize(int width, int height, const TileOptions& options) const;
+
+    // Decode for DetectTiled: reduced only as far as each tile keeps at
+    // least the model input resolution. tile_size is in original pixels.
+    DecodedImage DecodeForTiles(const uint8_t* data, size_t len, const TileOptions& options) const;
+
+    // Detect on one region of a BGR page, for re-detecting part of a form
+    // after an edit. The region is fed to the model on its own (no page
+    // crop, it is already part of the page); boxes are in image coordinates.
+    // False on failure; a region outside the image has no boxes.
+    bool DetectRegion(const cv::Mat& image, const cv::Rect& region, float conf_threshold,
+                      std::vector<DetectionBox>& results);
+
+    // Decode for DetectRegion: reduced only as far as region (in original
+    // pixels) keeps at least the model input resolution. An empty region
+    // decodes as Decode does.
+    DecodedImage DecodeForRegion(const uint8_t* data, size_t len, const cv::Rect& region) const;
+
+    // Run `iterations` dummy inferences at the model input size on every run
+    // context (and one full batch on batch-capable models), so the first
+    // real detection does not pay for kernel selection, arena growth or
+    // provider compilation. Not recorded in LatencyStats.
+    WarmupStats Warmup(int iterations);
+
+    // Release what this detector holds between runs: pooled decode buffers,
+    // batch buffers and, if shrink_arena is set and a run has grown it since
+    // the last trim, the CPU arena. The arena only shrinks at the end of a
+    // run, so that costs one full inference on the calling thread (as long
+    // as a detection). Waits for running inferences; call it when the app
+    // goes to the background.
+    void TrimMemory(bool shrink_arena = true);
+
+    // Whether the model accepts N > 1 images per run
+    bool SupportsBatch() const { return descriptor_.batch_capable; }
+
+    // Model input size: the model's static size, else input_size (default
+    // 640); decoding below this resolution loses detail
+    int InputWidth() const { return input_width_; }
+    int InputHeight() const { return input_height_; }
+
+    // Inputs, outputs, variant and class table read from the model at load time
+    const ModelDescriptor& Descriptor() const { return descriptor_; }
+
+    const std::string& ModelPath() const { return model_path_; }
+
+    // File the session was created from: model_path or one of its variants
+    const std::string& LoadedPath() const { return descriptor_.model_file; }
+    // Size and modification time of LoadedPath() when it was loaded, so a
+    // model file replaced in place (app update) is told apart; empty if
+    // the file could not be stat'ed
+    const std::string& ModelStamp() const { return model_stamp_; }
+    ModelPrecision Precision() const { return descriptor_.precision; }
+    const DetectorOptions& Options() const { return options_; }
+
+    // Execution providers that were actually registered (ExecutionProvider bits)
+    int ActiveProviders() const { return active_providers_; }
+
+    // Per-class thresholds, NMS, containment suppression and reading order
+    // applied to every following detection. Calls already running keep the
+    // options they started with.
+    void SetPostprocess(const PostprocessOptions& options);
+    std::shared_ptr<const PostprocessOptions> Postprocess() const;
+
+    // Stop ONNX Runtime profiling and return the trace file path, empty if
+    // profiling was not enabled. Profiling does not restart on this session.
+    std::string EndProfiling();
+
+private:
+    // ONNX Runtime allows one environment per process, shared by all detectors
+    static Ort::Env& SharedEnv();
+    // Register the shared CPU arena on SharedEnv() once, from the first
+    // options that configure it
+    static void RegisterSharedArena(const DetectorOptions& options);
+    static Ort::SessionOptions BuildSessionOptions(const DetectorOptions& options, bool with_providers,
+                                                   int* applied_providers);
+
+    // Create session_ from one file, through its cached optimized graph when there is one
+    void CreateSession(const std::string& path);
+
+    // Create session_ from path (ORT format if ort_format), retrying on plain
+    // CPU if the providers reject it; save_path non-empty = write the
+    // optimized graph there
+    void LoadSession(const std::string& path, bool ort_format, const std::string& save_path);
+    void OpenSession(const std::string& path, bool ort_format, const std::string& save_path,
+                     Ort::SessionOptions& session_options);
+
+    // optimized_model_dir/<name>.<key>.ort for a source file, empty if caching
+    // is off or providers are requested. The key covers the source's path,
+    // size and mtime, the ONNX Runtime version and the optimization level.
+    std::string OptimizedModelPath(const std::string& source) const;
+
+    // Allocate the persistent tensors and bind them to the session
+    void BindIo();
+
+    // Bound buffers of one in-flight inference on the shared session
+    struct RunContext {
+        Ort::RunOptions run_options;
+        Ort::IoBinding binding{nullptr};
+        std::vector<float> input_image;       // 3 x input_height_ x input_width_
+        std::array<float, 2> scale_factor{};  // M: target / original, L: [1, 1]
+        std::array<float, 2> im_shape{};      // L only: original [h, w]
+
+        // float16 counterparts bound instead for FP16 I/O models
+        std::vector<uint16_t> input_half;
+        std::array<uint16_t, 2> scale_half{};
+        std::array<uint16_t, 2> im_shape_half{};
+        std::vector<uint16_t> output_half;    // static float16 output
+        std::vector<float> output_widened;    // float16 boxes converted for parsing
+        Ort::Value image_tensor{nullptr};
+        Ort::Value scale_tensor{nullptr};
+        Ort::Value im_shape_tensor{nullptr};
+        std::vector<float> output_buffer;     // only for models with a static output shape
+        Ort::Value output_tensor{nullptr};
+
+        // Batch buffers, grown to the largest batch seen
+        std::vector<float> batch_image;
+        std::vector<float> batch_scale;
+        std::vector<float> batch_im_shape;
+        std::vector<uint16_t> batch_image_half;
+        std::vector<uint16_t> batch_side_half;  // [scale | im_shape] of the batch in float16
+    };
+
+    // Borrows a free run context for its lifetime
+    class ContextLease {
+    public:
+        explicit ContextLease(DocDetector& detector) : detector_(detector), context_(detector.AcquireContext()) {}
+        ~ContextLease() { detector_.ReleaseContext(context_); }
+
+        ContextLease(const ContextLease&) = delete;
+        ContextLease& operator=(const ContextLease&) = delete;
+
+        RunContext& operator*() const { return *context_; }
+        RunContext* operator->() const { return context_; }
+
+    private:
+        DocDetector& detector_;
+        RunContext* context_;
+    };
+
+    void InitContext(RunContext& context);
+
+    // Preprocess into the context's bound image buffer, float or float16 as the model takes
+    std::array<float, 2> PreprocessInto(RunContext& context, const cv::Mat& image, PixelFormat format) const;
+    std::array<float, 2> PreprocessInto(RunContext& context, const YuvPlanes& frame) const;
+
+    // Tensor over caller-owned float or float16 data, element type from `half`
+    Ort::Value WrapTensor(void* data, size_t count, bool half, const int64_t* shape, size_t rank) const;
+
+    // im_shape input of the L variant for a page preprocessed with scale_factor
+    std::array<float, 2> ImShape(const std::array<float, 2>& scale_factor, int image_width, int image_height) const;
+
+    // Detect on the whole image, no page search; false on failure
+    bool DetectFrame(const cv::Mat& image, PixelFormat format, float conf_threshold,
+                     std::vector<DetectionBox>& results);
+
+    // Blocks until a context is free
+    RunContext* AcquireContext();
+    void ReleaseContext(RunContext* context);
+
+    // Blocks until no context is in use, then leases the whole pool
+    std::vector<RunContext*> AcquireAllContexts();
+    void ReleaseAllContexts(std::vector<RunContext*>& leased);
+
+    // Run the bound session of a leased context and convert its output
+    void RunBound(RunContext& context, const std::array<float, 2>& scale_factor,
+                  int image_width, int image_height, float conf_threshold,
+                  std::vector<DetectionBox>& results);
+
+    // Convert raw [class_id, score, x1, y1, x2, y2] rows of one page to boxes in
+    // original image space and run the enabled postprocess passes on them
+    void AppendDetections(const float* rows, int num_rows, float inv_scale_x, float inv_scale_y,
+                          int image_width, int image_height, float conf_threshold,
+                          const PostprocessOptions& postprocess,
+                          std::vector<DetectionBox>& results) const;
+
+    // Run images[indices[0..count)] as one batch on a leased context
+    void RunBatch(const std::vector<cv::Mat>& images, const size_t* indices, size_t count,
+                  float conf_threshold, std::vector<std::vector<DetectionBox>>& results,
+                  std::vector<uint8_t>& succeeded);
+
+    static constexpr int kDefaultInputSize = 640;  // models with a dynamic image H/W
+    static constexpr int kInputAlignment = 32;     // total stride of the PP-DocLayout backbone
+    static constexpr size_t kDefaultMaxDetections = 300;
+    static constexpr size_t kDefaultMaxBatch = 8;
+    static constexpr size_t kDefaultDecodePool = 2;
+    static constexpr int kPageCropDecodeBoost = 2;  // decode size multiplier with page_crop
+
+    std::string model_path_;
+    DetectorOptions options_;
+    int active_providers_ = 0;
+    // Declared before session_: an ORT-format session reads its graph and
+    // weights from the mapping for its whole lifetime
+    MappedFile model_mapping_;
+    std::string load_method_;
+    std::string model_stamp_;
+    Ort::Session session_{nullptr};
+
+    // Fixed after construction, read by all contexts
+    ModelDescriptor descriptor_;
+    int input_width_ = kDefaultInputSize;
+    int input_height_ = kDefaultInputSize;
+    ResizeMode resize_mode_ = ResizeMode::kStretch;
+    Ort::MemoryInfo memory_info_{nullptr};
+    std::vector<int64_t> output_shape_;
+    bool static_output_ = false;
+    size_t results_capacity_ = 0;
+
+    // Swapped whole by SetPostprocess, never null
+    std::shared_ptr<const PostprocessOptions> postprocess_;
+    mutable std::mutex postprocess_mutex_;
+
+    // Run context pool, free_contexts_ guarded by pool_mutex_
+    std::vector<std::unique_ptr<RunContext>> contexts_;
+    std::vector<RunContext*> free_contexts_;
+    std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;
+
+    // Filled and drained by const Decode
+    mutable ImageBufferPool decode_pool_;
+    // Set by every run that may have grown the arena, cleared by TrimMemory
+    std::atomic<bool> arena_used_{false};
+};
+
+// Process-wide detector used by initModel() and detectDocLayout()
+void setDefaultDetector(std::shared_ptr<DocDetector> detector);
+std::shared_ptr<DocDetector> getDefaultDetector();
+
+// Main detection function, runs on the default detector
 std::vector<DetectionBox> detectDocLayout(const cv::Mat& image, float conf_threshold = 0.5);
 
+// Scale boxes detected on a reduced-resolution decode back to the original
+// image and clamp them to its bounds
+void mapDetectionsToOriginal(std::vector<DetectionBox>& detections, int decoded_width, int decoded_height,
+                             int original_width, int original_height);
+
+// Name of class_id in a class table, "unknown" if out of range
+const char* className(const std::vector<std::string>& class_names, int class_id);
+
 // Convert detections to JSON string
-std::string detectionsToJson(const std::vector<DetectionBox>& detections);
+std::string detectionsToJson(const std::vector<DetectionBox>& detections,
+                             const std::vector<std::string>& class_names = DOC_CLASSES);
 
 #endif // DOC_DETECTOR_H
@@ -0,0 +1,88 @@
+#ifndef DOCUMENT_READER_H
+#define DOCUMENT_READER_H
+
+#include "page_pipeline.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Pages of a multi-page image file, read one at a time. TIFF is the
+// multi-page format OpenCV decodes; any other image it reads is a one-page
+// document. PDF has no decoder in this build and fails to open.
+class DocumentReader {
+public:
+    // False with error / error_code set if the file cannot be read
+    bool Open(const std::string& path, std::string& error, std::string& error_code);
+
+    size_t PageCount() const { return page_count_; }
+
+    // Decode one page to BGR, empty if that page is unreadable. Only this
+    // page is decoded; earlier ones are skipped by their directory entries.
+    cv::Mat ReadPage(size_t index) const;
+
+private:
+    std::string path_;
+    size_t page_count_ = 0;
+};
+
+// Page range and queue depth of a document run, zero = defaults
+struct DocumentOptions {
+    size_t first_page = 0;
+    size_t page_count = 0;      // 0 = to the last page
+    size_t queue_depth = 0;     // 0 = PagePipeline::kDefaultQueueDepth
+};
+
+// How a document run ended, reported after the last page
+struct DocumentSummary {
+    size_t total_pages = 0;     // pages in the file
+    size_t pages = 0;           // pages submitted to the pipeline
+    bool cancelled = false;
+    std::string error;          // empty unless the file could not be opened
+    std::string error_code;
+
+    // {"total_pages":..,"pages":..,"cancelled":..} or {"error":..,"code":..}
+    std::string ToJson() const;
+};
+
+// Streams a document through a PagePipeline from its own reader thread:
+// one page is decoded, reduced for the model (DocDetector::ReducePage) and
+// submitted at a time, blocking while the pipeline is full, so memory stays
+// at a few pages whatever the document length. Page callbacks carry the
+// page's index in the file and arrive in page order; the done callback
+// comes once, after the last page callback.
+class DocumentStream {
+public:
+    using DoneCallback = std::function<void(const DocumentSummary& summary)>;
+
+    DocumentStream(std::shared_ptr<DocDetector> detector, std::string path, float conf_threshold,
+                   const DocumentOptions& options, PagePipeline::Serializer serializer,
+                   PagePipeline::PageCallback page_callback, DoneCallback done_callback);
+    // Cancels and waits for the reader thread
+    ~DocumentStream();
+
+    DocumentStream(const DocumentStream&) = delete;
+    DocumentStream& operator=(const DocumentStream&) = delete;
+
+    // Stop reading further pages; pages already queued are still delivered,
+    // then the done callback reports cancelled. Does not block.
+    void Cancel() { cancelled_ = true; }
+
+private:
+    void Run();
+
+    std::shared_ptr<DocDetector> detector_;
+    std::string path_;
+    float conf_threshold_;
+    DocumentOptions options_;
+    PagePipeline::Serializer serializer_;
+    PagePipeline::PageCallback page_callback_;
+    DoneCallback done_callback_;
+
+    std::atomic<bool> cancelled_{false};
+    std::thread reader_;
+};
+
+#endif  // DOCUMENT_READER_H
@@ -0,0 +1,80 @@
+#ifndef FRAME_TRACKER_H
+#define FRAME_TRACKER_H
+
+#include "doc_detector.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Tracking mode settings, zero values mean defaults
+struct TrackerOptions {
+    float change_threshold = 0.0f;  // mean abs luma difference (0-1) that triggers inference, default 0.04
+    int max_age_ms = 0;             // re-run inference at least this often, default 1000
+    float smoothing = 0.0f;         // weight of the previous box when re-detecting (0-1), default 0.3, < 0 = off
+};
+
+// Result of one tracked frame
+struct TrackedFrame {
+    std::vector<DetectionBox> detections;
+    bool reused = false;        // true if the cached detections were returned
+    float change = 1.0f;        // change metric against the last inferred frame
+};
+
+// Stateful live-camera mode. Each frame is first reduced to a tiny luma
+// thumbnail and compared with the thumbnail of the last frame that went
+// through inference. While the scene is steady the cached boxes are
+// returned; inference only runs when the change exceeds change_threshold,
+// the frame size changes or max_age_ms has passed. Re-detected boxes are
+// blended with their previous position to reduce jitter.
+class FrameTracker {
+public:
+    FrameTracker(std::shared_ptr<DocDetector> detector, const TrackerOptions& options = TrackerOptions());
+
+    FrameTracker(const FrameTracker&) = delete;
+    FrameTracker& operator=(const FrameTracker&) = delete;
+
+    // Track a packed 1/3/4 channel frame. Returns false if inference failed
+    // (or the frame is empty); the reference frame is then left unchanged.
+    bool Track(const cv::Mat& frame, PixelFormat format, float conf_threshold, TrackedFrame& result);
+
+    // Track a YUV 4:2:0 frame, only the luma plane is read for the change metric
+    bool Track(const YuvPlanes& frame, float conf_threshold, TrackedFrame& result);
+
+    // Drop the cached result, the next frame always runs inference
+    void Reset();
+
+    const DocDetector& Detector() const { return *detector_; }
+
+    static constexpr float kDefaultChangeThreshold = 0.04f;
+    static constexpr int kDefaultMaxAgeMs = 1000;
+    static constexpr float kDefaultSmoothing = 0.3f;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Returns true if the cached result can be reused for this thumbnail
+    bool CanReuse(const cv::Mat& thumbnail, int width, int height, float conf_threshold, float& change) const;
+
+    // Store a fresh inference result, smoothed against the previous one
+    void Update(const cv::Mat& thumbnail, int width, int height, float conf_threshold,
+                std::vector<DetectionBox>& detections);
+
+    static constexpr int kThumbnailSize = 32;
+
+    std::shared_ptr<DocDetector> detector_;
+    float change_threshold_;
+    int max_age_ms_;
+    float smoothing_;
+
+    std::mutex mutex_;
+    bool has_reference_ = false;
+    cv::Mat reference_;             // kThumbnailSize x kThumbnailSize CV_8UC1
+    int reference_width_ = 0;
+    int reference_height_ = 0;
+    float reference_conf_ = 0.0f;
+    Clock::time_point reference_time_;
+    std::vector<DetectionBox> cached_;
+};
+
+#endif  // FRAME_TRACKER_H
@@ -0,0 +1,53 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "doc_detector.h"
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <vector>
+
+// How a box of an incremental result relates to the previous result
+enum DiffMark {
+    kDiffUnchanged = 0,     // outside the changed region, kept as it was
+    kDiffAdded = 1,         // found in the changed region, no previous box matches it
+    kDiffUpdated = 2,       // re-detected in the changed region, replaces a previous box
+    kDiffMoved = 3,         // previous box mapped through a transform
+};
+
+const char* diffMarkName(int mark);
+
+struct DiffBox {
+    DetectionBox box;
+    int mark = kDiffUnchanged;
+    int previous_index = -1;    // index in the previous result, -1 for added boxes
+};
+
+// Merged boxes plus what disappeared
+struct IncrementalResult {
+    std::vector<DiffBox> boxes;
+    std::vector<int> removed;   // previous indices with no box in the new result
+    cv::Rect region;            // area that was re-detected, empty for transforms
+};
+
+// Same-class boxes overlapping at least this IoU are the same element
+constexpr float kDiffMatchIou = 0.5f;
+
+// The changed region grown until it fully covers every previous box it
+// touches, clipped to width x height, so re-detection never sees half an
+// element. An empty region means the whole image.
+cv::Rect affectedRegion(const std::vector<DetectionBox>& previous, const cv::Rect& region, int width, int height);
+
+// Previous boxes outside region are kept unchanged, those inside are
+// replaced by fresh (detected on the region, in image coordinates). A fresh
+// box matching a replaced one is marked updated with that box's index.
+void mergeRegion(const std::vector<DetectionBox>& previous, const cv::Rect& region,
+                 const std::vector<DetectionBox>& fresh, IncrementalResult& result);
+
+// Map every previous box through a 2x3 affine transform [a b tx; c d ty]
+// (rotation, scale, flip, translation) into a width x height image.
+// Each box becomes the bounding box of its transformed corners, which is
+// exact for multiples of 90 degrees; boxes falling outside are removed.
+void transformDetections(const std::vector<DetectionBox>& previous, const std::array<double, 6>& transform,
+                         int width, int height, IncrementalResult& result);
+
+#endif  // INCREMENTAL_H
@@ -0,0 +1,39 @@
+#ifndef INFERENCE_WORKER_H
+#define INFERENCE_WORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Long-lived background thread that runs queued detection tasks in order.
+// Replaces spawning a fresh thread per request.
+class InferenceWorker {
+public:
+    static InferenceWorker& GetInstance();
+
+    // Queue a task, returns immediately
+    void Submit(std::function<void()> task);
+
+    // Tasks queued but not started yet
+    size_t Pending();
+
+    ~InferenceWorker();
+
+private:
+    InferenceWorker();
+    InferenceWorker(const InferenceWorker&) = delete;
+    InferenceWorker& operator=(const InferenceWorker&) = delete;
+
+    void Run();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> queue_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+};
+
+#endif  // INFERENCE_WORKER_H
@@ -0,0 +1,117 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Stages of one detection call. Color conversion, resize and NCHW blob
+// building are a single fused pass (preprocessToTensor), reported as
+// kStagePreprocess.
+enum LatencyStage {
+    kStageDecode = 0,       // encoded bytes -> pixels
+    kStagePageCrop,         // page outline search and warp (DetectorOptions::page_crop)
+    kStagePreprocess,       // pixels -> model input tensor
+    kStageRun,              // session.Run
+    kStageParse,            // model output -> DetectionBox
+    kStageSerialize,        // DetectionBox -> JSON or binary buffer
+    kStageTotal,            // whole call, as reported in inference_time_ms
+    kStageCount
+};
+
+// Percentiles over the recent samples of one stage, in milliseconds
+struct StagePercentiles {
+    uint64_t count = 0;     // samples recorded since the last reset
+    size_t window = 0;      // samples the percentiles are computed over
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double mean = 0.0;
+    double max = 0.0;
+};
+
+// Process-wide per-stage latency recorder. Each stage keeps a ring buffer of
+// its most recent kWindow samples; percentiles are computed on demand.
+class LatencyStats {
+public:
+    static LatencyStats& GetInstance();
+
+    void Record(LatencyStage stage, double ms);
+
+    StagePercentiles Percentiles(LatencyStage stage) const;
+
+    // {"window":N,"stages":{"decode":{"count":..,"p50_ms":..,...},...}}
+    std::string ToJson() const;
+
+    void Reset();
+
+    static const char* StageName(LatencyStage stage);
+
+    static constexpr size_t kWindow = 256;
+
+private:
+    LatencyStats() = default;
+    LatencyStats(const LatencyStats&) = delete;
+    LatencyStats& operator=(const LatencyStats&) = delete;
+
+    struct Ring {
+        std::array<float, kWindow> samples{};
+        size_t next = 0;        // slot of the next sample
+        uint64_t count = 0;     // total samples recorded
+    };
+
+    mutable std::mutex mutex_;
+    std::array<Ring, kStageCount> rings_{};
+};
+
+// Drops the samples recorded on this thread while alive, so warm-up runs do
+// not skew the percentiles
+class ScopedStatsPause {
+public:
+    ScopedStatsPause() : previous_(paused_) { paused_ = true; }
+    ~ScopedStatsPause() { paused_ = previous_; }
+
+    ScopedStatsPause(const ScopedStatsPause&) = delete;
+    ScopedStatsPause& operator=(const ScopedStatsPause&) = delete;
+
+    static bool Active() { return paused_; }
+
+private:
+    static thread_local bool paused_;
+    bool previous_;
+};
+
+// Records the lifetime of the scope as one sample of a stage
+class StageTimer {
+public:
+    explicit StageTimer(LatencyStage stage) : stage_(stage), start_(Clock::now()) {}
+    ~StageTimer() { Stop(); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    // Record now instead of at scope exit
+    void Stop() {
+        if (stopped_) {
+            return;
+        }
+        stopped_ = true;
+        if (ScopedStatsPause::Active()) {
+            return;
+        }
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start_;
+        LatencyStats::GetInstance().Record(stage_, elapsed.count());
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    LatencyStage stage_;
+    Clock::time_point start_;
+    bool stopped_ = false;
+};
+
+#endif  // LATENCY_STATS_H
@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. The pages are backed by the file
+// itself, so they are loaded on first touch and the OS can drop them under
+// memory pressure instead of them counting as dirty heap.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map path, false (and nothing mapped) if it cannot be opened or is empty
+    bool Open(const std::string& path);
+    void Close();
+
+    const uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+    bool IsOpen() const { return data_ != nullptr; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+// Size and modification time of a file, false if it does not exist
+bool fileStamp(const std::string& path, uint64_t& size, int64_t& mtime);
+
+#endif  // MAPPED_FILE_H
@@ -0,0 +1,52 @@
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Resident memory of the whole process (model, arenas, images and the app
+// itself), 0 where the platform does not report a value
+struct ProcessMemory {
+    int64_t current_bytes = 0;
+    int64_t peak_bytes = 0;     // high-water mark since process start
+
+    // {"current_bytes":..,"peak_bytes":..}
+    std::string ToJson() const;
+};
+
+ProcessMemory processMemory();
+
+// A few decoded-page buffers kept for reuse. cv::imdecode writes into a
+// buffer of the right size and type instead of allocating, so a steady run
+// of same-sized pages (camera captures, one scanner) decodes into the same
+// memory instead of churning multi-megabyte blocks through the allocator.
+// Released images must not be referenced anywhere else.
+class ImageBufferPool {
+public:
+    explicit ImageBufferPool(size_t capacity) : capacity_(capacity) {}
+
+    ImageBufferPool(const ImageBufferPool&) = delete;
+    ImageBufferPool& operator=(const ImageBufferPool&) = delete;
+
+    // A recycled buffer, or an empty Mat if none is free
+    cv::Mat Acquire();
+
+    // Keep image's buffer for a later Acquire, dropped if the pool is full
+    void Release(cv::Mat image);
+
+    // Free every pooled buffer
+    void Trim();
+
+    size_t Bytes() const;
+
+private:
+    size_t capacity_;
+    std::vector<cv::Mat> buffers_;
+    mutable std::mutex mutex_;
+};
+
+#endif  // MEMORY_STATS_H
@@ -0,0 +1,70 @@
+#ifndef MODEL_DESCRIPTOR_H
+#define MODEL_DESCRIPTOR_H
+
+#include "model_variant.h"
+#include <onnxruntime_cxx_api.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Input contract of a PP-DocLayout export (DescribeModel() tells them apart
+// by input names, not by the model file)
+enum ModelVariant {
+    kModelVariantM = 0,     // image + scale_factor, boxes in model input space (M, S)
+    kModelVariantL = 1,     // im_shape + image + scale_factor, boxes in original space (L)
+};
+
+// Name, shape (-1 = dynamic) and ONNX element type of one model input or output
+struct TensorInfo {
+    std::string name;
+    std::vector<int64_t> shape;
+    int element_type = 0;
+};
+
+// Everything the detector needs to know about a model, read once at load time
+struct ModelDescriptor {
+    std::vector<TensorInfo> inputs;
+    std::vector<TensorInfo> outputs;
+
+    std::string image_input;        // [N, 3, H, W]
+    std::string scale_input;        // [N, 2] scale_factor, empty if the model has none
+    std::string shape_input;        // [N, 2] im_shape, L variant only
+    std::string boxes_output;       // [rows, 6] = [class_id, score, x1, y1, x2, y2]
+    std::string count_output;       // per-image row count (bbox_num), empty if absent
+
+    ModelVariant variant = kModelVariantM;
+    bool batch_capable = false;     // dynamic N and a per-image count output
+    int input_width = 0;            // static W of image_input, 0 if dynamic
+    int input_height = 0;           // static H of image_input, 0 if dynamic
+
+    // float16 tensors of FP16 exports (the rest are float)
+    bool half_image = false;        // image_input
+    bool half_side_inputs = false;  // scale_factor / im_shape
+    bool half_boxes = false;        // boxes_output
+
+    // Set by the detector: file actually loaded, its precision, how it was
+    // opened ("file", "mmap" or "ort_cache") and how long that took
+    std::string model_file;
+    ModelPrecision precision = kPrecisionFp32;
+    std::string load_method;
+    double load_ms = 0.0;
+
+    // Class table from the ONNX custom metadata, or the built-in 23 classes
+    std::vector<std::string> class_names;
+    bool class_names_from_metadata = false;
+
+    std::string producer;
+    int64_t version = 0;
+
+    // {"variant":"L","precision":"int8","inputs":[...],"outputs":[...],"classes":[...],...}
+    std::string ToJson() const;
+};
+
+// Inspect a loaded session. Throws std::runtime_error if the model has no
+// 4-D image input or no [rows, 6] output.
+ModelDescriptor DescribeModel(Ort::Session& session, const std::vector<std::string>& default_classes);
+
+// Parse a class table stored as metadata: ["a", "b"], {0: 'a', 1: 'b'} or a,b
+std::vector<std::string> parseClassNames(const std::string& text);
+
+#endif  // MODEL_DESCRIPTOR_H
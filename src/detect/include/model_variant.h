@@ -0,0 +1,57 @@
+#ifndef MODEL_VARIANT_H
+#define MODEL_VARIANT_H
+
+#include <string>
+#include <vector>
+
+// Numeric precision of a model file (DetectorOptions::precision)
+enum ModelPrecision {
+    kPrecisionModel = 0,    // load the given file as is
+    kPrecisionAuto = 1,     // fastest variant present next to the given file for this device
+    kPrecisionFp32 = 2,
+    kPrecisionFp16 = 3,     // <stem>.fp16.onnx: float16 weights, usually float16 I/O too
+    kPrecisionInt8 = 4,     // <stem>.int8.onnx: QDQ-quantized weights and activations, float I/O
+};
+
+// CPU features that decide which variant runs fastest, probed once per process
+struct CpuFeatures {
+    bool arm64 = false;
+    bool arm_dotprod = false;   // SDOT/UDOT (ARMv8.2 DotProd), 4 int8 MACs per lane
+    bool arm_fp16 = false;      // half-precision arithmetic (ARMv8.2 FP16)
+    bool arm_i8mm = false;      // SMMLA/UMMLA (ARMv8.6 I8MM)
+    bool x86_avx2 = false;
+    bool x86_vnni = false;      // AVX512-VNNI or AVX-VNNI
+    bool x86_f16c = false;      // float <-> half conversion
+
+    // {"arm64":true,"arm_dotprod":true,...}
+    std::string ToJson() const;
+};
+
+const CpuFeatures& cpuFeatures();
+
+// Variants from fastest to slowest on this device. `accelerator` = NNAPI or
+// Core ML was requested; those run half precision natively.
+std::vector<ModelPrecision> preferredPrecisions(const CpuFeatures& cpu, bool accelerator);
+
+// "fp32", "fp16", "int8" ("model" and "auto" for the selection modes)
+const char* precisionName(ModelPrecision precision);
+
+// Precision named by a file's suffix (model.int8.onnx, model_fp16.onnx),
+// kPrecisionFp32 if it carries none
+ModelPrecision precisionFromPath(const std::string& path);
+
+// Sibling file of a given precision: model.onnx -> model.int8.onnx. A path
+// that already names a variant is replaced by the requested one;
+// kPrecisionFp32 is the plain model.onnx.
+std::string variantPath(const std::string& model_path, ModelPrecision precision);
+
+struct ModelCandidate {
+    std::string path;
+    ModelPrecision precision;
+};
+
+// Files to try in order for a requested precision: the matching variants
+// that exist on disk, then model_path itself as the last resort
+std::vector<ModelCandidate> modelCandidates(const std::string& model_path, int requested, bool accelerator);
+
+#endif  // MODEL_VARIANT_H
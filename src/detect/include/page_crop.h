@@ -0,0 +1,45 @@
+#ifndef PAGE_CROP_H
+#define PAGE_CROP_H
+
+#include "doc_detector.h"
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <vector>
+
+// Outline of the page in a camera frame, in frame pixels
+struct PageQuad {
+    std::array<cv::Point2f, 4> corners;     // top-left, top-right, bottom-right, bottom-left
+    float coverage = 0.0f;                  // quad area / frame area
+};
+
+// Quads covering less of the frame are taken for something else on the
+// table, more means the page already fills the frame and cropping gains nothing
+constexpr float kPageCropMinCoverage = 0.2f;
+constexpr float kPageCropMaxCoverage = 0.9f;
+
+// Long edge of the downsampled frame the page search runs on
+constexpr int kPageCropAnalysisSize = 256;
+
+// Look for the page as the largest convex quadrilateral on an edge map of
+// the frame shrunk to kPageCropAnalysisSize. Returns false if there is no
+// quad within the coverage limits.
+bool findPageQuad(const cv::Mat& image, PixelFormat format, PageQuad& quad);
+
+// The page warped to an upright rectangle, plus the homography from page
+// pixels back to frame pixels
+struct PageCrop {
+    cv::Mat page;               // same pixel format as the frame
+    cv::Matx33d to_frame;
+};
+
+// Warp the quad to a rectangle with its own aspect ratio. The rectangle is
+// at least min_width x min_height where the frame has that many pixels
+// along the page edges, never larger than the page's size in the frame.
+void warpPage(const cv::Mat& image, const PageQuad& quad, int min_width, int min_height, PageCrop& crop);
+
+// Map boxes found on the warped page into the frame: each box becomes the
+// bounding box of its four transformed corners, clipped to the frame
+void mapDetectionsFromPage(std::vector<DetectionBox>& detections, const cv::Matx33d& to_frame,
+                           int frame_width, int frame_height);
+
+#endif  // PAGE_CROP_H
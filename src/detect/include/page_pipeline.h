@@ -0,0 +1,122 @@
+#ifndef PAGE_PIPELINE_H
+#define PAGE_PIPELINE_H
+
+#include "bounded_queue.h"
+#include "doc_detector.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One page leaving the pipeline
+struct PageResult {
+    size_t page_index = 0;
+    std::vector<DetectionBox> detections;
+    int image_width = 0;
+    int image_height = 0;
+    long long elapsed_ms = 0;   // from decode start to serialization
+    std::string error;          // empty on success
+    std::string error_code;
+};
+
+// Streaming detection over many pages. Each stage runs on its own thread
+// with a bounded queue in between:
+//
+//   Submit -> decode -> preprocess -> inference -> serialize -> callback
+//
+// so page N+1 is decoded and resized while page N is in session.Run().
+// Every stage is a single FIFO thread, so results are delivered in
+// submission order. Submit blocks when the decode queue is full.
+class PagePipeline {
+public:
+    using Serializer = std::function<std::string(const PageResult&)>;
+    // Called on the serialize thread, in page order
+    using PageCallback = std::function<void(size_t page_index, std::string result)>;
+
+    PagePipeline(std::shared_ptr<DocDetector> detector, float conf_threshold, size_t queue_depth,
+                 Serializer serializer, PageCallback callback);
+    ~PagePipeline();
+
+    PagePipeline(const PagePipeline&) = delete;
+    PagePipeline& operator=(const PagePipeline&) = delete;
+
+    // Queue an encoded image, returns its page index or -1 after Finish()
+    int64_t SubmitEncoded(std::vector<uint8_t> bytes);
+
+    // Queue an image file, returns its page index or -1 after Finish()
+    int64_t SubmitFile(std::string path);
+
+    // Queue an already decoded BGR page (empty image = unreadable page),
+    // returns its page index or -1 after Finish()
+    int64_t SubmitDecoded(DecodedImage decoded);
+
+    // Stop accepting pages and wait until every queued page has been
+    // delivered. Must not be called from the callback.
+    void Finish();
+
+    static constexpr size_t kDefaultQueueDepth = 2;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct SourcePage {
+        size_t index = 0;
+        std::vector<uint8_t> bytes;
+        std::string path;
+        DecodedImage decoded;
+        bool predecoded = false;
+        Clock::time_point start;
+    };
+
+    struct DecodedPage {
+        size_t index = 0;
+        DecodedImage decoded;
+        Clock::time_point start;
+        std::string error, error_code;
+    };
+
+    struct StagedPage {
+        size_t index = 0;
+        std::unique_ptr<PreparedInput> input;
+        int original_width = 0;
+        int original_height = 0;
+        Clock::time_point start;
+        std::string error, error_code;
+    };
+
+    struct InferredPage {
+        PageResult result;
+        Clock::time_point start;
+    };
+
+    int64_t Submit(SourcePage page);
+
+    void DecodeStage();
+    void PreprocessStage();
+    void InferStage();
+    void SerializeStage();
+
+    std::shared_ptr<DocDetector> detector_;
+    float conf_threshold_;
+    Serializer serializer_;
+    PageCallback callback_;
+
+    BoundedQueue<SourcePage> source_queue_;
+    BoundedQueue<DecodedPage> decoded_queue_;
+    BoundedQueue<StagedPage> staged_queue_;
+    BoundedQueue<InferredPage> inferred_queue_;
+    // Recycled input tensors, so steady-state streaming does not allocate them
+    BoundedQueue<std::unique_ptr<PreparedInput>> free_inputs_;
+
+    std::mutex submit_mutex_;
+    size_t next_index_ = 0;
+    bool finished_ = false;
+
+    std::vector<std::thread> threads_;
+};
+
+#endif  // PAGE_PIPELINE_H
@@ -0,0 +1,56 @@
+#ifndef POSTPROCESS_H
+#define POSTPROCESS_H
+
+#include "doc_detector.h"
+#include <vector>
+
+// Settings of the native postprocess stage. The defaults reproduce the plain
+// confidence filter, every extra pass is opt-in.
+struct PostprocessOptions {
+    std::vector<float> class_thresholds;  // by class ID, < 0 or missing = the call's conf_threshold
+    float nms_iou = 0.0f;                 // > 0 = class-aware NMS at this IoU
+    float containment = 0.0f;             // > 0 = drop boxes at least this much inside a higher-scoring same-class box
+    bool reading_order = false;           // sort by reading order instead of score
+
+    bool operator==(const PostprocessOptions& other) const {
+        return class_thresholds == other.class_thresholds && nms_iou == other.nms_iou &&
+               containment == other.containment && reading_order == other.reading_order;
+    }
+    bool operator!=(const PostprocessOptions& other) const { return !(*this == other); }
+
+    // Short suffix naming non-default options, e.g. for cache keys; "" for the defaults
+    std::string Id() const;
+};
+
+// Threshold raw [class_id, score, x1, y1, x2, y2] rows, scale the kept boxes
+// by inv_scale_x/y and clamp them to image_width x image_height, appending to
+// results. Rows are split into per-column arrays first so the score test and
+// the scale/clamp run as straight vector loops; class IDs outside
+// [0, num_classes) are dropped.
+void filterDetections(const float* rows, int num_rows, int num_classes, float conf_threshold,
+                      const PostprocessOptions& options, float inv_scale_x, float inv_scale_y,
+                      int image_width, int image_height, std::vector<DetectionBox>& results);
+
+// The passes below work in place on detections[first, end), boxes before
+// first (e.g. earlier pages of a batch) are left alone. Scratch space is
+// kept per thread, so steady-state refinement does not allocate.
+
+// Class-aware greedy NMS: keep the highest-scoring box of every group of
+// same-class boxes whose IoU exceeds iou_threshold. Result is sorted by score.
+void nmsDetections(std::vector<DetectionBox>& detections, float iou_threshold, size_t first = 0);
+
+// Drop boxes whose area lies at least `fraction` inside a higher-scoring box
+// of the same class (a paragraph detected both whole and in pieces).
+// Result is sorted by score.
+void suppressContained(std::vector<DetectionBox>& detections, float fraction, size_t first = 0);
+
+// Recursive XY-cut: split the boxes at horizontal gaps into bands, bands at
+// vertical gaps into columns, and so on; leaves are read top to bottom. A
+// full-width title above two columns reads title, left column, right column.
+void sortReadingOrder(std::vector<DetectionBox>& detections, size_t first = 0);
+
+// NMS, containment suppression and reading order as enabled in options
+void refineDetections(std::vector<DetectionBox>& detections, const PostprocessOptions& options,
+                      size_t first = 0);
+
+#endif  // POSTPROCESS_H
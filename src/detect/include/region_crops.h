@@ -0,0 +1,38 @@
+#ifndef REGION_CROPS_H
+#define REGION_CROPS_H
+
+#include "doc_detector.h"
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// How crops are handed out (CropOptions::encoding)
+enum CropEncoding {
+    kCropRaw = 0,       // BGR view into the decoded page, no copy
+    kCropPng = 1,
+    kCropJpeg = 2,
+};
+
+// Which detections to crop and how
+struct CropOptions {
+    std::vector<int> class_ids;     // empty = every detection
+    float padding = 0.0f;           // margin added on each side, as a fraction of the box size
+    int encoding = kCropRaw;
+    int jpeg_quality = 90;
+};
+
+// One cropped detection
+struct RegionCrop {
+    size_t detection_index = 0;     // index into the detections the crop was cut from
+    cv::Rect rect;                  // crop rectangle in page pixels
+    cv::Mat view;                   // ROI of the page, shares its pixels
+    std::vector<uint8_t> encoded;   // PNG or JPEG bytes, empty for kCropRaw
+};
+
+// Cut the selected detections out of a decoded BGR page. Raw crops are ROI
+// views and stay valid only as long as the page's pixels do. Boxes clipped
+// to nothing are skipped.
+void cropDetections(const cv::Mat& page, const std::vector<DetectionBox>& detections, const CropOptions& options,
+                    std::vector<RegionCrop>& crops);
+
+#endif  // REGION_CROPS_H
@@ -0,0 +1,152 @@
+#ifndef REQUEST_CONTROL_H
+#define REQUEST_CONTROL_H
+
+#include <onnxruntime_cxx_api.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Why a request stopped (RequestControl::State)
+enum RequestState {
+    kRequestActive = 0,
+    kRequestCancelled = 1,          // cancelRequest / RequestRegistry::Cancel
+    kRequestDeadlineExceeded = 2,   // its deadline passed before the result was ready
+    kRequestSuperseded = 3,         // a newer request in its lane replaced it
+};
+
+// Cancellation state of one queued detection. Stopping it before it starts
+// makes the worker skip it; stopping it during session.Run terminates every
+// run attached at that moment through its Ort::RunOptions (batches and tiles
+// run several at once on helper threads).
+class RequestControl {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // deadline_ms counts from now, 0 = none
+    RequestControl(int64_t id, int64_t lane, int deadline_ms);
+
+    RequestControl(const RequestControl&) = delete;
+    RequestControl& operator=(const RequestControl&) = delete;
+
+    int64_t Id() const { return id_; }
+    int64_t Lane() const { return lane_; }
+    bool HasDeadline() const { return has_deadline_; }
+    Clock::time_point Deadline() const { return deadline_; }
+
+    // RequestState, kRequestActive until the first Stop
+    int State() const { return state_.load(std::memory_order_acquire); }
+    bool Stopped() const { return State() != kRequestActive; }
+
+    // Stop with the given reason; later calls keep the first reason.
+    // Returns false if the request had already stopped.
+    bool Stop(int reason);
+
+    // Stop with kRequestDeadlineExceeded if the deadline has passed
+    bool CheckDeadline();
+
+    // Bind the options of a run about to start so Stop() terminates it.
+    // A request that has already stopped terminates the run right away.
+    void AttachRun(Ort::RunOptions* options);
+    // Unbind after the run and clear a termination, the options are reused
+    void DetachRun(Ort::RunOptions* options);
+
+private:
+    const int64_t id_;
+    const int64_t lane_;
+    const bool has_deadline_;
+    const Clock::time_point deadline_;
+    std::atomic<int> state_{kRequestActive};
+
+    std::mutex run_mutex_;
+    std::vector<Ort::RunOptions*> runs_;  // in flight, one per run context
+};
+
+// The request the calling thread is working on, so DocDetector can attach
+// its run options without every Detect overload taking a request parameter.
+// Thread-local: code that fans work out to other threads installs the
+// request there too (parallelFor in doc_detector.cpp).
+class ScopedRequest {
+public:
+    explicit ScopedRequest(RequestControl* request) : previous_(current_) { current_ = request; }
+    ~ScopedRequest() { current_ = previous_; }
+
+    ScopedRequest(const ScopedRequest&) = delete;
+    ScopedRequest& operator=(const ScopedRequest&) = delete;
+
+    // nullptr outside a ScopedRequest
+    static RequestControl* Current() { return current_; }
+
+private:
+    static thread_local RequestControl* current_;
+    RequestControl* previous_;
+};
+
+// Attaches run options to the current request for one session.Run
+class ScopedRunAttachment {
+public:
+    explicit ScopedRunAttachment(Ort::RunOptions& options)
+        : request_(ScopedRequest::Current()), options_(&options) {
+        if (request_ != nullptr) {
+            request_->AttachRun(options_);
+        }
+    }
+    ~ScopedRunAttachment() {
+        if (request_ != nullptr) {
+            request_->DetachRun(options_);
+        }
+    }
+
+    ScopedRunAttachment(const ScopedRunAttachment&) = delete;
+    ScopedRunAttachment& operator=(const ScopedRunAttachment&) = delete;
+
+private:
+    RequestControl* request_;
+    Ort::RunOptions* options_;
+};
+
+// Requests submitted to the worker and not finished yet, by id. A watchdog
+// thread stops requests whose deadline passes, including during a run.
+class RequestRegistry {
+public:
+    static RequestRegistry& GetInstance();
+
+    // Track a new request. With lane != 0 every older request in the same
+    // lane is stopped as superseded: the newest frame wins.
+    std::shared_ptr<RequestControl> Register(int64_t id, int64_t lane, int deadline_ms);
+
+    // Forget a finished request
+    void Remove(const std::shared_ptr<RequestControl>& request);
+
+    // Stop a request, false if no such request is in flight
+    bool Cancel(int64_t id);
+
+    // Stop every request in a lane, returns how many were stopped
+    int CancelLane(int64_t lane);
+
+    // Process-unique id for callers that do not manage their own
+    int64_t NextId() { return next_id_.fetch_add(1, std::memory_order_relaxed); }
+
+    ~RequestRegistry();
+
+private:
+    RequestRegistry();
+    RequestRegistry(const RequestRegistry&) = delete;
+    RequestRegistry& operator=(const RequestRegistry&) = delete;
+
+    void Watch();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::unordered_multimap<int64_t, std::shared_ptr<RequestControl>> requests_;
+    std::atomic<int64_t> next_id_{1};
+    std::thread watchdog_;
+    bool stopping_ = false;
+};
+
+#endif  // REQUEST_CONTROL_H
@@ -0,0 +1,105 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "doc_detector.h"
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Identifies one detection request: the encoded input bytes, the model and
+// the confidence threshold
+struct CacheKey {
+    uint64_t content_hash = 0;
+    uint64_t model_hash = 0;
+    uint64_t length = 0;
+    float conf_threshold = 0.0f;
+
+    bool operator==(const CacheKey& other) const {
+        return content_hash == other.content_hash && model_hash == other.model_hash &&
+               length == other.length && conf_threshold == other.conf_threshold;
+    }
+};
+
+// Detections of one page in original-image coordinates
+struct CachedResult {
+    std::vector<DetectionBox> detections;
+    int image_width = 0;
+    int image_height = 0;
+};
+
+struct CacheStats {
+    uint64_t hits = 0;          // memory and disk hits
+    uint64_t misses = 0;
+    uint64_t disk_hits = 0;     // hits that were loaded back from disk
+    uint64_t evictions = 0;     // entries dropped to stay within the memory bound
+    uint64_t entries = 0;
+    uint64_t bytes = 0;         // estimated memory held by the entries
+};
+
+// Process-wide LRU cache of detection results keyed on a hash of the
+// encoded input, so re-submitted pages skip decode and inference. Disabled
+// until Configure() is called with a non-zero memory bound. With a disk
+// directory, entries are also written there and survive restarts; the
+// memory bound does not apply to the disk copy.
+class ResultCache {
+public:
+    static ResultCache& GetInstance();
+
+    // max_bytes = 0 disables the cache and drops the memory entries.
+    // disk_dir empty = memory only. Returns false if disk_dir cannot be created.
+    bool Configure(size_t max_bytes, const std::string& disk_dir);
+
+    bool Enabled() const;
+
+    // Build the key of a request; model_id names the model and any option
+    // that changes its output
+    static CacheKey MakeKey(const uint8_t* data, size_t len, float conf_threshold, const std::string& model_id);
+
+    // 64-bit non-cryptographic hash (XXH64)
+    static uint64_t Hash(const void* data, size_t len, uint64_t seed = 0);
+
+    bool Lookup(const CacheKey& key, CachedResult& result);
+    void Insert(const CacheKey& key, const CachedResult& result);
+
+    // Drop all memory entries and, if remove_disk is set, the disk entries
+    void Clear(bool remove_disk);
+
+    CacheStats Stats() const;
+
+private:
+    ResultCache() = default;
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    struct KeyHash {
+        size_t operator()(const CacheKey& key) const;
+    };
+    struct Entry {
+        CacheKey key;
+        CachedResult result;
+        size_t bytes = 0;
+    };
+    using EntryList = std::list<Entry>;
+
+    static size_t EntryBytes(const CachedResult& result);
+
+    // mutex_ must be held
+    void InsertLocked(const CacheKey& key, const CachedResult& result);
+    void EvictLocked();
+    std::string DiskPathLocked(const CacheKey& key) const;
+
+    bool ReadDisk(const std::string& path, const CacheKey& key, CachedResult& result) const;
+    bool WriteDisk(const std::string& path, const CacheKey& key, const CachedResult& result) const;
+
+    mutable std::mutex mutex_;
+    size_t max_bytes_ = 0;
+    std::string disk_dir_;
+    EntryList lru_;             // most recently used first
+    std::unordered_map<CacheKey, EntryList::iterator, KeyHash> index_;
+    CacheStats stats_;
+};
+
+#endif  // RESULT_CACHE_H
@@ -1,38 +1,129 @@
-#ifndef UTILS_H
-#define UTILS_H
-
-#include <utility>
-#include <iostream>
-#include <chrono>
-#include <tuple>
-#include <vector>
-#include <map>
-#include <string>
-#include <opencv2/dnn.hpp>
-#include <opencv2/opencv.hpp>
-#include <onnxruntime_cxx_api.h>
-
-using std::map;
-using std::pair;
-using std::string;
-using std::to_string;
-using std::vector;
-using std::ifstream;
-using std::runtime_error;
-using std::endl;
-using std::max;
-using std::min;
-using std::get;
-using std::sort;
-using std::round;
-using std::cerr;
-using std::cout;
-using namespace std::chrono;
-
-// PP-DocLayout preprocess: resize to target size and return scale factors
-std::pair<cv::Mat, std::vector<float>> preprocessImage(const cv::Mat& img, int target_width = 640, int target_height = 640);
-
-// Convert image to blob for ONNX inference
-cv::Mat imageToBlob(const cv::Mat& img);
-
-#endif
+#ifndef UTILS_H
+#define UTILS_H
+
+#include <array>
+#include <utility>
+#include <iostream>
+#include <chrono>
+#include <tuple>
+#include <vector>
+#include <map>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include <onnxruntime_cxx_api.h>
+
+using std::map;
+using std::pair;
+using std::string;
+using std::to_string;
+using std::vector;
+using std::ifstream;
+using std::runtime_error;
+using std::endl;
+using std::max;
+using std::min;
+using std::get;
+using std::sort;
+using std::round;
+using std::cerr;
+using std::cout;
+using namespace std::chrono;
+
+// Decode an encoded image (PNG, JPEG, ...) straight from memory to BGR.
+// Returns an empty Mat if the bytes are not a supported image. A non-null
+// target is decoded into, reusing its buffer when size and type match.
+cv::Mat decodeImage(const uint8_t* data, size_t len, cv::Mat* target = nullptr);
+
+// Decoded image together with the size of the encoded original
+struct DecodedImage {
+    cv::Mat image;
+    int original_width = 0;
+    int original_height = 0;
+};
+
+// Read the size from a JPEG header without decoding, false if not a JPEG
+bool probeJpegSize(const uint8_t* data, size_t len, int& width, int& height);
+
+// Largest reduced-decode factor (1, 2, 4 or 8) that keeps the decoded image
+// at least min_width x min_height
+int reducedDecodeFactor(int width, int height, int min_width, int min_height);
+
+// Decode to BGR, at a reduced resolution when the source is a JPEG that is
+// at least twice as large as min_width x min_height: libjpeg's DCT scaling
+// (cv::IMREAD_REDUCED_COLOR_2/4/8) skips most of the decode work and the
+// full-size pixels are never allocated. min_width/min_height of 0 decode at
+// full resolution. Returns an empty image if the bytes are not decodable.
+// target as for decodeImage.
+DecodedImage decodeImageReduced(const uint8_t* data, size_t len, int min_width, int min_height,
+                                cv::Mat* target = nullptr);
+
+// Read a whole file into memory, false if it cannot be read
+bool readFileBytes(const char* path, std::vector<uint8_t>& bytes);
+
+// Pixel layouts accepted by the fused preprocess kernel
+enum class PixelFormat {
+    kBGR,    // 3 channels, OpenCV default
+    kRGB,
+    kBGRA,   // 4 channels, iOS camera frames
+    kRGBA,
+    kGray,   // 1 channel
+};
+
+// How the source is fitted into the model input
+enum class ResizeMode {
+    kStretch,    // fill the whole input, aspect ratio not kept (PP-DocLayout keep_ratio = false)
+    kLetterbox,  // keep the aspect ratio, content at the top-left, border filled with kLetterboxPadValue
+};
+
+// Border value of letterboxed inputs, white like the paper around a page
+constexpr float kLetterboxPadValue = 1.0f;
+
+// Uniform scale that fits src into target without cropping
+float letterboxScale(int src_width, int src_height, int target_width, int target_height);
+
+// Fused PP-DocLayout preprocess: bilinear resize straight from the source
+// pixels, channel swap to RGB and scale to [0, 1], written as NCHW float
+// planes into dst (3 * target_height * target_width floats). One pass over
+// the output, no intermediate full-resolution or resized images.
+// Returns the scale factors {scale_x, scale_y}; with kLetterbox the content
+// starts at (0, 0), so boxes map back by dividing by them in both modes.
+std::array<float, 2> preprocessToTensor(const cv::Mat& img, PixelFormat format,
+                                        int target_width, int target_height, float* dst,
+                                        ResizeMode mode = ResizeMode::kStretch);
+
+// Same, writing IEEE 754 half-precision planes for models with float16 input
+std::array<float, 2> preprocessToTensor(const cv::Mat& img, PixelFormat format,
+                                        int target_width, int target_height, uint16_t* dst,
+                                        ResizeMode mode = ResizeMode::kStretch);
+
+// YUV 4:2:0 camera frame as separate plane pointers. Covers I420
+// (uv_pixel_stride 1) as well as NV21/NV12 (uv_pixel_stride 2, with u and
+// v pointing into the interleaved plane), i.e. Android YUV_420_888.
+struct YuvPlanes {
+    const uint8_t* y = nullptr;
+    const uint8_t* u = nullptr;
+    const uint8_t* v = nullptr;
+    int width = 0;
+    int height = 0;
+    int y_row_stride = 0;
+    int uv_row_stride = 0;
+    int uv_pixel_stride = 1;
+};
+
+// Same as preprocessToTensor, reading a YUV 4:2:0 frame. The color
+// conversion is done per sampled tap, so no full-resolution RGB image is
+// ever built. Returns the scale factors {scale_x, scale_y}.
+std::array<float, 2> preprocessYuvToTensor(const YuvPlanes& frame, int target_width, int target_height,
+                                           float* dst, ResizeMode mode = ResizeMode::kStretch);
+std::array<float, 2> preprocessYuvToTensor(const YuvPlanes& frame, int target_width, int target_height,
+                                           uint16_t* dst, ResizeMode mode = ResizeMode::kStretch);
+
+// IEEE 754 binary16 conversion (round to nearest even), for float16 model
+// inputs and outputs. The array versions use the hardware conversion
+// instructions where available (AArch64 NEON, x86 F16C).
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+void floatsToHalves(const float* src, uint16_t* dst, size_t count);
+void halvesToFloats(const uint16_t* src, float* dst, size_t count);
+
+#endif
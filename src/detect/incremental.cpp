@@ -0,0 +1,153 @@
+#include "include/incremental.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+cv::Rect boxRect(const DetectionBox& box) {
+    const int x1 = static_cast<int>(std::floor(box.x1));
+    const int y1 = static_cast<int>(std::floor(box.y1));
+    const int x2 = static_cast<int>(std::ceil(box.x2));
+    const int y2 = static_cast<int>(std::ceil(box.y2));
+    return cv::Rect(x1, y1, std::max(0, x2 - x1), std::max(0, y2 - y1));
+}
+
+float iou(const DetectionBox& a, const DetectionBox& b) {
+    const float w = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+    const float h = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+    if (w <= 0.0f || h <= 0.0f) {
+        return 0.0f;
+    }
+    const float inter = w * h;
+    const float uni = (a.x2 - a.x1) * (a.y2 - a.y1) + (b.x2 - b.x1) * (b.y2 - b.y1) - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+}  // namespace
+
+const char* diffMarkName(int mark) {
+    switch (mark) {
+        case kDiffAdded:   return "added";
+        case kDiffUpdated: return "updated";
+        case kDiffMoved:   return "moved";
+        default:           return "unchanged";
+    }
+}
+
+cv::Rect affectedRegion(const std::vector<DetectionBox>& previous, const cv::Rect& region, int width, int height) {
+    const cv::Rect bounds(0, 0, width, height);
+    cv::Rect affected = region & bounds;
+    if (affected.width <= 0 || affected.height <= 0) {
+        return bounds;
+    }
+    // Growing can touch further boxes; each pass adds at least one
+    bool grown = true;
+    for (size_t pass = 0; grown && pass <= previous.size(); pass++) {
+        grown = false;
+        for (const DetectionBox& box : previous) {
+            const cv::Rect rect = boxRect(box) & bounds;
+            if ((rect & affected).area() > 0 && (rect | affected) != affected) {
+                affected |= rect;
+                grown = true;
+            }
+        }
+    }
+    return affected;
+}
+
+void mergeRegion(const std::vector<DetectionBox>& previous, const cv::Rect& region,
+                 const std::vector<DetectionBox>& fresh, IncrementalResult& result) {
+    result.boxes.clear();
+    result.removed.clear();
+    result.region = region;
+
+    std::vector<int> replaced;
+    for (size_t i = 0; i < previous.size(); i++) {
+        if ((boxRect(previous[i]) & region).area() > 0) {
+            replaced.push_back(static_cast<int>(i));
+        } else {
+            DiffBox kept;
+            kept.box = previous[i];
+            kept.previous_index = static_cast<int>(i);
+            result.boxes.push_back(kept);
+        }
+    }
+
+    // Greedy matching, highest-scoring fresh boxes first
+    std::vector<size_t> order(fresh.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fresh[a].score > fresh[b].score; });
+    std::vector<bool> matched(replaced.size(), false);
+    for (size_t index : order) {
+        DiffBox box;
+        box.box = fresh[index];
+        box.mark = kDiffAdded;
+        float best = kDiffMatchIou;
+        int best_slot = -1;
+        for (size_t slot = 0; slot < replaced.size(); slot++) {
+            const DetectionBox& candidate = previous[replaced[slot]];
+            if (matched[slot] || candidate.class_id != box.box.class_id) {
+                continue;
+            }
+            const float overlap = iou(candidate, box.box);
+            if (overlap >= best) {
+                best = overlap;
+                best_slot = static_cast<int>(slot);
+            }
+        }
+        if (best_slot >= 0) {
+            matched[best_slot] = true;
+            box.mark = kDiffUpdated;
+            box.previous_index = replaced[best_slot];
+        }
+        result.boxes.push_back(box);
+    }
+    for (size_t slot = 0; slot < replaced.size(); slot++) {
+        if (!matched[slot]) {
+            result.removed.push_back(replaced[slot]);
+        }
+    }
+}
+
+void transformDetections(const std::vector<DetectionBox>& previous, const std::array<double, 6>& transform,
+                         int width, int height, IncrementalResult& result) {
+    result.boxes.clear();
+    result.removed.clear();
+    result.region = cv::Rect();
+
+    const float max_x = static_cast<float>(width);
+    const float max_y = static_cast<float>(height);
+    for (size_t i = 0; i < previous.size(); i++) {
+        const DetectionBox& box = previous[i];
+        const float xs[4] = {box.x1, box.x2, box.x2, box.x1};
+        const float ys[4] = {box.y1, box.y1, box.y2, box.y2};
+        float x1 = max_x, y1 = max_y, x2 = 0.0f, y2 = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            const float x = static_cast<float>(transform[0] * xs[c] + transform[1] * ys[c] + transform[2]);
+            const float y = static_cast<float>(transform[3] * xs[c] + transform[4] * ys[c] + transform[5]);
+            x1 = std::min(x1, x);
+            y1 = std::min(y1, y);
+            x2 = std::max(x2, x);
+            y2 = std::max(y2, y);
+        }
+        x1 = std::max(0.0f, x1);
+        y1 = std::max(0.0f, y1);
+        x2 = std::min(x2, max_x);
+        y2 = std::min(y2, max_y);
+        if (x2 <= x1 || y2 <= y1) {
+            result.removed.push_back(static_cast<int>(i));
+            continue;
+        }
+        DiffBox moved;
+        moved.box = box;
+        moved.box.x1 = x1;
+        moved.box.y1 = y1;
+        moved.box.x2 = x2;
+        moved.box.y2 = y2;
+        moved.mark = kDiffMoved;
+        moved.previous_index = static_cast<int>(i);
+        result.boxes.push_back(moved);
+    }
+}
@@ -0,0 +1,53 @@
+#include "include/inference_worker.h"
+
+InferenceWorker& InferenceWorker::GetInstance() {
+    static InferenceWorker instance;
+    return instance;
+}
+
+InferenceWorker::InferenceWorker() {
+    // One inference at a time: the ORT session already parallelizes inside Run()
+    threads_.emplace_back(&InferenceWorker::Run, this);
+}
+
+InferenceWorker::~InferenceWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void InferenceWorker::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+size_t InferenceWorker::Pending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void InferenceWorker::Run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_ && queue_.empty()) {
+                return;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,102 @@
+#include "include/latency_stats.h"
+#include "include/memory_stats.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+thread_local bool ScopedStatsPause::paused_ = false;
+
+LatencyStats& LatencyStats::GetInstance() {
+    static LatencyStats instance;
+    return instance;
+}
+
+const char* LatencyStats::StageName(LatencyStage stage) {
+    switch (stage) {
+        case kStageDecode:     return "decode";
+        case kStagePageCrop:   return "page_crop";
+        case kStagePreprocess: return "preprocess";
+        case kStageRun:        return "run";
+        case kStageParse:      return "parse";
+        case kStageSerialize:  return "serialize";
+        case kStageTotal:      return "total";
+        default:               return "unknown";
+    }
+}
+
+void LatencyStats::Record(LatencyStage stage, double ms) {
+    if (stage < 0 || stage >= kStageCount) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Ring& ring = rings_[stage];
+    ring.samples[ring.next] = static_cast<float>(ms);
+    ring.next = (ring.next + 1) % kWindow;
+    ring.count++;
+}
+
+StagePercentiles LatencyStats::Percentiles(LatencyStage stage) const {
+    StagePercentiles result;
+    if (stage < 0 || stage >= kStageCount) {
+        return result;
+    }
+
+    // Copy the samples out so sorting runs without the lock
+    std::array<float, kWindow> samples;
+    size_t n;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Ring& ring = rings_[stage];
+        result.count = ring.count;
+        n = static_cast<size_t>(std::min<uint64_t>(ring.count, kWindow));
+        std::copy(ring.samples.begin(), ring.samples.begin() + n, samples.begin());
+    }
+    result.window = n;
+    if (n == 0) {
+        return result;
+    }
+
+    std::sort(samples.begin(), samples.begin() + n);
+    // Nearest-rank percentile
+    auto rank = [&](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(n) + 0.999999);
+        return static_cast<double>(samples[std::min(n, std::max<size_t>(index, 1)) - 1]);
+    };
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += samples[i];
+    }
+    result.p50 = rank(0.50);
+    result.p95 = rank(0.95);
+    result.p99 = rank(0.99);
+    result.mean = sum / static_cast<double>(n);
+    result.max = samples[n - 1];
+    return result;
+}
+
+std::string LatencyStats::ToJson() const {
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\"window\":" << kWindow << ",\"stages\":{";
+    for (int stage = 0; stage < kStageCount; stage++) {
+        StagePercentiles p = Percentiles(static_cast<LatencyStage>(stage));
+        if (stage > 0) {
+            json << ",";
+        }
+        json << "\"" << StageName(static_cast<LatencyStage>(stage)) << "\":{";
+        json << "\"count\":" << p.count << ",";
+        json << "\"p50_ms\":" << p.p50 << ",";
+        json << "\"p95_ms\":" << p.p95 << ",";
+        json << "\"p99_ms\":" << p.p99 << ",";
+        json << "\"mean_ms\":" << p.mean << ",";
+        json << "\"max_ms\":" << p.max;
+        json << "}";
+    }
+    json << "},\"memory\":" << processMemory().ToJson() << "}";
+    return json.str();
+}
+
+void LatencyStats::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_ = {};
+}
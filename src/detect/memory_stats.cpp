@@ -0,0 +1,80 @@
+#include "include/memory_stats.h"
+#include <cstdio>
+#include <sstream>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__) || defined(__ANDROID__)
+#include <unistd.h>
+#endif
+
+ProcessMemory processMemory() {
+    ProcessMemory memory;
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+        KERN_SUCCESS) {
+        memory.current_bytes = static_cast<int64_t>(info.resident_size);
+        memory.peak_bytes = static_cast<int64_t>(info.resident_size_max);
+    }
+#elif defined(__linux__) || defined(__ANDROID__)
+    // VmRSS is the current resident set, VmHWM its high-water mark
+    if (FILE* status = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        while (std::fgets(line, sizeof(line), status)) {
+            long kb = 0;
+            if (std::sscanf(line, "VmRSS: %ld kB", &kb) == 1) {
+                memory.current_bytes = static_cast<int64_t>(kb) * 1024;
+            } else if (std::sscanf(line, "VmHWM: %ld kB", &kb) == 1) {
+                memory.peak_bytes = static_cast<int64_t>(kb) * 1024;
+            }
+        }
+        std::fclose(status);
+    }
+#endif
+    return memory;
+}
+
+std::string ProcessMemory::ToJson() const {
+    std::ostringstream json;
+    json << "{\"current_bytes\":" << current_bytes << ",\"peak_bytes\":" << peak_bytes << "}";
+    return json.str();
+}
+
+cv::Mat ImageBufferPool::Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffers_.empty()) {
+        return cv::Mat();
+    }
+    cv::Mat buffer = buffers_.back();
+    buffers_.pop_back();
+    return buffer;
+}
+
+void ImageBufferPool::Release(cv::Mat image) {
+    if (image.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (buffers_.size() < capacity_) {
+        buffers_.push_back(std::move(image));
+    }
+}
+
+void ImageBufferPool::Trim() {
+    std::vector<cv::Mat> released;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released.swap(buffers_);
+    }
+}
+
+size_t ImageBufferPool::Bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t bytes = 0;
+    for (const cv::Mat& buffer : buffers_) {
+        bytes += buffer.total() * buffer.elemSize();
+    }
+    return bytes;
+}
@@ -0,0 +1,209 @@
+#include "include/model_descriptor.h"
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Metadata keys exporters use for the label list
+const char* const kClassMetadataKeys[] = {"class_names", "names", "labels", "label_list"};
+
+TensorInfo tensorInfo(const std::string& name, const Ort::TypeInfo& type_info) {
+    TensorInfo info;
+    info.name = name;
+    auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
+    info.shape = tensor_info.GetShape();
+    info.element_type = static_cast<int>(tensor_info.GetElementType());
+    return info;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) begin++;
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) end--;
+    return text.substr(begin, end - begin);
+}
+
+void appendShapeJson(std::ostringstream& json, const TensorInfo& info) {
+    json << "{\"name\":\"" << info.name << "\",\"shape\":[";
+    for (size_t i = 0; i < info.shape.size(); i++) {
+        json << (i > 0 ? "," : "") << info.shape[i];
+    }
+    json << "],\"type\":" << info.element_type << "}";
+}
+
+void appendEscaped(std::ostringstream& json, const std::string& text) {
+    json << "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            json << '\\';
+        }
+        json << c;
+    }
+    json << "\"";
+}
+
+}  // namespace
+
+std::vector<std::string> parseClassNames(const std::string& text) {
+    std::vector<std::string> names;
+
+    // Quoted entries: ["a", "b"] or {0: 'a', 1: 'b'}, in order of appearance
+    for (size_t i = 0; i < text.size(); i++) {
+        char quote = text[i];
+        if (quote != '"' && quote != '\'') {
+            continue;
+        }
+        size_t end = text.find(quote, i + 1);
+        if (end == std::string::npos) {
+            break;
+        }
+        names.push_back(text.substr(i + 1, end - i - 1));
+        i = end;
+    }
+    if (!names.empty()) {
+        return names;
+    }
+
+    // Plain list: a,b,c or one name per line
+    std::string item;
+    std::istringstream stream(text);
+    while (std::getline(stream, item, text.find(',') != std::string::npos ? ',' : '\n')) {
+        item = trim(item);
+        if (!item.empty()) {
+            names.push_back(item);
+        }
+    }
+    return names;
+}
+
+ModelDescriptor DescribeModel(Ort::Session& session, const std::vector<std::string>& default_classes) {
+    ModelDescriptor desc;
+    Ort::AllocatorWithDefaultOptions allocator;
+
+    for (size_t i = 0; i < session.GetInputCount(); i++) {
+        desc.inputs.push_back(tensorInfo(session.GetInputNameAllocated(i, allocator).get(),
+                                         session.GetInputTypeInfo(i)));
+    }
+    for (size_t i = 0; i < session.GetOutputCount(); i++) {
+        desc.outputs.push_back(tensorInfo(session.GetOutputNameAllocated(i, allocator).get(),
+                                          session.GetOutputTypeInfo(i)));
+    }
+
+    // Inputs by role: the two [N, 2] side inputs by name, the image by rank
+    const TensorInfo* image = nullptr;
+    for (const TensorInfo& input : desc.inputs) {
+        if (input.name == "im_shape") {
+            desc.shape_input = input.name;
+        } else if (input.name == "scale_factor") {
+            desc.scale_input = input.name;
+        } else if (input.shape.size() == 4 && image == nullptr) {
+            image = &input;
+        }
+    }
+    if (image == nullptr) {
+        throw std::runtime_error("model has no [N, 3, H, W] image input");
+    }
+    desc.image_input = image->name;
+    desc.variant = desc.shape_input.empty() ? kModelVariantM : kModelVariantL;
+    desc.input_height = image->shape[2] > 0 ? static_cast<int>(image->shape[2]) : 0;
+    desc.input_width = image->shape[3] > 0 ? static_cast<int>(image->shape[3]) : 0;
+
+    // Outputs: the [rows, 6] box table, then an optional 1-D per-image count
+    for (const TensorInfo& output : desc.outputs) {
+        bool is_boxes = output.shape.size() == 2 && (output.shape[1] == 6 || output.shape[1] <= 0);
+        if (is_boxes && desc.boxes_output.empty()) {
+            desc.boxes_output = output.name;
+        } else if (output.shape.size() == 1 && desc.count_output.empty()) {
+            desc.count_output = output.name;
+        }
+    }
+    if (desc.boxes_output.empty()) {
+        if (desc.outputs.empty()) {
+            throw std::runtime_error("model has no outputs");
+        }
+        desc.boxes_output = desc.outputs[0].name;
+    }
+    desc.batch_capable = !desc.count_output.empty() && image->shape[0] <= 0;
+
+    // FP16 exports converted without keep_io_types take and return float16
+    const int kFloat16 = static_cast<int>(ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16);
+    desc.half_image = image->element_type == kFloat16;
+    for (const TensorInfo& input : desc.inputs) {
+        if ((input.name == desc.scale_input || input.name == desc.shape_input) && input.element_type == kFloat16) {
+            desc.half_side_inputs = true;
+        }
+    }
+    for (const TensorInfo& output : desc.outputs) {
+        if (output.name == desc.boxes_output) {
+            desc.half_boxes = output.element_type == kFloat16;
+        }
+    }
+    desc.precision = desc.half_image ? kPrecisionFp16 : kPrecisionFp32;
+
+    // Metadata is optional; a model without it uses the built-in table
+    try {
+        Ort::ModelMetadata metadata = session.GetModelMetadata();
+        Ort::AllocatedStringPtr producer = metadata.GetProducerNameAllocated(allocator);
+        desc.producer = producer ? producer.get() : "";
+        desc.version = metadata.GetVersion();
+        for (const char* key : kClassMetadataKeys) {
+            Ort::AllocatedStringPtr value = metadata.LookupCustomMetadataMapAllocated(key, allocator);
+            if (!value) {
+                continue;
+            }
+            std::vector<std::string> names = parseClassNames(value.get());
+            if (!names.empty()) {
+                desc.class_names = std::move(names);
+                desc.class_names_from_metadata = true;
+                break;
+            }
+        }
+    } catch (const Ort::Exception& e) {
+        (void)e;
+    }
+    if (desc.class_names.empty()) {
+        desc.class_names = default_classes;
+    }
+    return desc;
+}
+
+std::string ModelDescriptor::ToJson() const {
+    std::ostringstream json;
+    json << "{";
+    json << "\"variant\":\"" << (variant == kModelVariantL ? "L" : "M") << "\",";
+    json << "\"input_width\":" << input_width << ",";
+    json << "\"input_height\":" << input_height << ",";
+    json << "\"batch_capable\":" << (batch_capable ? "true" : "false") << ",";
+    json << "\"precision\":\"" << precisionName(precision) << "\",";
+    json << "\"half_io\":" << (half_image ? "true" : "false") << ",";
+    json << "\"model_file\":";
+    appendEscaped(json, model_file);
+    json << ",\"load_method\":";
+    appendEscaped(json, load_method);
+    json << ",\"load_ms\":" << std::fixed << std::setprecision(1) << load_ms << std::defaultfloat << ",";
+    json << "\"inputs\":[";
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (i > 0) json << ",";
+        appendShapeJson(json, inputs[i]);
+    }
+    json << "],\"outputs\":[";
+    for (size_t i = 0; i < outputs.size(); i++) {
+        if (i > 0) json << ",";
+        appendShapeJson(json, outputs[i]);
+    }
+    json << "],\"classes\":[";
+    for (size_t i = 0; i < class_names.size(); i++) {
+        if (i > 0) json << ",";
+        appendEscaped(json, class_names[i]);
+    }
+    json << "],";
+    json << "\"classes_from_metadata\":" << (class_names_from_metadata ? "true" : "false") << ",";
+    json << "\"producer\":";
+    appendEscaped(json, producer);
+    json << ",\"version\":" << version;
+    json << "}";
+    return json.str();
+}
@@ -0,0 +1,204 @@
+#include "include/model_variant.h"
+#include <fstream>
+#include <sstream>
+
+#if (defined(__linux__) || defined(__ANDROID__)) && defined(__aarch64__)
+#include <sys/auxv.h>
+#ifndef HWCAP_ASIMDHP
+#define HWCAP_ASIMDHP (1 << 10)
+#endif
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP (1 << 20)
+#endif
+#ifndef HWCAP2_I8MM
+#define HWCAP2_I8MM (1 << 13)
+#endif
+#define DOCLAYOUT_HWCAP 1
+#elif defined(__APPLE__) && defined(__aarch64__)
+#include <sys/sysctl.h>
+#define DOCLAYOUT_SYSCTL 1
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#define DOCLAYOUT_CPUID 1
+#endif
+
+namespace {
+
+// Suffixes a variant file may carry before ".onnx", by precision
+struct VariantSuffix {
+    ModelPrecision precision;
+    const char* suffix;
+};
+
+const VariantSuffix kVariantSuffixes[] = {
+    {kPrecisionInt8, ".int8"}, {kPrecisionInt8, "_int8"}, {kPrecisionInt8, "_quant"},
+    {kPrecisionFp16, ".fp16"}, {kPrecisionFp16, "_fp16"},
+    {kPrecisionFp32, ".fp32"}, {kPrecisionFp32, "_fp32"},
+};
+
+const char kOnnxExtension[] = ".onnx";
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool fileExists(const std::string& path) {
+    return std::ifstream(path, std::ios::binary).good();
+}
+
+// model.int8.onnx -> {"model", ".onnx"}
+void splitVariantPath(const std::string& path, std::string& stem, std::string& extension) {
+    stem = path;
+    extension.clear();
+    if (endsWith(stem, kOnnxExtension)) {
+        stem.resize(stem.size() - (sizeof(kOnnxExtension) - 1));
+        extension = kOnnxExtension;
+    }
+    for (const VariantSuffix& variant : kVariantSuffixes) {
+        if (endsWith(stem, variant.suffix)) {
+            stem.resize(stem.size() - std::char_traits<char>::length(variant.suffix));
+            break;
+        }
+    }
+}
+
+#ifdef DOCLAYOUT_SYSCTL
+bool sysctlFlag(const char* name) {
+    int value = 0;
+    size_t size = sizeof(value);
+    return sysctlbyname(name, &value, &size, nullptr, 0) == 0 && value != 0;
+}
+#endif
+
+CpuFeatures probeCpuFeatures() {
+    CpuFeatures cpu;
+#if defined(DOCLAYOUT_HWCAP)
+    const unsigned long hwcap = getauxval(AT_HWCAP);
+    const unsigned long hwcap2 = getauxval(AT_HWCAP2);
+    cpu.arm64 = true;
+    cpu.arm_dotprod = (hwcap & HWCAP_ASIMDDP) != 0;
+    cpu.arm_fp16 = (hwcap & HWCAP_ASIMDHP) != 0;
+    cpu.arm_i8mm = (hwcap2 & HWCAP2_I8MM) != 0;
+#elif defined(DOCLAYOUT_SYSCTL)
+    cpu.arm64 = true;
+    cpu.arm_dotprod = sysctlFlag("hw.optional.arm.FEAT_DotProd");
+    cpu.arm_fp16 = sysctlFlag("hw.optional.arm.FEAT_FP16") || sysctlFlag("hw.optional.neon_fp16");
+    cpu.arm_i8mm = sysctlFlag("hw.optional.arm.FEAT_I8MM");
+#elif defined(DOCLAYOUT_CPUID)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return cpu;
+    }
+    // AVX state has to be enabled by the OS (XCR0), not just present
+    bool ymm = false, zmm = false;
+    const bool f16c = (ecx & (1u << 29)) != 0;
+    if ((ecx & (1u << 27)) != 0 && (ecx & (1u << 28)) != 0) {
+        unsigned xcr0_lo = 0, xcr0_hi = 0;
+        __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        ymm = (xcr0_lo & 0x6u) == 0x6u;
+        zmm = (xcr0_lo & 0xE6u) == 0xE6u;
+    }
+    cpu.x86_f16c = ymm && f16c;
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        cpu.x86_avx2 = ymm && (ebx & (1u << 5)) != 0;
+        cpu.x86_vnni = zmm && (ebx & (1u << 16)) != 0 && (ecx & (1u << 11)) != 0;
+    }
+    if (__get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx)) {
+        cpu.x86_vnni = cpu.x86_vnni || (ymm && (eax & (1u << 4)) != 0);
+    }
+#endif
+    return cpu;
+}
+
+}  // namespace
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = probeCpuFeatures();
+    return features;
+}
+
+std::string CpuFeatures::ToJson() const {
+    std::ostringstream json;
+    json << "{\"arm64\":" << (arm64 ? "true" : "false")
+         << ",\"arm_dotprod\":" << (arm_dotprod ? "true" : "false")
+         << ",\"arm_fp16\":" << (arm_fp16 ? "true" : "false")
+         << ",\"arm_i8mm\":" << (arm_i8mm ? "true" : "false")
+         << ",\"x86_avx2\":" << (x86_avx2 ? "true" : "false")
+         << ",\"x86_vnni\":" << (x86_vnni ? "true" : "false")
+         << ",\"x86_f16c\":" << (x86_f16c ? "true" : "false") << "}";
+    return json.str();
+}
+
+std::vector<ModelPrecision> preferredPrecisions(const CpuFeatures& cpu, bool accelerator) {
+    if (accelerator) {
+        return {kPrecisionFp16, kPrecisionFp32};
+    }
+    // Dot-product instructions make int8 convolutions roughly twice as fast
+    // as fp32 at a quarter of the weight size. Without them ARM emulates int8
+    // GEMM with widening multiplies and seldom wins; AVX2 still gains from
+    // ONNX Runtime's u8s8 kernels.
+    if (cpu.arm_dotprod || cpu.x86_vnni || cpu.x86_avx2) {
+        return {kPrecisionInt8, kPrecisionFp32};
+    }
+    if (cpu.arm_fp16) {
+        return {kPrecisionFp16, kPrecisionFp32};
+    }
+    return {kPrecisionFp32};
+}
+
+const char* precisionName(ModelPrecision precision) {
+    switch (precision) {
+        case kPrecisionModel: return "model";
+        case kPrecisionAuto:  return "auto";
+        case kPrecisionFp32:  return "fp32";
+        case kPrecisionFp16:  return "fp16";
+        case kPrecisionInt8:  return "int8";
+    }
+    return "fp32";
+}
+
+ModelPrecision precisionFromPath(const std::string& path) {
+    std::string stem = path;
+    if (endsWith(stem, kOnnxExtension)) {
+        stem.resize(stem.size() - (sizeof(kOnnxExtension) - 1));
+    }
+    for (const VariantSuffix& variant : kVariantSuffixes) {
+        if (endsWith(stem, variant.suffix)) {
+            return variant.precision;
+        }
+    }
+    return kPrecisionFp32;
+}
+
+std::string variantPath(const std::string& model_path, ModelPrecision precision) {
+    std::string stem, extension;
+    splitVariantPath(model_path, stem, extension);
+    if (precision == kPrecisionInt8) {
+        return stem + ".int8" + extension;
+    }
+    if (precision == kPrecisionFp16) {
+        return stem + ".fp16" + extension;
+    }
+    return stem + extension;
+}
+
+std::vector<ModelCandidate> modelCandidates(const std::string& model_path, int requested, bool accelerator) {
+    std::vector<ModelPrecision> wanted;
+    if (requested == kPrecisionAuto) {
+        wanted = preferredPrecisions(cpuFeatures(), accelerator);
+    } else if (requested == kPrecisionFp32 || requested == kPrecisionFp16 || requested == kPrecisionInt8) {
+        wanted.push_back(static_cast<ModelPrecision>(requested));
+    }
+
+    std::vector<ModelCandidate> candidates;
+    for (ModelPrecision precision : wanted) {
+        std::string path = variantPath(model_path, precision);
+        if (path != model_path && fileExists(path)) {
+            candidates.push_back({path, precision});
+        } else if (path == model_path) {
+            break;  // the given file is already the preferred one
+        }
+    }
+    candidates.push_back({model_path, precisionFromPath(model_path)});
+    return candidates;
+}
@@ -0,0 +1,167 @@
+#include "include/page_crop.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Median of an 8-bit image from its histogram
+int medianLevel(const cv::Mat& gray) {
+    int histogram[256] = {0};
+    for (int y = 0; y < gray.rows; y++) {
+        const uint8_t* row = gray.ptr<uint8_t>(y);
+        for (int x = 0; x < gray.cols; x++) {
+            histogram[row[x]]++;
+        }
+    }
+    const int half = static_cast<int>(gray.total() / 2);
+    int seen = 0;
+    for (int level = 0; level < 256; level++) {
+        seen += histogram[level];
+        if (seen > half) {
+            return level;
+        }
+    }
+    return 255;
+}
+
+void toGray(const cv::Mat& image, PixelFormat format, cv::Mat& gray) {
+    switch (format) {
+        case PixelFormat::kRGB:  cv::cvtColor(image, gray, cv::COLOR_RGB2GRAY); break;
+        case PixelFormat::kBGRA: cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY); break;
+        case PixelFormat::kRGBA: cv::cvtColor(image, gray, cv::COLOR_RGBA2GRAY); break;
+        case PixelFormat::kGray: gray = image; break;
+        default:                 cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY); break;
+    }
+}
+
+// Top-left has the smallest x + y, bottom-right the largest; top-right the
+// smallest y - x, bottom-left the largest
+std::array<cv::Point2f, 4> orderCorners(const std::vector<cv::Point>& points) {
+    std::array<cv::Point2f, 4> corners;
+    auto sum = [](const cv::Point& p) { return p.x + p.y; };
+    auto diff = [](const cv::Point& p) { return p.y - p.x; };
+    corners[0] = *std::min_element(points.begin(), points.end(),
+                                   [&](const cv::Point& a, const cv::Point& b) { return sum(a) < sum(b); });
+    corners[2] = *std::max_element(points.begin(), points.end(),
+                                   [&](const cv::Point& a, const cv::Point& b) { return sum(a) < sum(b); });
+    corners[1] = *std::min_element(points.begin(), points.end(),
+                                   [&](const cv::Point& a, const cv::Point& b) { return diff(a) < diff(b); });
+    corners[3] = *std::max_element(points.begin(), points.end(),
+                                   [&](const cv::Point& a, const cv::Point& b) { return diff(a) < diff(b); });
+    return corners;
+}
+
+float distance(const cv::Point2f& a, const cv::Point2f& b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+}  // namespace
+
+bool findPageQuad(const cv::Mat& image, PixelFormat format, PageQuad& quad) {
+    if (image.empty()) {
+        return false;
+    }
+
+    // 1. Shrink first: the page border survives, texture and text do not
+    const float scale = std::min(1.0f, static_cast<float>(kPageCropAnalysisSize) / std::max(image.cols, image.rows));
+    cv::Mat small = image;
+    if (scale < 1.0f) {
+        cv::resize(image, small,
+                   cv::Size(std::max(1, static_cast<int>(std::lround(image.cols * scale))),
+                            std::max(1, static_cast<int>(std::lround(image.rows * scale)))),
+                   0, 0, cv::INTER_AREA);
+    }
+    cv::Mat gray;
+    toGray(small, format, gray);
+    cv::GaussianBlur(gray, gray, cv::Size(5, 5), 0);
+
+    // 2. Edges with thresholds around the median, so dim and bright scenes
+    //    both work; dilation closes the small gaps a finger or glare leaves
+    const int median = medianLevel(gray);
+    cv::Mat edges;
+    cv::Canny(gray, edges, std::max(0.0, 0.66 * median), std::min(255.0, 1.33 * median + 1.0));
+    cv::dilate(edges, edges, cv::Mat());
+
+    // 3. The largest convex quadrilateral within the coverage limits
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(edges, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
+    const double frame_area = static_cast<double>(small.cols) * small.rows;
+    double best_area = 0.0;
+    std::vector<cv::Point> best;
+    std::vector<cv::Point> approx;
+    for (const std::vector<cv::Point>& contour : contours) {
+        const double area = std::fabs(cv::contourArea(contour));
+        if (area < kPageCropMinCoverage * frame_area || area <= best_area) {
+            continue;
+        }
+        cv::approxPolyDP(contour, approx, 0.02 * cv::arcLength(contour, true), true);
+        if (approx.size() != 4 || !cv::isContourConvex(approx)) {
+            continue;
+        }
+        const double quad_area = std::fabs(cv::contourArea(approx));
+        if (quad_area < kPageCropMinCoverage * frame_area || quad_area > kPageCropMaxCoverage * frame_area) {
+            continue;
+        }
+        best_area = quad_area;
+        best = approx;
+    }
+    if (best.empty()) {
+        return false;
+    }
+
+    quad.corners = orderCorners(best);
+    for (cv::Point2f& corner : quad.corners) {
+        corner.x = std::min(corner.x / scale, static_cast<float>(image.cols));
+        corner.y = std::min(corner.y / scale, static_cast<float>(image.rows));
+    }
+    quad.coverage = static_cast<float>(best_area / frame_area);
+    return true;
+}
+
+void warpPage(const cv::Mat& image, const PageQuad& quad, int min_width, int min_height, PageCrop& crop) {
+    const std::array<cv::Point2f, 4>& c = quad.corners;
+    const float width = std::max(std::max(distance(c[0], c[1]), distance(c[3], c[2])), 1.0f);
+    const float height = std::max(std::max(distance(c[0], c[3]), distance(c[1], c[2])), 1.0f);
+
+    // Enough pixels for the model input on both sides, but no upsampling
+    // past what the frame holds of the page
+    const float scale = std::min(1.0f, std::max(min_width / width, min_height / height));
+    const int page_width = std::max(1, static_cast<int>(std::lround(width * scale)));
+    const int page_height = std::max(1, static_cast<int>(std::lround(height * scale)));
+
+    const cv::Point2f page_corners[4] = {
+        cv::Point2f(0.0f, 0.0f),
+        cv::Point2f(static_cast<float>(page_width), 0.0f),
+        cv::Point2f(static_cast<float>(page_width), static_cast<float>(page_height)),
+        cv::Point2f(0.0f, static_cast<float>(page_height)),
+    };
+    cv::Mat to_page = cv::getPerspectiveTransform(c.data(), page_corners);
+    cv::Mat to_frame = cv::getPerspectiveTransform(page_corners, c.data());
+    cv::warpPerspective(image, crop.page, to_page, cv::Size(page_width, page_height), cv::INTER_LINEAR,
+                        cv::BORDER_REPLICATE);
+    crop.to_frame = cv::Matx33d(to_frame.ptr<double>());
+}
+
+void mapDetectionsFromPage(std::vector<DetectionBox>& detections, const cv::Matx33d& to_frame,
+                           int frame_width, int frame_height) {
+    const float max_x = static_cast<float>(frame_width);
+    const float max_y = static_cast<float>(frame_height);
+    for (DetectionBox& box : detections) {
+        const float xs[4] = {box.x1, box.x2, box.x2, box.x1};
+        const float ys[4] = {box.y1, box.y1, box.y2, box.y2};
+        float x1 = max_x, y1 = max_y, x2 = 0.0f, y2 = 0.0f;
+        for (int i = 0; i < 4; i++) {
+            const double w = to_frame(2, 0) * xs[i] + to_frame(2, 1) * ys[i] + to_frame(2, 2);
+            const float x = static_cast<float>((to_frame(0, 0) * xs[i] + to_frame(0, 1) * ys[i] + to_frame(0, 2)) / w);
+            const float y = static_cast<float>((to_frame(1, 0) * xs[i] + to_frame(1, 1) * ys[i] + to_frame(1, 2)) / w);
+            x1 = std::min(x1, x);
+            y1 = std::min(y1, y);
+            x2 = std::max(x2, x);
+            y2 = std::max(y2, y);
+        }
+        box.x1 = std::max(0.0f, std::min(x1, max_x));
+        box.y1 = std::max(0.0f, std::min(y1, max_y));
+        box.x2 = std::max(0.0f, std::min(x2, max_x));
+        box.y2 = std::max(0.0f, std::min(y2, max_y));
+    }
+}
@@ -0,0 +1,185 @@
+#include "include/page_pipeline.h"
+#include "include/latency_stats.h"
+
+PagePipeline::PagePipeline(std::shared_ptr<DocDetector> detector, float conf_threshold, size_t queue_depth,
+                           Serializer serializer, PageCallback callback)
+    : detector_(std::move(detector)),
+      conf_threshold_(conf_threshold),
+      serializer_(std::move(serializer)),
+      callback_(std::move(callback)),
+      source_queue_(queue_depth > 0 ? queue_depth : kDefaultQueueDepth),
+      decoded_queue_(queue_depth > 0 ? queue_depth : kDefaultQueueDepth),
+      staged_queue_(queue_depth > 0 ? queue_depth : kDefaultQueueDepth),
+      inferred_queue_(queue_depth > 0 ? queue_depth : kDefaultQueueDepth),
+      free_inputs_((queue_depth > 0 ? queue_depth : kDefaultQueueDepth) + 2) {
+    // Enough tensors for a full staged queue plus one in each neighbouring stage
+    size_t depth = queue_depth > 0 ? queue_depth : kDefaultQueueDepth;
+    for (size_t i = 0; i < depth + 2; i++) {
+        free_inputs_.Push(std::unique_ptr<PreparedInput>(new PreparedInput()));
+    }
+
+    threads_.emplace_back(&PagePipeline::DecodeStage, this);
+    threads_.emplace_back(&PagePipeline::PreprocessStage, this);
+    threads_.emplace_back(&PagePipeline::InferStage, this);
+    threads_.emplace_back(&PagePipeline::SerializeStage, this);
+}
+
+PagePipeline::~PagePipeline() {
+    Finish();
+}
+
+int64_t PagePipeline::SubmitEncoded(std::vector<uint8_t> bytes) {
+    SourcePage page;
+    page.bytes = std::move(bytes);
+    return Submit(std::move(page));
+}
+
+int64_t PagePipeline::SubmitFile(std::string path) {
+    SourcePage page;
+    page.path = std::move(path);
+    return Submit(std::move(page));
+}
+
+int64_t PagePipeline::SubmitDecoded(DecodedImage decoded) {
+    SourcePage page;
+    page.decoded = std::move(decoded);
+    page.predecoded = true;
+    return Submit(std::move(page));
+}
+
+int64_t PagePipeline::Submit(SourcePage page) {
+    // Held across Push so indices match queue order
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    if (finished_) {
+        return -1;
+    }
+    page.index = next_index_;
+    page.start = Clock::now();
+    if (!source_queue_.Push(std::move(page))) {
+        return -1;
+    }
+    return static_cast<int64_t>(next_index_++);
+}
+
+void PagePipeline::Finish() {
+    {
+        std::lock_guard<std::mutex> lock(submit_mutex_);
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+    }
+    // Each stage closes the next queue once its input is drained
+    source_queue_.Close();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void PagePipeline::DecodeStage() {
+    SourcePage page;
+    while (source_queue_.Pop(page)) {
+        DecodedPage decoded;
+        decoded.index = page.index;
+        decoded.start = page.start;
+
+        if (page.predecoded) {
+            decoded.decoded = std::move(page.decoded);
+            if (decoded.decoded.image.empty()) {
+                decoded.error = "Could not load image";
+                decoded.error_code = "IMAGE_LOAD_FAILED";
+            }
+        } else if (!page.path.empty()) {
+            if (readFileBytes(page.path.c_str(), page.bytes)) {
+                decoded.decoded = detector_->Decode(page.bytes.data(), page.bytes.size());
+            }
+            if (decoded.decoded.image.empty()) {
+                decoded.error = "Could not load image";
+                decoded.error_code = "IMAGE_LOAD_FAILED";
+            }
+        } else {
+            decoded.decoded = detector_->Decode(page.bytes.data(), page.bytes.size());
+            if (decoded.decoded.image.empty()) {
+                decoded.error = page.bytes.empty() ? "Empty image buffer" : "Could not decode image";
+                decoded.error_code = "IMAGE_DECODE_FAILED";
+            }
+        }
+        // Release the encoded bytes before blocking on the next queue
+        page = SourcePage();
+
+        decoded_queue_.Push(std::move(decoded));
+    }
+    decoded_queue_.Close();
+}
+
+void PagePipeline::PreprocessStage() {
+    DecodedPage decoded;
+    while (decoded_queue_.Pop(decoded)) {
+        StagedPage staged;
+        staged.index = decoded.index;
+        staged.start = decoded.start;
+        staged.error = std::move(decoded.error);
+        staged.error_code = std::move(decoded.error_code);
+        staged.original_width = decoded.decoded.original_width;
+        staged.original_height = decoded.decoded.original_height;
+
+        if (staged.error.empty() && free_inputs_.Pop(staged.input)) {
+            try {
+                detector_->Preprocess(decoded.decoded.image, PixelFormat::kBGR, *staged.input);
+            } catch (const cv::Exception& e) {
+                (void)e;
+                staged.error = "Preprocess failed";
+                staged.error_code = "INFERENCE_FAILED";
+            }
+        }
+        detector_->RecycleDecoded(decoded.decoded);
+
+        staged_queue_.Push(std::move(staged));
+    }
+    staged_queue_.Close();
+}
+
+void PagePipeline::InferStage() {
+    StagedPage staged;
+    while (staged_queue_.Pop(staged)) {
+        InferredPage inferred;
+        inferred.start = staged.start;
+        inferred.result.page_index = staged.index;
+        inferred.result.error = std::move(staged.error);
+        inferred.result.error_code = std::move(staged.error_code);
+
+        if (staged.input) {
+            if (inferred.result.error.empty()) {
+                if (detector_->Infer(*staged.input, conf_threshold_, inferred.result.detections)) {
+                    mapDetectionsToOriginal(inferred.result.detections,
+                                            staged.input->image_width, staged.input->image_height,
+                                            staged.original_width, staged.original_height);
+                    inferred.result.image_width = staged.original_width;
+                    inferred.result.image_height = staged.original_height;
+                } else {
+                    inferred.result.error = "Inference failed";
+                    inferred.result.error_code = "INFERENCE_FAILED";
+                }
+            }
+            free_inputs_.Push(std::move(staged.input));
+        }
+
+        inferred_queue_.Push(std::move(inferred));
+    }
+    inferred_queue_.Close();
+}
+
+void PagePipeline::SerializeStage() {
+    InferredPage inferred;
+    while (inferred_queue_.Pop(inferred)) {
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - inferred.start;
+        inferred.result.elapsed_ms = static_cast<long long>(elapsed.count());
+        StageTimer serialize_timer(kStageSerialize);
+        std::string json = serializer_(inferred.result);
+        serialize_timer.Stop();
+        LatencyStats::GetInstance().Record(kStageTotal, elapsed.count());
+        callback_(inferred.result.page_index, std::move(json));
+    }
+}
@@ -0,0 +1,257 @@
+#include "include/postprocess.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DOCLAYOUT_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DOCLAYOUT_SSE2 1
+#endif
+
+namespace {
+
+// Per-thread column arrays so steady-state filtering does not allocate
+struct FilterScratch {
+    std::vector<float> threshold;   // per class, resolved against conf_threshold
+    std::vector<int> kept;          // row indices that passed
+    std::vector<float> coords[4];   // x1, y1, x2, y2 of the kept rows
+};
+
+thread_local FilterScratch t_filter;
+
+// Per-thread buffers of the reading-order sort
+struct ReadingScratch {
+    std::vector<int> indices;           // into the refined range, cut in place
+    std::vector<DetectionBox> sorted;   // boxes in reading order
+};
+
+thread_local ReadingScratch t_reading;
+
+// v[i] = clamp(v[i] * scale, 0, limit)
+void scaleClamp(float* v, int n, float scale, float limit) {
+    int i = 0;
+#if defined(DOCLAYOUT_NEON)
+    const float32x4_t vzero = vdupq_n_f32(0.0f);
+    const float32x4_t vlimit = vdupq_n_f32(limit);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t x = vmulq_n_f32(vld1q_f32(v + i), scale);
+        vst1q_f32(v + i, vminq_f32(vmaxq_f32(x, vzero), vlimit));
+    }
+#elif defined(DOCLAYOUT_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 vzero = _mm_setzero_ps();
+    const __m128 vlimit = _mm_set1_ps(limit);
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(v + i), vscale);
+        _mm_storeu_ps(v + i, _mm_min_ps(_mm_max_ps(x, vzero), vlimit));
+    }
+#endif
+    for (; i < n; i++) {
+        v[i] = std::max(0.0f, std::min(v[i] * scale, limit));
+    }
+}
+
+inline float area(const DetectionBox& box) {
+    return std::max(0.0f, box.x2 - box.x1) * std::max(0.0f, box.y2 - box.y1);
+}
+
+inline float intersection(const DetectionBox& a, const DetectionBox& b) {
+    const float w = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+    const float h = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+    return (w > 0.0f && h > 0.0f) ? w * h : 0.0f;
+}
+
+// Stable insertion sort by score, in place: std::stable_sort may allocate a
+// merge buffer, and model output arrives nearly sorted already
+void sortByScore(DetectionBox* boxes, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        const DetectionBox box = boxes[i];
+        size_t j = i;
+        for (; j > 0 && boxes[j - 1].score < box.score; j--) {
+            boxes[j] = boxes[j - 1];
+        }
+        boxes[j] = box;
+    }
+}
+
+// Greedy suppression in score order of detections[first, end);
+// drop(kept, candidate) decides per pair
+template <typename DropFn>
+void suppress(std::vector<DetectionBox>& detections, size_t first, DropFn drop) {
+    if (first >= detections.size()) {
+        return;
+    }
+    DetectionBox* boxes = detections.data() + first;
+    const size_t count = detections.size() - first;
+    sortByScore(boxes, count);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool dropped = false;
+        for (size_t k = 0; k < kept; k++) {
+            if (boxes[k].class_id == boxes[i].class_id && drop(boxes[k], boxes[i])) {
+                dropped = true;
+                break;
+            }
+        }
+        if (!dropped) {
+            boxes[kept++] = boxes[i];
+        }
+    }
+    detections.resize(first + kept);
+}
+
+// End of the group starting at indices[begin] along one axis: the group
+// grows while the next box starts before the reach of the boxes so far
+size_t groupEnd(const DetectionBox* boxes, const int* indices, size_t begin, size_t end, bool vertical) {
+    auto lo = [&](int i) { return vertical ? boxes[i].y1 : boxes[i].x1; };
+    auto hi = [&](int i) { return vertical ? boxes[i].y2 : boxes[i].x2; };
+    float reach = hi(indices[begin]);
+    size_t i = begin + 1;
+    for (; i < end && lo(indices[i]) < reach; i++) {
+        reach = std::max(reach, hi(indices[i]));
+    }
+    return i;
+}
+
+// Groups are contiguous once indices[begin, end) is sorted along the cut
+// axis, so the recursion works on subranges of one index array
+void xyCut(const DetectionBox* boxes, int* indices, size_t begin, size_t end,
+           std::vector<DetectionBox>& sorted) {
+    if (end - begin > 1) {
+        for (bool vertical : {true, false}) {  // bands top to bottom, then columns left to right
+            std::sort(indices + begin, indices + end, [&](int a, int b) {
+                return vertical ? boxes[a].y1 < boxes[b].y1 : boxes[a].x1 < boxes[b].x1;
+            });
+            if (groupEnd(boxes, indices, begin, end, vertical) < end) {
+                for (size_t group = begin; group < end;) {
+                    const size_t next = groupEnd(boxes, indices, group, end, vertical);
+                    xyCut(boxes, indices, group, next, sorted);
+                    group = next;
+                }
+                return;
+            }
+        }
+        // Overlapping boxes with no clean cut: top to bottom, then left to right
+        std::sort(indices + begin, indices + end, [&](int a, int b) {
+            return boxes[a].y1 != boxes[b].y1 ? boxes[a].y1 < boxes[b].y1 : boxes[a].x1 < boxes[b].x1;
+        });
+    }
+    for (size_t i = begin; i < end; i++) {
+        sorted.push_back(boxes[indices[i]]);
+    }
+}
+
+}  // namespace
+
+std::string PostprocessOptions::Id() const {
+    if (*this == PostprocessOptions()) {
+        return std::string();
+    }
+    std::string id = "#pp";
+    char buf[32];
+    for (float t : class_thresholds) {
+        std::snprintf(buf, sizeof(buf), ":%.3f", t);
+        id += buf;
+    }
+    std::snprintf(buf, sizeof(buf), "/%.3f/%.3f/%d", nms_iou, containment, reading_order ? 1 : 0);
+    return id + buf;
+}
+
+void filterDetections(const float* rows, int num_rows, int num_classes, float conf_threshold,
+                      const PostprocessOptions& options, float inv_scale_x, float inv_scale_y,
+                      int image_width, int image_height, std::vector<DetectionBox>& results) {
+    if (num_rows <= 0 || num_classes <= 0) {
+        return;
+    }
+    FilterScratch& scratch = t_filter;
+
+    // Threshold per class, so the row test is one table lookup
+    scratch.threshold.assign(num_classes, conf_threshold);
+    for (size_t c = 0; c < options.class_thresholds.size() && c < static_cast<size_t>(num_classes); c++) {
+        if (options.class_thresholds[c] >= 0.0f) {
+            scratch.threshold[c] = options.class_thresholds[c];
+        }
+    }
+
+    // 1. Score test over the [class_id, score] columns
+    scratch.kept.clear();
+    for (int i = 0; i < num_rows; i++) {
+        const int class_id = static_cast<int>(rows[i * 6 + 0]);
+        if (class_id >= 0 && class_id < num_classes && rows[i * 6 + 1] >= scratch.threshold[class_id]) {
+            scratch.kept.push_back(i);
+        }
+    }
+    const int n = static_cast<int>(scratch.kept.size());
+    if (n == 0) {
+        return;
+    }
+
+    // 2. Gather the kept coordinates into columns, scale and clamp them four at a time
+    for (int c = 0; c < 4; c++) {
+        scratch.coords[c].resize(n);
+        for (int k = 0; k < n; k++) {
+            scratch.coords[c][k] = rows[scratch.kept[k] * 6 + 2 + c];
+        }
+    }
+    scaleClamp(scratch.coords[0].data(), n, inv_scale_x, static_cast<float>(image_width));
+    scaleClamp(scratch.coords[1].data(), n, inv_scale_y, static_cast<float>(image_height));
+    scaleClamp(scratch.coords[2].data(), n, inv_scale_x, static_cast<float>(image_width));
+    scaleClamp(scratch.coords[3].data(), n, inv_scale_y, static_cast<float>(image_height));
+
+    // 3. Write the boxes, no per-box heap work
+    const size_t base = results.size();
+    results.resize(base + n);
+    for (int k = 0; k < n; k++) {
+        const float* row = rows + scratch.kept[k] * 6;
+        DetectionBox& box = results[base + k];
+        box.x1 = scratch.coords[0][k];
+        box.y1 = scratch.coords[1][k];
+        box.x2 = scratch.coords[2][k];
+        box.y2 = scratch.coords[3][k];
+        box.score = row[1];
+        box.class_id = static_cast<int>(row[0]);
+    }
+}
+
+void nmsDetections(std::vector<DetectionBox>& detections, float iou_threshold, size_t first) {
+    suppress(detections, first, [iou_threshold](const DetectionBox& kept, const DetectionBox& box) {
+        const float inter = intersection(kept, box);
+        const float uni = area(kept) + area(box) - inter;
+        return uni > 0.0f && inter / uni > iou_threshold;
+    });
+}
+
+void suppressContained(std::vector<DetectionBox>& detections, float fraction, size_t first) {
+    suppress(detections, first, [fraction](const DetectionBox& kept, const DetectionBox& box) {
+        const float box_area = area(box);
+        return box_area > 0.0f && intersection(kept, box) >= fraction * box_area;
+    });
+}
+
+void sortReadingOrder(std::vector<DetectionBox>& detections, size_t first) {
+    if (first >= detections.size()) {
+        return;
+    }
+    ReadingScratch& scratch = t_reading;
+    const size_t count = detections.size() - first;
+    scratch.indices.resize(count);
+    std::iota(scratch.indices.begin(), scratch.indices.end(), 0);
+    scratch.sorted.clear();
+    xyCut(detections.data() + first, scratch.indices.data(), 0, count, scratch.sorted);
+    std::copy(scratch.sorted.begin(), scratch.sorted.end(), detections.begin() + first);
+}
+
+void refineDetections(std::vector<DetectionBox>& detections, const PostprocessOptions& options, size_t first) {
+    if (options.nms_iou > 0.0f) {
+        nmsDetections(detections, options.nms_iou, first);
+    }
+    if (options.containment > 0.0f) {
+        suppressContained(detections, options.containment, first);
+    }
+    if (options.reading_order) {
+        sortReadingOrder(detections, first);
+    }
+}
@@ -0,0 +1,46 @@
+#include "include/region_crops.h"
+#include <algorithm>
+#include <cmath>
+
+void cropDetections(const cv::Mat& page, const std::vector<DetectionBox>& detections, const CropOptions& options,
+                    std::vector<RegionCrop>& crops) {
+    crops.clear();
+    if (page.empty()) {
+        return;
+    }
+    const cv::Rect bounds(0, 0, page.cols, page.rows);
+    const float padding = std::max(0.0f, options.padding);
+    std::vector<int> params;
+    if (options.encoding == kCropJpeg) {
+        params = {cv::IMWRITE_JPEG_QUALITY, std::max(1, std::min(options.jpeg_quality, 100))};
+    }
+
+    for (size_t i = 0; i < detections.size(); i++) {
+        const DetectionBox& box = detections[i];
+        if (!options.class_ids.empty() &&
+            std::find(options.class_ids.begin(), options.class_ids.end(), box.class_id) == options.class_ids.end()) {
+            continue;
+        }
+        const float pad_x = (box.x2 - box.x1) * padding;
+        const float pad_y = (box.y2 - box.y1) * padding;
+        const int x1 = static_cast<int>(std::floor(box.x1 - pad_x));
+        const int y1 = static_cast<int>(std::floor(box.y1 - pad_y));
+        const int x2 = static_cast<int>(std::ceil(box.x2 + pad_x));
+        const int y2 = static_cast<int>(std::ceil(box.y2 + pad_y));
+        const cv::Rect rect = cv::Rect(x1, y1, x2 - x1, y2 - y1) & bounds;
+        if (rect.width <= 0 || rect.height <= 0) {
+            continue;
+        }
+
+        RegionCrop crop;
+        crop.detection_index = i;
+        crop.rect = rect;
+        crop.view = page(rect);
+        if (options.encoding == kCropPng || options.encoding == kCropJpeg) {
+            if (!cv::imencode(options.encoding == kCropPng ? ".png" : ".jpg", crop.view, crop.encoded, params)) {
+                continue;
+            }
+        }
+        crops.push_back(std::move(crop));
+    }
+}
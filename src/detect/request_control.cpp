@@ -0,0 +1,141 @@
+#include "include/request_control.h"
+#include <algorithm>
+
+thread_local RequestControl* ScopedRequest::current_ = nullptr;
+
+RequestControl::RequestControl(int64_t id, int64_t lane, int deadline_ms)
+    : id_(id),
+      lane_(lane),
+      has_deadline_(deadline_ms > 0),
+      deadline_(Clock::now() + std::chrono::milliseconds(deadline_ms > 0 ? deadline_ms : 0)) {}
+
+bool RequestControl::Stop(int reason) {
+    int expected = kRequestActive;
+    if (!state_.compare_exchange_strong(expected, reason, std::memory_order_acq_rel)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    for (Ort::RunOptions* run : runs_) {
+        run->SetTerminate();
+    }
+    return true;
+}
+
+bool RequestControl::CheckDeadline() {
+    return has_deadline_ && Clock::now() >= deadline_ && Stop(kRequestDeadlineExceeded);
+}
+
+void RequestControl::AttachRun(Ort::RunOptions* options) {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    runs_.push_back(options);
+    if (Stopped()) {
+        options->SetTerminate();
+    }
+}
+
+void RequestControl::DetachRun(Ort::RunOptions* options) {
+    std::lock_guard<std::mutex> lock(run_mutex_);
+    runs_.erase(std::remove(runs_.begin(), runs_.end(), options), runs_.end());
+    // A stopped request may have terminated this run; clearing an
+    // untouched flag is harmless
+    if (Stopped()) {
+        options->UnsetTerminate();
+    }
+}
+
+RequestRegistry& RequestRegistry::GetInstance() {
+    static RequestRegistry instance;
+    return instance;
+}
+
+RequestRegistry::RequestRegistry() {
+    watchdog_ = std::thread(&RequestRegistry::Watch, this);
+}
+
+RequestRegistry::~RequestRegistry() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (watchdog_.joinable()) {
+        watchdog_.join();
+    }
+}
+
+std::shared_ptr<RequestControl> RequestRegistry::Register(int64_t id, int64_t lane, int deadline_ms) {
+    auto request = std::make_shared<RequestControl>(id, lane, deadline_ms);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (lane != 0) {
+            for (auto& entry : requests_) {
+                if (entry.second->Lane() == lane) {
+                    entry.second->Stop(kRequestSuperseded);
+                }
+            }
+        }
+        requests_.emplace(id, request);
+    }
+    if (request->HasDeadline()) {
+        // The watchdog may be sleeping until a later deadline
+        cv_.notify_one();
+    }
+    return request;
+}
+
+void RequestRegistry::Remove(const std::shared_ptr<RequestControl>& request) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = requests_.equal_range(request->Id());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == request) {
+            requests_.erase(it);
+            return;
+        }
+    }
+}
+
+bool RequestRegistry::Cancel(int64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool stopped = false;
+    auto range = requests_.equal_range(id);
+    for (auto it = range.first; it != range.second; ++it) {
+        stopped = it->second->Stop(kRequestCancelled) || stopped;
+    }
+    return stopped;
+}
+
+int RequestRegistry::CancelLane(int64_t lane) {
+    if (lane == 0) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    int stopped = 0;
+    for (auto& entry : requests_) {
+        if (entry.second->Lane() == lane && entry.second->Stop(kRequestCancelled)) {
+            stopped++;
+        }
+    }
+    return stopped;
+}
+
+void RequestRegistry::Watch() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // Stop what has expired and sleep until the next deadline
+        RequestControl::Clock::time_point next = RequestControl::Clock::time_point::max();
+        for (auto& entry : requests_) {
+            RequestControl& request = *entry.second;
+            if (!request.HasDeadline() || request.Stopped()) {
+                continue;
+            }
+            if (!request.CheckDeadline() && request.Deadline() < next) {
+                next = request.Deadline();
+            }
+        }
+        if (next == RequestControl::Clock::time_point::max()) {
+            cv_.wait(lock);
+        } else {
+            cv_.wait_until(lock, next);
+        }
+    }
+}
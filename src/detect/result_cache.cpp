@@ -0,0 +1,408 @@
+#include "include/result_cache.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+// Disk entry: header, then count x {x1, y1, x2, y2, score, class_id}
+constexpr uint32_t kDiskMagic = 0x31434C44;  // "DLC1"
+constexpr const char* kDiskExtension = ".dlc";
+
+struct DiskHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t content_hash;
+    uint64_t model_hash;
+    uint64_t length;
+    float conf_threshold;
+    int32_t image_width;
+    int32_t image_height;
+    int32_t reserved;
+};
+
+struct DiskBox {
+    float x1, y1, x2, y2, score;
+    int32_t class_id;
+};
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl64(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+    acc ^= round64(0, val);
+    return acc * kPrime1 + kPrime4;
+}
+
+bool makeDirectory(const std::string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0700) == 0 || errno == EEXIST;
+#endif
+}
+
+// Remove every cache entry file in dir
+void removeDiskEntries(const std::string& dir) {
+    const size_t ext_len = std::strlen(kDiskExtension);
+    auto isEntry = [&](const std::string& name) {
+        return name.size() > ext_len && name.compare(name.size() - ext_len, ext_len, kDiskExtension) == 0;
+    };
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((dir + "\\*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        if (isEntry(data.cFileName)) {
+            std::remove((dir + "/" + data.cFileName).c_str());
+        }
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    DIR* handle = opendir(dir.c_str());
+    if (handle == nullptr) {
+        return;
+    }
+    while (dirent* entry = readdir(handle)) {
+        if (isEntry(entry->d_name)) {
+            std::remove((dir + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(handle);
+#endif
+}
+
+}  // namespace
+
+ResultCache& ResultCache::GetInstance() {
+    static ResultCache instance;
+    return instance;
+}
+
+uint64_t ResultCache::Hash(const void* data, size_t len, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + len;
+    uint64_t h;
+
+    if (len >= 32) {
+        // Four independent lanes keep the multipliers busy
+        uint64_t v1 = seed + kPrime1 + kPrime2;
+        uint64_t v2 = seed + kPrime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - kPrime1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + kPrime5;
+    }
+
+    h += static_cast<uint64_t>(len);
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= round64(0, read64(p));
+        h = rotl64(h, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl64(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= static_cast<uint64_t>(*p) * kPrime5;
+        h = rotl64(h, 11) * kPrime1;
+    }
+
+    // Avalanche
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+CacheKey ResultCache::MakeKey(const uint8_t* data, size_t len, float conf_threshold, const std::string& model_id) {
+    CacheKey key;
+    key.content_hash = Hash(data, len);
+    key.model_hash = Hash(model_id.data(), model_id.size());
+    key.length = len;
+    key.conf_threshold = conf_threshold;
+    return key;
+}
+
+size_t ResultCache::KeyHash::operator()(const CacheKey& key) const {
+    return static_cast<size_t>(key.content_hash ^ rotl64(key.model_hash, 17));
+}
+
+size_t ResultCache::EntryBytes(const CachedResult& result) {
+    // Entry, list node and index slot, plus the boxes
+    return sizeof(Entry) + 4 * sizeof(void*) + sizeof(CacheKey) +
+           result.detections.capacity() * sizeof(DetectionBox);
+}
+
+bool ResultCache::Configure(size_t max_bytes, const std::string& disk_dir) {
+    if (!disk_dir.empty() && !makeDirectory(disk_dir)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_bytes_ = max_bytes;
+    disk_dir_ = max_bytes > 0 ? disk_dir : std::string();
+    EvictLocked();
+    return true;
+}
+
+bool ResultCache::Enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_bytes_ > 0;
+}
+
+bool ResultCache::Lookup(const CacheKey& key, CachedResult& result) {
+    std::string disk_path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (max_bytes_ == 0) {
+            return false;
+        }
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            result = it->second->result;
+            stats_.hits++;
+            return true;
+        }
+        if (disk_dir_.empty()) {
+            stats_.misses++;
+            return false;
+        }
+        disk_path = DiskPathLocked(key);
+    }
+
+    // Disk I/O without holding the lock
+    bool found = ReadDisk(disk_path, key, result);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!found) {
+        stats_.misses++;
+        return false;
+    }
+    stats_.hits++;
+    stats_.disk_hits++;
+    if (max_bytes_ > 0) {
+        InsertLocked(key, result);
+    }
+    return true;
+}
+
+void ResultCache::Insert(const CacheKey& key, const CachedResult& result) {
+    std::string disk_path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (max_bytes_ == 0) {
+            return;
+        }
+        InsertLocked(key, result);
+        if (!disk_dir_.empty()) {
+            disk_path = DiskPathLocked(key);
+        }
+    }
+
+    if (!disk_path.empty()) {
+        WriteDisk(disk_path, key, result);
+    }
+}
+
+void ResultCache::Clear(bool remove_disk) {
+    std::string disk_dir;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lru_.clear();
+        index_.clear();
+        stats_ = CacheStats();
+        disk_dir = disk_dir_;
+    }
+    if (remove_disk && !disk_dir.empty()) {
+        removeDiskEntries(disk_dir);
+    }
+}
+
+CacheStats ResultCache::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ResultCache::InsertLocked(const CacheKey& key, const CachedResult& result) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        stats_.bytes -= it->second->bytes;
+        stats_.entries--;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.result = result;
+    entry.bytes = EntryBytes(entry.result);
+    if (entry.bytes > max_bytes_) {
+        return;
+    }
+
+    stats_.bytes += entry.bytes;
+    stats_.entries++;
+    lru_.push_front(std::move(entry));
+    index_[key] = lru_.begin();
+    EvictLocked();
+}
+
+void ResultCache::EvictLocked() {
+    while (!lru_.empty() && stats_.bytes > max_bytes_) {
+        const Entry& victim = lru_.back();
+        stats_.bytes -= victim.bytes;
+        stats_.entries--;
+        stats_.evictions++;
+        index_.erase(victim.key);
+        lru_.pop_back();
+    }
+}
+
+std::string ResultCache::DiskPathLocked(const CacheKey& key) const {
+    uint32_t conf_bits;
+    std::memcpy(&conf_bits, &key.conf_threshold, sizeof(conf_bits));
+    uint64_t parts[4] = {key.content_hash, key.model_hash, key.length, conf_bits};
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(Hash(parts, sizeof(parts))));
+    return disk_dir_ + "/" + name + kDiskExtension;
+}
+
+bool ResultCache::ReadDisk(const std::string& path, const CacheKey& key, CachedResult& result) const {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // The entry is exactly a header plus count boxes; anything else is a
+    // truncated or corrupted file, whose count must not be trusted
+    long file_size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        file_size = std::ftell(file);
+        std::rewind(file);
+    }
+    DiskHeader header;
+    bool intact = file_size >= static_cast<long>(sizeof(header)) &&
+                  std::fread(&header, sizeof(header), 1, file) == 1 && header.magic == kDiskMagic &&
+                  static_cast<uint64_t>(file_size) - sizeof(header) ==
+                      static_cast<uint64_t>(header.count) * sizeof(DiskBox);
+    bool ok = intact && header.content_hash == key.content_hash && header.model_hash == key.model_hash &&
+              header.length == key.length && header.conf_threshold == key.conf_threshold;
+
+    std::vector<DiskBox> boxes;
+    if (ok) {
+        boxes.resize(header.count);
+        ok = intact = header.count == 0 ||
+                      std::fread(boxes.data(), sizeof(DiskBox), header.count, file) == header.count;
+    }
+    std::fclose(file);
+    if (!intact) {
+        std::remove(path.c_str());
+    }
+    if (!ok) {
+        return false;
+    }
+
+    result.image_width = header.image_width;
+    result.image_height = header.image_height;
+    result.detections.clear();
+    result.detections.reserve(boxes.size());
+    for (const DiskBox& b : boxes) {
+        DetectionBox box;
+        box.x1 = b.x1;
+        box.y1 = b.y1;
+        box.x2 = b.x2;
+        box.y2 = b.y2;
+        box.score = b.score;
+        box.class_id = b.class_id;
+        result.detections.push_back(box);
+    }
+    return true;
+}
+
+bool ResultCache::WriteDisk(const std::string& path, const CacheKey& key, const CachedResult& result) const {
+    DiskHeader header = {};
+    header.magic = kDiskMagic;
+    header.count = static_cast<uint32_t>(result.detections.size());
+    header.content_hash = key.content_hash;
+    header.model_hash = key.model_hash;
+    header.length = key.length;
+    header.conf_threshold = key.conf_threshold;
+    header.image_width = result.image_width;
+    header.image_height = result.image_height;
+
+    std::vector<DiskBox> boxes;
+    boxes.reserve(result.detections.size());
+    for (const DetectionBox& box : result.detections) {
+        boxes.push_back({box.x1, box.y1, box.x2, box.y2, box.score, box.class_id});
+    }
+
+    // Write to a temporary name and rename, readers never see a partial entry
+    std::string tmp_path = path + ".tmp";
+    FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              (boxes.empty() || std::fwrite(boxes.data(), sizeof(DiskBox), boxes.size(), file) == boxes.size());
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
@@ -1,37 +1,650 @@
-#include "include/utils.h"
-
-std::pair<cv::Mat, std::vector<float>> preprocessImage(const cv::Mat& img, int target_width, int target_height) {
-    // PP-DocLayout: keep_ratio = false, direct resize
-    int orig_height = img.rows;
-    int orig_width = img.cols;
-
-    // Calculate scale factors for restoring coordinates
-    float scale_x = static_cast<float>(target_width) / orig_width;
-    float scale_y = static_cast<float>(target_height) / orig_height;
-    std::vector<float> scale_factor = {scale_x, scale_y};
-
-    // Convert BGR to RGB (OpenCV loads as BGR)
-    cv::Mat img_rgb;
-    cv::cvtColor(img, img_rgb, cv::COLOR_BGR2RGB);
-
-    // Resize to target size (direct stretch, no padding)
-    cv::Mat resized;
-    cv::resize(img_rgb, resized, cv::Size(target_width, target_height), 0, 0, cv::INTER_LINEAR);
-
-    return {resized, scale_factor};
-}
-
-cv::Mat imageToBlob(const cv::Mat& img) {
-    // PP-DocLayout: mean=[0,0,0], std=[1,1,1] (no normalization, just scale to float)
-    // Input: HWC RGB uint8 -> Output: NCHW float32 [0, 255]
-    cv::Mat blob = cv::dnn::blobFromImage(
-        img,
-        1.0 / 255.0,  // Scale to [0, 1]
-        cv::Size(),   // Keep size
-        cv::Scalar(0, 0, 0),  // No mean subtraction
-        false,        // swapRB: already RGB
-        false,        // crop
-        CV_32F
-    );
-    return blob;
-}
+#include "include/utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+cv::Mat decodeImage(const uint8_t* data, size_t len, cv::Mat* target) {
+    cv::Mat image;
+    if (data == nullptr || len == 0) {
+        return image;
+    }
+    // The buffer is only wrapped, not copied
+    cv::Mat encoded(1, static_cast<int>(len), CV_8UC1, const_cast<uint8_t*>(data));
+    try {
+        image = target != nullptr ? cv::imdecode(encoded, cv::IMREAD_COLOR, target)
+                                  : cv::imdecode(encoded, cv::IMREAD_COLOR);
+    } catch (const cv::Exception& e) {
+        (void)e;
+    }
+    return image;
+}
+
+bool probeJpegSize(const uint8_t* data, size_t len, int& width, int& height) {
+    if (data == nullptr || len < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+
+    // Walk the marker segments up to the first start-of-frame
+    size_t pos = 2;
+    while (pos + 4 <= len) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            pos++;  // fill byte
+            continue;
+        }
+        if (marker == 0xD8 || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            pos += 2;  // no length field
+            continue;
+        }
+        size_t segment = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+        bool is_sof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (is_sof) {
+            if (pos + 9 > len) {
+                return false;
+            }
+            height = (data[pos + 5] << 8) | data[pos + 6];
+            width = (data[pos + 7] << 8) | data[pos + 8];
+            return width > 0 && height > 0;
+        }
+        if (marker == 0xD9 || marker == 0xDA || segment < 2) {
+            return false;  // end of image / entropy-coded data before any frame header
+        }
+        pos += 2 + segment;
+    }
+    return false;
+}
+
+int reducedDecodeFactor(int width, int height, int min_width, int min_height) {
+    if (min_width <= 0 || min_height <= 0) {
+        return 1;
+    }
+    for (int factor = 8; factor > 1; factor /= 2) {
+        if (width / factor >= min_width && height / factor >= min_height) {
+            return factor;
+        }
+    }
+    return 1;
+}
+
+DecodedImage decodeImageReduced(const uint8_t* data, size_t len, int min_width, int min_height,
+                                cv::Mat* target) {
+    DecodedImage decoded;
+    if (data == nullptr || len == 0) {
+        return decoded;
+    }
+
+    int width = 0, height = 0;
+    int factor = 1;
+    if (probeJpegSize(data, len, width, height)) {
+        factor = reducedDecodeFactor(width, height, min_width, min_height);
+    }
+
+    if (factor == 1) {
+        decoded.image = decodeImage(data, len, target);
+        decoded.original_width = decoded.image.cols;
+        decoded.original_height = decoded.image.rows;
+        return decoded;
+    }
+
+    int flags = factor == 8 ? cv::IMREAD_REDUCED_COLOR_8
+              : factor == 4 ? cv::IMREAD_REDUCED_COLOR_4
+              : cv::IMREAD_REDUCED_COLOR_2;
+    cv::Mat encoded(1, static_cast<int>(len), CV_8UC1, const_cast<uint8_t*>(data));
+    try {
+        decoded.image = target != nullptr ? cv::imdecode(encoded, flags, target) : cv::imdecode(encoded, flags);
+    } catch (const cv::Exception& e) {
+        (void)e;
+    }
+    if (decoded.image.empty()) {
+        return decoded;
+    }
+    // Boxes are detected on the reduced image and mapped back with these.
+    // EXIF orientation may have swapped the axes of the decoded image.
+    int expected_cols = (width + factor - 1) / factor;
+    bool rotated = decoded.image.cols != expected_cols && decoded.image.rows == expected_cols;
+    decoded.original_width = rotated ? height : width;
+    decoded.original_height = rotated ? width : height;
+    return decoded;
+}
+
+bool readFileBytes(const char* path, std::vector<uint8_t>& bytes) {
+    if (path == nullptr) {
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    if (size <= 0) {
+        return false;
+    }
+    bytes.resize(static_cast<size_t>(size));
+    file.seekg(0, std::ios::beg);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(bytes.data()), size));
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DOCLAYOUT_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DOCLAYOUT_SSE2 1
+#endif
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#define DOCLAYOUT_F16C 1
+#endif
+
+namespace {
+
+// Source column taps of the output columns (bilinear, pixel-center aligned
+// like cv::INTER_LINEAR), one array per field so weights load four at a time
+struct XTaps {
+    std::vector<int> ofs0, ofs1;  // byte offsets of the two source pixels in a row
+    std::vector<float> w1;        // weight of ofs1
+
+    int size() const { return static_cast<int>(w1.size()); }
+};
+
+// Per-thread scratch so steady-state preprocessing does not allocate
+struct PreprocessScratch {
+    XTaps xtaps;
+    std::vector<float> rows;   // 2 cached source rows x 3 planes x target_width
+    int cached_y[2] = {-1, -1};
+};
+
+thread_local PreprocessScratch t_scratch;
+
+inline void sourceTap(int dst, float inv_scale, int src_size, int& i0, int& i1, float& w1) {
+    float f = (dst + 0.5f) * inv_scale - 0.5f;
+    if (f <= 0.0f) {
+        i0 = i1 = 0;
+        w1 = 0.0f;
+        return;
+    }
+    i0 = static_cast<int>(f);
+    if (i0 >= src_size - 1) {
+        i0 = i1 = src_size - 1;
+        w1 = 0.0f;
+        return;
+    }
+    i1 = i0 + 1;
+    w1 = f - static_cast<float>(i0);
+}
+
+// out[0..3] = a + (b - a) * w
+inline void lerp4(const float* a, const float* b, const float* w, float* out) {
+#if defined(DOCLAYOUT_NEON)
+    const float32x4_t va = vld1q_f32(a);
+    vst1q_f32(out, vmlaq_f32(va, vsubq_f32(vld1q_f32(b), va), vld1q_f32(w)));
+#elif defined(DOCLAYOUT_SSE2)
+    const __m128 va = _mm_loadu_ps(a);
+    _mm_storeu_ps(out, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b), va), _mm_loadu_ps(w))));
+#else
+    for (int k = 0; k < 4; k++) {
+        out[k] = a[k] + (b[k] - a[k]) * w[k];
+    }
+#endif
+}
+
+// Horizontally interpolate one source row into R, G, B float rows. Neither
+// NEON nor SSE2 can gather bytes from arbitrary offsets, so the taps of four
+// columns are loaded (and the channels reordered) with scalar loads, then
+// interpolated four columns per instruction.
+void interpolateRow(const uint8_t* row, const XTaps& xtaps, int r_idx, int g_idx, int b_idx,
+                    float* r_out, float* g_out, float* b_out) {
+    const int n = xtaps.size();
+    const int* ofs0 = xtaps.ofs0.data();
+    const int* ofs1 = xtaps.ofs1.data();
+    const float* w1 = xtaps.w1.data();
+    int x = 0;
+    for (; x + 4 <= n; x += 4) {
+        float r0[4], r1[4], g0[4], g1[4], b0[4], b1[4];
+        for (int k = 0; k < 4; k++) {
+            const uint8_t* p0 = row + ofs0[x + k];
+            const uint8_t* p1 = row + ofs1[x + k];
+            r0[k] = p0[r_idx];
+            r1[k] = p1[r_idx];
+            g0[k] = p0[g_idx];
+            g1[k] = p1[g_idx];
+            b0[k] = p0[b_idx];
+            b1[k] = p1[b_idx];
+        }
+        lerp4(r0, r1, w1 + x, r_out + x);
+        lerp4(g0, g1, w1 + x, g_out + x);
+        lerp4(b0, b1, w1 + x, b_out + x);
+    }
+    for (; x < n; x++) {
+        const uint8_t* p0 = row + ofs0[x];
+        const uint8_t* p1 = row + ofs1[x];
+        float r0 = p0[r_idx], g0 = p0[g_idx], b0 = p0[b_idx];
+        r_out[x] = r0 + (p1[r_idx] - r0) * w1[x];
+        g_out[x] = g0 + (p1[g_idx] - g0) * w1[x];
+        b_out[x] = b0 + (p1[b_idx] - b0) * w1[x];
+    }
+}
+
+// out = (a * (1 - wy) + b * wy) * scale
+void blendRows(const float* a, const float* b, float wy, float scale, float* out, int n) {
+    const float w0 = (1.0f - wy) * scale;
+    const float w1 = wy * scale;
+    int x = 0;
+#if defined(DOCLAYOUT_NEON)
+    for (; x + 4 <= n; x += 4) {
+        float32x4_t va = vld1q_f32(a + x);
+        float32x4_t vb = vld1q_f32(b + x);
+        vst1q_f32(out + x, vmlaq_n_f32(vmulq_n_f32(va, w0), vb, w1));
+    }
+#elif defined(DOCLAYOUT_SSE2)
+    const __m128 vw0 = _mm_set1_ps(w0);
+    const __m128 vw1 = _mm_set1_ps(w1);
+    for (; x + 4 <= n; x += 4) {
+        __m128 va = _mm_loadu_ps(a + x);
+        __m128 vb = _mm_loadu_ps(b + x);
+        _mm_storeu_ps(out + x, _mm_add_ps(_mm_mul_ps(va, vw0), _mm_mul_ps(vb, vw1)));
+    }
+#endif
+    for (; x < n; x++) {
+        out[x] = a[x] * w0 + b[x] * w1;
+    }
+}
+
+// Same, rounded to half precision for float16 inputs
+void blendRows(const float* a, const float* b, float wy, float scale, uint16_t* out, int n) {
+    const float w0 = (1.0f - wy) * scale;
+    const float w1 = wy * scale;
+    int x = 0;
+#if defined(DOCLAYOUT_NEON) && defined(__aarch64__)
+    for (; x + 4 <= n; x += 4) {
+        float32x4_t va = vld1q_f32(a + x);
+        float32x4_t vb = vld1q_f32(b + x);
+        vst1_u16(out + x, vreinterpret_u16_f16(vcvt_f16_f32(vmlaq_n_f32(vmulq_n_f32(va, w0), vb, w1))));
+    }
+#elif defined(DOCLAYOUT_F16C)
+    const __m128 vw0 = _mm_set1_ps(w0);
+    const __m128 vw1 = _mm_set1_ps(w1);
+    for (; x + 4 <= n; x += 4) {
+        __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + x), vw0), _mm_mul_ps(_mm_loadu_ps(b + x), vw1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+#endif
+    for (; x < n; x++) {
+        out[x] = floatToHalf(a[x] * w0 + b[x] * w1);
+    }
+}
+
+// Border value in the tensor's element type
+template <typename T> T padElement();
+template <> float padElement<float>() { return kLetterboxPadValue; }
+template <> uint16_t padElement<uint16_t>() { return floatToHalf(kLetterboxPadValue); }
+
+// Vertical pass shared by all source formats. interpolate(sy, r, g, b)
+// fills the horizontally resized R, G, B floats of source row sy; each
+// source row is interpolated at most once. The tw x th result is written
+// to the top-left of dst_width x dst_height planes.
+template <typename T, typename RowFn>
+void resizeRowsToTensor(int src_h, int tw, int th, T* dst, int dst_width, int dst_height, RowFn interpolate) {
+    PreprocessScratch& scratch = t_scratch;
+    scratch.rows.resize(static_cast<size_t>(2) * 3 * tw);
+    scratch.cached_y[0] = scratch.cached_y[1] = -1;
+
+    const float inv_scale_y = static_cast<float>(src_h) / th;
+
+    // Slot s holds planes R, G, B of one interpolated source row
+    auto slot = [&](int s) { return scratch.rows.data() + static_cast<size_t>(s) * 3 * tw; };
+    auto ensureRow = [&](int sy, int preferred_slot) -> float* {
+        for (int s = 0; s < 2; s++) {
+            if (scratch.cached_y[s] == sy) {
+                return slot(s);
+            }
+        }
+        float* base = slot(preferred_slot);
+        interpolate(sy, base, base + tw, base + 2 * tw);
+        scratch.cached_y[preferred_slot] = sy;
+        return base;
+    };
+
+    const size_t plane = static_cast<size_t>(dst_height) * dst_width;
+    const float pixel_scale = 1.0f / 255.0f;
+
+    for (int y = 0; y < th; y++) {
+        int y0, y1;
+        float wy;
+        sourceTap(y, inv_scale_y, src_h, y0, y1, wy);
+
+        // Keep the row shared with the previous output row (upscaling) in its slot
+        int slot0 = (scratch.cached_y[1] == y0) ? 1 : 0;
+        float* row0 = ensureRow(y0, slot0);
+        float* row1 = ensureRow(y1, 1 - slot0);
+
+        for (int c = 0; c < 3; c++) {
+            blendRows(row0 + c * tw, row1 + c * tw, wy, pixel_scale,
+                      dst + c * plane + static_cast<size_t>(y) * dst_width, tw);
+        }
+    }
+}
+
+// Column taps in units of `step` bytes per source pixel
+void buildXTaps(int src_w, int tw, int step, XTaps& xtaps) {
+    const float inv_scale_x = static_cast<float>(src_w) / tw;
+    xtaps.ofs0.resize(tw);
+    xtaps.ofs1.resize(tw);
+    xtaps.w1.resize(tw);
+    for (int x = 0; x < tw; x++) {
+        int i0, i1;
+        sourceTap(x, inv_scale_x, src_w, i0, i1, xtaps.w1[x]);
+        xtaps.ofs0[x] = i0 * step;
+        xtaps.ofs1[x] = i1 * step;
+    }
+}
+
+// Size the source is resized to inside the target_width x target_height input
+void contentSize(int src_w, int src_h, int target_width, int target_height, ResizeMode mode,
+                 int& content_width, int& content_height) {
+    if (mode == ResizeMode::kStretch) {
+        content_width = target_width;
+        content_height = target_height;
+        return;
+    }
+    const float scale = letterboxScale(src_w, src_h, target_width, target_height);
+    content_width = std::max(1, std::min(target_width, static_cast<int>(std::lround(src_w * scale))));
+    content_height = std::max(1, std::min(target_height, static_cast<int>(std::lround(src_h * scale))));
+}
+
+// Fill the right and bottom border around the top-left content area
+template <typename T>
+void fillLetterboxPadding(T* dst, int content_width, int content_height, int target_width, int target_height) {
+    const size_t plane = static_cast<size_t>(target_height) * target_width;
+    const T pad = padElement<T>();
+    for (int c = 0; c < 3; c++) {
+        T* base = dst + c * plane;
+        if (content_width < target_width) {
+            for (int y = 0; y < content_height; y++) {
+                T* row = base + static_cast<size_t>(y) * target_width;
+                std::fill(row + content_width, row + target_width, pad);
+            }
+        }
+        std::fill(base + static_cast<size_t>(content_height) * target_width, base + plane, pad);
+    }
+}
+
+inline uint8_t clampToByte(float v) {
+    return static_cast<uint8_t>(v <= 0.0f ? 0.0f : (v >= 255.0f ? 255.0f : v + 0.5f));
+}
+
+// BT.601 limited range, same coefficients as cv::COLOR_YUV2RGB_NV21
+inline void yuvToRgb(int y, int u, int v, float& r, float& g, float& b) {
+    const float yf = 1.164f * static_cast<float>(y - 16);
+    const float uf = static_cast<float>(u - 128);
+    const float vf = static_cast<float>(v - 128);
+    r = clampToByte(yf + 1.596f * vf);
+    g = clampToByte(yf - 0.813f * vf - 0.391f * uf);
+    b = clampToByte(yf + 2.018f * uf);
+}
+
+// yuvToRgb on four pixels
+inline void yuvToRgb4(const float* y, const float* u, const float* v, float* r, float* g, float* b) {
+#if defined(DOCLAYOUT_NEON)
+    const float32x4_t vmax = vdupq_n_f32(255.0f);
+    const float32x4_t vzero = vdupq_n_f32(0.0f);
+    const float32x4_t vhalf = vdupq_n_f32(0.5f);
+    // clampToByte: clamp, then round half up by truncating v + 0.5
+    auto toByte = [&](float32x4_t x) {
+        x = vaddq_f32(vminq_f32(vmaxq_f32(x, vzero), vmax), vhalf);
+        return vcvtq_f32_s32(vcvtq_s32_f32(x));
+    };
+    const float32x4_t yf = vmulq_n_f32(vsubq_f32(vld1q_f32(y), vdupq_n_f32(16.0f)), 1.164f);
+    const float32x4_t uf = vsubq_f32(vld1q_f32(u), vdupq_n_f32(128.0f));
+    const float32x4_t vf = vsubq_f32(vld1q_f32(v), vdupq_n_f32(128.0f));
+    vst1q_f32(r, toByte(vmlaq_n_f32(yf, vf, 1.596f)));
+    vst1q_f32(g, toByte(vmlsq_n_f32(vmlsq_n_f32(yf, vf, 0.813f), uf, 0.391f)));
+    vst1q_f32(b, toByte(vmlaq_n_f32(yf, uf, 2.018f)));
+#elif defined(DOCLAYOUT_SSE2)
+    const __m128 vmax = _mm_set1_ps(255.0f);
+    const __m128 vzero = _mm_setzero_ps();
+    const __m128 vhalf = _mm_set1_ps(0.5f);
+    auto toByte = [&](__m128 x) {
+        x = _mm_add_ps(_mm_min_ps(_mm_max_ps(x, vzero), vmax), vhalf);
+        return _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    };
+    const __m128 yf = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(y), _mm_set1_ps(16.0f)), _mm_set1_ps(1.164f));
+    const __m128 uf = _mm_sub_ps(_mm_loadu_ps(u), _mm_set1_ps(128.0f));
+    const __m128 vf = _mm_sub_ps(_mm_loadu_ps(v), _mm_set1_ps(128.0f));
+    _mm_storeu_ps(r, toByte(_mm_add_ps(yf, _mm_mul_ps(vf, _mm_set1_ps(1.596f)))));
+    _mm_storeu_ps(g, toByte(_mm_sub_ps(_mm_sub_ps(yf, _mm_mul_ps(vf, _mm_set1_ps(0.813f))),
+                                       _mm_mul_ps(uf, _mm_set1_ps(0.391f)))));
+    _mm_storeu_ps(b, toByte(_mm_add_ps(yf, _mm_mul_ps(uf, _mm_set1_ps(2.018f)))));
+#else
+    for (int k = 0; k < 4; k++) {
+        yuvToRgb(static_cast<int>(y[k]), static_cast<int>(u[k]), static_cast<int>(v[k]), r[k], g[k], b[k]);
+    }
+#endif
+}
+
+// Horizontally interpolate one YUV 4:2:0 row. Each tap is converted to RGB
+// first (chroma shared by 2x2 luma pixels), so the result matches a full
+// resolution color conversion followed by the bilinear resize. As in
+// interpolateRow the samples of four columns are gathered with scalar
+// loads; conversion and interpolation run four columns at a time.
+void interpolateYuvRow(const uint8_t* y_row, const uint8_t* u_row, const uint8_t* v_row, int uv_pixel_stride,
+                       const XTaps& xtaps, float* r_out, float* g_out, float* b_out) {
+    const int n = xtaps.size();
+    const int* ofs0 = xtaps.ofs0.data();
+    const int* ofs1 = xtaps.ofs1.data();
+    const float* w1 = xtaps.w1.data();
+    int x = 0;
+    for (; x + 4 <= n; x += 4) {
+        // Taps 0-3 come from ofs0, 4-7 from ofs1
+        float ys[8], us[8], vs[8];
+        for (int k = 0; k < 4; k++) {
+            const int c0 = (ofs0[x + k] >> 1) * uv_pixel_stride;
+            const int c1 = (ofs1[x + k] >> 1) * uv_pixel_stride;
+            ys[k] = y_row[ofs0[x + k]];
+            us[k] = u_row[c0];
+            vs[k] = v_row[c0];
+            ys[k + 4] = y_row[ofs1[x + k]];
+            us[k + 4] = u_row[c1];
+            vs[k + 4] = v_row[c1];
+        }
+        float rs[8], gs[8], bs[8];
+        yuvToRgb4(ys, us, vs, rs, gs, bs);
+        yuvToRgb4(ys + 4, us + 4, vs + 4, rs + 4, gs + 4, bs + 4);
+        lerp4(rs, rs + 4, w1 + x, r_out + x);
+        lerp4(gs, gs + 4, w1 + x, g_out + x);
+        lerp4(bs, bs + 4, w1 + x, b_out + x);
+    }
+    for (; x < n; x++) {
+        const int c0 = (ofs0[x] >> 1) * uv_pixel_stride;
+        const int c1 = (ofs1[x] >> 1) * uv_pixel_stride;
+        float r0, g0, b0, r1, g1, b1;
+        yuvToRgb(y_row[ofs0[x]], u_row[c0], v_row[c0], r0, g0, b0);
+        yuvToRgb(y_row[ofs1[x]], u_row[c1], v_row[c1], r1, g1, b1);
+        r_out[x] = r0 + (r1 - r0) * w1[x];
+        g_out[x] = g0 + (g1 - g0) * w1[x];
+        b_out[x] = b0 + (b1 - b0) * w1[x];
+    }
+}
+
+}  // namespace
+
+float letterboxScale(int src_width, int src_height, int target_width, int target_height) {
+    if (src_width <= 0 || src_height <= 0) {
+        return 1.0f;
+    }
+    return std::min(static_cast<float>(target_width) / src_width, static_cast<float>(target_height) / src_height);
+}
+
+namespace {
+
+// Fused preprocess into float or half planes, see preprocessToTensor
+template <typename T>
+std::array<float, 2> preprocessPixels(const cv::Mat& img, PixelFormat format,
+                                      int target_width, int target_height, T* dst, ResizeMode mode) {
+    const int src_w = img.cols;
+    const int src_h = img.rows;
+
+    // Channel order of R, G, B inside one source pixel
+    int cn = 3, r_idx = 2, g_idx = 1, b_idx = 0;
+    switch (format) {
+        case PixelFormat::kBGR:  cn = 3; r_idx = 2; g_idx = 1; b_idx = 0; break;
+        case PixelFormat::kRGB:  cn = 3; r_idx = 0; g_idx = 1; b_idx = 2; break;
+        case PixelFormat::kBGRA: cn = 4; r_idx = 2; g_idx = 1; b_idx = 0; break;
+        case PixelFormat::kRGBA: cn = 4; r_idx = 0; g_idx = 1; b_idx = 2; break;
+        case PixelFormat::kGray: cn = 1; r_idx = 0; g_idx = 0; b_idx = 0; break;
+    }
+    CV_Assert(img.depth() == CV_8U && img.channels() == cn);
+
+    int content_w, content_h;
+    contentSize(src_w, src_h, target_width, target_height, mode, content_w, content_h);
+    fillLetterboxPadding(dst, content_w, content_h, target_width, target_height);
+
+    PreprocessScratch& scratch = t_scratch;
+    buildXTaps(src_w, content_w, cn, scratch.xtaps);
+
+    resizeRowsToTensor(src_h, content_w, content_h, dst, target_width, target_height,
+        [&](int sy, float* r, float* g, float* b) {
+            interpolateRow(img.ptr<uint8_t>(sy), scratch.xtaps, r_idx, g_idx, b_idx, r, g, b);
+        });
+
+    return {static_cast<float>(content_w) / src_w, static_cast<float>(content_h) / src_h};
+}
+
+template <typename T>
+std::array<float, 2> preprocessYuv(const YuvPlanes& frame, int target_width, int target_height,
+                                   T* dst, ResizeMode mode) {
+    CV_Assert(frame.y != nullptr && frame.u != nullptr && frame.v != nullptr);
+    CV_Assert(frame.width > 0 && frame.height > 0 && frame.uv_pixel_stride > 0);
+
+    int content_w, content_h;
+    contentSize(frame.width, frame.height, target_width, target_height, mode, content_w, content_h);
+    fillLetterboxPadding(dst, content_w, content_h, target_width, target_height);
+
+    PreprocessScratch& scratch = t_scratch;
+    // Luma taps are pixel indices, chroma offsets are derived per tap
+    buildXTaps(frame.width, content_w, 1, scratch.xtaps);
+
+    resizeRowsToTensor(frame.height, content_w, content_h, dst, target_width, target_height,
+        [&](int sy, float* r, float* g, float* b) {
+            const uint8_t* y_row = frame.y + static_cast<size_t>(sy) * frame.y_row_stride;
+            const size_t uv_offset = static_cast<size_t>(sy >> 1) * frame.uv_row_stride;
+            interpolateYuvRow(y_row, frame.u + uv_offset, frame.v + uv_offset, frame.uv_pixel_stride,
+                              scratch.xtaps, r, g, b);
+        });
+
+    return {static_cast<float>(content_w) / frame.width, static_cast<float>(content_h) / frame.height};
+}
+
+}  // namespace
+
+std::array<float, 2> preprocessToTensor(const cv::Mat& img, PixelFormat format,
+                                        int target_width, int target_height, float* dst, ResizeMode mode) {
+    return preprocessPixels(img, format, target_width, target_height, dst, mode);
+}
+
+std::array<float, 2> preprocessToTensor(const cv::Mat& img, PixelFormat format,
+                                        int target_width, int target_height, uint16_t* dst, ResizeMode mode) {
+    return preprocessPixels(img, format, target_width, target_height, dst, mode);
+}
+
+std::array<float, 2> preprocessYuvToTensor(const YuvPlanes& frame, int target_width, int target_height,
+                                           float* dst, ResizeMode mode) {
+    return preprocessYuv(frame, target_width, target_height, dst, mode);
+}
+
+std::array<float, 2> preprocessYuvToTensor(const YuvPlanes& frame, int target_width, int target_height,
+                                           uint16_t* dst, ResizeMode mode) {
+    return preprocessYuv(frame, target_width, target_height, dst, mode);
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+    if (magnitude >= 0x7F800000u) {
+        // Inf stays inf, NaN stays a quiet NaN
+        return sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x0200u : 0u);
+    }
+    if (magnitude >= 0x477FF000u) {
+        return sign | 0x7C00u;  // rounds past 65504
+    }
+    if (magnitude < 0x38800000u) {
+        // Below the smallest normal half: subnormal (m * 2^-24) or zero
+        if (magnitude < 0x33000000u) {
+            return sign;
+        }
+        const uint32_t exponent = magnitude >> 23;
+        const uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+        const uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1u))) {
+            half++;
+        }
+        return sign | static_cast<uint16_t>(half);
+    }
+    // Normal: rebias the exponent (127 -> 15) and round the dropped 13 bits
+    uint32_t half = (magnitude - 0x38000000u) >> 13;
+    const uint32_t rest = magnitude & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) {
+        half++;
+    }
+    return sign | static_cast<uint16_t>(half);
+}
+
+float halfToFloat(uint16_t value) {
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1Fu;
+    const uint32_t mantissa = value & 0x3FFu;
+    if (exponent == 0) {
+        const float subnormal = static_cast<float>(mantissa) * (1.0f / 16777216.0f);  // m * 2^-24
+        return sign ? -subnormal : subnormal;
+    }
+    const uint32_t bits = exponent == 0x1Fu
+        ? sign | 0x7F800000u | (mantissa << 13)
+        : sign | ((exponent + 112) << 23) | (mantissa << 13);
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void floatsToHalves(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+#if defined(DOCLAYOUT_NEON) && defined(__aarch64__)
+    for (; i + 4 <= count; i += 4) {
+        vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+    }
+#elif defined(DOCLAYOUT_F16C)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = floatToHalf(src[i]);
+    }
+}
+
+void halvesToFloats(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+#if defined(DOCLAYOUT_NEON) && defined(__aarch64__)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+    }
+#elif defined(DOCLAYOUT_F16C)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i))));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = halfToFloat(src[i]);
+    }
+}
@@ -0,0 +1,510 @@
+#ifndef FLUTTER_DOCLAYOUT_KIT_H
+#define FLUTTER_DOCLAYOUT_KIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Graph optimization levels
+#define DOCLAYOUT_GRAPH_OPT_DEFAULT  0
+#define DOCLAYOUT_GRAPH_OPT_DISABLE  1
+#define DOCLAYOUT_GRAPH_OPT_BASIC    2
+#define DOCLAYOUT_GRAPH_OPT_EXTENDED 3
+#define DOCLAYOUT_GRAPH_OPT_ALL      4
+
+// Execution provider bits, CPU is always the fallback
+#define DOCLAYOUT_EP_CPU     0
+#define DOCLAYOUT_EP_NNAPI   (1 << 0)   // Android only
+#define DOCLAYOUT_EP_XNNPACK (1 << 1)
+#define DOCLAYOUT_EP_COREML  (1 << 2)   // iOS/macOS only
+
+// Model precision (DocLayoutOptions.precision). Variants sit next to the
+// given file as <stem>.int8.onnx (QDQ-quantized) and <stem>.fp16.onnx; a
+// missing or unloadable variant falls back to the given file.
+#define DOCLAYOUT_PRECISION_MODEL 0   // load model_path as is
+#define DOCLAYOUT_PRECISION_AUTO  1   // fastest variant for this device (see getDeviceCapabilities)
+#define DOCLAYOUT_PRECISION_FP32  2
+#define DOCLAYOUT_PRECISION_FP16  3
+#define DOCLAYOUT_PRECISION_INT8  4
+
+// CPU arena growth (DocLayoutOptions.arena_extend_strategy)
+#define DOCLAYOUT_ARENA_EXTEND_DEFAULT            0   // ONNX Runtime's default, next power of two
+#define DOCLAYOUT_ARENA_EXTEND_NEXT_POWER_OF_TWO  1
+#define DOCLAYOUT_ARENA_EXTEND_SAME_AS_REQUESTED  2   // least slack, for low-RAM devices
+
+// Status codes of the *ToBuffer functions
+#define DOCLAYOUT_OK                     0
+#define DOCLAYOUT_ERR_MODEL_NOT_LOADED  -1
+#define DOCLAYOUT_ERR_IMAGE_LOAD        -2
+#define DOCLAYOUT_ERR_IMAGE_DECODE      -3
+#define DOCLAYOUT_ERR_EMPTY_INPUT       -4
+#define DOCLAYOUT_ERR_INVALID_ARGUMENT  -5
+#define DOCLAYOUT_ERR_CANCELLED         -6   // async request cancelled
+#define DOCLAYOUT_ERR_DEADLINE_EXCEEDED -7   // async request passed its deadline
+#define DOCLAYOUT_ERR_SUPERSEDED        -8   // a newer request in the same lane replaced it
+#define DOCLAYOUT_ERR_INFERENCE_FAILED  -9   // the model run failed; nothing is cached
+
+// Binary result layout: a DocLayoutResultHeader followed by `count`
+// DocLayoutBox entries. Every field is a float, so the whole buffer can be
+// read as one float array; size it DOCLAYOUT_RESULT_HEADER_FLOATS +
+// DOCLAYOUT_BOX_FLOATS * max_boxes.
+#define DOCLAYOUT_RESULT_HEADER_FLOATS 8
+#define DOCLAYOUT_BOX_FLOATS           6
+
+typedef struct DocLayoutResultHeader {
+    float status;               // DOCLAYOUT_OK or DOCLAYOUT_ERR_*
+    float count;                // boxes written
+    float total_count;          // boxes found, > count if max_boxes was too small
+    float inference_time_ms;
+    float image_width;
+    float image_height;
+    float reused;               // tracking mode: 1 if the cached detections were returned
+    float change;               // tracking mode: change metric against the last inferred frame
+} DocLayoutResultHeader;
+
+typedef struct DocLayoutBox {
+    float x1, y1, x2, y2;       // original image space
+    float score;
+    float class_id;
+} DocLayoutBox;
+
+// Detector session options, zero-initialize for defaults
+typedef struct DocLayoutOptions {
+    int32_t intra_op_threads;           // 0 = ONNX Runtime default
+    int32_t inter_op_threads;           // 0 = ONNX Runtime default
+    int32_t graph_optimization_level;   // DOCLAYOUT_GRAPH_OPT_*
+    int32_t execution_providers;        // DOCLAYOUT_EP_* bits
+    int32_t max_batch_size;             // pages per inference run in the batch calls, 0 = default (8)
+    int32_t full_resolution_decode;     // 1 = never decode large JPEGs at reduced resolution
+    const char* profile_file_prefix;    // non-NULL = ONNX Runtime profiling trace to <prefix>_<timestamp>.json
+    int32_t max_concurrent_runs;        // inferences in flight on one detector, 0 = 1 (calls are serialized)
+    int32_t input_size;                 // square model input (e.g. 480, 640, 800, 1024), multiple of 32, 0 = 640;
+                                        // ignored for models exported with a static image size
+    int32_t letterbox;                  // 1 = keep the page's aspect ratio and pad, 0 = stretch
+    int32_t precision;                  // DOCLAYOUT_PRECISION_*, which variant of model_path to load
+    int32_t disable_memory_map;         // 1 = read the model into the heap instead of memory-mapping it
+    const char* optimized_model_dir;    // non-NULL = writable directory for the optimized graph (.ort), saved
+                                        // on first load and reused on later starts; CPU-only sessions
+    // Memory budget. The three arena settings configure one CPU arena shared
+    // by every detector in the process that sets any of them; the first such
+    // detector creates it.
+    int32_t disable_cpu_arena;          // 1 = no CPU arena: run buffers are freed after each run
+    int32_t arena_extend_strategy;      // DOCLAYOUT_ARENA_EXTEND_*
+    int64_t arena_initial_chunk_bytes;  // first arena block, 0 = ONNX Runtime default
+    int64_t arena_max_bytes;            // cap on the CPU arena, 0 = none; runs that need more fail
+    int32_t shrink_arena_after_run;     // 1 = hand arena growth back at the end of every run
+    int32_t decode_pool_size;           // decoded page buffers kept for reuse, 0 = 2, < 0 = none
+    int32_t page_crop;                  // 1 = find the page outline in camera captures and warp only the page
+                                        // into the model input; boxes stay in original image coordinates
+} DocLayoutOptions;
+
+// Native postprocess settings, zero-initialize for the plain confidence filter
+typedef struct DocLayoutPostprocessOptions {
+    const float* class_thresholds;      // score threshold by class ID, < 0 = the call's conf_threshold; may be NULL
+    int32_t num_class_thresholds;
+    float nms_iou;                      // > 0 = class-aware NMS at this IoU
+    float containment;                  // > 0 = drop boxes at least this fraction inside a higher-scoring same-class box
+    int32_t reading_order;              // 1 = return boxes in reading order (XY-cut) instead of by score
+} DocLayoutPostprocessOptions;
+
+// Tiled detection settings, zero-initialize for defaults
+typedef struct DocLayoutTileOptions {
+    int32_t tile_size;          // square tile side in original-image pixels, 0 = auto (half the longest side,
+                                // at least the model input)
+    float overlap;              // fraction of a tile shared with its neighbour, 0 = 0.2
+    float nms_iou;              // same-class boxes overlapping more than this are merged, 0 = 0.5
+    int32_t skip_full_page;     // 1 = tiles only; by default the whole page is run too, for large elements
+} DocLayoutTileOptions;
+
+// Crop encodings (DocLayoutCropOptions.encoding)
+#define DOCLAYOUT_CROP_RAW   0   // BGR pixels viewed in place in the decoded page, no copy
+#define DOCLAYOUT_CROP_PNG   1
+#define DOCLAYOUT_CROP_JPEG  2
+
+// Which detections detectWithCrops cuts out, zero-initialize for raw crops of every box
+typedef struct DocLayoutCropOptions {
+    const int32_t* class_ids;   // classes to crop (e.g. table, formula, image); NULL = all
+    int32_t num_class_ids;
+    float padding;              // margin on each side as a fraction of the box size, 0 = none
+    int32_t encoding;           // DOCLAYOUT_CROP_*
+    int32_t jpeg_quality;       // 1-100, 0 = 90
+} DocLayoutCropOptions;
+
+// One crop of a DocLayoutCropResult
+typedef struct DocLayoutCrop {
+    int32_t detection_index;    // index into the result JSON's detections
+    int32_t x;                  // crop rectangle in original image pixels
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    int32_t stride;             // raw: bytes per row (the page's row, > width * 3); encoded: 0
+    const uint8_t* data;        // raw: first BGR pixel of the crop; encoded: PNG / JPEG bytes
+    int64_t size;               // bytes at data (raw: stride * (height - 1) + width * 3)
+} DocLayoutCrop;
+
+// Detections plus crops from one decode of the page; release with releaseCrops
+typedef struct DocLayoutCropResult {
+    char* result_json;          // same JSON as detectWithHandle, owned by the result
+    int32_t count;
+    DocLayoutCrop* crops;       // count entries, owned by the result
+    void* reserved;             // internal, do not touch
+} DocLayoutCropResult;
+
+// Earlier result handed to detectRegion / transformResult, boxes in the
+// DocLayoutBox layout (count rows of DOCLAYOUT_BOX_FLOATS floats)
+typedef struct DocLayoutPreviousResult {
+    const float* boxes;
+    int32_t count;
+    int32_t image_width;        // size the boxes refer to, 0 = the new image's size
+    int32_t image_height;
+} DocLayoutPreviousResult;
+
+// Changed area of the page in original image pixels
+typedef struct DocLayoutRegion {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+} DocLayoutRegion;
+
+// Page range of detectDocument, zero-initialize for the whole document
+typedef struct DocLayoutDocumentOptions {
+    int32_t first_page;         // 0-based index of the first page to detect
+    int32_t page_count;         // pages from first_page, 0 = to the last page
+    int32_t queue_depth;        // pages queued between pipeline stages, 0 = 2
+} DocLayoutDocumentOptions;
+
+// Result cache counters, see getResultCacheStats
+typedef struct DocLayoutCacheStats {
+    int64_t hits;               // memory and disk hits
+    int64_t misses;
+    int64_t disk_hits;          // hits loaded back from the disk directory
+    int64_t evictions;          // entries dropped to stay within max_bytes
+    int64_t entries;
+    int64_t bytes;              // estimated memory held by the entries
+} DocLayoutCacheStats;
+
+// Tracking mode settings, zero-initialize for defaults
+typedef struct DocLayoutTrackerOptions {
+    float change_threshold;     // mean abs luma difference (0-1) that triggers inference, 0 = 0.04
+    int32_t max_age_ms;         // re-run inference at least this often, 0 = 1000
+    float smoothing;            // weight of the previous box position (0-1), 0 = 0.3, < 0 = off
+} DocLayoutTrackerOptions;
+
+// Completion callback for the *Async functions. Called on the background
+// worker thread; result_json is owned by the callee (free with freeString).
+typedef void (*DocLayoutResultCallback)(int64_t request_id, char* result_json);
+
+// Scheduling of one async request (detectAsyncWithOptions)
+typedef struct DocLayoutRequestOptions {
+    int32_t deadline_ms;        // give up this long after submission, also mid-inference; 0 = none
+    int64_t lane;               // non-zero: a new request stops the older ones in the same lane
+                                // (latest frame wins, for live preview); 0 = none
+} DocLayoutRequestOptions;
+
+// Per-page callback of a page stream, called in page order on the stream's
+// serialize thread; result_json is owned by the callee (free with freeString).
+typedef void (*DocLayoutPageCallback)(int64_t stream_id, int32_t page_index, char* result_json);
+
+// Initialize (or swap) the default model used by the detectLayout* functions
+void initModel(const char* model_path);
+
+// Same as initModel with explicit session options, options may be NULL.
+// Returns 1 on success, 0 if the model could not be loaded.
+int initModelWithOptions(const char* model_path, const DocLayoutOptions* options);
+
+// Detect from image file, returns JSON (free with freeString)
+char* detectLayout(const char* img_path, float conf_threshold);
+
+// Detect from encoded image bytes (PNG, JPEG, ...), returns JSON (free with freeString)
+char* detectLayoutFromEncoded(const uint8_t* data, size_t len, float conf_threshold);
+
+// Detect from raw 1/3/4 channel pixels, returns JSON (free with freeString)
+char* detectLayoutFromBytes(const unsigned char* image_data, int width, int height, int channels, float conf_threshold);
+
+// Detect from a YUV 4:2:0 camera frame given as plane pointers, e.g. Android
+// YUV_420_888 / NV21 (uv_pixel_stride 2) or I420 (uv_pixel_stride 1). Color
+// conversion and downscaling are fused into the preprocess pass, so no RGB
+// copy of the frame is made. Returns JSON (free with freeString).
+char* detectLayoutFromYuv(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                          int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                          float conf_threshold);
+
+// Same as detectLayout / detectLayoutFromEncoded / detectLayoutFromBytes, but
+// fill `out` with the binary result layout instead of returning JSON. Returns
+// the number of boxes found (>= 0) or a DOCLAYOUT_ERR_* status.
+int detectLayoutToBuffer(const char* img_path, float conf_threshold, float* out, int32_t max_boxes);
+int detectLayoutFromEncodedToBuffer(const uint8_t* data, size_t len, float conf_threshold,
+                                    float* out, int32_t max_boxes);
+int detectLayoutFromBytesToBuffer(const unsigned char* image_data, int width, int height, int channels,
+                                  float conf_threshold, float* out, int32_t max_boxes);
+int detectLayoutFromYuvToBuffer(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                                int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                                float conf_threshold, float* out, int32_t max_boxes);
+
+// Detect on count encoded images, data[i] has lens[i] bytes. Pages are run
+// through the model in batches when it supports it. Returns
+// {"results":[...],"count":N,"inference_time_ms":T} JSON (free with freeString),
+// results[i] has the same shape as a detectLayoutFromEncoded result.
+char* detectLayoutBatch(const uint8_t* const* data, const size_t* lens, int count, float conf_threshold);
+
+// Queue detection of encoded image bytes on the background worker and return
+// immediately (1 = queued, 0 = rejected). data must stay valid until the
+// callback for request_id has run.
+int detectLayoutFromEncodedAsync(const uint8_t* data, size_t len, float conf_threshold,
+                                 int64_t request_id, DocLayoutResultCallback callback);
+
+// detectLayoutFromEncodedAsync / detectWithHandleAsync with scheduling
+// options (NULL handle = default model, options may be NULL). A request
+// that is cancelled, expires or is superseded still gets its callback, with
+// a CANCELLED, DEADLINE_EXCEEDED or SUPERSEDED error: if it had not started
+// it is skipped without decoding, if it was running the inference is
+// terminated (Ort::RunOptions::SetTerminate). Data must stay valid until
+// the callback in every case.
+int detectAsyncWithOptions(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                           const DocLayoutRequestOptions* options, int64_t request_id,
+                           DocLayoutResultCallback callback);
+
+// Cancel a queued or running async request by the request_id it was
+// submitted with. Returns 1 if it was in flight, 0 if it had already
+// finished or stopped. request_id should be unique among requests in flight;
+// nextRequestId() hands out process-unique values.
+int cancelRequest(int64_t request_id);
+
+// Cancel every queued or running async request of a lane, returns how many
+int cancelLane(int64_t lane);
+
+// Process-unique value for a request_id or a lane
+int64_t nextRequestId(void);
+
+// Load a model into a new detector instance, returns NULL on failure.
+// options may be NULL.
+void* createDetector(const char* model_path, const DocLayoutOptions* options);
+
+// Detect from encoded image bytes on a detector instance, returns JSON (free with freeString)
+char* detectWithHandle(void* handle, const uint8_t* data, size_t len, float conf_threshold);
+
+// Binary variant of detectWithHandle, see detectLayoutFromEncodedToBuffer
+int detectWithHandleToBuffer(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                             float* out, int32_t max_boxes);
+
+// Same as detectLayoutFromEncodedAsync on a detector instance. The handle
+// must not be destroyed before the callback has run.
+int detectWithHandleAsync(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                          int64_t request_id, DocLayoutResultCallback callback);
+
+// Same as detectLayoutBatch on a detector instance
+char* detectBatchWithHandle(void* handle, const uint8_t* const* data, const size_t* lens, int count,
+                            float conf_threshold);
+
+// Set the postprocess passes of a detector (handle NULL = default model),
+// applied to every following detection on it; options NULL restores the
+// plain confidence filter. Boxes carry class IDs only, names are looked up
+// from the model's class table when serializing. Returns DOCLAYOUT_OK or
+// DOCLAYOUT_ERR_MODEL_NOT_LOADED.
+int setPostprocessOptions(void* handle, const DocLayoutPostprocessOptions* options);
+
+// Tiled detection for dense high-resolution pages (handle NULL = default
+// model): the page is split into overlapping tiles that run as one batch
+// (or in parallel with max_concurrent_runs), and the boxes are merged with
+// class-aware NMS in original-image coordinates. options may be NULL for
+// defaults. Same JSON as detectLayoutFromEncoded; there is no binary
+// variant because the box count is not bounded by the model's 300. Not
+// answered from the result cache.
+char* detectTiledWithHandle(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                            const DocLayoutTileOptions* options);
+
+// Detect on encoded image bytes (handle NULL = default model) and cut the
+// detections of the selected classes out of the same decoded page, so an
+// OCR or export step does not decode the image again. The page is decoded at
+// full resolution. Raw crops point into the decoded page itself; encoded
+// crops are compressed natively. All memory stays valid until releaseCrops.
+// On failure result_json carries the error and count is 0. Not answered
+// from the result cache. options may be NULL. Returns NULL only if out of memory.
+DocLayoutCropResult* detectWithCrops(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                                     const DocLayoutCropOptions* options);
+
+// Free a detectWithCrops result, its JSON and every crop
+void releaseCrops(DocLayoutCropResult* result);
+
+// Incremental detection after part of a page changed (a re-captured
+// field, a pasted signature). The region is grown to cover every previous
+// box it touches and only that crop is run through the model; previous
+// boxes outside it are kept. Returns the detectWithHandle JSON where each
+// detection also has "diff" ("unchanged", "added" or "updated") and
+// "previous_index" (-1 for added), plus "removed" (previous indices that
+// have no box any more) and "region" ([x,y,w,h] actually re-detected).
+// region NULL or empty = whole image. Not answered from the result cache.
+// handle NULL = default model.
+char* detectRegion(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                   const DocLayoutPreviousResult* previous, const DocLayoutRegion* region);
+
+// detectRegion on the background worker, scheduled like
+// detectAsyncWithOptions (options may be NULL). The previous boxes are
+// copied before returning; data must stay valid until the callback.
+int detectRegionAsync(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                      const DocLayoutPreviousResult* previous, const DocLayoutRegion* region,
+                      const DocLayoutRequestOptions* options, int64_t request_id,
+                      DocLayoutResultCallback callback);
+
+// Remap a previous result through a 2x3 affine transform (row-major
+// a b tx c d ty, in original pixels) into a width x height image, for a
+// page that was only rotated, flipped or scaled: no decode, no inference.
+// Same JSON as detectRegion with every box "moved" and no "region"; boxes
+// mapped off the image are listed in "removed". handle NULL = default model
+// (for class names only, works without a model).
+char* transformResult(void* handle, const DocLayoutPreviousResult* previous, const float* transform,
+                      int32_t width, int32_t height);
+
+// Content-hash result cache in front of the encoded-image and file entry
+// points (including batches and handles). A hit skips decode and inference.
+// Keys combine a hash of the input bytes, the confidence threshold and the
+// model path. Disabled by default; max_bytes bounds the memory used. With a
+// non-NULL disk_dir entries are also written to that directory and read back
+// after a restart. Returns DOCLAYOUT_OK or DOCLAYOUT_ERR_INVALID_ARGUMENT.
+int configureResultCache(int64_t max_bytes, const char* disk_dir);
+void getResultCacheStats(DocLayoutCacheStats* stats);
+
+// Drop the memory entries and reset the counters; remove_disk != 0 also
+// deletes the entries in the disk directory
+void clearResultCache(int remove_disk);
+
+// Per-stage latency percentiles (decode, preprocess, run, parse, serialize,
+// total) over the last calls of each stage, as JSON:
+// {"window":256,"stages":{"decode":{"count":..,"p50_ms":..,"p95_ms":..,
+// "p99_ms":..,"mean_ms":..,"max_ms":..},...},"memory":{"current_bytes":..,
+// "peak_bytes":..}}, memory being the process's resident set now and at its
+// peak. Free with freeString.
+char* getStats(void);
+
+// Release what a detector (NULL = default model) holds between runs: pooled
+// decode buffers, batch buffers and, if shrink_arena is non-zero, the CPU
+// arena's free blocks. Shrinking the arena runs one full inference on the
+// calling thread, as slow as a detection; pass 0 to keep the arena and
+// return quickly. Waits for running inferences; call it when the app goes
+// to the background (onTrimMemory, didEnterBackground). Returns DOCLAYOUT_OK
+// or DOCLAYOUT_ERR_MODEL_NOT_LOADED.
+int trimMemory(void* handle, int shrink_arena);
+void resetStats(void);
+
+// Stop ONNX Runtime profiling on a detector (handle NULL = default model)
+// and return the trace file path, "" if profile_file_prefix was not set.
+// Free with freeString.
+char* endProfiling(void* handle);
+
+// Model descriptor of a detector (handle NULL = default model), read once at
+// load time, as JSON: {"variant":"M"|"L","input_width":..,"input_height":..,
+// "batch_capable":..,"precision":"fp32"|"fp16"|"int8","half_io":..,
+// "model_file":..,"load_method":"file"|"mmap"|"ort_cache","load_ms":..,"inputs":[{"name":..,"shape":[..],"type":..}],
+// "outputs":[..],"classes":[..],"classes_from_metadata":..,"producer":..,
+// "version":..}. input_width/height are 0 when the model's size is dynamic;
+// model_file is the variant actually loaded.
+// Returns the MODEL_NOT_LOADED error JSON if no model is loaded. Free with
+// freeString.
+char* getModelInfo(void* handle);
+
+// Run `iterations` dummy inferences at the model input size on each of the
+// default model's run contexts (plus one full batch on batch-capable
+// models), so kernel selection, arena growth and provider compilation are
+// done before the first real request. Blocks, call it off the UI thread;
+// not recorded in the latency stats. Returns {"runs":..,"first_ms":..,
+// "mean_ms":..,"last_ms":..} or the MODEL_NOT_LOADED error JSON. Free with
+// freeString.
+char* warmupModel(int32_t iterations);
+
+// Same on a detector instance (handle NULL = default model)
+char* warmupDetector(void* handle, int32_t iterations);
+
+// CPU features probed for variant selection and the precision order
+// DOCLAYOUT_PRECISION_AUTO tries: {"cpu":{"arm64":..,"arm_dotprod":..,
+// "arm_fp16":..,"arm_i8mm":..,"x86_avx2":..,"x86_vnni":..,"x86_f16c":..},
+// "preferred":["int8","fp32"],"preferred_with_accelerator":[..]}. The second
+// list applies when NNAPI or Core ML is requested. Free with freeString.
+char* getDeviceCapabilities(void);
+
+// Live-camera tracking mode on a detector instance (handle NULL = default
+// model). A tiny luma thumbnail of each frame is compared with the last
+// inferred frame; while the scene is steady the cached boxes are returned
+// ("reused":true) and inference is skipped. options may be NULL.
+void* createTracker(void* handle, const DocLayoutTrackerOptions* options);
+
+// Same inputs as detectLayoutFromBytes / detectLayoutFromYuv, JSON results
+// additionally carry "reused" and "change"
+char* trackFrameFromBytes(void* tracker, const unsigned char* image_data, int width, int height, int channels,
+                          float conf_threshold);
+char* trackFrameFromYuv(void* tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                        int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                        float conf_threshold);
+
+// Binary variants, the header's reused/change fields are filled
+int trackFrameFromBytesToBuffer(void* tracker, const unsigned char* image_data, int width, int height, int channels,
+                                float conf_threshold, float* out, int32_t max_boxes);
+int trackFrameFromYuvToBuffer(void* tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                              int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                              float conf_threshold, float* out, int32_t max_boxes);
+
+// Forget the cached frame, the next frame always runs inference
+void resetTracker(void* tracker);
+
+// Release a tracker and its reference to the detector it was created on.
+void destroyTracker(void* tracker);
+
+// Open a streaming pipeline (decode -> preprocess -> inference -> serialize,
+// one thread per stage with bounded queues of queue_depth in between, 0 =
+// default) on a detector instance, or on the default model if handle is NULL.
+// Returns NULL if no model is loaded.
+void* openPageStream(void* handle, float conf_threshold, int32_t queue_depth,
+                     int64_t stream_id, DocLayoutPageCallback callback);
+
+// Queue an encoded page; the bytes are copied. Blocks while the pipeline is
+// full. Returns the page index, or -1 if the stream is closed.
+int64_t pushPageEncoded(void* stream, const uint8_t* data, size_t len);
+
+// Queue an image file, same as pushPageEncoded
+int64_t pushPageFile(void* stream, const char* img_path);
+
+// Wait until every queued page has been delivered and release the stream.
+// Must not be called from the page callback.
+void closePageStream(void* stream);
+
+// Detect on every page of a multi-page TIFF (or a single-page image file)
+// without leaving native code. A reader thread decodes one page at a time,
+// reduced to the resolution the model needs, and feeds the page pipeline;
+// it blocks while the pipeline is full, so only a few pages are held in
+// memory however long the document is. callback receives each page's
+// result with its 0-based index in the file, in page order, then once more
+// with page_index -1 and {"total_pages":..,"pages":..,"cancelled":..} or an
+// error ({"code":"UNSUPPORTED_FORMAT"} for PDF, which has no decoder in
+// this build). handle NULL = default model; options may be NULL. Returns a
+// document to release with closeDocument, NULL if no model is loaded.
+void* detectDocument(void* handle, const char* path, float conf_threshold,
+                     const DocLayoutDocumentOptions* options, int64_t document_id,
+                     DocLayoutPageCallback callback);
+
+// Stop reading further pages; queued pages are still delivered, then the
+// final callback reports cancelled. Does not block.
+void cancelDocument(void* document);
+
+// Cancel, wait for the reader and release the document. Call it after the
+// final callback to avoid blocking; must not be called from the callback.
+void closeDocument(void* document);
+
+// Release a detector instance. No synchronous call may be running on it;
+// queued async requests, trackers, page streams and documents on it keep
+// the session until they finish or are closed.
+void destroyDetector(void* handle);
+
+// Free a string returned by this library
+void freeString(char* str);
+
+// Library version
+const char* getVersion(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // FLUTTER_DOCLAYOUT_KIT_H
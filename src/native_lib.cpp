@@ -1,14 +1,35 @@
 #include <opencv2/opencv.hpp>
 #include <onnxruntime_cxx_api.h>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <iomanip>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 #include <string>
-#include <future>
 #include <chrono>
 
+#include "flutter_doclayout_kit.h"
 #include "detect/include/config_manager.h"
 #include "detect/include/doc_detector.h"
+#include "detect/include/inference_worker.h"
+#include "detect/include/page_pipeline.h"
+#include "detect/include/document_reader.h"
+#include "detect/include/frame_tracker.h"
+#include "detect/include/result_cache.h"
+#include "detect/include/latency_stats.h"
+#include "detect/include/postprocess.h"
+#include "detect/include/model_variant.h"
+#include "detect/include/region_crops.h"
+#include "detect/include/incremental.h"
+#include "detect/include/request_control.h"
 
 #ifdef __ANDROID__
 #include <android/log.h>
@@ -19,117 +40,1530 @@
 
 using namespace std::chrono;
 
-// Initialize model path
+static const char* kModelNotLoadedJson = "{\"error\":\"Model not initialized\",\"code\":\"MODEL_NOT_LOADED\"}";
+
+// Detectors handed out by createDetector, by handle. Work that outlives the
+// call (queued requests, trackers, page streams) holds its own reference, so
+// destroyDetector only drops the caller's and the session is released when
+// the last of that work is done.
+static std::mutex g_handles_mutex;
+static std::unordered_map<void*, std::shared_ptr<DocDetector>> g_handles;
+
+// Owning reference to a handle's detector (NULL = default model); empty if
+// the handle has been destroyed
+static std::shared_ptr<DocDetector> retainDetector(void* handle) {
+    if (handle == nullptr) {
+        return getDefaultDetector();
+    }
+    std::lock_guard<std::mutex> lock(g_handles_mutex);
+    auto it = g_handles.find(handle);
+    return it != g_handles.end() ? it->second : nullptr;
+}
+
+static DetectorOptions toDetectorOptions(const DocLayoutOptions* options) {
+    DetectorOptions result;
+    if (options != nullptr) {
+        result.intra_op_threads = options->intra_op_threads;
+        result.inter_op_threads = options->inter_op_threads;
+        result.graph_optimization_level = options->graph_optimization_level;
+        result.execution_providers = options->execution_providers;
+        result.max_batch_size = options->max_batch_size;
+        result.full_resolution_decode = options->full_resolution_decode;
+        if (options->profile_file_prefix != nullptr) {
+            result.profile_prefix = options->profile_file_prefix;
+        }
+        result.max_concurrent_runs = options->max_concurrent_runs;
+        result.input_size = options->input_size;
+        result.letterbox = options->letterbox;
+        result.precision = options->precision;
+        result.disable_memory_map = options->disable_memory_map;
+        if (options->optimized_model_dir != nullptr) {
+            result.optimized_model_dir = options->optimized_model_dir;
+        }
+        result.disable_cpu_arena = options->disable_cpu_arena;
+        result.arena_extend_strategy = options->arena_extend_strategy;
+        result.arena_initial_chunk_bytes = options->arena_initial_chunk_bytes;
+        result.arena_max_bytes = options->arena_max_bytes;
+        result.shrink_arena_after_run = options->shrink_arena_after_run;
+        result.decode_pool_size = options->decode_pool_size;
+        result.page_crop = options->page_crop;
+    }
+    return result;
+}
+
+// Initialize model path and load the default detector eagerly
 extern "C" __attribute__((visibility("default")))
-void initModel(const char* model_path) {
+int initModelWithOptions(const char* model_path, const DocLayoutOptions* options) {
+    if (model_path == nullptr) {
+        return 0;
+    }
     ConfigManager::GetInstance().Init(std::string(model_path));
-    LOGI("Model initialized: %s\n", model_path);
+    DetectorOptions detector_options = toDetectorOptions(options);
+
+    // Same model and options already loaded, keep the warm session
+    std::shared_ptr<DocDetector> current = getDefaultDetector();
+    if (current && current->ModelPath() == model_path && current->Options() == detector_options) {
+        return 1;
+    }
+
+    try {
+        setDefaultDetector(std::make_shared<DocDetector>(model_path, detector_options));
+        LOGI("Model initialized: %s\n", model_path);
+        return 1;
+    } catch (const std::exception& e) {
+        // Do not keep serving the previous model for a path that failed to load
+        setDefaultDetector(nullptr);
+        (void)e;
+        LOGE("Model load failed: %s\n", e.what());
+        return 0;
+    }
 }
 
-// Detect document layout from image path (async)
+// Initialize model path with default session options
 extern "C" __attribute__((visibility("default")))
-char* detectLayout(const char* img_path, float conf_threshold) {
-    return strdup(std::async(std::launch::async, [img_path, conf_threshold]() -> std::string {
-        auto start = high_resolution_clock::now();
+void initModel(const char* model_path) {
+    initModelWithOptions(model_path, nullptr);
+}
+
+// Build JSON response for a finished detection
+static std::string buildResultJson(const std::vector<DetectionBox>& detections,
+                                   const std::vector<std::string>& class_names,
+                                   long long inference_time, int image_width, int image_height) {
+    std::ostringstream json;
+    json << "{\"detections\":[";
+
+    for (size_t i = 0; i < detections.size(); i++) {
+        const auto& box = detections[i];
+        json << "{";
+        json << "\"x1\":" << std::fixed << std::setprecision(1) << box.x1 << ",";
+        json << "\"y1\":" << box.y1 << ",";
+        json << "\"x2\":" << box.x2 << ",";
+        json << "\"y2\":" << box.y2 << ",";
+        json << "\"score\":" << std::setprecision(4) << box.score << ",";
+        json << "\"class_id\":" << box.class_id << ",";
+        json << "\"class_name\":\"" << className(class_names, box.class_id) << "\"";
+        json << "}";
+        if (i < detections.size() - 1) {
+            json << ",";
+        }
+    }
+
+    json << "],";
+    json << "\"count\":" << detections.size() << ",";
+    json << "\"inference_time_ms\":" << inference_time << ",";
+    json << "\"image_width\":" << image_width << ",";
+    json << "\"image_height\":" << image_height;
+    json << "}";
 
-        // Load image
-        cv::Mat image = cv::imread(img_path);
-        if (image.empty()) {
+    return json.str();
+}
+
+// Outcome of one detection, serialized either to JSON or to the binary layout
+struct PageOutput {
+    std::vector<DetectionBox> detections;
+    long long inference_time = 0;
+    int image_width = 0;
+    int image_height = 0;
+    int status = DOCLAYOUT_OK;
+    bool tracked = false;       // produced by a FrameTracker
+    bool reused = false;        // tracker returned its cached detections
+    float change = 0.0f;        // tracker change metric
+    const std::vector<std::string>* class_names = &DOC_CLASSES;  // the detector's class table, for JSON
+};
+
+// Set inference_time_ms and record the whole call in the latency stats
+template <typename Output>
+static void finishTiming(Output& output, high_resolution_clock::time_point start) {
+    duration<double, std::milli> elapsed = high_resolution_clock::now() - start;
+    output.inference_time = static_cast<long long>(elapsed.count());
+    LatencyStats::GetInstance().Record(kStageTotal, elapsed.count());
+}
+
+static const char* kEmptyBufferJson = "{\"error\":\"Empty image buffer\",\"code\":\"IMAGE_DECODE_FAILED\"}";
+static const char* kDecodeFailedJson = "{\"error\":\"Could not decode image\",\"code\":\"IMAGE_DECODE_FAILED\"}";
+
+// Error JSON matching a DOCLAYOUT_ERR_* status
+static const char* statusJson(int status) {
+    switch (status) {
+        case DOCLAYOUT_ERR_MODEL_NOT_LOADED:
+            return kModelNotLoadedJson;
+        case DOCLAYOUT_ERR_IMAGE_LOAD:
             return "{\"error\":\"Could not load image\",\"code\":\"IMAGE_LOAD_FAILED\"}";
+        case DOCLAYOUT_ERR_IMAGE_DECODE:
+            return kDecodeFailedJson;
+        case DOCLAYOUT_ERR_EMPTY_INPUT:
+            return kEmptyBufferJson;
+        case DOCLAYOUT_ERR_CANCELLED:
+            return "{\"error\":\"Request cancelled\",\"code\":\"CANCELLED\"}";
+        case DOCLAYOUT_ERR_DEADLINE_EXCEEDED:
+            return "{\"error\":\"Deadline exceeded\",\"code\":\"DEADLINE_EXCEEDED\"}";
+        case DOCLAYOUT_ERR_SUPERSEDED:
+            return "{\"error\":\"Superseded by a newer request\",\"code\":\"SUPERSEDED\"}";
+        case DOCLAYOUT_ERR_INFERENCE_FAILED:
+            return "{\"error\":\"Inference failed\",\"code\":\"INFERENCE_FAILED\"}";
+        default:
+            return "{\"error\":\"Invalid argument\",\"code\":\"INVALID_ARGUMENT\"}";
+    }
+}
+
+static std::string outputJson(const PageOutput& output) {
+    if (output.status != DOCLAYOUT_OK) {
+        return statusJson(output.status);
+    }
+    StageTimer serialize_timer(kStageSerialize);
+    std::string json = buildResultJson(output.detections, *output.class_names, output.inference_time,
+                                       output.image_width, output.image_height);
+    if (output.tracked) {
+        // Append the tracking fields before the closing brace
+        std::ostringstream extra;
+        extra << ",\"reused\":" << (output.reused ? "true" : "false")
+              << ",\"change\":" << std::fixed << std::setprecision(4) << output.change << "}";
+        json.pop_back();
+        json += extra.str();
+    }
+    return json;
+}
+
+// Write the binary layout: a DocLayoutResultHeader followed by up to
+// max_boxes DocLayoutBox entries. Returns the status, or the number of
+// boxes found on success.
+static int writeOutput(const PageOutput& output, float* out, int32_t max_boxes) {
+    if (out == nullptr || max_boxes < 0) {
+        return DOCLAYOUT_ERR_INVALID_ARGUMENT;
+    }
+
+    StageTimer serialize_timer(kStageSerialize);
+    size_t written = output.status == DOCLAYOUT_OK
+        ? std::min(output.detections.size(), static_cast<size_t>(max_boxes)) : 0;
+
+    DocLayoutResultHeader* header = reinterpret_cast<DocLayoutResultHeader*>(out);
+    header->status = static_cast<float>(output.status);
+    header->count = static_cast<float>(written);
+    header->total_count = static_cast<float>(output.status == DOCLAYOUT_OK ? output.detections.size() : 0);
+    header->inference_time_ms = static_cast<float>(output.inference_time);
+    header->image_width = static_cast<float>(output.image_width);
+    header->image_height = static_cast<float>(output.image_height);
+    header->reused = output.reused ? 1.0f : 0.0f;
+    header->change = output.tracked ? output.change : 0.0f;
+
+    DocLayoutBox* boxes = reinterpret_cast<DocLayoutBox*>(out + DOCLAYOUT_RESULT_HEADER_FLOATS);
+    for (size_t i = 0; i < written; i++) {
+        const DetectionBox& box = output.detections[i];
+        boxes[i].x1 = box.x1;
+        boxes[i].y1 = box.y1;
+        boxes[i].x2 = box.x2;
+        boxes[i].y2 = box.y2;
+        boxes[i].score = box.score;
+        boxes[i].class_id = static_cast<float>(box.class_id);
+    }
+
+    return output.status == DOCLAYOUT_OK ? static_cast<int>(output.detections.size()) : output.status;
+}
+
+// Detect on a decoded image and report boxes and size in original-image
+// space; false if inference failed
+static bool detectDecoded(DocDetector& detector, const DecodedImage& decoded, float conf_threshold,
+                          PageOutput& output) {
+    if (!detector.Detect(decoded.image, PixelFormat::kBGR, conf_threshold, output.detections)) {
+        return false;
+    }
+    mapDetectionsToOriginal(output.detections, decoded.image.cols, decoded.image.rows,
+                            decoded.original_width, decoded.original_height);
+    output.image_width = decoded.original_width;
+    output.image_height = decoded.original_height;
+    return true;
+}
+
+// Model identity for the result cache: the loaded file (variants differ
+// slightly in their boxes) and its size / mtime, so a model replaced at the
+// same path does not hit the old model's disk entries, plus options that
+// change the boxes
+static std::string cacheModelId(const DocDetector& detector) {
+    std::string id = detector.LoadedPath() + "@" + detector.ModelStamp() + "#" +
+                     std::to_string(detector.InputWidth()) + "x" + std::to_string(detector.InputHeight());
+    if (detector.Options().letterbox) {
+        id += "#letterbox";
+    }
+    if (detector.Options().full_resolution_decode) {
+        id += "#full";
+    }
+    if (detector.Options().page_crop) {
+        id += "#pagecrop";
+    }
+    return id + detector.Postprocess()->Id();
+}
+
+// Decode and detect encoded bytes, answered from the result cache when it is
+// enabled. Returns DOCLAYOUT_OK, DOCLAYOUT_ERR_IMAGE_DECODE or
+// DOCLAYOUT_ERR_INFERENCE_FAILED; only successful runs are cached.
+static int detectEncodedCached(DocDetector& detector, const uint8_t* data, size_t len, float conf_threshold,
+                                PageOutput& output) {
+    ResultCache& cache = ResultCache::GetInstance();
+    const bool use_cache = cache.Enabled();
+    CacheKey key;
+    if (use_cache) {
+        key = ResultCache::MakeKey(data, len, conf_threshold, cacheModelId(detector));
+        CachedResult cached;
+        if (cache.Lookup(key, cached)) {
+            output.detections = std::move(cached.detections);
+            output.image_width = cached.image_width;
+            output.image_height = cached.image_height;
+            return DOCLAYOUT_OK;
         }
+    }
+
+    DecodedImage decoded = detector.Decode(data, len);
+    if (decoded.image.empty()) {
+        return DOCLAYOUT_ERR_IMAGE_DECODE;
+    }
+
+    // Run detection
+    const bool inferred = detectDecoded(detector, decoded, conf_threshold, output);
+    detector.RecycleDecoded(decoded);
+    if (!inferred) {
+        return DOCLAYOUT_ERR_INFERENCE_FAILED;
+    }
+
+    // A terminated run leaves no detections, which must not be cached
+    RequestControl* request = ScopedRequest::Current();
+    if (use_cache && (request == nullptr || !request->Stopped())) {
+        CachedResult entry;
+        entry.detections = output.detections;
+        entry.image_width = output.image_width;
+        entry.image_height = output.image_height;
+        cache.Insert(key, entry);
+    }
+    return DOCLAYOUT_OK;
+}
+
+// Load an image file and run detection on it
+static PageOutput runFile(DocDetector& detector, const char* img_path, float conf_threshold) {
+    PageOutput output;
+    output.class_names = &detector.Descriptor().class_names;
+    auto start = high_resolution_clock::now();
 
-        // Run detection
-        std::vector<DetectionBox> detections = detectDocLayout(image, conf_threshold);
-
-        auto end = high_resolution_clock::now();
-        long long inference_time = duration_cast<milliseconds>(end - start).count();
-
-        // Build JSON response
-        std::ostringstream json;
-        json << "{\"detections\":[";
-
-        for (size_t i = 0; i < detections.size(); i++) {
-            const auto& box = detections[i];
-            json << "{";
-            json << "\"x1\":" << std::fixed << std::setprecision(1) << box.x1 << ",";
-            json << "\"y1\":" << box.y1 << ",";
-            json << "\"x2\":" << box.x2 << ",";
-            json << "\"y2\":" << box.y2 << ",";
-            json << "\"score\":" << std::setprecision(4) << box.score << ",";
-            json << "\"class_id\":" << box.class_id << ",";
-            json << "\"class_name\":\"" << box.class_name << "\"";
-            json << "}";
-            if (i < detections.size() - 1) {
-                json << ",";
+    // Load image
+    std::vector<uint8_t> bytes;
+    if (!readFileBytes(img_path, bytes)) {
+        output.status = DOCLAYOUT_ERR_IMAGE_LOAD;
+        return output;
+    }
+    const int status = detectEncodedCached(detector, bytes.data(), bytes.size(), conf_threshold, output);
+    if (status != DOCLAYOUT_OK) {
+        output.status = status == DOCLAYOUT_ERR_IMAGE_DECODE ? DOCLAYOUT_ERR_IMAGE_LOAD : status;
+        return output;
+    }
+
+    finishTiming(output, start);
+    return output;
+}
+
+// Decode encoded image bytes and run detection on them
+static PageOutput runEncoded(DocDetector& detector, const uint8_t* data, size_t len, float conf_threshold) {
+    PageOutput output;
+    output.class_names = &detector.Descriptor().class_names;
+    auto start = high_resolution_clock::now();
+
+    if (data == nullptr || len == 0) {
+        output.status = DOCLAYOUT_ERR_EMPTY_INPUT;
+        return output;
+    }
+
+    output.status = detectEncodedCached(detector, data, len, conf_threshold, output);
+    if (output.status != DOCLAYOUT_OK) {
+        return output;
+    }
+
+    finishTiming(output, start);
+    return output;
+}
+
+// Wrap raw 1/3/4 channel pixels without copying, returns DOCLAYOUT_OK or an error status
+static int wrapPixels(const unsigned char* image_data, int width, int height, int channels,
+                      cv::Mat& image, PixelFormat& format) {
+    if (image_data == nullptr || width <= 0 || height <= 0) {
+        return DOCLAYOUT_ERR_EMPTY_INPUT;
+    }
+
+    // Create cv::Mat from bytes
+    int cv_type = (channels == 4) ? CV_8UC4 : (channels == 3) ? CV_8UC3 : CV_8UC1;
+    image = cv::Mat(height, width, cv_type, const_cast<unsigned char*>(image_data));
+
+    // The preprocess kernel reads RGBA/gray directly, no full-size BGR copy
+    format = (channels == 4) ? PixelFormat::kRGBA
+           : (channels == 1) ? PixelFormat::kGray
+           : PixelFormat::kBGR;
+    return DOCLAYOUT_OK;
+}
+
+// Describe YUV 4:2:0 planes (I420, NV21, NV12), returns DOCLAYOUT_OK or an error status
+static int wrapYuv(const uint8_t* y, const uint8_t* u, const uint8_t* v, int width, int height,
+                   int y_row_stride, int uv_row_stride, int uv_pixel_stride, YuvPlanes& frame) {
+    if (y == nullptr || u == nullptr || v == nullptr || width <= 0 || height <= 0) {
+        return DOCLAYOUT_ERR_EMPTY_INPUT;
+    }
+    if (y_row_stride < width || uv_row_stride <= 0 || uv_pixel_stride <= 0) {
+        return DOCLAYOUT_ERR_INVALID_ARGUMENT;
+    }
+
+    frame.y = y;
+    frame.u = u;
+    frame.v = v;
+    frame.width = width;
+    frame.height = height;
+    frame.y_row_stride = y_row_stride;
+    frame.uv_row_stride = uv_row_stride;
+    frame.uv_pixel_stride = uv_pixel_stride;
+    return DOCLAYOUT_OK;
+}
+
+// Wrap raw 1/3/4 channel pixels and run detection on them
+static PageOutput runPixels(DocDetector& detector, const unsigned char* image_data, int width, int height,
+                            int channels, float conf_threshold) {
+    PageOutput output;
+    output.class_names = &detector.Descriptor().class_names;
+    auto start = high_resolution_clock::now();
+
+    cv::Mat image;
+    PixelFormat format = PixelFormat::kBGR;
+    output.status = wrapPixels(image_data, width, height, channels, image, format);
+    if (output.status != DOCLAYOUT_OK) {
+        return output;
+    }
+
+    // Run detection
+    if (!detector.Detect(image, format, conf_threshold, output.detections)) {
+        output.status = DOCLAYOUT_ERR_INFERENCE_FAILED;
+        return output;
+    }
+
+    finishTiming(output, start);
+    output.image_width = width;
+    output.image_height = height;
+    return output;
+}
+
+// Decode several encoded images and run them through the model in batches.
+// Pages that fail to decode get their own error object in the results array.
+static std::string detectEncodedBatch(DocDetector& detector, const uint8_t* const* data, const size_t* lens,
+                                      int count, float conf_threshold) {
+    auto start = high_resolution_clock::now();
+
+    if (data == nullptr || lens == nullptr || count <= 0) {
+        return "{\"error\":\"Empty batch\",\"code\":\"IMAGE_DECODE_FAILED\"}";
+    }
+
+    // Pages found in the result cache are not decoded and stay empty in the batch
+    ResultCache& cache = ResultCache::GetInstance();
+    const bool use_cache = cache.Enabled();
+    const std::string model_id = use_cache ? cacheModelId(detector) : std::string();
+    std::vector<CacheKey> keys(use_cache ? count : 0);
+    std::vector<CachedResult> cached(count);
+    std::vector<char> hit(count, 0);
+
+    std::vector<cv::Mat> images(count);
+    std::vector<DecodedImage> decoded(count);
+    for (int i = 0; i < count; i++) {
+        if (use_cache && data[i] != nullptr && lens[i] > 0) {
+            keys[i] = ResultCache::MakeKey(data[i], lens[i], conf_threshold, model_id);
+            if (cache.Lookup(keys[i], cached[i])) {
+                hit[i] = 1;
+                decoded[i].original_width = cached[i].image_width;
+                decoded[i].original_height = cached[i].image_height;
+                continue;
             }
         }
+        decoded[i] = detector.Decode(data[i], lens[i]);
+        images[i] = decoded[i].image;
+    }
 
-        json << "],";
-        json << "\"count\":" << detections.size() << ",";
-        json << "\"inference_time_ms\":" << inference_time << ",";
-        json << "\"image_width\":" << image.cols << ",";
-        json << "\"image_height\":" << image.rows;
-        json << "}";
+    std::vector<std::vector<DetectionBox>> detections;
+    std::vector<uint8_t> succeeded;
+    detector.DetectBatch(images, conf_threshold, detections, &succeeded);
+    // A terminated run leaves no detections, which must not be cached
+    RequestControl* request = ScopedRequest::Current();
+    const bool stopped = request != nullptr && request->Stopped();
+    for (int i = 0; i < count; i++) {
+        if (hit[i]) {
+            detections[i] = std::move(cached[i].detections);
+            continue;
+        }
+        if (images[i].empty() || !succeeded[i]) {
+            continue;
+        }
+        mapDetectionsToOriginal(detections[i], images[i].cols, images[i].rows,
+                                decoded[i].original_width, decoded[i].original_height);
+        if (use_cache && !stopped) {
+            CachedResult entry;
+            entry.detections = detections[i];
+            entry.image_width = decoded[i].original_width;
+            entry.image_height = decoded[i].original_height;
+            cache.Insert(keys[i], entry);
+        }
+    }
+
+    auto end = high_resolution_clock::now();
+    long long total_time = duration_cast<milliseconds>(end - start).count();
+    long long page_time = total_time / count;
+    LatencyStats::GetInstance().Record(kStageTotal, duration<double, std::milli>(end - start).count());
+
+    StageTimer serialize_timer(kStageSerialize);
+    std::ostringstream json;
+    json << "{\"results\":[";
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            json << ",";
+        }
+        if (images[i].empty() && !hit[i]) {
+            json << (lens[i] == 0 ? kEmptyBufferJson : kDecodeFailedJson);
+        } else if (!hit[i] && !succeeded[i]) {
+            json << statusJson(DOCLAYOUT_ERR_INFERENCE_FAILED);
+        } else {
+            json << buildResultJson(detections[i], detector.Descriptor().class_names, page_time,
+                                    decoded[i].original_width, decoded[i].original_height);
+        }
+    }
+    json << "],";
+    json << "\"count\":" << count << ",";
+    json << "\"inference_time_ms\":" << total_time;
+    json << "}";
+
+    return json.str();
+}
+
+// Run detection on YUV 4:2:0 planes (I420, NV21, NV12)
+static PageOutput runYuv(DocDetector& detector, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                         int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                         float conf_threshold) {
+    PageOutput output;
+    output.class_names = &detector.Descriptor().class_names;
+    auto start = high_resolution_clock::now();
+
+    YuvPlanes frame;
+    output.status = wrapYuv(y, u, v, width, height, y_row_stride, uv_row_stride, uv_pixel_stride, frame);
+    if (output.status != DOCLAYOUT_OK) {
+        return output;
+    }
+
+    // Run detection
+    if (!detector.Detect(frame, conf_threshold, output.detections)) {
+        output.status = DOCLAYOUT_ERR_INFERENCE_FAILED;
+        return output;
+    }
 
-        return json.str();
-    }).get().c_str());
+    finishTiming(output, start);
+    output.image_width = width;
+    output.image_height = height;
+    return output;
+}
+
+// Tracking mode: reuse the previous detections while the scene is steady
+static PageOutput runTrackedPixels(FrameTracker& tracker, const unsigned char* image_data, int width, int height,
+                                   int channels, float conf_threshold) {
+    PageOutput output;
+    output.class_names = &tracker.Detector().Descriptor().class_names;
+    output.tracked = true;
+    auto start = high_resolution_clock::now();
+
+    cv::Mat image;
+    PixelFormat format = PixelFormat::kBGR;
+    output.status = wrapPixels(image_data, width, height, channels, image, format);
+    if (output.status != DOCLAYOUT_OK) {
+        return output;
+    }
+
+    TrackedFrame frame;
+    if (!tracker.Track(image, format, conf_threshold, frame)) {
+        output.status = DOCLAYOUT_ERR_INFERENCE_FAILED;
+        return output;
+    }
+    output.detections = std::move(frame.detections);
+    output.reused = frame.reused;
+    output.change = frame.change;
+
+    finishTiming(output, start);
+    output.image_width = width;
+    output.image_height = height;
+    return output;
+}
+
+static PageOutput runTrackedYuv(FrameTracker& tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                                int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                                float conf_threshold) {
+    PageOutput output;
+    output.class_names = &tracker.Detector().Descriptor().class_names;
+    output.tracked = true;
+    auto start = high_resolution_clock::now();
+
+    YuvPlanes planes;
+    output.status = wrapYuv(y, u, v, width, height, y_row_stride, uv_row_stride, uv_pixel_stride, planes);
+    if (output.status != DOCLAYOUT_OK) {
+        return output;
+    }
+
+    TrackedFrame frame;
+    if (!tracker.Track(planes, conf_threshold, frame)) {
+        output.status = DOCLAYOUT_ERR_INFERENCE_FAILED;
+        return output;
+    }
+    output.detections = std::move(frame.detections);
+    output.reused = frame.reused;
+    output.change = frame.change;
+
+    finishTiming(output, start);
+    output.image_width = width;
+    output.image_height = height;
+    return output;
+}
+
+// Detect document layout from image path, runs on the calling thread
+extern "C" __attribute__((visibility("default")))
+char* detectLayout(const char* img_path, float conf_threshold) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(outputJson(runFile(*detector, img_path, conf_threshold)).c_str());
+}
+
+// Detect from encoded image bytes (PNG, JPEG, ...) without touching the filesystem
+extern "C" __attribute__((visibility("default")))
+char* detectLayoutFromEncoded(const uint8_t* data, size_t len, float conf_threshold) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(outputJson(runEncoded(*detector, data, len, conf_threshold)).c_str());
 }
 
 // Detect from image bytes (for camera preview)
 extern "C" __attribute__((visibility("default")))
 char* detectLayoutFromBytes(const unsigned char* image_data, int width, int height, int channels, float conf_threshold) {
-    return strdup(std::async(std::launch::async, [image_data, width, height, channels, conf_threshold]() -> std::string {
-        auto start = high_resolution_clock::now();
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(outputJson(runPixels(*detector, image_data, width, height, channels, conf_threshold)).c_str());
+}
+
+// Detect from YUV 4:2:0 camera planes, returns JSON
+extern "C" __attribute__((visibility("default")))
+char* detectLayoutFromYuv(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                          int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                          float conf_threshold) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(outputJson(runYuv(*detector, y, u, v, width, height, y_row_stride, uv_row_stride,
+                                    uv_pixel_stride, conf_threshold)).c_str());
+}
+
+// Binary variants: fill a caller-provided float buffer instead of building JSON
 
-        // Create cv::Mat from bytes
-        int cv_type = (channels == 4) ? CV_8UC4 : (channels == 3) ? CV_8UC3 : CV_8UC1;
-        cv::Mat image(height, width, cv_type, const_cast<unsigned char*>(image_data));
+extern "C" __attribute__((visibility("default")))
+int detectLayoutToBuffer(const char* img_path, float conf_threshold, float* out, int32_t max_boxes) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    PageOutput output;
+    if (detector) {
+        output = runFile(*detector, img_path, conf_threshold);
+    } else {
+        output.status = DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    return writeOutput(output, out, max_boxes);
+}
 
-        // Convert to BGR if needed
-        cv::Mat bgr_image;
-        if (channels == 4) {
-            cv::cvtColor(image, bgr_image, cv::COLOR_RGBA2BGR);
-        } else if (channels == 1) {
-            cv::cvtColor(image, bgr_image, cv::COLOR_GRAY2BGR);
+extern "C" __attribute__((visibility("default")))
+int detectLayoutFromEncodedToBuffer(const uint8_t* data, size_t len, float conf_threshold,
+                                    float* out, int32_t max_boxes) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    PageOutput output;
+    if (detector) {
+        output = runEncoded(*detector, data, len, conf_threshold);
+    } else {
+        output.status = DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    return writeOutput(output, out, max_boxes);
+}
+
+extern "C" __attribute__((visibility("default")))
+int detectLayoutFromBytesToBuffer(const unsigned char* image_data, int width, int height, int channels,
+                                  float conf_threshold, float* out, int32_t max_boxes) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    PageOutput output;
+    if (detector) {
+        output = runPixels(*detector, image_data, width, height, channels, conf_threshold);
+    } else {
+        output.status = DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    return writeOutput(output, out, max_boxes);
+}
+
+extern "C" __attribute__((visibility("default")))
+int detectLayoutFromYuvToBuffer(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                                int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                                float conf_threshold, float* out, int32_t max_boxes) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    PageOutput output;
+    if (detector) {
+        output = runYuv(*detector, y, u, v, width, height, y_row_stride, uv_row_stride, uv_pixel_stride,
+                        conf_threshold);
+    } else {
+        output.status = DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    return writeOutput(output, out, max_boxes);
+}
+
+// Detect on several encoded images at once, returns {"results":[...]} JSON
+extern "C" __attribute__((visibility("default")))
+char* detectLayoutBatch(const uint8_t* const* data, const size_t* lens, int count, float conf_threshold) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(detectEncodedBatch(*detector, data, lens, count, conf_threshold).c_str());
+}
+
+// DOCLAYOUT_ERR_* status of a request that stopped early
+static int requestStatus(const RequestControl& request) {
+    switch (request.State()) {
+        case kRequestCancelled:
+            return DOCLAYOUT_ERR_CANCELLED;
+        case kRequestDeadlineExceeded:
+            return DOCLAYOUT_ERR_DEADLINE_EXCEEDED;
+        case kRequestSuperseded:
+            return DOCLAYOUT_ERR_SUPERSEDED;
+        default:
+            return DOCLAYOUT_OK;
+    }
+}
+
+// Work of one queued request: returns the result JSON
+using RequestWork = std::function<std::string(DocDetector& detector)>;
+
+// Queue a request on the background worker under its own RequestControl.
+// detector may be null (no model); the request keeps it alive until done,
+// even if its handle is destroyed meanwhile.
+static void submitRequest(std::shared_ptr<DocDetector> detector, const DocLayoutRequestOptions* options,
+                          int64_t request_id, DocLayoutResultCallback callback, RequestWork work) {
+    const int64_t lane = options != nullptr ? options->lane : 0;
+    const int deadline_ms = options != nullptr ? options->deadline_ms : 0;
+    // Registered before the task is queued, so cancelRequest works right away
+    std::shared_ptr<RequestControl> request = RequestRegistry::GetInstance().Register(request_id, lane, deadline_ms);
+    InferenceWorker::GetInstance().Submit([detector, request_id, callback, request, work]() {
+        std::string json;
+        request->CheckDeadline();
+        if (request->Stopped()) {
+            // Skipped without decoding
+            json = statusJson(requestStatus(*request));
+        } else if (detector == nullptr) {
+            json = kModelNotLoadedJson;
         } else {
-            bgr_image = image;
-        }
-
-        // Run detection
-        std::vector<DetectionBox> detections = detectDocLayout(bgr_image, conf_threshold);
-
-        auto end = high_resolution_clock::now();
-        long long inference_time = duration_cast<milliseconds>(end - start).count();
-
-        // Build JSON response
-        std::ostringstream json;
-        json << "{\"detections\":[";
-
-        for (size_t i = 0; i < detections.size(); i++) {
-            const auto& box = detections[i];
-            json << "{";
-            json << "\"x1\":" << std::fixed << std::setprecision(1) << box.x1 << ",";
-            json << "\"y1\":" << box.y1 << ",";
-            json << "\"x2\":" << box.x2 << ",";
-            json << "\"y2\":" << box.y2 << ",";
-            json << "\"score\":" << std::setprecision(4) << box.score << ",";
-            json << "\"class_id\":" << box.class_id << ",";
-            json << "\"class_name\":\"" << box.class_name << "\"";
-            json << "}";
-            if (i < detections.size() - 1) {
-                json << ",";
+            ScopedRequest scope(request.get());
+            json = work(*detector);
+            request->CheckDeadline();
+            if (request->Stopped()) {
+                json = statusJson(requestStatus(*request));
             }
         }
+        RequestRegistry::GetInstance().Remove(request);
+        callback(request_id, strdup(json.c_str()));
+    });
+}
+
+// Queue detection of encoded image bytes on the background worker.
+// The default detector is captured at submission, so a later initModel()
+// does not change the model used by already queued requests.
+extern "C" __attribute__((visibility("default")))
+int detectLayoutFromEncodedAsync(const uint8_t* data, size_t len, float conf_threshold,
+                                 int64_t request_id, DocLayoutResultCallback callback) {
+    return detectAsyncWithOptions(nullptr, data, len, conf_threshold, nullptr, request_id, callback);
+}
+
+// Queue detection with a deadline and / or a latest-wins lane. NULL handle = default model.
+extern "C" __attribute__((visibility("default")))
+int detectAsyncWithOptions(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                           const DocLayoutRequestOptions* options, int64_t request_id,
+                           DocLayoutResultCallback callback) {
+    if (callback == nullptr) {
+        return 0;
+    }
+    RequestWork work = [data, len, conf_threshold](DocDetector& detector) {
+        return outputJson(runEncoded(detector, data, len, conf_threshold));
+    };
+    submitRequest(retainDetector(handle), options, request_id, callback, work);
+    return 1;
+}
 
-        json << "],";
-        json << "\"count\":" << detections.size() << ",";
-        json << "\"inference_time_ms\":" << inference_time << ",";
-        json << "\"image_width\":" << width << ",";
-        json << "\"image_height\":" << height;
+// Stop a queued or running async request
+extern "C" __attribute__((visibility("default")))
+int cancelRequest(int64_t request_id) {
+    return RequestRegistry::GetInstance().Cancel(request_id) ? 1 : 0;
+}
+
+// Stop every queued or running async request of a lane
+extern "C" __attribute__((visibility("default")))
+int cancelLane(int64_t lane) {
+    return RequestRegistry::GetInstance().CancelLane(lane);
+}
+
+// Process-unique request id / lane
+extern "C" __attribute__((visibility("default")))
+int64_t nextRequestId() {
+    return RequestRegistry::GetInstance().NextId();
+}
+
+// Create a detector instance with its own session
+extern "C" __attribute__((visibility("default")))
+void* createDetector(const char* model_path, const DocLayoutOptions* options) {
+    if (model_path == nullptr) {
+        return nullptr;
+    }
+    try {
+        auto detector = std::make_shared<DocDetector>(model_path, toDetectorOptions(options));
+        void* handle = detector.get();
+        std::lock_guard<std::mutex> lock(g_handles_mutex);
+        g_handles.emplace(handle, std::move(detector));
+        return handle;
+    } catch (const std::exception& e) {
+        (void)e;
+        LOGE("createDetector failed: %s\n", e.what());
+        return nullptr;
+    }
+}
+
+// Detect from encoded image bytes on a detector instance
+extern "C" __attribute__((visibility("default")))
+char* detectWithHandle(void* handle, const uint8_t* data, size_t len, float conf_threshold) {
+    if (handle == nullptr) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(outputJson(runEncoded(*static_cast<DocDetector*>(handle), data, len, conf_threshold)).c_str());
+}
+
+// Binary variant of detectWithHandle
+extern "C" __attribute__((visibility("default")))
+int detectWithHandleToBuffer(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                             float* out, int32_t max_boxes) {
+    PageOutput output;
+    if (handle != nullptr) {
+        output = runEncoded(*static_cast<DocDetector*>(handle), data, len, conf_threshold);
+    } else {
+        output.status = DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    return writeOutput(output, out, max_boxes);
+}
+
+// Queue detection on a detector instance. The request keeps the detector
+// alive, destroyDetector may be called before the callback.
+extern "C" __attribute__((visibility("default")))
+int detectWithHandleAsync(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                          int64_t request_id, DocLayoutResultCallback callback) {
+    if (handle == nullptr) {
+        return 0;
+    }
+    return detectAsyncWithOptions(handle, data, len, conf_threshold, nullptr, request_id, callback);
+}
+
+// Detect on several encoded images with a detector instance
+extern "C" __attribute__((visibility("default")))
+char* detectBatchWithHandle(void* handle, const uint8_t* const* data, const size_t* lens, int count,
+                            float conf_threshold) {
+    if (handle == nullptr) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(detectEncodedBatch(*static_cast<DocDetector*>(handle), data, lens, count, conf_threshold).c_str());
+}
+
+// Configure the postprocess passes of a detector (NULL = default model)
+extern "C" __attribute__((visibility("default")))
+int setPostprocessOptions(void* handle, const DocLayoutPostprocessOptions* options) {
+    std::shared_ptr<DocDetector> detector = retainDetector(handle);
+    if (!detector) {
+        return DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    PostprocessOptions postprocess;
+    if (options != nullptr) {
+        if (options->class_thresholds != nullptr && options->num_class_thresholds > 0) {
+            postprocess.class_thresholds.assign(options->class_thresholds,
+                                                options->class_thresholds + options->num_class_thresholds);
+        }
+        postprocess.nms_iou = options->nms_iou;
+        postprocess.containment = options->containment;
+        postprocess.reading_order = options->reading_order != 0;
+    }
+    detector->SetPostprocess(postprocess);
+    return DOCLAYOUT_OK;
+}
+
+// Decode at tile resolution and run tiled detection
+static PageOutput runTiled(DocDetector& detector, const uint8_t* data, size_t len, float conf_threshold,
+                           const DocLayoutTileOptions* options) {
+    PageOutput output;
+    output.class_names = &detector.Descriptor().class_names;
+    auto start = high_resolution_clock::now();
+
+    if (data == nullptr || len == 0) {
+        output.status = DOCLAYOUT_ERR_EMPTY_INPUT;
+        return output;
+    }
+
+    TileOptions tile_options;
+    if (options != nullptr) {
+        tile_options.tile_size = options->tile_size;
+        if (options->overlap > 0.0f) tile_options.overlap = options->overlap;
+        if (options->nms_iou > 0.0f) tile_options.nms_iou = options->nms_iou;
+        tile_options.full_page = options->skip_full_page == 0;
+    }
+
+    DecodedImage decoded = detector.DecodeForTiles(data, len, tile_options);
+    if (decoded.image.empty()) {
+        output.status = DOCLAYOUT_ERR_IMAGE_DECODE;
+        return output;
+    }
+
+    // tile_size is given in original pixels, the page may be decoded reduced
+    if (tile_options.tile_size > 0 && decoded.original_width > 0) {
+        tile_options.tile_size = std::max(1, static_cast<int>(std::lround(
+            static_cast<double>(tile_options.tile_size) * decoded.image.cols / decoded.original_width)));
+    }
+    if (!detector.DetectTiled(decoded.image, conf_threshold, tile_options, output.detections)) {
+        output.status = DOCLAYOUT_ERR_INFERENCE_FAILED;
+        return output;
+    }
+    mapDetectionsToOriginal(output.detections, decoded.image.cols, decoded.image.rows,
+                            decoded.original_width, decoded.original_height);
+    output.image_width = decoded.original_width;
+    output.image_height = decoded.original_height;
+
+    finishTiming(output, start);
+    return output;
+}
+
+// Tiled detection on a detector instance (NULL = default model)
+extern "C" __attribute__((visibility("default")))
+char* detectTiledWithHandle(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                            const DocLayoutTileOptions* options) {
+    if (handle != nullptr) {
+        return strdup(outputJson(runTiled(*static_cast<DocDetector*>(handle), data, len,
+                                          conf_threshold, options)).c_str());
+    }
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(outputJson(runTiled(*detector, data, len, conf_threshold, options)).c_str());
+}
+
+// Everything a DocLayoutCropResult points into
+struct CropBundle {
+    DocLayoutCropResult result;
+    cv::Mat page;                       // raw crops view into these pixels
+    std::vector<RegionCrop> regions;    // encoded crops own their bytes here
+    std::vector<DocLayoutCrop> crops;
+    std::string json;
+};
+
+extern "C" __attribute__((visibility("default")))
+DocLayoutCropResult* detectWithCrops(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                                     const DocLayoutCropOptions* options) {
+    std::shared_ptr<DocDetector> detector = retainDetector(handle);
+    CropBundle* bundle = new (std::nothrow) CropBundle();
+    if (bundle == nullptr) {
+        return nullptr;
+    }
+
+    PageOutput output;
+    if (!detector) {
+        output.status = DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    } else if (data == nullptr || len == 0) {
+        output.status = DOCLAYOUT_ERR_EMPTY_INPUT;
+    } else {
+        output.class_names = &detector->Descriptor().class_names;
+        auto start = high_resolution_clock::now();
+        {
+            // Full resolution: the crops are for OCR, not for the model
+            StageTimer decode_timer(kStageDecode);
+            bundle->page = decodeImage(data, len);
+        }
+        if (bundle->page.empty()) {
+            output.status = DOCLAYOUT_ERR_IMAGE_DECODE;
+        } else if (!detector->Detect(bundle->page, PixelFormat::kBGR, conf_threshold, output.detections)) {
+            output.status = DOCLAYOUT_ERR_INFERENCE_FAILED;
+        } else {
+            output.image_width = bundle->page.cols;
+            output.image_height = bundle->page.rows;
+
+            CropOptions crop_options;
+            if (options != nullptr) {
+                if (options->class_ids != nullptr && options->num_class_ids > 0) {
+                    crop_options.class_ids.assign(options->class_ids, options->class_ids + options->num_class_ids);
+                }
+                crop_options.padding = options->padding;
+                crop_options.encoding = options->encoding;
+                if (options->jpeg_quality > 0) {
+                    crop_options.jpeg_quality = options->jpeg_quality;
+                }
+            }
+            cropDetections(bundle->page, output.detections, crop_options, bundle->regions);
+            finishTiming(output, start);
+        }
+    }
+
+    bundle->crops.reserve(bundle->regions.size());
+    for (const RegionCrop& region : bundle->regions) {
+        DocLayoutCrop crop;
+        crop.detection_index = static_cast<int32_t>(region.detection_index);
+        crop.x = region.rect.x;
+        crop.y = region.rect.y;
+        crop.width = region.rect.width;
+        crop.height = region.rect.height;
+        if (region.encoded.empty()) {
+            crop.stride = static_cast<int32_t>(region.view.step);
+            crop.data = region.view.data;
+            crop.size = static_cast<int64_t>(region.view.step) * (region.view.rows - 1) +
+                        static_cast<int64_t>(region.view.cols) * region.view.elemSize();
+        } else {
+            crop.stride = 0;
+            crop.data = region.encoded.data();
+            crop.size = static_cast<int64_t>(region.encoded.size());
+        }
+        bundle->crops.push_back(crop);
+    }
+
+    bundle->json = outputJson(output);
+    bundle->result.result_json = &bundle->json[0];
+    bundle->result.count = static_cast<int32_t>(bundle->crops.size());
+    bundle->result.crops = bundle->crops.empty() ? nullptr : bundle->crops.data();
+    bundle->result.reserved = bundle;
+    return &bundle->result;
+}
+
+extern "C" __attribute__((visibility("default")))
+void releaseCrops(DocLayoutCropResult* result) {
+    if (result != nullptr) {
+        delete static_cast<CropBundle*>(result->reserved);
+    }
+}
+
+// Outcome of an incremental call
+struct IncrementalOutput {
+    IncrementalResult result;
+    long long inference_time = 0;
+    int image_width = 0;
+    int image_height = 0;
+    int status = DOCLAYOUT_OK;
+    const std::vector<std::string>* class_names = &DOC_CLASSES;
+};
+
+// Copy the previous boxes out of the caller's buffer, scaled from the size
+// they refer to onto width x height
+static std::vector<DetectionBox> previousBoxes(const DocLayoutPreviousResult* previous, int width, int height) {
+    std::vector<DetectionBox> boxes;
+    if (previous == nullptr || previous->boxes == nullptr || previous->count <= 0) {
+        return boxes;
+    }
+    const float sx = previous->image_width > 0 && width > 0
+        ? static_cast<float>(width) / previous->image_width : 1.0f;
+    const float sy = previous->image_height > 0 && height > 0
+        ? static_cast<float>(height) / previous->image_height : 1.0f;
+    boxes.resize(previous->count);
+    for (int32_t i = 0; i < previous->count; i++) {
+        const float* row = previous->boxes + static_cast<size_t>(i) * DOCLAYOUT_BOX_FLOATS;
+        boxes[i].x1 = row[0] * sx;
+        boxes[i].y1 = row[1] * sy;
+        boxes[i].x2 = row[2] * sx;
+        boxes[i].y2 = row[3] * sy;
+        boxes[i].score = row[4];
+        boxes[i].class_id = static_cast<int>(row[5]);
+    }
+    return boxes;
+}
+
+// buildResultJson plus the diff fields
+static std::string incrementalJson(const IncrementalOutput& output) {
+    if (output.status != DOCLAYOUT_OK) {
+        return statusJson(output.status);
+    }
+    StageTimer serialize_timer(kStageSerialize);
+    const std::vector<DiffBox>& boxes = output.result.boxes;
+    std::ostringstream json;
+    json << "{\"detections\":[";
+
+    for (size_t i = 0; i < boxes.size(); i++) {
+        const auto& box = boxes[i].box;
+        json << "{";
+        json << "\"x1\":" << std::fixed << std::setprecision(1) << box.x1 << ",";
+        json << "\"y1\":" << box.y1 << ",";
+        json << "\"x2\":" << box.x2 << ",";
+        json << "\"y2\":" << box.y2 << ",";
+        json << "\"score\":" << std::setprecision(4) << box.score << ",";
+        json << "\"class_id\":" << box.class_id << ",";
+        json << "\"class_name\":\"" << className(*output.class_names, box.class_id) << "\",";
+        json << "\"diff\":\"" << diffMarkName(boxes[i].mark) << "\",";
+        json << "\"previous_index\":" << boxes[i].previous_index;
         json << "}";
+        if (i < boxes.size() - 1) {
+            json << ",";
+        }
+    }
+
+    json << "],";
+    json << "\"count\":" << boxes.size() << ",";
+    json << "\"inference_time_ms\":" << output.inference_time << ",";
+    json << "\"image_width\":" << output.image_width << ",";
+    json << "\"image_height\":" << output.image_height << ",";
+    json << "\"removed\":[";
+    for (size_t i = 0; i < output.result.removed.size(); i++) {
+        json << (i > 0 ? "," : "") << output.result.removed[i];
+    }
+    json << "]";
+    const cv::Rect& region = output.result.region;
+    if (region.area() > 0) {
+        json << ",\"region\":[" << region.x << "," << region.y << "," << region.width << "," << region.height << "]";
+    }
+    json << "}";
+
+    return json.str();
+}
+
+// Decode, re-detect the affected region and merge with the previous boxes.
+// previous holds the caller's rows as passed (image_width/height say what
+// size they refer to).
+static IncrementalOutput runRegion(DocDetector& detector, const uint8_t* data, size_t len, float conf_threshold,
+                                   const DocLayoutPreviousResult* previous, const DocLayoutRegion* region) {
+    IncrementalOutput output;
+    output.class_names = &detector.Descriptor().class_names;
+    auto start = high_resolution_clock::now();
+
+    if (data == nullptr || len == 0) {
+        output.status = DOCLAYOUT_ERR_EMPTY_INPUT;
+        return output;
+    }
+
+    cv::Rect requested;
+    if (region != nullptr && region->width > 0 && region->height > 0) {
+        requested = cv::Rect(region->x, region->y, region->width, region->height);
+    }
+    DecodedImage decoded = detector.DecodeForRegion(data, len, requested);
+    if (decoded.image.empty()) {
+        output.status = DOCLAYOUT_ERR_IMAGE_DECODE;
+        return output;
+    }
+    output.image_width = decoded.original_width;
+    output.image_height = decoded.original_height;
+
+    std::vector<DetectionBox> boxes = previousBoxes(previous, output.image_width, output.image_height);
+    const cv::Rect affected = affectedRegion(boxes, requested, output.image_width, output.image_height);
+
+    // Affected region in decoded pixels, rounded outwards
+    const double sx = static_cast<double>(decoded.image.cols) / output.image_width;
+    const double sy = static_cast<double>(decoded.image.rows) / output.image_height;
+    const int x1 = static_cast<int>(std::floor(affected.x * sx));
+    const int y1 = static_cast<int>(std::floor(affected.y * sy));
+    const int x2 = static_cast<int>(std::ceil(affected.br().x * sx));
+    const int y2 = static_cast<int>(std::ceil(affected.br().y * sy));
+    std::vector<DetectionBox> fresh;
+    if (!detector.DetectRegion(decoded.image, cv::Rect(x1, y1, x2 - x1, y2 - y1), conf_threshold, fresh)) {
+        // Merging nothing would report every previous box in the region removed
+        detector.RecycleDecoded(decoded);
+        output.status = DOCLAYOUT_ERR_INFERENCE_FAILED;
+        return output;
+    }
+    mapDetectionsToOriginal(fresh, decoded.image.cols, decoded.image.rows,
+                            decoded.original_width, decoded.original_height);
+    detector.RecycleDecoded(decoded);
+
+    mergeRegion(boxes, affected, fresh, output.result);
+    finishTiming(output, start);
+    return output;
+}
+
+extern "C" __attribute__((visibility("default")))
+char* detectRegion(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                   const DocLayoutPreviousResult* previous, const DocLayoutRegion* region) {
+    if (handle != nullptr) {
+        return strdup(incrementalJson(runRegion(*static_cast<DocDetector*>(handle), data, len, conf_threshold,
+                                                previous, region)).c_str());
+    }
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(incrementalJson(runRegion(*detector, data, len, conf_threshold, previous, region)).c_str());
+}
+
+extern "C" __attribute__((visibility("default")))
+int detectRegionAsync(void* handle, const uint8_t* data, size_t len, float conf_threshold,
+                      const DocLayoutPreviousResult* previous, const DocLayoutRegion* region,
+                      const DocLayoutRequestOptions* options, int64_t request_id,
+                      DocLayoutResultCallback callback) {
+    if (callback == nullptr) {
+        return 0;
+    }
+    // The caller's buffers may be gone by the time the request runs
+    std::vector<float> rows;
+    DocLayoutPreviousResult copied = {};
+    if (previous != nullptr) {
+        copied = *previous;
+        if (previous->boxes != nullptr && previous->count > 0) {
+            rows.assign(previous->boxes, previous->boxes + static_cast<size_t>(previous->count) * DOCLAYOUT_BOX_FLOATS);
+        }
+    }
+    DocLayoutRegion changed = {};
+    if (region != nullptr) {
+        changed = *region;
+    }
+    RequestWork work = [data, len, conf_threshold, rows, copied, changed](DocDetector& detector) {
+        DocLayoutPreviousResult own = copied;
+        own.boxes = rows.empty() ? nullptr : rows.data();
+        own.count = static_cast<int32_t>(rows.size() / DOCLAYOUT_BOX_FLOATS);
+        return incrementalJson(runRegion(detector, data, len, conf_threshold, &own, &changed));
+    };
+    submitRequest(retainDetector(handle), options, request_id, callback, work);
+    return 1;
+}
+
+extern "C" __attribute__((visibility("default")))
+char* transformResult(void* handle, const DocLayoutPreviousResult* previous, const float* transform,
+                      int32_t width, int32_t height) {
+    if (transform == nullptr || width <= 0 || height <= 0) {
+        return strdup(statusJson(DOCLAYOUT_ERR_INVALID_ARGUMENT));
+    }
+    std::shared_ptr<DocDetector> detector = retainDetector(handle);
+
+    IncrementalOutput output;
+    if (detector) {
+        output.class_names = &detector->Descriptor().class_names;
+    }
+    output.image_width = width;
+    output.image_height = height;
+    // The transform is in the previous result's pixels, so no rescaling
+    const std::array<double, 6> matrix = {transform[0], transform[1], transform[2],
+                                          transform[3], transform[4], transform[5]};
+    transformDetections(previousBoxes(previous, 0, 0), matrix, width, height, output.result);
+    return strdup(incrementalJson(output).c_str());
+}
+
+// Serialize one finished pipeline page the same way detectLayoutFromEncoded does
+static std::string pageResultJson(const PageResult& page, const std::vector<std::string>& class_names) {
+    if (!page.error.empty()) {
+        return "{\"error\":\"" + page.error + "\",\"code\":\"" + page.error_code + "\"}";
+    }
+    return buildResultJson(page.detections, class_names, page.elapsed_ms, page.image_width, page.image_height);
+}
+
+// Enable the content-hash result cache (max_bytes = 0 disables it)
+extern "C" __attribute__((visibility("default")))
+int configureResultCache(int64_t max_bytes, const char* disk_dir) {
+    std::string dir = disk_dir != nullptr ? disk_dir : "";
+    if (max_bytes < 0) {
+        return DOCLAYOUT_ERR_INVALID_ARGUMENT;
+    }
+    if (!ResultCache::GetInstance().Configure(static_cast<size_t>(max_bytes), dir)) {
+        return DOCLAYOUT_ERR_INVALID_ARGUMENT;
+    }
+    return DOCLAYOUT_OK;
+}
 
-        return json.str();
-    }).get().c_str());
+extern "C" __attribute__((visibility("default")))
+void getResultCacheStats(DocLayoutCacheStats* stats) {
+    if (stats == nullptr) {
+        return;
+    }
+    CacheStats current = ResultCache::GetInstance().Stats();
+    stats->hits = static_cast<int64_t>(current.hits);
+    stats->misses = static_cast<int64_t>(current.misses);
+    stats->disk_hits = static_cast<int64_t>(current.disk_hits);
+    stats->evictions = static_cast<int64_t>(current.evictions);
+    stats->entries = static_cast<int64_t>(current.entries);
+    stats->bytes = static_cast<int64_t>(current.bytes);
+}
+
+extern "C" __attribute__((visibility("default")))
+void clearResultCache(int remove_disk) {
+    ResultCache::GetInstance().Clear(remove_disk != 0);
+}
+
+// Per-stage latency percentiles over the recent calls, free with freeString
+extern "C" __attribute__((visibility("default")))
+char* getStats() {
+    return strdup(LatencyStats::GetInstance().ToJson().c_str());
+}
+
+extern "C" __attribute__((visibility("default")))
+void resetStats() {
+    LatencyStats::GetInstance().Reset();
+}
+
+// Release a detector's idle buffers and arena blocks (NULL = default model)
+extern "C" __attribute__((visibility("default")))
+int trimMemory(void* handle, int shrink_arena) {
+    if (handle != nullptr) {
+        static_cast<DocDetector*>(handle)->TrimMemory(shrink_arena != 0);
+        return DOCLAYOUT_OK;
+    }
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    if (!detector) {
+        return DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    detector->TrimMemory(shrink_arena != 0);
+    return DOCLAYOUT_OK;
+}
+
+// Stop ONNX Runtime profiling on a detector (NULL = default model) and
+// return the trace file path, "" if profiling was not enabled
+extern "C" __attribute__((visibility("default")))
+char* endProfiling(void* handle) {
+    if (handle != nullptr) {
+        return strdup(static_cast<DocDetector*>(handle)->EndProfiling().c_str());
+    }
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    return strdup(detector ? detector->EndProfiling().c_str() : "");
+}
+
+// Inputs, outputs, variant and class table of a detector (NULL = default
+// model) as JSON, the MODEL_NOT_LOADED error if there is none
+extern "C" __attribute__((visibility("default")))
+char* getModelInfo(void* handle) {
+    if (handle != nullptr) {
+        return strdup(static_cast<DocDetector*>(handle)->Descriptor().ToJson().c_str());
+    }
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    return strdup(detector ? detector->Descriptor().ToJson().c_str() : kModelNotLoadedJson);
+}
+
+static std::string warmupJson(DocDetector& detector, int iterations) {
+    WarmupStats stats = detector.Warmup(iterations);
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(2)
+         << "{\"runs\":" << stats.runs << ",\"first_ms\":" << stats.first_ms
+         << ",\"mean_ms\":" << stats.mean_ms << ",\"last_ms\":" << stats.last_ms << "}";
+    return json.str();
+}
+
+// Run dummy inferences on the default model so the first real detection
+// runs at steady-state speed. Blocks for the duration, call it off the UI
+// thread. Returns the timings as JSON, or MODEL_NOT_LOADED.
+extern "C" __attribute__((visibility("default")))
+char* warmupModel(int32_t iterations) {
+    std::shared_ptr<DocDetector> detector = getDefaultDetector();
+    return strdup(detector ? warmupJson(*detector, iterations).c_str() : kModelNotLoadedJson);
+}
+
+// Same on a detector instance
+extern "C" __attribute__((visibility("default")))
+char* warmupDetector(void* handle, int32_t iterations) {
+    if (handle == nullptr) {
+        return warmupModel(iterations);
+    }
+    return strdup(warmupJson(*static_cast<DocDetector*>(handle), iterations).c_str());
+}
+
+// CPU features relevant to variant selection and the precision order
+// DOCLAYOUT_PRECISION_AUTO tries on this device
+extern "C" __attribute__((visibility("default")))
+char* getDeviceCapabilities() {
+    const CpuFeatures& cpu = cpuFeatures();
+    std::ostringstream json;
+    json << "{\"cpu\":" << cpu.ToJson() << ",\"preferred\":[";
+    const std::vector<ModelPrecision> preferred = preferredPrecisions(cpu, false);
+    for (size_t i = 0; i < preferred.size(); i++) {
+        json << (i > 0 ? "," : "") << "\"" << precisionName(preferred[i]) << "\"";
+    }
+    json << "],\"preferred_with_accelerator\":[";
+    const std::vector<ModelPrecision> accelerated = preferredPrecisions(cpu, true);
+    for (size_t i = 0; i < accelerated.size(); i++) {
+        json << (i > 0 ? "," : "") << "\"" << precisionName(accelerated[i]) << "\"";
+    }
+    json << "]}";
+    return strdup(json.str().c_str());
+}
+
+// Create a live-camera tracker on a detector instance (NULL = default model)
+extern "C" __attribute__((visibility("default")))
+void* createTracker(void* handle, const DocLayoutTrackerOptions* options) {
+    // Held until destroyTracker, destroyDetector may come first
+    std::shared_ptr<DocDetector> detector = retainDetector(handle);
+    if (!detector) {
+        return nullptr;
+    }
+    TrackerOptions tracker_options;
+    if (options != nullptr) {
+        tracker_options.change_threshold = options->change_threshold;
+        tracker_options.max_age_ms = options->max_age_ms;
+        tracker_options.smoothing = options->smoothing;
+    }
+    return new FrameTracker(detector, tracker_options);
+}
+
+extern "C" __attribute__((visibility("default")))
+char* trackFrameFromBytes(void* tracker, const unsigned char* image_data, int width, int height, int channels,
+                          float conf_threshold) {
+    if (tracker == nullptr) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(outputJson(runTrackedPixels(*static_cast<FrameTracker*>(tracker), image_data, width, height,
+                                              channels, conf_threshold)).c_str());
+}
+
+extern "C" __attribute__((visibility("default")))
+int trackFrameFromBytesToBuffer(void* tracker, const unsigned char* image_data, int width, int height, int channels,
+                                float conf_threshold, float* out, int32_t max_boxes) {
+    PageOutput output;
+    if (tracker != nullptr) {
+        output = runTrackedPixels(*static_cast<FrameTracker*>(tracker), image_data, width, height, channels,
+                                  conf_threshold);
+    } else {
+        output.status = DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    return writeOutput(output, out, max_boxes);
+}
+
+extern "C" __attribute__((visibility("default")))
+char* trackFrameFromYuv(void* tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                        int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                        float conf_threshold) {
+    if (tracker == nullptr) {
+        return strdup(kModelNotLoadedJson);
+    }
+    return strdup(outputJson(runTrackedYuv(*static_cast<FrameTracker*>(tracker), y, u, v, width, height,
+                                           y_row_stride, uv_row_stride, uv_pixel_stride, conf_threshold)).c_str());
+}
+
+extern "C" __attribute__((visibility("default")))
+int trackFrameFromYuvToBuffer(void* tracker, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                              int width, int height, int y_row_stride, int uv_row_stride, int uv_pixel_stride,
+                              float conf_threshold, float* out, int32_t max_boxes) {
+    PageOutput output;
+    if (tracker != nullptr) {
+        output = runTrackedYuv(*static_cast<FrameTracker*>(tracker), y, u, v, width, height,
+                               y_row_stride, uv_row_stride, uv_pixel_stride, conf_threshold);
+    } else {
+        output.status = DOCLAYOUT_ERR_MODEL_NOT_LOADED;
+    }
+    return writeOutput(output, out, max_boxes);
+}
+
+// Forget the cached frame, the next tracked frame always runs inference
+extern "C" __attribute__((visibility("default")))
+void resetTracker(void* tracker) {
+    if (tracker != nullptr) {
+        static_cast<FrameTracker*>(tracker)->Reset();
+    }
+}
+
+extern "C" __attribute__((visibility("default")))
+void destroyTracker(void* tracker) {
+    delete static_cast<FrameTracker*>(tracker);
+}
+
+// Open a streaming page pipeline on a detector instance (NULL = default model)
+extern "C" __attribute__((visibility("default")))
+void* openPageStream(void* handle, float conf_threshold, int32_t queue_depth,
+                     int64_t stream_id, DocLayoutPageCallback callback) {
+    if (callback == nullptr) {
+        return nullptr;
+    }
+    // Held until closePageStream, destroyDetector may come first
+    std::shared_ptr<DocDetector> detector = retainDetector(handle);
+    if (!detector) {
+        return nullptr;
+    }
+    return new PagePipeline(
+        detector, conf_threshold, queue_depth > 0 ? static_cast<size_t>(queue_depth) : 0,
+        [detector](const PageResult& page) { return pageResultJson(page, detector->Descriptor().class_names); },
+        [stream_id, callback](size_t page_index, std::string json) {
+            callback(stream_id, static_cast<int32_t>(page_index), strdup(json.c_str()));
+        });
+}
+
+// Queue an encoded page (copied), returns its page index or -1
+extern "C" __attribute__((visibility("default")))
+int64_t pushPageEncoded(void* stream, const uint8_t* data, size_t len) {
+    if (stream == nullptr) {
+        return -1;
+    }
+    std::vector<uint8_t> bytes;
+    if (data != nullptr && len > 0) {
+        bytes.assign(data, data + len);
+    }
+    return static_cast<PagePipeline*>(stream)->SubmitEncoded(std::move(bytes));
+}
+
+// Queue an image file, returns its page index or -1
+extern "C" __attribute__((visibility("default")))
+int64_t pushPageFile(void* stream, const char* img_path) {
+    if (stream == nullptr || img_path == nullptr) {
+        return -1;
+    }
+    return static_cast<PagePipeline*>(stream)->SubmitFile(img_path);
+}
+
+// Wait for every queued page to be delivered, then release the stream
+extern "C" __attribute__((visibility("default")))
+void closePageStream(void* stream) {
+    delete static_cast<PagePipeline*>(stream);
+}
+
+// Stream the pages of a multi-page file through the page pipeline
+// (handle NULL = default model)
+extern "C" __attribute__((visibility("default")))
+void* detectDocument(void* handle, const char* path, float conf_threshold,
+                     const DocLayoutDocumentOptions* options, int64_t document_id,
+                     DocLayoutPageCallback callback) {
+    if (path == nullptr || callback == nullptr) {
+        return nullptr;
+    }
+    // Held until closeDocument, destroyDetector may come first
+    std::shared_ptr<DocDetector> detector = retainDetector(handle);
+    if (!detector) {
+        return nullptr;
+    }
+    DocumentOptions document_options;
+    if (options != nullptr) {
+        document_options.first_page = static_cast<size_t>(std::max(0, options->first_page));
+        document_options.page_count = static_cast<size_t>(std::max(0, options->page_count));
+        document_options.queue_depth = static_cast<size_t>(std::max(0, options->queue_depth));
+    }
+    return new DocumentStream(
+        detector, path, conf_threshold, document_options,
+        [detector](const PageResult& page) { return pageResultJson(page, detector->Descriptor().class_names); },
+        [document_id, callback](size_t page_index, std::string json) {
+            callback(document_id, static_cast<int32_t>(page_index), strdup(json.c_str()));
+        },
+        [document_id, callback](const DocumentSummary& summary) {
+            callback(document_id, -1, strdup(summary.ToJson().c_str()));
+        });
+}
+
+extern "C" __attribute__((visibility("default")))
+void cancelDocument(void* document) {
+    if (document != nullptr) {
+        static_cast<DocumentStream*>(document)->Cancel();
+    }
+}
+
+extern "C" __attribute__((visibility("default")))
+void closeDocument(void* document) {
+    delete static_cast<DocumentStream*>(document);
+}
+
+// Release a detector instance. Queued requests, trackers and streams still
+// using it keep the session until they finish.
+extern "C" __attribute__((visibility("default")))
+void destroyDetector(void* handle) {
+    std::shared_ptr<DocDetector> released;
+    {
+        std::lock_guard<std::mutex> lock(g_handles_mutex);
+        auto it = g_handles.find(handle);
+        if (it == g_handles.end()) {
+            return;
+        }
+        released = std::move(it->second);
+        g_handles.erase(it);
+    }
+    // The session, if this was the last reference, is released outside the lock
 }
 
 // Free allocated string memory